@@ -0,0 +1,52 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ * 
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief A read-only memory mapped file implementation.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+
+#ifndef MAPPED_FILE_H_INCLUDED
+#define MAPPED_FILE_H_INCLUDED
+
+//! A read-only memory mapped file implementation.
+class MappedFile
+{
+public:
+    //! Constructor.
+    MappedFile();
+
+    //! Destructor. Closes the file if it is open.
+    ~MappedFile();
+
+    //! Opens the file and maps it to memory.
+    bool open(const char *aFileName);
+
+    //! Unmaps and closes the file.
+    void close();
+
+    //! Returns a pointer to the contents of the file, NULL if the file is not open.
+    const char *getData();
+
+    //! Returns the size of the file in bytes.
+    int getSize();
+
+protected:
+    void *mFile;
+    void *mMapping;
+    const char *mData;
+    int mSize;
+};
+
+#endif // !MAPPED_FILE_H_INCLUDED
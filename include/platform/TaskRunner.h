@@ -0,0 +1,67 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ * 
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief A task runner implementation.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+
+#ifndef TASK_RUNNER_H_INCLUDED
+#define TASK_RUNNER_H_INCLUDED
+
+// The maximum count of threads in a task runner.
+#define TASKRUNNER_MAX_THREADS 64
+
+//! A task that is run by a task runner.
+class TaskRunnerTask
+{
+public:
+    //! Virtual destructor.
+    virtual ~TaskRunnerTask();
+
+    //! Runs the task.
+    virtual void run() = 0;
+};
+
+
+//! A task runner implementation.
+/*! Runs a set of tasks concurrently in a number of threads. The tasks are taken
+ *  in their order by the first free thread.
+ */
+class TaskRunner
+{
+public:
+    //! Constructor.
+    TaskRunner();
+
+    //! Initializer.
+    void init(int aThreadCount);
+
+    //! Returns the count of threads.
+    int getThreadCount();
+
+    //! Runs the tasks and returns when all of them are done.
+    void run(TaskRunnerTask * const *aTasks, int aTaskCount);
+
+    //! Runs the tasks of the current run until none are left.
+    void runTasks();
+
+protected:
+    int mThreadCount;
+    TaskRunnerTask * const *mTasks;
+    int mTaskCount;
+    volatile long mNextTask;
+};
+
+#endif // !TASK_RUNNER_H_INCLUDED
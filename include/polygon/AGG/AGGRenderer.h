@@ -37,6 +37,9 @@ public:
     virtual void render(RenderTargetWrapper *aTarget, PolygonWrapper *aPolygon, PaintWrapper *aColor,
                         RENDERER_FILLMODE aFillMode, const MATRIX2D &aTransformation);
 
+    //! Sets the clip rectangle for the renderer.
+    virtual void setClipRect(unsigned int aX, unsigned int aY, unsigned int aWidth, unsigned int aHeight);
+
     //! Returns a pointer to the path storage of the renderer.
     agg::path_storage *getPathStorage()
     {
@@ -56,6 +59,12 @@ protected:
     MATRIX2D mCachedTransformation;
     agg::trans_affine mMatrix;
     agg::conv_transform<agg::path_storage, agg::trans_affine> mConvTransformation;
+
+    bool mClip;
+    int mClipX1;
+    int mClipY1;
+    int mClipX2;
+    int mClipY2;
 };
 
 #endif // !AGG_RENDER_TARGET_H_INCLUDED
@@ -24,6 +24,12 @@
 class GDIplusRenderer : public Renderer
 {
 public:
+    //! Constructor.
+    GDIplusRenderer()
+    {
+        mClip = false;
+    }
+
     //! Renders a polygon.
     /*! /param aTarget the render target for rendering the polygon.
      *  /param aPolygon the polygon to render.
@@ -33,6 +39,13 @@ public:
      */
     virtual void render(RenderTargetWrapper *aTarget, PolygonWrapper *aPolygon, PaintWrapper *aColor,
                         RENDERER_FILLMODE aFillMode, const MATRIX2D &aTransformation);
+
+    //! Sets the clip rectangle for the renderer.
+    virtual void setClipRect(unsigned int aX, unsigned int aY, unsigned int aWidth, unsigned int aHeight);
+
+protected:
+    bool mClip;
+    Rect mClipRect;
 };
 
 #endif // !GDI_PLUS_RENDER_TARGET_H_INCLUDED
@@ -23,12 +23,15 @@
 #include "polygon/base/Platform.h"
 #include "polygon/base/ClipRectangle.h"
 #include "polygon/base/PolygonData.h"
+#include "polygon/base/PathData.h"
+#include "polygon/base/Stroker.h"
 #include "polygon/base/PolygonWrapper.h"
 #include "polygon/base/PaintWrapper.h"
 #include "polygon/base/DefaultPaintWrapper.h"
 #include "polygon/base/PolygonFactory.h"
 #include "polygon/base/RenderTargetWrapper.h"
 #include "polygon/base/Renderer.h"
+#include "polygon/base/PolygonGrid.h"
 #include "polygon/base/VectorGraphic.h"
 
 #endif // !BASE_H_INCLUDED
@@ -0,0 +1,102 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ * 
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief A class for holding raw path data with curves.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+#ifndef PATH_DATA_H_INCLUDED
+#define PATH_DATA_H_INCLUDED
+
+// Point tags of the path data. Each segment ends at an on-curve point. A segment
+// that starts with one quadratic control point is a quadratic bezier curve, and
+// a segment that starts with two cubic control points is a cubic bezier curve.
+#define PATH_POINT_TAG unsigned char
+#define PATH_POINT_ON_CURVE 0
+#define PATH_POINT_QUADRATIC 1
+#define PATH_POINT_CUBIC 2
+
+// The maximum amount of segments a single bezier curve is split to.
+#define PATH_DATA_MAX_CURVE_STEPS 1024
+
+//! A class for holding raw path data with curves.
+/*! The data consists of sub-paths. Each sub-path is a set of points with tags,
+ *  starting with an on-curve point. The sub-paths are closed implicitly when
+ *  filled. For strokes, the sub-paths can be marked closed or open.
+ */
+class PathData
+{
+public:
+    //! Constructor.
+    /*! \param aClosedData the closed flags of the sub-paths, or NULL if all sub-paths are closed.
+     */
+    PathData(const RATIONAL * const *aPointData, const PATH_POINT_TAG * const *aTagData, const int *aPointCounts, int aSubPathCount,
+             const bool *aClosedData = NULL) :
+      mPointData(aPointData), mTagData(aTagData), mPointCounts(aPointCounts), mSubPathCount(aSubPathCount), mClosedData(aClosedData) { }
+
+    //! Returns the count of sub-paths.
+    inline int getSubPathCount() const
+    {
+        return mSubPathCount;
+    }
+
+    //! Returns a pointer to the point data array of a sub-path at given index.
+    inline const RATIONAL * getPointData(int aIndex) const
+    {
+        return mPointData[aIndex];
+    }
+
+    //! Returns a pointer to the tag array of a sub-path at given index.
+    inline const PATH_POINT_TAG * getTagData(int aIndex) const
+    {
+        return mTagData[aIndex];
+    }
+
+    //! Returns the point count of a sub-path at given index.
+    inline int getPointCount(int aIndex) const
+    {
+        return mPointCounts[aIndex];
+    }
+
+    //! Returns true if a sub-path at given index is closed.
+    inline bool isClosed(int aIndex) const
+    {
+        return mClosedData == NULL || mClosedData[aIndex];
+    }
+
+    //! Flattens a sub-path to vertices.
+    /*! \param aIndex the index of the sub-path.
+     *  \param aFlatness the maximum distance of the vertices from the curves.
+     *  \param aVertices the array for the vertices, two values per vertex, or NULL
+     *         for counting the vertices only.
+     *  \return the amount of vertices.
+     */
+    int flatten(int aIndex, RATIONAL aFlatness, RATIONAL *aVertices) const;
+
+    //! Returns the amount of segments a curve is split to for given flatness.
+    /*! \param aDifference the maximum length of the second differences of the control points.
+     *  \param aDegree the degree of the curve.
+     *  \param aFlatness the maximum distance of the segments from the curve.
+     */
+    static int getCurveSteps(RATIONAL aDifference, int aDegree, RATIONAL aFlatness);
+
+protected:
+    const RATIONAL * const *mPointData;
+    const PATH_POINT_TAG * const *mTagData;
+    const int *mPointCounts;
+    int mSubPathCount;
+    const bool *mClosedData;
+};
+
+#endif // !PATH_DATA_H_INCLUDED
@@ -47,6 +47,22 @@
 #define TICKCOUNTER_END(aTickCounter) aTickCounter.end()
 #define TICKCOUNTER_GETTICKS(aTickCounter) aTickCounter.getTicks()
 
+// Memory mapped file defines
+#include "platform/MappedFile.h"
+#define MAPPEDFILE MappedFile
+#define MAPPEDFILE_OPEN(aMappedFile,aName) aMappedFile.open(aName)
+#define MAPPEDFILE_GETDATA(aMappedFile) aMappedFile.getData()
+#define MAPPEDFILE_GETSIZE(aMappedFile) aMappedFile.getSize()
+#define MAPPEDFILE_CLOSE(aMappedFile) aMappedFile.close()
+
+// Task runner defines
+#include "platform/TaskRunner.h"
+#define TASKRUNNER TaskRunner
+#define TASKRUNNER_TASK TaskRunnerTask
+#define TASKRUNNER_INIT(aTaskRunner,aThreadCount) aTaskRunner.init(aThreadCount)
+#define TASKRUNNER_GETTHREADCOUNT(aTaskRunner) aTaskRunner.getThreadCount()
+#define TASKRUNNER_RUN(aTaskRunner,aTasks,aTaskCount) aTaskRunner.run(aTasks,aTaskCount)
+
 // Defines for the rational number format.
 #define RATIONAL float
 #define INT_TO_RATIONAL(a) ((float)(a))
@@ -45,6 +45,37 @@ public:
         return mVertexCounts[aIndex];
     }
 
+    //! Calculates the bounding box of the vertex data.
+    /*! \param aBounds the array for the result in the order of minimum x, minimum y,
+     *         maximum x and maximum y. Zero for polygons without vertices.
+     */
+    void getBounds(RATIONAL *aBounds) const
+    {
+        bool first = true;
+        aBounds[0] = aBounds[1] = aBounds[2] = aBounds[3] = INT_TO_RATIONAL(0);
+
+        int n;
+        for (n = 0; n < mSubPolygonCount; n++)
+        {
+            const RATIONAL *vertices = mVertexData[n];
+            int p;
+            for (p = 0; p < mVertexCounts[n]; p++)
+            {
+                RATIONAL x = vertices[p * 2];
+                RATIONAL y = vertices[p * 2 + 1];
+                if (first || x < aBounds[0])
+                    aBounds[0] = x;
+                if (first || y < aBounds[1])
+                    aBounds[1] = y;
+                if (first || x > aBounds[2])
+                    aBounds[2] = x;
+                if (first || y > aBounds[3])
+                    aBounds[3] = y;
+                first = false;
+            }
+        }
+    }
+
 protected:
     const RATIONAL * const *mVertexData;
     const int *mVertexCounts;
@@ -30,6 +30,22 @@ public:
     //! Creates a polygon with the factory.
     virtual PolygonWrapper * createPolygonWrapper(const PolygonData *aData) = 0;
 
+    //! Creates a polygon with the factory, keeping the curves it was flattened from.
+    /*! Factories that don't support curves create the polygon from the flattened data.
+     */
+    virtual PolygonWrapper * createCurvePolygonWrapper(const PolygonData *aData, const PathData * /*aPathData*/)
+    {
+        return createPolygonWrapper(aData);
+    }
+
+    //! Creates a stroke polygon with the factory, keeping the path it was stroked from.
+    /*! Factories that don't support curves create the polygon from the stroked data.
+     */
+    virtual PolygonWrapper * createStrokePolygonWrapper(const PolygonData *aData, const PathData * /*aPathData*/, const StrokeStyle * /*aStrokeStyle*/)
+    {
+        return createPolygonWrapper(aData);
+    }
+
     //! Creates a paint with the factory from an RGB color.
     virtual PaintWrapper * createPaintWrapper(const unsigned int aColor)
     {
@@ -0,0 +1,122 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ * 
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief A uniform grid for finding the polygons that intersect a rectangle.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+#ifndef POLYGON_GRID_H_INCLUDED
+#define POLYGON_GRID_H_INCLUDED
+
+// The maximum amount of grid cells in one direction.
+#define POLYGON_GRID_MAX_CELLS 1024
+
+//! A uniform grid for finding the polygons that intersect a rectangle.
+/*! The grid is built from the bounding boxes of the polygons. Each cell lists the
+ *  polygons whose bounding box overlaps the cell. The grid has roughly as many
+ *  cells as there are polygons.
+ */
+class PolygonGrid
+{
+public:
+    //! Constructor.
+    PolygonGrid();
+
+    //! Initializer.
+    /*! \param aBounds the bounding boxes of the polygons, four values per polygon in
+     *         the order of minimum x, minimum y, maximum x and maximum y.
+     *  \param aPolygonCount the amount of polygons.
+     */
+    bool init(const RATIONAL *aBounds, int aPolygonCount);
+
+    //! Destructor.
+    ~PolygonGrid();
+
+    //! Returns the amount of polygons in the grid.
+    inline int getPolygonCount() const
+    {
+        return mPolygonCount;
+    }
+
+    //! Finds the polygons whose bounding box intersects the given rectangle.
+    /*! \param aMinX the minimum x of the rectangle.
+     *  \param aMinY the minimum y of the rectangle.
+     *  \param aMaxX the maximum x of the rectangle.
+     *  \param aMaxY the maximum y of the rectangle.
+     *  \param aResult the array for the polygon indices. It has to be able to hold all
+     *         polygons of the grid.
+     *  \return the amount of polygons found. The indices are in ascending order.
+     */
+    int query(RATIONAL aMinX, RATIONAL aMinY, RATIONAL aMaxX, RATIONAL aMaxY, int *aResult);
+
+    //! Updates the bounding box of a polygon.
+    /*! The cells are not rebuilt. Instead, the polygon is added to a list of moved
+     *  polygons that every query checks. The grid should be rebuilt when the list
+     *  gets long.
+     */
+    void update(int aIndex, const RATIONAL *aBounds);
+
+    //! Returns the amount of polygons that have moved since the grid was built.
+    inline int getMovedCount() const
+    {
+        return mMovedCount;
+    }
+
+protected:
+    //! Returns the column of the cell containing aX, clamped to the grid.
+    inline int getColumn(RATIONAL aX) const
+    {
+        int column = (int)((aX - mMinX) * mColumnScale);
+        if (column < 0)
+            return 0;
+        if (column >= mColumns)
+            return mColumns - 1;
+        return column;
+    }
+
+    //! Returns the row of the cell containing aY, clamped to the grid.
+    inline int getRow(RATIONAL aY) const
+    {
+        int row = (int)((aY - mMinY) * mRowScale);
+        if (row < 0)
+            return 0;
+        if (row >= mRows)
+            return mRows - 1;
+        return row;
+    }
+
+    int mPolygonCount;
+    RATIONAL *mBounds;
+
+    RATIONAL mMinX;
+    RATIONAL mMinY;
+    RATIONAL mColumnScale;
+    RATIONAL mRowScale;
+    int mColumns;
+    int mRows;
+
+    //! Index of the first polygon of each cell in mCellPolygons.
+    int *mCellStart;
+    int *mCellPolygons;
+
+    //! One bit per polygon for collecting the query results.
+    unsigned int *mQueryBits;
+
+    //! The polygons whose bounding box has changed since the grid was built.
+    int *mMovedPolygons;
+    int mMovedCount;
+    unsigned char *mMovedFlags;
+};
+
+#endif // !POLYGON_GRID_H_INCLUDED
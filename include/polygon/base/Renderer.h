@@ -43,6 +43,53 @@ public:
      */
     virtual void render(RenderTargetWrapper *aTarget, PolygonWrapper *aPolygon, PaintWrapper *aColor,
                         RENDERER_FILLMODE aFillMode, const MATRIX2D &aTransformation) = 0;
+
+    //! Sets the clip rectangle for the renderer.
+    virtual void setClipRect(unsigned int aX, unsigned int aY, unsigned int aWidth, unsigned int aHeight) = 0;
+
+    //! Limits the rendering to a damaged area of the target.
+    /*! The pixels inside the area are rendered exactly as without the limit and
+     *  the pixels outside are left untouched. The default implementation uses
+     *  the clip rectangle. Setting the clip rectangle or an area covering it
+     *  removes the limit.
+     */
+    virtual void setDamageRect(unsigned int aX, unsigned int aY, unsigned int aWidth, unsigned int aHeight)
+    {
+        setClipRect(aX,aY,aWidth,aHeight);
+    }
+
+    //! Replaces the pixels of the damaged area with a color.
+    /*! The default implementation renders the polygon of the area.
+     *  /param aTarget the render target.
+     *  /param aArea the pixel aligned rectangle of the damaged area.
+     *  /param aColor the color for the area.
+     */
+    virtual void clearDamageRect(RenderTargetWrapper *aTarget, PolygonWrapper *aArea, PaintWrapper *aColor)
+    {
+        MATRIX2D identity;
+        MATRIX2D_MAKEIDENTITY(identity);
+        render(aTarget,aArea,aColor,RENDERER_FILLMODE_EVENODD,identity);
+    }
+
+    //! Renders a set of polygons in painter's order.
+    /*! The default implementation renders the polygons one at a time. Renderers
+     *  can override this for rendering all polygons in a single pass. Returns
+     *  false if the rendering fails.
+     *  /param aTarget the render target for rendering the polygons.
+     *  /param aPolygons the polygons to render.
+     *  /param aColors the rendering colors.
+     *  /param aFillModes the fill modes for rendering.
+     *  /param aPolygonCount the amount of polygons.
+     *  /param aTransformation the transformation for rendering.
+     */
+    virtual bool renderScene(RenderTargetWrapper *aTarget, PolygonWrapper * const *aPolygons, PaintWrapper * const *aColors,
+                             const RENDERER_FILLMODE *aFillModes, int aPolygonCount, const MATRIX2D &aTransformation)
+    {
+        int n;
+        for (n = 0; n < aPolygonCount; n++)
+            render(aTarget,aPolygons[n],aColors[n],aFillModes[n],aTransformation);
+        return true;
+    }
 };
 
 #endif // !RENDER_TARGET_H_INCLUDED
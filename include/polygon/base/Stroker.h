@@ -0,0 +1,149 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ * 
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief A class for converting strokes to polygons.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+
+#ifndef STROKER_H_INCLUDED
+#define STROKER_H_INCLUDED
+
+// Join styles of the strokes.
+#define STROKE_JOIN unsigned char
+#define STROKE_JOIN_MITER 0
+#define STROKE_JOIN_ROUND 1
+#define STROKE_JOIN_BEVEL 2
+
+// Cap styles of the strokes.
+#define STROKE_CAP unsigned char
+#define STROKE_CAP_BUTT 0
+#define STROKE_CAP_ROUND 1
+#define STROKE_CAP_SQUARE 2
+
+// The maximum amount of segments a round join or cap is split to.
+#define STROKER_MAX_ARC_STEPS 256
+
+//! Parameters of a stroke.
+class StrokeStyle
+{
+public:
+    //! Constructor. The defaults are the same as in SVG.
+    StrokeStyle() :
+      mWidth(INT_TO_RATIONAL(1)), mJoin(STROKE_JOIN_MITER), mCap(STROKE_CAP_BUTT),
+      mMiterLimit(INT_TO_RATIONAL(4)), mHairline(false) { }
+
+    //! The width of the stroke.
+    RATIONAL mWidth;
+    STROKE_JOIN mJoin;
+    STROKE_CAP mCap;
+    //! The maximum ratio of the miter length and the width. Longer miters are beveled.
+    RATIONAL mMiterLimit;
+    //! If true, the width is in pixels regardless of the scale, and the joins and caps are left out.
+    bool mHairline;
+};
+
+//! A class for converting the sub-paths of a path to polygons that cover the stroke.
+/*! The sub-paths are flattened and the segments are offset by half of the width to
+ *  both sides. An open sub-path becomes a single outline that goes along one side
+ *  and back along the other, with caps at the ends. A closed sub-path becomes two
+ *  outlines of opposite orientation. The joins on the inner side of a turn go
+ *  through the vertex, which keeps the winding right even if the segments are
+ *  shorter than the width. The polygons have to be filled with the non-zero
+ *  winding rule.
+ *
+ *  In hairline mode the offset segments are connected directly without joins and
+ *  caps, which is enough for strokes that are about a pixel wide.
+ */
+class Stroker
+{
+public:
+    //! Constructor.
+    Stroker();
+
+    //! Destructor.
+    ~Stroker();
+
+    //! Strokes a path to polygons.
+    /*! The result is kept until the next call.
+     *  \param aPathData the path.
+     *  \param aStyle the style of the stroke.
+     *  \param aWidth the width of the stroke in the coordinates of the path.
+     *  \param aFlatness the maximum distance of the polygons from the curves and
+     *         the round joins and caps.
+     */
+    bool stroke(const PathData *aPathData, const StrokeStyle &aStyle, RATIONAL aWidth, RATIONAL aFlatness);
+
+    //! Returns the amount of sub-polygons in the result.
+    inline int getSubPolygonCount() const
+    {
+        return mSubPolygonCount;
+    }
+
+    //! Returns a pointer to the vertex data arrays of the sub-polygons.
+    inline const RATIONAL * const * getVertexData() const
+    {
+        return mSubPolygonData;
+    }
+
+    //! Returns a pointer to the vertex counts of the sub-polygons.
+    inline const int * getVertexCounts() const
+    {
+        return mSubPolygonCounts;
+    }
+
+protected:
+    //! Strokes the flattened sub-path in mPathVertices.
+    bool strokeSubPath(int aCount, bool aClosed);
+
+    //! Adds the offset vertices of one side of the flattened sub-path.
+    bool addSide(int aCount, int aFirst, int aStep, bool aClosed);
+
+    //! Adds a join between two segments.
+    bool addJoin(RATIONAL aX, RATIONAL aY, RATIONAL aDX0, RATIONAL aDY0, RATIONAL aDX1, RATIONAL aDY1);
+
+    //! Adds a cap at the end of a side.
+    bool addCap(RATIONAL aX, RATIONAL aY, RATIONAL aDX, RATIONAL aDY);
+
+    //! Adds the vertices of an arc between its end points.
+    bool addArc(RATIONAL aX, RATIONAL aY, RATIONAL aVX, RATIONAL aVY, double aAngle);
+
+    //! Begins a new sub-polygon.
+    bool beginSubPolygon();
+
+    //! Ends the sub-polygon.
+    void endSubPolygon();
+
+    //! Adds a vertex to the current sub-polygon.
+    bool addVertex(RATIONAL aX, RATIONAL aY);
+
+    RATIONAL *mPathVertices;
+    int mPathVertexCapacity;
+
+    RATIONAL *mVertices;
+    int mVertexCount;
+    int mVertexCapacity;
+
+    int *mSubPolygonStarts;
+    RATIONAL **mSubPolygonData;
+    int *mSubPolygonCounts;
+    int mSubPolygonCount;
+    int mSubPolygonCapacity;
+
+    RATIONAL mHalfWidth;
+    RATIONAL mFlatness;
+    StrokeStyle mStyle;
+};
+
+#endif // !STROKER_H_INCLUDED
@@ -19,6 +19,12 @@
 #ifndef VECTOR_GRAPHIC_H_INCLUDED
 #define VECTOR_GRAPHIC_H_INCLUDED
 
+// The minimum amount of polygons for building a spatial index for the graphic.
+#define VECTOR_GRAPHIC_GRID_MIN_POLYGONS 64
+
+// The spatial index is rebuilt when more than 1/2^n of the polygons have moved.
+#define VECTOR_GRAPHIC_GRID_REBUILD_SHIFT 3
+
 //! A vector graphic image is a set of polygons. Each polygon is associated with a color.
 class VectorGraphic
 {
@@ -53,6 +59,20 @@ public:
         return mFillModes[aIndex];
     }
 
+    //! Returns the layer count of the graphic. Graphics without layers have one layer.
+    inline int getLayerCount() const
+    {
+        return mLayerCount;
+    }
+
+    //! Returns the version of the layer at given index.
+    /*! The version changes whenever a polygon or a color of the layer is replaced.
+     */
+    inline unsigned int getLayerVersion(int aLayer) const
+    {
+        return mLayerVersions[aLayer];
+    }
+
     //! Renders the vector graphic with given renderer.
     /*! /param aRenderer the class to use for rendering.
      *  /param aTarget the render target.
@@ -60,16 +80,135 @@ public:
      */
     void render(Renderer *aRenderer, RenderTargetWrapper *aTarget, const MATRIX2D &aTransformation);
 
+    //! Renders the polygons of the vector graphic that intersect a viewport.
+    /*! Only the polygons whose bounding box intersects the viewport are passed to
+     *  the renderer, in the original order. The spatial index is used for finding
+     *  them if the graphic has one. Note that the polygons are not clipped to the
+     *  viewport.
+     *  /param aRenderer the class to use for rendering.
+     *  /param aTarget the render target.
+     *  /param aTransformation the transformation to use in the rendering.
+     *  /param aViewport the area of the target to render, in pixels.
+     */
+    void render(Renderer *aRenderer, RenderTargetWrapper *aTarget, const MATRIX2D &aTransformation,
+                const ClipRectangle &aViewport);
+
+    //! Renders the vector graphic with given renderer as a single scene.
+    /*! All polygons are passed to the renderer at once, so that the renderer can
+     *  composite them in a single pass over the target. Returns false if the
+     *  renderer fails.
+     *  /param aRenderer the class to use for rendering.
+     *  /param aTarget the render target.
+     *  /param aTransformation the transformation to use in the rendering.
+     */
+    bool renderScene(Renderer *aRenderer, RenderTargetWrapper *aTarget, const MATRIX2D &aTransformation);
+
+    //! Renders a range of layers of the vector graphic.
+    /*! The target is not notified with onRenderDone(), so that several ranges can
+     *  be rendered to the same target.
+     *  /param aRenderer the class to use for rendering.
+     *  /param aTarget the render target.
+     *  /param aTransformation the transformation to use in the rendering.
+     *  /param aFirstLayer the first layer to render.
+     *  /param aLastLayer the last layer to render.
+     */
+    void renderLayers(Renderer *aRenderer, RenderTargetWrapper *aTarget, const MATRIX2D &aTransformation,
+                      int aFirstLayer, int aLastLayer);
+
+    //! Divides the polygons to layers.
+    /*! Each layer is a range of consecutive polygons. Layers without polygons are
+     *  dropped.
+     *  /param aLayerStarts the index of the first polygon of each layer in ascending order.
+     *  /param aLayerCount the amount of layers.
+     */
+    bool setLayers(const int *aLayerStarts, int aLayerCount);
+
+    //! Stores the bounding boxes of the polygons.
+    /*! The bounding boxes are used for the viewport and damage queries. A spatial
+     *  index is built for graphics with at least VECTOR_GRAPHIC_GRID_MIN_POLYGONS
+     *  polygons.
+     *  /param aPolygons the data the polygons of the graphic were created from.
+     */
+    bool initBounds(const PolygonData * const *aPolygons);
+
+    //! Replaces the polygon at given index.
+    /*! The area covered by the old and the new polygon is added to the damaged area.
+     *  /param aIndex the index of the polygon.
+     *  /param aData the new polygon data.
+     *  /param aFactory the factory for creating the polygon.
+     */
+    bool setPolygon(int aIndex, const PolygonData *aData, PolygonFactory *aFactory);
+
+    //! Replaces the color of the polygon at given index.
+    /*! The area covered by the polygon is added to the damaged area.
+     *  /param aIndex the index of the polygon.
+     *  /param aColor the new color.
+     *  /param aFactory the factory for creating the paint.
+     */
+    bool setColor(int aIndex, unsigned long aColor, PolygonFactory *aFactory);
+
+    //! Re-renders the damaged area of the vector graphic.
+    /*! The damaged area is transformed to the target, the rendering is limited to it
+     *  with the damage rectangle of the renderer, the area is cleared with the background
+     *  color and only the polygons that intersect it are rendered. The limit is removed
+     *  with aClip afterwards. The target is expected to hold the result of an earlier rendering
+     *  with the same transformation.
+     *  /param aRenderer the class to use for rendering.
+     *  /param aTarget the render target.
+     *  /param aTransformation the transformation to use in the rendering.
+     *  /param aClip the normal clip rectangle of the rendering, in pixels.
+     *  /param aBackgroundColor the color for clearing the damaged area.
+     *  /param aFactory the factory for creating the background polygon.
+     */
+    void renderChanges(Renderer *aRenderer, RenderTargetWrapper *aTarget, const MATRIX2D &aTransformation,
+                       const ClipRectangle &aClip, unsigned long aBackgroundColor, PolygonFactory *aFactory);
+
     //! Static method for creating the vector graphic from data.
+    /*! The bounding boxes of the polygons are stored with initBounds().
+     */
     static VectorGraphic * create(const PolygonData * const *aPolygons, const unsigned long *aColors,
                                   const RENDERER_FILLMODE *aFillModes, int aPolygonCount,
                                   PolygonFactory *aFactory);
 
 protected:
+    //! Builds a spatial index for the polygons from the bounding boxes.
+    bool initGrid();
+
+    //! Finds the polygons whose bounding box intersects a rectangle in object space.
+    /*! The result is stored to mVisiblePolygons in the original order.
+     *  \return the amount of polygons found.
+     */
+    int findPolygons(RATIONAL aMinX, RATIONAL aMinY, RATIONAL aMaxX, RATIONAL aMaxY);
+
+    //! Adds the bounding box of a polygon to the damaged area.
+    void addDamage(int aIndex);
+
+    //! Returns the layer of the polygon at given index.
+    int getLayer(int aIndex) const;
+
     int mPolygonCount;
     PolygonWrapper **mPolygons;
     PaintWrapper **mColors;
     RENDERER_FILLMODE *mFillModes;
+    PolygonGrid *mGrid;
+    int *mVisiblePolygons;
+
+    //! Bounding boxes of the polygons in object space, four values per polygon.
+    RATIONAL *mBounds;
+
+    //! Bounding box of the damaged area in object space.
+    RATIONAL mDamage[4];
+    bool mDamaged;
+    bool mFullDamage;
+
+    //! The index of the first polygon of each layer, followed by the polygon count.
+    int *mLayerStarts;
+    unsigned int *mLayerVersions;
+    int mLayerCount;
+
+    //! The layer data for graphics without layers.
+    int mDefaultLayerStarts[2];
+    unsigned int mDefaultLayerVersion;
 };
 
 #endif // !VECTOR_GRAPHIC_H_INCLUDED
@@ -33,7 +33,9 @@ public:
         BITMAP_FORMAT_RGBX,
         BITMAP_FORMAT_RGBA,
         BITMAP_FORMAT_BGRX,
-        BITMAP_FORMAT_BGRA
+        BITMAP_FORMAT_BGRA,
+        BITMAP_FORMAT_RGBA32F,
+        BITMAP_FORMAT_RGBA16F
     };
 
     //! Constructor.
@@ -42,13 +44,23 @@ public:
      *  /param aPitch the lenght of one scanline in bytes.
      *  /param aData a pointer to the data.
      *  /param aFormat the format of the bitmap.
+     *
+     *  For the floating point formats aData points to four floats (RGBA32F) or
+     *  four half floats (RGBA16F) per pixel, cast to unsigned long *. The pitch
+     *  is in bytes for these formats as well.
      */
     BitmapData(unsigned int aWidth, unsigned int aHeight,
                unsigned int aPitch, unsigned long *aData,
                BitmapFormat aFormat) :
                mWidth(aWidth), mHeight(aHeight), mPitch(aPitch), mData(aData),
                mFormat(aFormat) {}
-    
+
+    //! Returns true if the format is one of the floating point formats.
+    inline bool isFloatFormat() const
+    {
+        return mFormat == BITMAP_FORMAT_RGBA32F || mFormat == BITMAP_FORMAT_RGBA16F;
+    }
+
     unsigned int mWidth;
     unsigned int mHeight;
     unsigned int mPitch;
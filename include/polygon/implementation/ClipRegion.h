@@ -0,0 +1,143 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ *
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief A clip region made of several rectangles.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+
+#ifndef CLIP_REGION_H_INCLUDED
+#define CLIP_REGION_H_INCLUDED
+
+//! A horizontal interval of a clip region. The coordinates are inclusive.
+typedef struct ClipRegionSpan
+{
+    int mMinX;
+    int mMaxX;
+} ClipRegionSpan;
+
+//! A band of scanlines with the same intervals. The coordinates are inclusive.
+typedef struct ClipRegionBand
+{
+    int mMinY;
+    int mMaxY;
+    int mFirstSpan;
+    int mSpanCount;
+} ClipRegionBand;
+
+//! A class for defining a clip region as a union of rectangles.
+/*! The region is stored as bands of scanlines sorted from top to bottom. Each band
+ *  has a list of non-overlapping intervals sorted from left to right.
+ */
+class ClipRegion
+{
+public:
+    //! Constructor.
+    ClipRegion();
+
+    //! Destructor.
+    ~ClipRegion();
+
+    //! Removes all rectangles from the region.
+    void reset();
+
+    //! Adds a rectangle to the region.
+    /*! \param aX the left edge of the rectangle in pixels.
+     *  \param aY the top edge of the rectangle in pixels.
+     *  \param aWidth the width of the rectangle in pixels.
+     *  \param aHeight the height of the rectangle in pixels.
+     */
+    bool addRectangle(int aX, int aY, int aWidth, int aHeight);
+
+    //! Returns true if the region is empty.
+    inline bool isEmpty() const
+    {
+        return mBandCount == 0;
+    }
+
+    //! Returns the minimum X of the bounds.
+    inline int getMinX() const { return mMinX; }
+
+    //! Returns the minimum Y of the bounds.
+    inline int getMinY() const { return mMinY; }
+
+    //! Returns the maximum X of the bounds.
+    inline int getMaxX() const { return mMaxX; }
+
+    //! Returns the maximum Y of the bounds.
+    inline int getMaxY() const { return mMaxY; }
+
+    //! Returns a band.
+    inline const ClipRegionBand & getBand(int aIndex) const
+    {
+        return mBands[aIndex];
+    }
+
+    //! Returns the intervals of a band.
+    inline const ClipRegionSpan * getSpans(const ClipRegionBand &aBand) const
+    {
+        return &mSpans[aBand.mFirstSpan];
+    }
+
+    //! Returns the index of the band containing a scanline, or -1 if there is none.
+    /*! The scanlines are typically processed in order, so the band of the previous
+     *  scanline is given as a hint.
+     */
+    inline int findBand(int aY, int aHint) const
+    {
+        if (aHint >= 0 && aHint < mBandCount)
+        {
+            if (aY >= mBands[aHint].mMinY && aY <= mBands[aHint].mMaxY)
+                return aHint;
+            if (aHint + 1 < mBandCount &&
+                aY >= mBands[aHint + 1].mMinY && aY <= mBands[aHint + 1].mMaxY)
+                return aHint + 1;
+        }
+
+        int first = 0;
+        int last = mBandCount - 1;
+        while (first <= last)
+        {
+            int middle = (first + last) >> 1;
+            if (aY < mBands[middle].mMinY)
+                last = middle - 1;
+            else if (aY > mBands[middle].mMaxY)
+                first = middle + 1;
+            else
+                return middle;
+        }
+        return -1;
+    }
+
+protected:
+    //! Builds the bands from the rectangles.
+    bool updateBands();
+
+    //! The rectangles of the region, four coordinates each.
+    int *mRectangles;
+    int mRectangleCount;
+    int mRectangleCapacity;
+
+    ClipRegionBand *mBands;
+    int mBandCount;
+    ClipRegionSpan *mSpans;
+    int mSpanCount;
+
+    int mMinX;
+    int mMinY;
+    int mMaxX;
+    int mMaxY;
+};
+
+#endif // !CLIP_REGION_H_INCLUDED
@@ -111,6 +111,24 @@ public:
         return Polygon::create(aData);
     }
 
+    //! Creates a polygon with the factory, keeping the curves it was flattened from.
+    virtual PolygonWrapper * createCurvePolygonWrapper(const PolygonData *aData, const PathData *aPathData)
+    {
+#ifdef GATHER_STATISTICS
+        mStatistics.add(aData);
+#endif
+        return Polygon::create(aData,aPathData);
+    }
+
+    //! Creates a stroke polygon with the factory, keeping the path it was stroked from.
+    virtual PolygonWrapper * createStrokePolygonWrapper(const PolygonData *aData, const PathData *aPathData, const StrokeStyle *aStrokeStyle)
+    {
+#ifdef GATHER_STATISTICS
+        mStatistics.add(aData);
+#endif
+        return Polygon::create(aData,aPathData,aStrokeStyle);
+    }
+
 protected:
 #ifdef GATHER_STATISTICS
     PolygonConstructionStatistics mStatistics;
@@ -0,0 +1,115 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ *
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief Lookup tables for gamma correct blending of the antialiased pixels.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+
+#ifndef GAMMA_TABLE_H_INCLUDED
+#define GAMMA_TABLE_H_INCLUDED
+
+// The amount of bits in the linear light values. The red and blue channels are
+// blended in parallel in the 16-bit halves of a 32-bit integer, so the value has
+// to leave room for multiplication with the coverage (SUBPIXEL_SHIFT bits). With
+// 32 samples this leaves 11 bits, so some of the darkest sRGB values share the
+// same linear value.
+#define GAMMA_LINEAR_SHIFT (16 - SUBPIXEL_SHIFT)
+#define GAMMA_LINEAR_MAX ((1 << GAMMA_LINEAR_SHIFT) - 1)
+#define GAMMA_LINEAR_MASK ((GAMMA_LINEAR_MAX << 16) | GAMMA_LINEAR_MAX)
+
+// The size of the color cache. Has to be a power of two.
+#define GAMMA_COLOR_CACHE_SIZE 16
+
+//! Precalculated source terms of a single color for each coverage level.
+class GammaColorTable
+{
+public:
+    //! Constructor.
+    GammaColorTable()
+    {
+        mColor = 0;
+        mValid = false;
+    }
+
+    unsigned long mColor;
+    bool mValid;
+
+    //! Linear red and blue components multiplied with the coverage.
+    unsigned long mSourceRB[SUBPIXEL_COUNT + 1];
+    //! Linear green component multiplied with the coverage.
+    unsigned long mSourceG[SUBPIXEL_COUNT + 1];
+};
+
+//! A class for blending the antialiased pixels in linear light.
+/*! The target pixels are converted from sRGB to linear light with a lookup table,
+ *  blended with the source color and converted back to sRGB with another lookup
+ *  table. Source terms are precalculated for each coverage level and cached per
+ *  color, so the cost of the blend is six table lookups and two multiplications.
+ */
+class GammaTable
+{
+public:
+    //! Constructor.
+    GammaTable();
+
+    //! Returns the precalculated table for a color.
+    /*! The tables are kept in a small direct mapped cache, so rendering several
+     *  polygons with the same color calculates the table only once.
+     */
+    inline const GammaColorTable * getColorTable(unsigned long aColor)
+    {
+        unsigned int index = (aColor ^ (aColor >> 7) ^ (aColor >> 15)) & (GAMMA_COLOR_CACHE_SIZE - 1);
+        GammaColorTable *table = &mColorCache[index];
+        if (!table->mValid || table->mColor != aColor)
+            initColorTable(*table,aColor);
+        return table;
+    }
+
+    //! Blends a color to the target pixel with given coverage.
+    /*! The high byte is blended without gamma correction, the same way as in
+     *  the blend without the table.
+     *  \param aColorTable the precalculated color table from getColorTable().
+     *  \param aTarget the target pixel.
+     *  \param aAlpha the coverage in range of 0 to SUBPIXEL_COUNT.
+     */
+    inline unsigned long blend(const GammaColorTable *aColorTable, unsigned long aTarget, unsigned long aAlpha) const
+    {
+        unsigned long invAlpha = SUBPIXEL_COUNT - aAlpha;
+
+        unsigned long rb = ((unsigned long)mToLinear[(aTarget >> 16) & 0xff] << 16) |
+                           (unsigned long)mToLinear[aTarget & 0xff];
+        unsigned long g = mToLinear[(aTarget >> 8) & 0xff];
+
+        rb = ((rb * invAlpha + aColorTable->mSourceRB[aAlpha]) >> SUBPIXEL_SHIFT) & GAMMA_LINEAR_MASK;
+        g = (g * invAlpha + aColorTable->mSourceG[aAlpha]) >> SUBPIXEL_SHIFT;
+
+        unsigned long a = (((aTarget >> 24) & 0xff) * invAlpha + ((aColorTable->mColor >> 24) & 0xff) * aAlpha) >> SUBPIXEL_SHIFT;
+
+        return (a << 24) |
+               ((unsigned long)mToSRGB[rb >> 16] << 16) |
+               ((unsigned long)mToSRGB[g] << 8) |
+               (unsigned long)mToSRGB[rb & 0xffff];
+    }
+
+protected:
+    //! Calculates the source terms of a color for all coverage levels.
+    void initColorTable(GammaColorTable &aTable, unsigned long aColor);
+
+    unsigned short mToLinear[256];
+    unsigned char mToSRGB[GAMMA_LINEAR_MAX + 1];
+    GammaColorTable mColorCache[GAMMA_COLOR_CACHE_SIZE];
+};
+
+#endif // !GAMMA_TABLE_H_INCLUDED
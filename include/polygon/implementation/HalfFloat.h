@@ -0,0 +1,96 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ *
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief Conversions between 32-bit floats and 16-bit half floats.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+
+#ifndef HALF_FLOAT_H_INCLUDED
+#define HALF_FLOAT_H_INCLUDED
+
+//! A union for accessing the bits of a float.
+typedef union FloatBits
+{
+    float mFloat;
+    unsigned int mBits;
+} FloatBits;
+
+//! Converts a float to a half float. Values are rounded to nearest.
+inline unsigned short floatToHalf(float aValue)
+{
+    FloatBits value;
+    value.mFloat = aValue;
+
+    unsigned int sign = (value.mBits >> 16) & 0x8000;
+    unsigned int bits = value.mBits & 0x7fffffff;
+
+    // Too large for half, infinity or NaN.
+    if (bits >= 0x47800000)
+        return (unsigned short)(sign | (bits > 0x7f800000 ? 0x7e00 : 0x7c00));
+
+    // Denormalized half.
+    if (bits < 0x38800000)
+    {
+        if (bits < 0x33000000)
+            return (unsigned short)sign;
+
+        unsigned int shift = 126 - (bits >> 23);
+        unsigned int mantissa = (bits & 0x7fffff) | 0x800000;
+        return (unsigned short)(sign | ((mantissa + (1 << (shift - 1))) >> shift));
+    }
+
+    // Rebias the exponent and round the mantissa.
+    return (unsigned short)(sign | ((bits - 0x38000000 + 0x1000) >> 13));
+}
+
+//! Converts a half float to a float.
+inline float halfToFloat(unsigned short aValue)
+{
+    unsigned int sign = ((unsigned int)aValue & 0x8000) << 16;
+    unsigned int exponent = (aValue >> 10) & 0x1f;
+    unsigned int mantissa = aValue & 0x3ff;
+
+    FloatBits value;
+    if (exponent == 0)
+    {
+        // Zero or denormalized half.
+        value.mFloat = (float)mantissa * (1.0f / 16777216.0f);
+        value.mBits |= sign;
+    }
+    else if (exponent == 31)
+        value.mBits = sign | 0x7f800000 | (mantissa << 13);
+    else
+        value.mBits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+    return value.mFloat;
+}
+
+//! Converts an array of half floats to floats.
+inline void halfToFloat(const unsigned short *aSource, float *aTarget, int aCount)
+{
+    int n;
+    for (n = 0; n < aCount; n++)
+        aTarget[n] = halfToFloat(aSource[n]);
+}
+
+//! Converts an array of floats to half floats.
+inline void floatToHalf(const float *aSource, unsigned short *aTarget, int aCount)
+{
+    int n;
+    for (n = 0; n < aCount; n++)
+        aTarget[n] = floatToHalf(aSource[n]);
+}
+
+#endif // !HALF_FLOAT_H_INCLUDED
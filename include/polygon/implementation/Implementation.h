@@ -22,20 +22,26 @@
 
 #include "polygon/implementation/SubPolygon.h"
 #include "polygon/implementation/Polygon.h"
+#include "polygon/implementation/PolygonCurves.h"
 #include "polygon/implementation/DefaultPolygonFactory.h"
 #include "polygon/implementation/BitmapData.h"
+#include "polygon/implementation/HalfFloat.h"
 #include "polygon/implementation/PolygonFiller.h"
 #include "polygon/implementation/CoverageTable.h"
+#include "polygon/implementation/GammaTable.h"
 #include "polygon/implementation/SpanExtents.h"
+#include "polygon/implementation/ClipRegion.h"
 #include "polygon/implementation/NonZeroMask.h"
 #include "polygon/implementation/NonZeroMaskA.h"
 #include "polygon/implementation/NonZeroMaskB.h"
 #include "polygon/implementation/NonZeroMaskC.h"
+#include "polygon/implementation/NonZeroMaskD.h"
 #include "polygon/implementation/PolygonVersionA.h"
 #include "polygon/implementation/PolygonVersionB.h"
 #include "polygon/implementation/PolygonVersionC.h"
 #include "polygon/implementation/PolygonVersionD.h"
 #include "polygon/implementation/PolygonVersionE.h"
 #include "polygon/implementation/PolygonVersionF.h"
+#include "polygon/implementation/LayerCache.h"
 
 #endif // !IMPLEMENTATION_H_INCLUDED
@@ -0,0 +1,85 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ *
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief A cache for the rendering of the unchanged layers of a vector graphic.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+
+#ifndef LAYER_CACHE_H_INCLUDED
+#define LAYER_CACHE_H_INCLUDED
+
+//! A class for caching the rendering of the bottom layers of a vector graphic.
+/*! The longest run of layers from the bottom that have the same transformation
+ *  and version as in the previous frame is rendered once and stored as a copy
+ *  of the target. The following frames copy it back to the target and render
+ *  only the layers above it. The polygon fillers have no alpha channel in the
+ *  target, so only the bottom layers can be cached.
+ */
+class LayerCache
+{
+public:
+    //! Constructor.
+    LayerCache();
+
+    //! Destructor.
+    ~LayerCache();
+
+    //! Renders the layers of a vector graphic, reusing the cached layers.
+    /*! The target has to be cleared before the call, as the layers are rendered
+     *  on it when the cache is not valid.
+     *  \param aGraphic the vector graphic.
+     *  \param aRenderer the renderer.
+     *  \param aTarget the render target.
+     *  \param aTransformations the transformation of each layer.
+     */
+    bool render(VectorGraphic *aGraphic, Renderer *aRenderer, BitmapData *aTarget, const MATRIX2D *aTransformations);
+
+    //! Drops the cached layers.
+    void invalidate();
+
+    //! Returns the amount of layers in the cache.
+    inline int getCachedLayerCount() const
+    {
+        return mCachedLayerCount;
+    }
+
+protected:
+    //! Makes room for the state of aLayerCount layers.
+    bool resizeLayers(int aLayerCount);
+
+    //! Returns true if the matrices are equal.
+    static bool isEqual(const MATRIX2D &aMatrix1, const MATRIX2D &aMatrix2);
+
+    //! The copy of the target with the cached layers.
+    unsigned char *mData;
+    unsigned int mDataSize;
+
+    //! The target the cache was made for.
+    const VectorGraphic *mGraphic;
+    unsigned int mWidth;
+    unsigned int mHeight;
+    unsigned int mPitch;
+    BitmapData::BitmapFormat mFormat;
+
+    //! The transformations and versions of the layers in the previous frame.
+    MATRIX2D *mTransformations;
+    unsigned int *mVersions;
+    int mLayerCount;
+    int mLayerCapacity;
+
+    int mCachedLayerCount;
+};
+
+#endif // !LAYER_CACHE_H_INCLUDED
@@ -0,0 +1,143 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ * 
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief NonZeroMaskD is a class for tracking the mask data of non-zero winding buffer with packed 4-bit counters.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+
+#ifndef NON_ZERO_MASK_D_H_INCLUDED
+#define NON_ZERO_MASK_D_H_INCLUDED
+
+// The winding buffer stores the winding changes of each pixel in 4-bit two's
+// complement lanes, eight samples per 32-bit composite. This is less than half of
+// the size of NonZeroMask. The accumulated winding values are unpacked to 7-bit
+// lanes, eight samples per two 32-bit composites, so they have the same range as
+// with NonZeroMaskC. The change of a single pixel has the range of -8 to 7, so 8 or
+// more edges crossing the same sample of the same pixel in the same direction
+// overflow.
+#define NON_ZERO_PACKED_MASK_COUNT (SUBPIXEL_COUNT / 8)
+
+//! A struct for tracking the packed winding changes of non-zero winding buffer.
+typedef struct NonZeroPackedMask
+{
+    unsigned long mBuffer[NON_ZERO_PACKED_MASK_COUNT];
+} NonZeroPackedMask;
+
+//! A struct for the accumulated winding values of the samples.
+typedef struct NonZeroPackedSum
+{
+    unsigned long mBuffer[NON_ZERO_PACKED_MASK_COUNT * 2];
+} NonZeroPackedSum;
+
+static const unsigned long NonZeroPackedMaskHighBits = 0x88888888;
+static const unsigned long NonZeroPackedMaskLowBits = 0x77777777;
+static const unsigned long NonZeroPackedMaskNibbles = 0x0f0f0f0f;
+static const unsigned long NonZeroPackedMaskSignBits = 0x08080808;
+static const unsigned long NonZeroPackedMaskSignBias = 0x78787878;
+
+// These are the same as the 8-bit values of NonZeroMaskC.h.
+static const unsigned long NonZeroPackedSumHighBitOff = 0x7f7f7f7f;
+static const unsigned long NonZeroPackedSumLowBitsOff = 0x80808080;
+
+class NonZeroMaskD
+{
+public:
+    //! Adds a winding value to the counter of a sample.
+    /*! The high bits of the lanes are added separately, so the carry never
+     *  propagates to the neighbouring counter.
+     */
+    static inline void plot(NonZeroPackedMask &aTarget, int aSample, int aWinding)
+    {
+        unsigned long &t = aTarget.mBuffer[aSample >> 3];
+        unsigned long d = (unsigned long)(aWinding & 0xf) << ((aSample & 7) << 2);
+        t = ((t & NonZeroPackedMaskLowBits) + (d & NonZeroPackedMaskLowBits)) ^ ((t ^ d) & NonZeroPackedMaskHighBits);
+    }
+
+    //! Returns true if the entry has no winding changes.
+    static inline bool isEmpty(const NonZeroPackedMask &aSource)
+    {
+#if SUBPIXEL_COUNT == 8
+        return aSource.mBuffer[0] == 0;
+#elif SUBPIXEL_COUNT == 16
+        return (aSource.mBuffer[0] | aSource.mBuffer[1]) == 0;
+#else
+        return (aSource.mBuffer[0] | aSource.mBuffer[1] | aSource.mBuffer[2] | aSource.mBuffer[3]) == 0;
+#endif
+    }
+
+    //! Sets the winding values from the source to the destination and returns the mask.
+    /*! The source is cleared.
+     */
+    static inline SUBPIXEL_DATA init(NonZeroPackedMask &aSource, NonZeroPackedSum &aDestination)
+    {
+        MEMSET(&aDestination,0,sizeof(NonZeroPackedSum));
+        return apply(aSource,aDestination,0);
+    }
+
+    //! Adds the winding values of the source to the destination and returns the new mask.
+    /*! The source is cleared. Each composite of the source covers eight samples,
+     *  and the composites without winding changes keep their part of aMask, so
+     *  an edge that crosses only some of the sample rows of the pixel updates only
+     *  those. The bits of the mask are not in the order of the samples, so this
+     *  works only with unweighted sampling.
+     */
+    static inline SUBPIXEL_DATA apply(NonZeroPackedMask &aSource, NonZeroPackedSum &aDestination, SUBPIXEL_DATA aMask)
+    {
+        unsigned long mask = aMask;
+        int n;
+        for (n = 0; n < NON_ZERO_PACKED_MASK_COUNT; n++)
+        {
+            unsigned long s = aSource.mBuffer[n];
+#if NON_ZERO_PACKED_MASK_COUNT > 1
+            if (s == 0)
+                continue;
+#endif
+            aSource.mBuffer[n] = 0;
+
+            // Even and odd samples are unpacked separately. Flipping the sign bit and
+            // adding 128 - 8 sign extends the lane to 7 bits.
+            unsigned long even = ((s & NonZeroPackedMaskNibbles) ^ NonZeroPackedMaskSignBits) + NonZeroPackedMaskSignBias;
+            unsigned long odd = (((s >> 4) & NonZeroPackedMaskNibbles) ^ NonZeroPackedMaskSignBits) + NonZeroPackedMaskSignBias;
+            even &= NonZeroPackedSumHighBitOff;
+            odd &= NonZeroPackedSumHighBitOff;
+
+            even = (aDestination.mBuffer[2 * n] + even) & NonZeroPackedSumHighBitOff;
+            odd = (aDestination.mBuffer[2 * n + 1] + odd) & NonZeroPackedSumHighBitOff;
+            aDestination.mBuffer[2 * n] = even;
+            aDestination.mBuffer[2 * n + 1] = odd;
+
+            mask &= ~(0xffUL << (n << 3));
+            mask |= (composeMask(even) | (composeMask(odd) << 4)) << (n << 3);
+        }
+        return (SUBPIXEL_DATA)mask;
+    }
+
+protected:
+    //! Packs the non-zero lanes of a composite to the lowest 4 bits.
+    static inline unsigned long composeMask(unsigned long a)
+    {
+        a += NonZeroPackedSumHighBitOff;
+        a &= NonZeroPackedSumLowBitsOff;
+        // pattern is .......A.......B.......C.......D
+        a >>= 7;
+        a |= a >> 7;
+        // pattern is .......A......AB......BC......CD
+        a |= a >> 14;
+        // pattern is ............................ABCD after masking
+        return a & 0x0f;
+    }
+};
+
+#endif // !NON_ZERO_MASK_D_H_INCLUDED
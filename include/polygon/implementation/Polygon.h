@@ -20,6 +20,7 @@
 #define POLYGON_H_INCLUDED
 
 class SubPolygon;
+class PolygonCurves;
 //! A class for handling polygons. Each polygon is a set of sub-polygons.
 class Polygon : public PolygonWrapper
 {
@@ -44,12 +45,66 @@ public:
         return *mSubPolygons[aIndex];
     }
 
+    //! Classifies the polygon against the clip rectangle after transformation.
+    /*! \return one of POLYGON_BOUNDS_CLIP values.
+     */
+    inline int getBoundsClip(const MATRIX2D &aTransformation, const ClipRectangle &aClipRectangle) const
+    {
+        if (mSubPolygonCount == 0)
+            return POLYGON_BOUNDS_OUTSIDE;
+        return SubPolygon::getBoundsClip(mMinimum,mMaximum,aTransformation,aClipRectangle);
+    }
+
+    //! Calculates the bounding box of the polygon after transformation.
+    inline void getBounds(const MATRIX2D &aTransformation, VECTOR2D &aMinimum, VECTOR2D &aMaximum) const
+    {
+        SubPolygon::getBounds(mMinimum,mMaximum,aTransformation,aMinimum,aMaximum);
+    }
+
+    //! Returns true if the polygon is a single convex sub-polygon.
+    inline bool isConvex() const
+    {
+        return mSubPolygonCount == 1 && mSubPolygons[0]->isConvex();
+    }
+
+    //! Returns true if even-odd fill gives the same result as non-zero winding fill.
+    inline bool isEvenOddEquivalent() const
+    {
+        return mEvenOddEquivalent;
+    }
+
+    //! Returns the curves of the polygon, or NULL if the polygon has none.
+    inline const PolygonCurves * getCurves() const
+    {
+        return mCurves;
+    }
+
+    //! Returns the polygon to render with given transformation.
+    /*! If the polygon has curves, this returns the polygon flattened for the
+     *  scale of the transformation. Otherwise returns the polygon itself.
+     */
+    const Polygon * getLevel(const MATRIX2D &aTransformation) const;
+
     //! Static method for creating a polygon from the data.
-    static Polygon * create(const PolygonData *aPolygonData);
+    /*! \param aPolygonData the flattened polygon data.
+     *  \param aPathData the path data with the curves the polygon data was flattened
+     *         from, or NULL.
+     *  \param aStrokeStyle the style the polygon data was stroked from the path data
+     *         with, or NULL if the polygon data is a fill.
+     */
+    static Polygon * create(const PolygonData *aPolygonData, const PathData *aPathData = NULL,
+                            const StrokeStyle *aStrokeStyle = NULL);
 
 protected:
+    //! Checks if even-odd fill gives the same result as non-zero winding fill.
+    bool checkEvenOddEquivalence() const;
+
     int mSubPolygonCount;
     SubPolygon **mSubPolygons;
+    VECTOR2D mMinimum;
+    VECTOR2D mMaximum;
+    bool mEvenOddEquivalent;
+    PolygonCurves *mCurves;
 };
 
 #endif // !POLYGON_H_INCLUDED
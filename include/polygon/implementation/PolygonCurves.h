@@ -0,0 +1,119 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ *
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief A cache of the polygon flattened from curves for different scales.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+
+#ifndef POLYGON_CURVES_H_INCLUDED
+#define POLYGON_CURVES_H_INCLUDED
+
+// The amount of flattened levels kept in the cache per polygon.
+#define POLYGON_CURVES_CACHE_SIZE 4
+
+// The flatness of the curves in pixels at the lower end of a level.
+#define POLYGON_CURVES_FLATNESS FLOAT_TO_RATIONAL(0.1f)
+
+// The range of the levels. Scales outside of the range use the closest level.
+#define POLYGON_CURVES_MIN_LEVEL -8
+#define POLYGON_CURVES_MAX_LEVEL 16
+
+//! A class for flattening the curves of a polygon again for different scales.
+/*! The scale of the transformation is split to levels at powers of two, so that
+ *  level L covers the scales from 2^L to 2^(L+1). The polygon the curves belong
+ *  to is used as is for level 0. Other levels are flattened from the curves
+ *  when they are first needed, and the least recently used levels are dropped
+ *  when the cache is full.
+ *
+ *  If the curves have a stroke style, the levels are the stroked outlines of the
+ *  curves instead, so the joins and caps of each scale are cached the same way.
+ */
+class PolygonCurves
+{
+public:
+    //! Constructor.
+    PolygonCurves();
+
+    //! Destructor.
+    ~PolygonCurves();
+
+    //! Initializes the curves with a copy of the path data.
+    bool init(const PathData *aPathData, const StrokeStyle *aStrokeStyle = NULL);
+
+    //! Returns the polygon flattened for given level, or NULL if it can't be created.
+    Polygon * getPolygon(int aLevel);
+
+    //! Returns the level of a transformation.
+    static int getLevel(const MATRIX2D &aTransformation);
+
+    //! Returns the path data with the curves.
+    inline const PathData * getPathData() const
+    {
+        return mPathData;
+    }
+
+    //! Returns true if the levels are stroked outlines of the curves.
+    inline bool isStroke() const
+    {
+        return mStroke;
+    }
+
+    //! Returns true if the levels are hairline outlines of the curves.
+    /*! The width of a hairline depends on the level, so level 0 is created from
+     *  the curves as well.
+     */
+    inline bool isHairline() const
+    {
+        return mStroke && mStrokeStyle.mHairline;
+    }
+
+    //! Returns the minimum corner of the bounding box of the points.
+    /*! The curves are within the bounding box of their control points.
+     */
+    inline const VECTOR2D & getMinimum() const
+    {
+        return mMinimum;
+    }
+
+    //! Returns the maximum corner of the bounding box of the points.
+    inline const VECTOR2D & getMaximum() const
+    {
+        return mMaximum;
+    }
+
+protected:
+    //! Creates a polygon flattened for given level.
+    Polygon * createPolygon(int aLevel) const;
+
+    //! Creates a stroked outline of the curves for given level.
+    Polygon * createStrokePolygon(int aLevel, RATIONAL aFlatness) const;
+
+    RATIONAL **mPointData;
+    PATH_POINT_TAG **mTagData;
+    int *mPointCounts;
+    bool *mClosedData;
+    PathData *mPathData;
+    bool mStroke;
+    StrokeStyle mStrokeStyle;
+    VECTOR2D mMinimum;
+    VECTOR2D mMaximum;
+
+    int mLevels[POLYGON_CURVES_CACHE_SIZE];
+    unsigned int mLastUse[POLYGON_CURVES_CACHE_SIZE];
+    Polygon *mPolygons[POLYGON_CURVES_CACHE_SIZE];
+    unsigned int mUseCounter;
+};
+
+#endif // !POLYGON_CURVES_H_INCLUDED
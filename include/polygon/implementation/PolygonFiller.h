@@ -450,10 +450,11 @@ public:
                         RENDERER_FILLMODE aFillMode, const MATRIX2D &aTransformation)
     {
         unsigned int color = ((DefaultPaintWrapper *)aColor)->getColor();
+        const Polygon *polygon = ((Polygon *)aPolygon)->getLevel(aTransformation);
         if (aFillMode == RENDERER_FILLMODE_EVENODD)
-            renderEvenOdd((BitmapData *)aTarget, (Polygon *)aPolygon, color, aTransformation);
+            renderEvenOdd((BitmapData *)aTarget, polygon, color, aTransformation);
         else
-            renderNonZeroWinding((BitmapData *)aTarget, (Polygon *)aPolygon, color, aTransformation);
+            renderNonZeroWinding((BitmapData *)aTarget, polygon, color, aTransformation);
     }
 
     //! Renders the polygon with even-odd fill.
@@ -472,9 +473,6 @@ public:
      */
     virtual void renderNonZeroWinding(BitmapData *aTarget, const Polygon *aPolygon, unsigned long aColor, const MATRIX2D &aTransformation) = 0;
 
-    //! Sets the clip rectangle for the polygon filler.
-    virtual void setClipRect(unsigned int aX, unsigned int aY, unsigned int aWidth, unsigned int aHeight) = 0;
-
 #ifdef GATHER_STATISTICS
     //! Returns the statistics for the filling operation.
     const PolygonRasterizationStatistics &getStatistics()
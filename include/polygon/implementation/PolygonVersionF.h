@@ -22,6 +22,152 @@
 
 #include "polygon/implementation/SpanExtents.h"
 
+//! An axis-aligned rectangle in the sub-scanline coordinates of the filler.
+/*! mMinX and mMaxX are the positions of the left and right edge. The rectangle
+ *  covers the sub-scanlines from mFirstLine to mLastLine.
+ */
+typedef struct ScanRectangle
+{
+    FIXED_POINT mMinX;
+    FIXED_POINT mMaxX;
+    int mFirstLine;
+    int mLastLine;
+} ScanRectangle;
+
+//! The samples of a span on each sub-scanline of a scanline.
+/*! The sub-scanline s covers the pixels from mLeft[s] to mRight[s] - 1. Only the
+ *  sub-scanlines from mFirstSub to mLastSub are used.
+ */
+typedef struct SampleSpan
+{
+    int mLeft[SUBPIXEL_COUNT];
+    int mRight[SUBPIXEL_COUNT];
+    int mFirstSub;
+    int mLastSub;
+} SampleSpan;
+
+// The amount of pixels converted at a time when blending to a half float canvas.
+#define FLOAT_SPAN_CHUNK_SIZE 64
+
+// The maximum distance of the forward differencing steps from the curve in pixels.
+#define CURVE_EDGE_FLATNESS FLOAT_TO_RATIONAL(0.05f)
+
+// The maximum amount of forward differencing steps of a curve edge as a power of two.
+// The differences are scaled by 2^(3 * shift) on top of the fixed point, so the shift
+// has to stay small enough for the accumulators to fit in 64 bits.
+#define CURVE_EDGE_MAX_STEP_SHIFT 8
+
+//! The forward differencing state of a curve edge.
+/*! The curve is monotonic in y, in the sub-scanline coordinates of the filler.
+ *  It is stepped forward as the sub-scanlines advance. The x position of the
+ *  curve on a sub-scanline is interpolated between the two last steps.
+ *
+ *  The curve is stepped in 2^mShift steps. The control points are rounded to
+ *  fixed point and the differences are kept scaled by 2^(3 * mShift), so the
+ *  stepping is exact and the last step lands on the end point. The y positions
+ *  are 64 bit, as the sub-scanlines of a tall target overflow 16.16 fixed point.
+ */
+typedef struct PolygonCurveEdge
+{
+    INTEGER64 mStepX;
+    INTEGER64 mStepY;
+    INTEGER64 mDX;
+    INTEGER64 mDY;
+    INTEGER64 mDDX;
+    INTEGER64 mDDY;
+    INTEGER64 mDDDX;
+    INTEGER64 mDDDY;
+    INTEGER64 mSlope;
+    FIXED_POINT mX;
+    INTEGER64 mY;
+    FIXED_POINT mPrevX;
+    INTEGER64 mPrevY;
+    int mSteps;
+    int mShift;
+} PolygonCurveEdge;
+
+//! State of a polygon in the scene rendering.
+typedef struct ScenePolygon
+{
+    PolygonScanEdge *mActiveEdges;
+    int mCurrentEdgeLine;
+    int mLastEdgeLine;
+    int mLastLine;
+    unsigned long mColor;
+    RENDERER_FILLMODE mFillMode;
+    int mNext;
+    bool mIsRectangle;
+    bool mIsConvex;
+    ScanRectangle mRectangle;
+} ScenePolygon;
+
+//! The edges of a scene polygon starting from a given scanline.
+typedef struct SceneEdgeLine
+{
+    int mLine;
+    int mEdgeIndex;
+} SceneEdgeLine;
+
+// The maximum amount of rectangles used as occluders in the scene setup.
+#define SCENE_OCCLUDER_COUNT 8
+
+//! The fully covered pixels of a rectangle polygon in the scene setup.
+/*! The polygons behind that fit inside the rectangle are not rendered at all.
+ *  The limits are inclusive pixels and scanlines.
+ */
+typedef struct SceneOccluder
+{
+    int mMinX;
+    int mMaxX;
+    int mMinY;
+    int mMaxY;
+} SceneOccluder;
+
+//! An antialiased pixel whose blending is deferred in the occlusion culling.
+typedef struct SceneDeferredPixel
+{
+    int mX;
+    unsigned long mAlpha;
+    unsigned long mColor;
+} SceneDeferredPixel;
+
+//! A scanline of a clip mask.
+/*! The pixels outside of mMinX and mMaxX have no coverage. The pixels between
+ *  mFullMinX and mFullMaxX have full coverage. The coverage from mMinX to mMaxX
+ *  is stored at mOffset in the coverage of the mask.
+ */
+typedef struct ClipMaskRow
+{
+    int mMinX;
+    int mMaxX;
+    int mFullMinX;
+    int mFullMaxX;
+    int mOffset;
+} ClipMaskRow;
+
+//! A level in the clip mask stack.
+/*! Only the covered pixels of each scanline are stored, one scanline after the
+ *  other. The coverage buffer is kept for the following masks of the level.
+ */
+typedef struct ClipMask
+{
+    unsigned char *mCoverage;
+    int mCoverageSize;
+    ClipMaskRow *mRows;
+    int mMinX;
+    int mMinY;
+    int mMaxX;
+    int mMaxY;
+} ClipMask;
+
+//! Classification of a span against the clip mask and the clip region.
+enum CLIP_SPAN
+{
+    CLIP_SPAN_EMPTY = 0,
+    CLIP_SPAN_FULL = 1,
+    CLIP_SPAN_PARTIAL = 2,
+};
+
 //! Version F of the polygon filler. Similar to E, but does the rendering one scanline at a time.
 class PolygonVersionF : public PolygonFiller
 {
@@ -41,6 +187,20 @@ public:
     //! Virtual destructor.
     virtual ~PolygonVersionF();
 
+    //! Renders a polygon.
+    /*! Polygons with curves are passed to the fill functions as is, so that the
+     *  curves can be rendered directly when they fit in the clip rectangle.
+     */
+    virtual void render(RenderTargetWrapper *aTarget, PolygonWrapper *aPolygon, PaintWrapper *aColor,
+                        RENDERER_FILLMODE aFillMode, const MATRIX2D &aTransformation)
+    {
+        unsigned int color = ((DefaultPaintWrapper *)aColor)->getColor();
+        if (aFillMode == RENDERER_FILLMODE_EVENODD)
+            renderEvenOdd((BitmapData *)aTarget, (Polygon *)aPolygon, color, aTransformation);
+        else
+            renderNonZeroWinding((BitmapData *)aTarget, (Polygon *)aPolygon, color, aTransformation);
+    }
+
     //! Renders the polygon with even-odd fill.
     /*! \param aTarget the target bitmap.
      *  \param aPolygon the polygon to render.
@@ -57,9 +217,68 @@ public:
      */
     virtual void renderNonZeroWinding(BitmapData *aTarget, const Polygon *aPolygon, unsigned long aColor, const MATRIX2D &aTransformation);
 
+    //! Renders a set of polygons in painter's order in a single pass.
+    /*! The edges of all polygons are collected to a global edge table first. Then
+     *  the target is processed one scanline at a time, and all polygons covering
+     *  the scanline are resolved in painter's order while the scanline is in cache.
+     *  Returns false if the storage for the scene cannot be allocated.
+     */
+    virtual bool renderScene(RenderTargetWrapper *aTarget, PolygonWrapper * const *aPolygons, PaintWrapper * const *aColors,
+                             const RENDERER_FILLMODE *aFillModes, int aPolygonCount, const MATRIX2D &aTransformation);
+
     //! Sets the clip rectangle for the polygon filler.
     virtual void setClipRect(unsigned int aX, unsigned int aY, unsigned int aWidth, unsigned int aHeight);
 
+    //! Limits the rendering to a damaged area of the target.
+    /*! The edges are clipped to the clip rectangle as without the limit, and only
+     *  the spans are limited to the area. This keeps the pixels inside the area
+     *  identical to a full rendering at any amount of samples.
+     */
+    virtual void setDamageRect(unsigned int aX, unsigned int aY, unsigned int aWidth, unsigned int aHeight);
+
+    //! Replaces the pixels of the damaged area with a color.
+    /*! The pixels are written directly, as the right clip border leaves out
+     *  samples of the last pixel column.
+     */
+    virtual void clearDamageRect(RenderTargetWrapper *aTarget, PolygonWrapper *aArea, PaintWrapper *aColor);
+
+    //! Enables or disables the gamma correct blending of antialiased pixels.
+    /*! When enabled, the antialiased pixels are blended in linear light instead
+     *  of sRGB. This makes thin features look correct instead of too dark.
+     */
+    bool setGammaCorrection(bool aEnabled);
+
+    //! Enables or disables the occlusion culling in the scene rendering.
+    /*! When enabled, renderScene() processes the polygons of each scanline front
+     *  to back and skips the pixels that are already fully covered by the polygons
+     *  in front. The output is identical to the painter's order. Has to be called
+     *  after init().
+     */
+    bool setOcclusionCulling(bool aEnabled);
+
+    //! Pushes a clip polygon to the clip mask stack.
+    /*! The polygon is rasterized once to a coverage mask, which is intersected
+     *  with the mask on top of the stack. The coverage of the following fills is
+     *  multiplied with the mask until it is removed with popClipPolygon(). Has to
+     *  be called after init().
+     *  \param aPolygon the clip polygon.
+     *  \param aTransformation the transformation matrix.
+     *  \param aFillMode the fill mode of the clip polygon.
+     */
+    bool pushClipPolygon(const Polygon *aPolygon, const MATRIX2D &aTransformation, RENDERER_FILLMODE aFillMode);
+
+    //! Removes the topmost clip polygon from the clip mask stack.
+    void popClipPolygon();
+
+    //! Sets the clip region for the polygon filler.
+    /*! The fills are limited to the region in addition to the clip rectangle.
+     *  The edges are clipped once to the bounds of the region, and the spans
+     *  of each scanline are limited to the intervals of the region. The region
+     *  is not copied, so it has to exist as long as it is set. NULL removes
+     *  the region.
+     */
+    void setClipRegion(const ClipRegion *aRegion);
+
 protected:
     //! Checks if a surface format is supported.
     bool isSupported(BitmapData::BitmapFormat aFormat);
@@ -70,15 +289,235 @@ protected:
     //! Renders the edges from the current vertical index using even-odd fill.
     inline void renderEvenOddEdges(PolygonScanEdge * &aActiveEdgeTable, SpanExtents &aEdgeExtents, int aCurrentLine);
 
+    //! Renders one scanline of the mask to the canvas with even-odd fill.
+    inline void fillEvenOddSpan(unsigned long *aTarget, int aMinX, int aMaxX, unsigned long aColor, const GammaColorTable *aGammaColor);
+
+    //! Renders one scanline of the mask to the canvas with even-odd fill, limited by the clip mask and region.
+    inline void fillEvenOddClippedSpan(unsigned long *aTarget, int aY, int aMinX, int aMaxX, unsigned long aColor, const GammaColorTable *aGammaColor);
+
     //! Renders the mask to the canvas with even-odd fill.
     void fillEvenOdd(BitmapData *aTarget, unsigned long aColor);
 
     //! Renders the edges from the current vertical index using non-zero winding fill.
     inline void renderNonZeroEdges(PolygonScanEdge * &aActiveEdgeTable, SpanExtents &aEdgeExtents, int aCurrentLine);
 
+    //! Renders one scanline of the winding buffer to the canvas with non-zero winding fill.
+    inline void fillNonZeroSpan(unsigned long *aTarget, int aMinX, int aMaxX, unsigned long aColor, const GammaColorTable *aGammaColor);
+
+    //! Renders one scanline of the winding buffer to the canvas with non-zero winding fill, limited by the clip mask and region.
+    inline void fillNonZeroClippedSpan(unsigned long *aTarget, int aY, int aMinX, int aMaxX, unsigned long aColor, const GammaColorTable *aGammaColor);
+
     //! Renders the mask to the canvas with non-zero winding fill.
     void fillNonZero(BitmapData *aTarget, unsigned long aColor, const ClipRectangle &aClipRect);
 
+    //! Renders the mask to a floating point canvas with even-odd fill.
+    void fillEvenOddFloat(BitmapData *aTarget, unsigned long aColor);
+
+    //! Renders the mask to a floating point canvas with non-zero winding fill.
+    void fillNonZeroFloat(BitmapData *aTarget, unsigned long aColor);
+
+    //! Renders one scanline of the mask to the canvas with even-odd fill, skipping occluded pixels.
+    inline void fillEvenOddOccludedSpan(unsigned long *aTarget, int aMinX, int aMaxX, unsigned long aColor, SpanExtents &aOcclusionExtents);
+
+    //! Renders one scanline of the winding buffer to the canvas with non-zero winding fill, skipping occluded pixels.
+    inline void fillNonZeroOccludedSpan(unsigned long *aTarget, int aMinX, int aMaxX, unsigned long aColor, SpanExtents &aOcclusionExtents);
+
+    //! Blends the deferred antialiased pixels of a scanline in painter's order.
+    void blendDeferredPixels(unsigned long *aTarget);
+
+    //! Returns the first pixel at or after aX that is not occluded.
+    inline int findUnoccludedPixel(int aX)
+    {
+        int *ob = mOcclusionBuffer;
+        while (ob[aX] != aX)
+        {
+            ob[aX] = ob[ob[aX]];
+            aX = ob[aX];
+        }
+        return aX;
+    }
+
+    //! Blends a span of the coverage buffer to a floating point canvas.
+    void blendFloatSpan(BitmapData *aTarget, unsigned long aColor, int aY, int aMinX, int aMaxX);
+
+    //! Blends a color to float pixels with the coverage of each pixel.
+    /*! All pixels go through the same multiply-add, so there are no branches in
+     *  the loop. Zero coverage keeps the target and full coverage gives the color.
+     */
+    static inline void blendFloatPixels(float *aTarget, const unsigned char *aCoverage, int aCount, const float *aColor)
+    {
+        static const float scale = 1.0f / (float)SUBPIXEL_COUNT;
+
+        int n;
+        for (n = 0; n < aCount; n++)
+        {
+            float alpha = (float)aCoverage[n] * scale;
+            float invAlpha = 1.0f - alpha;
+            aTarget[0] = aTarget[0] * invAlpha + aColor[0] * alpha;
+            aTarget[1] = aTarget[1] * invAlpha + aColor[1] * alpha;
+            aTarget[2] = aTarget[2] * invAlpha + aColor[2] * alpha;
+            aTarget[3] = aTarget[3] * invAlpha + aColor[3] * alpha;
+            aTarget += 4;
+        }
+    }
+
+    //! Blends a span of the coverage buffer to the canvas.
+    void blendCoverageSpan(unsigned long *aTarget, int aMinX, int aMaxX, unsigned long aColor, const GammaColorTable *aGammaColor);
+
+    //! Resolves the coverage of a span of the mask buffer to the coverage buffer.
+    inline void resolveEvenOddSpan(int aMinX, int aMaxX);
+
+    //! Resolves the coverage of a span of the winding buffer to the coverage buffer.
+    inline void resolveNonZeroSpan(int aMinX, int aMaxX);
+
+    //! Calculates the rectangle of an axis-aligned rectangle polygon.
+    bool getScanRectangle(const Polygon *aPolygon, const MATRIX2D &aTransformation, const ClipRectangle &aClipRect, ScanRectangle &aRectangle) const;
+
+    //! Renders an axis-aligned rectangle to the canvas.
+    void fillRectangle(BitmapData *aTarget, const ScanRectangle &aRectangle, unsigned long aColor);
+
+    //! Renders one scanline of an axis-aligned rectangle to the canvas.
+    inline void fillRectangleSpan(unsigned long *aTarget, const ScanRectangle &aRectangle, int aY, unsigned long aColor, const GammaColorTable *aGammaColor);
+
+    //! Renders the samples of a span to the canvas.
+    void fillSampleSpan(unsigned long *aTarget, const SampleSpan &aSpan, unsigned long aColor, const GammaColorTable *aGammaColor);
+
+    //! Stores the samples of a convex polygon edge on the current scanline to a span.
+    inline bool plotConvexEdge(PolygonScanEdge *aEdge, SampleSpan &aSpan, SUBPIXEL_DATA &aSampleMask, int aCurrentLine);
+
+    //! Renders the edges of a convex polygon from the current vertical index to a span.
+    inline void renderConvexEdges(PolygonScanEdge * &aActiveEdgeTable, SampleSpan &aSpan, int aCurrentLine);
+
+    //! Renders the edges of a convex polygon to the canvas.
+    void fillConvex(BitmapData *aTarget, unsigned long aColor);
+
+    //! Returns true if the fills are limited by a clip mask, a clip region or a damage rectangle.
+    inline bool isClipped() const
+    {
+        return mClipMaskCount > 0 || mClipRegion != NULL || mDamageClip;
+    }
+
+    //! Classifies a span against the clip mask and the clip region.
+    inline CLIP_SPAN getClipSpan(int aY, int aMinX, int aMaxX);
+
+    //! Classifies a span against the clip mask on top of the stack.
+    inline CLIP_SPAN getClipMaskSpan(int aY, int aMinX, int aMaxX) const
+    {
+        const ClipMaskRow &row = mClipMasks[mClipMaskCount - 1].mRows[aY];
+        if (aMaxX < row.mMinX || aMinX > row.mMaxX)
+            return CLIP_SPAN_EMPTY;
+        if (aMinX >= row.mFullMinX && aMaxX <= row.mFullMaxX)
+            return CLIP_SPAN_FULL;
+        return CLIP_SPAN_PARTIAL;
+    }
+
+    //! Classifies a span against the clip region.
+    inline CLIP_SPAN getClipRegionSpan(int aY, int aMinX, int aMaxX);
+
+    //! Classifies a span against the damage rectangle.
+    inline CLIP_SPAN getDamageSpan(int aY, int aMinX, int aMaxX) const
+    {
+        if (aY < mDamageRect.getMinYi() || aY >= mDamageRect.getMaxYi() ||
+            aMaxX < mDamageRect.getMinXi() || aMinX >= mDamageRect.getMaxXi())
+            return CLIP_SPAN_EMPTY;
+        // The span may extend over the right edge of the bitmap, even though there
+        // is no coverage there.
+        if (aMinX >= mDamageRect.getMinXi() &&
+            (aMaxX < mDamageRect.getMaxXi() || mDamageRect.getMaxXi() >= (int)mWidth))
+            return CLIP_SPAN_FULL;
+        return CLIP_SPAN_PARTIAL;
+    }
+
+    //! Limits a span of the coverage buffer with the clip mask and the clip region.
+    void clipCoverageSpan(int aY, int aMinX, int aMaxX);
+
+    //! Multiplies a span of the coverage buffer with the clip mask on top of the stack.
+    void clipMaskSpan(int aY, int aMinX, int aMaxX);
+
+    //! Clears the pixels of a span of the coverage buffer that are outside of the clip region.
+    void clipRegionSpan(int aY, int aMinX, int aMaxX);
+
+    //! Clears the pixels of a span of the coverage buffer that are outside of the damage rectangle.
+    void clipDamageSpan(int aY, int aMinX, int aMaxX);
+
+    //! Intersects a clip rectangle with the bounds of the clip mask on top of the stack.
+    bool intersectClipMask(ClipRectangle &aClipRect) const;
+
+    //! Intersects a clip rectangle with the bounds of the clip region.
+    bool intersectClipRegion(ClipRectangle &aClipRect) const;
+
+    //! Resizes the clip mask stack.
+    bool resizeClipMasks(int aMaskCount);
+
+    //! Resizes the coverage buffer of a clip mask.
+    bool resizeClipMaskCoverage(ClipMask &aMask, int aSize);
+
+    //! Adds the edges of a polygon to the edge table.
+    bool addPolygonEdges(const Polygon *aPolygon, const MATRIX2D &aTransformation, const ClipRectangle &aClipRect);
+
+    //! Returns true if the curves of a polygon are rendered as curve edges.
+    /*! The curve edges are not clipped, so they are used only when the curves are
+     *  completely inside the clip rectangle. Strokes always use the stroked outlines.
+     */
+    inline bool useCurveEdges(const Polygon *aPolygon, const MATRIX2D &aTransformation, const ClipRectangle &aClipRect) const
+    {
+        const PolygonCurves *curves = aPolygon->getCurves();
+        return curves != NULL && !curves->isStroke() &&
+               SubPolygon::getBoundsClip(curves->getMinimum(),curves->getMaximum(),aTransformation,aClipRect) == POLYGON_BOUNDS_INSIDE;
+    }
+
+    //! Adds the edges of a path with curves to the edge table.
+    bool addCurveEdges(const PathData *aPathData, const MATRIX2D &aTransformation);
+
+    //! Adds the edges of a line or a curve segment to the edge table.
+    bool addSegmentEdges(const VECTOR2D *aPoints, int aDegree);
+
+    //! Adds a line edge to the edge table.
+    void addLineEdge(const VECTOR2D &aStart, const VECTOR2D &aEnd);
+
+    //! Adds a curve edge that is monotonic in y to the edge table.
+    void addCurveEdge(const VECTOR2D *aPoints, int aDegree);
+
+    //! Splits a curve to two at given parameter value.
+    static void splitCurve(const VECTOR2D *aPoints, int aDegree, RATIONAL aT, VECTOR2D *aFirst, VECTOR2D *aSecond);
+
+    //! Returns the x position of a curve edge at given sub-scanline.
+    inline FIXED_POINT getCurveEdgeX(PolygonCurveEdge &aCurve, int aLine);
+
+    //! Plots a curve edge to the mask buffer on the given sub-scanlines of a scanline.
+    inline void plotEvenOddCurveEdge(const PolygonScanEdge *aEdge, SpanExtents &aEdgeExtents, int aCurrentLine, int aFirstSub, int aLastSub);
+
+    //! Plots a curve edge to the winding buffer on the given sub-scanlines of a scanline.
+    inline void plotNonZeroCurveEdge(const PolygonScanEdge *aEdge, SpanExtents &aEdgeExtents, int aCurrentLine, int aFirstSub, int aLastSub);
+
+    //! Resizes the curve edge storage.
+    bool resizeCurveEdges(int aIncrement);
+
+    //! Renders the edges of a scene polygon for the given scanline.
+    inline void renderScenePolygonEdges(ScenePolygon &aPolygon, SpanExtents &aEdgeExtents, int aCurrentLine);
+
+    //! Renders the edges of a convex scene polygon for the given scanline to a span.
+    inline void renderSceneConvexEdges(ScenePolygon &aPolygon, SampleSpan &aSpan, int aCurrentLine);
+
+    //! Returns true if a scene polygon is inside one of the occluders.
+    bool isSceneOccluded(const Polygon *aPolygon, bool aCurveEdges, const MATRIX2D &aTransformation, const ClipRectangle &aClipRect,
+                         const SceneOccluder *aOccluders, int aOccluderCount) const;
+
+    //! Adds the fully covered pixels of a rectangle polygon to the occluders.
+    static void addSceneOccluder(const ScanRectangle &aRectangle, SceneOccluder *aOccluders, int &aOccluderCount);
+
+    //! Merges two lists of scene polygons sorted by the polygon index.
+    int mergeScenePolygons(int aFirst, int aSecond);
+
+    //! Resizes the scene polygon storage.
+    bool resizeScenePolygons(int aPolygonCount);
+
+    //! Resizes the scene edge line storage.
+    bool resizeSceneEdgeLines(int aIncrement);
+
+    //! Resizes the deferred pixel storage.
+    bool resizeDeferredPixels(int aPixelCount);
+
     //! Resets the fill extents.
     void resetExtents();
 
@@ -92,7 +531,8 @@ protected:
     }
 
     SUBPIXEL_DATA *mMaskBuffer;
-    NonZeroMask *mWindingBuffer;
+    NonZeroPackedMask *mWindingBuffer;
+    unsigned char *mCoverageBuffer;
     SpanExtents mVerticalExtents;
 
     PolygonScanEdge **mEdgeTable;
@@ -100,12 +540,40 @@ protected:
     unsigned int mEdgeCount;
     unsigned int mCurrentEdge;
 
+    PolygonCurveEdge *mCurveEdges;
+    unsigned int mCurveEdgeCount;
+    unsigned int mCurrentCurveEdge;
+
     unsigned int mWidth;
     unsigned int mBufferWidth;
     unsigned int mHeight;
 
     ClipRectangle mClipRect;
     MATRIX2D mRemappingMatrix;
+
+    GammaTable *mGammaTable;
+
+    ScenePolygon *mScenePolygons;
+    unsigned int mScenePolygonCount;
+    SceneEdgeLine *mSceneEdgeLines;
+    unsigned int mSceneEdgeLineCount;
+    int *mSceneStartTable;
+    int *mSceneActivePolygons;
+
+    int *mOcclusionBuffer;
+    SceneDeferredPixel *mDeferredPixels;
+    unsigned int mDeferredPixelCount;
+    unsigned int mCurrentDeferredPixel;
+
+    ClipMask *mClipMasks;
+    int mClipMaskCount;
+    int mClipMaskCapacity;
+
+    const ClipRegion *mClipRegion;
+    int mClipRegionBand;
+
+    ClipRectangle mDamageRect;
+    bool mDamageClip;
 };
 
 #endif // !POLYGON_VERSION_F_H_INCLUDED
@@ -84,6 +84,36 @@ enum POLYGON_CLIP_FLAGS
     POLYGON_CLIP_BOTTOM = 0x08,
 };
 
+//! Classification of a transformed bounding box against the clip rectangle.
+enum POLYGON_BOUNDS_CLIP
+{
+    POLYGON_BOUNDS_OUTSIDE = 0,
+    POLYGON_BOUNDS_INSIDE = 1,
+    POLYGON_BOUNDS_PARTIAL = 2,
+};
+
+/*! The transformed bounding box is compared against the clip rectangle with a
+ *  margin, so that the rounding errors of the transformation never cause a vertex
+ *  to be trivially accepted or rejected incorrectly. The units are pixels
+ *  horizontally and sub-pixel scanlines vertically.
+ */
+#define POLYGON_BOUNDS_MARGIN INT_TO_RATIONAL(1)
+
+/*! The simplicity check of a sub-polygon sorts the edges to horizontal buckets. If
+ *  the edges are spread to more buckets than this on average, the bucket count is
+ *  halved. The bucket count isn't reduced below the edge count divided by this, in
+ *  which case the check gives up and the sub-polygon is considered to be non-simple.
+ */
+#define SUBPOLYGON_SIMPLE_BUCKET_LIMIT 16
+
+/*! Highly tessellated sub-polygons have lots of edges that cross only a couple
+ *  of sub-scanlines. The scan edge conversion merges runs of such edges within
+ *  one scanline worth of sub-scanlines to one edge, if the merged edge hits the
+ *  same pixel with every sample as the original edges. The coverage is
+ *  identical to the unmerged edges. Undefine to disable the merging.
+ */
+#define SUBPOLYGON_COALESCE_EDGES
+
 #define CLIP_SUM_SHIFT 8
 #define CLIP_UNION_SHIFT 4
 
@@ -118,6 +148,8 @@ public:
     FIXED_POINT mSlope;
     FIXED_POINT mSlopeFix;
     class PolygonScanEdge *mNextEdge;
+    //! Index of the curve state of a curve edge in the filler, -1 for lines.
+    int mCurve;
 };
 
 //! A class for holding processing data regarding the vertex.
@@ -156,6 +188,69 @@ public:
         return mVertices[aIndex];
     }
 
+    //! Returns the minimum corner of the bounding box.
+    inline const VECTOR2D & getMinimum() const
+    {
+        return mMinimum;
+    }
+
+    //! Returns the maximum corner of the bounding box.
+    inline const VECTOR2D & getMaximum() const
+    {
+        return mMaximum;
+    }
+
+    //! Returns true if the sub-polygon is an axis-aligned rectangle.
+    /*! The rectangle is the same as the bounding box.
+     */
+    inline bool isRectangle() const
+    {
+        return mRectangle;
+    }
+
+    //! Returns true if the sub-polygon is strictly convex.
+    /*! A convex sub-polygon crosses each scanline at most twice.
+     */
+    inline bool isConvex() const
+    {
+        return mConvex;
+    }
+
+    //! Returns true if none of the edges of the sub-polygon intersect.
+    /*! The winding number of a simple sub-polygon is either 0 or its orientation.
+     */
+    inline bool isSimple() const
+    {
+        return mSimple;
+    }
+
+    //! Returns the orientation of the sub-polygon.
+    /*! \return 1 for positive signed area, -1 for negative and 0 for no area.
+     */
+    inline int getOrientation() const
+    {
+        return mOrientation;
+    }
+
+    //! Classifies a bounding box against the clip rectangle after transformation.
+    /*! \param aMinimum the minimum corner of the bounding box.
+     *  \param aMaximum the maximum corner of the bounding box.
+     *  \param aTransformation the transformation matrix.
+     *  \param aClipRectangle the clip rectangle.
+     *  \return one of POLYGON_BOUNDS_CLIP values.
+     */
+    static int getBoundsClip(const VECTOR2D &aMinimum, const VECTOR2D &aMaximum, const MATRIX2D &aTransformation, const ClipRectangle &aClipRectangle);
+
+    //! Calculates the bounding box of a bounding box after transformation.
+    /*! \param aMinimum the minimum corner of the bounding box.
+     *  \param aMaximum the maximum corner of the bounding box.
+     *  \param aTransformation the transformation matrix.
+     *  \param aTransformedMinimum the minimum corner of the result.
+     *  \param aTransformedMaximum the maximum corner of the result.
+     */
+    static void getBounds(const VECTOR2D &aMinimum, const VECTOR2D &aMaximum, const MATRIX2D &aTransformation,
+                          VECTOR2D &aTransformedMinimum, VECTOR2D &aTransformedMaximum);
+
     //! Calculates the edges of the polygon with transformation and clipping to aEdges array.
     /*! Note that this may return upto three times the amount of edges that aVertexCount defines,
      *  in the unlucky case where both left and right side get clipped for all edges.
@@ -179,6 +274,18 @@ public:
     int getScanEdges(PolygonScanEdge *aEdges, const MATRIX2D &aTransformation, const ClipRectangle &aClipRectangle) const;
 
 protected:
+    //! Checks if the sub-polygon is strictly convex.
+    bool checkConvexity() const;
+
+    //! Checks if none of the edges of the sub-polygon intersect.
+    bool checkSimplicity() const;
+
+    //! Calculates the orientation of the sub-polygon.
+    int calculateOrientation() const;
+
+    //! Checks if two edges intersect or touch.
+    static bool edgesIntersect(const VECTOR2D &aStart1, const VECTOR2D &aEnd1, const VECTOR2D &aStart2, const VECTOR2D &aEnd2);
+
     //! Calculates the clip flags for a point.
     inline int getClipFlags(const VECTOR2D &aPoint, const ClipRectangle &aClipRectangle) const;
 
@@ -194,6 +301,14 @@ protected:
      */
     bool getVerticalEdge(RATIONAL aStartY, RATIONAL aEndY, RATIONAL aX, PolygonEdge &aEdge, const ClipRectangle &aClipRectangle) const;
 
+#ifdef SUBPOLYGON_COALESCE_EDGES
+    //! Calculates the sample pixels of an unclipped edge between two vertices.
+    inline void getEdgeSamples(const VertexData &aStart, const VertexData &aEnd, int *aPixels) const;
+
+    //! Removes the transformed vertices that don't change the samples of the edges.
+    int coalesceVertices() const;
+#endif
+
     //! Returns the edge(s) between two vertices in aVertexData.
     inline int getScanEdge(VertexData *aVertexData, short aWinding, PolygonScanEdge *aEdges, const ClipRectangle &aClipRectangle) const;
 
@@ -208,6 +323,12 @@ protected:
     int mVertexCount;
     VECTOR2D *mVertices;
     VertexData *mVertexData;
+    VECTOR2D mMinimum;
+    VECTOR2D mMaximum;
+    bool mRectangle;
+    bool mConvex;
+    bool mSimple;
+    int mOrientation;
 };
 
 #endif // !SUB_POLYGON_H_INCLUDED
@@ -20,6 +20,7 @@
 #define SVG_H_INCLUDED
 
 class ShapeMaker;
+class SVGProgram;
 
 //! Base class for nodes in a stack.
 class StackNode
@@ -62,6 +63,25 @@ public:
 };
 
 
+//! A class for representing strokes in SVG images.
+class SVGStroke
+{
+public:
+    unsigned int mColor;
+    RATIONAL mOpacity;
+    bool mNone;
+    StrokeStyle mStyle;
+};
+
+
+//! Stack node for storing stroke.
+class SVGStackNodeStroke : public StackNode
+{
+public:
+    SVGStroke mStroke;
+};
+
+
 //! A pool for stack nodes.
 class StackNodePool
 {
@@ -123,6 +143,15 @@ protected:
 };
 
 
+//! A pool for stroke stack nodes.
+class SVGStackNodeStrokePool : public StackNodePool
+{
+protected:
+    //! Virtual method for implementations for creating the nodes.
+    virtual StackNode *createNode();
+};
+
+
 //! A stack used while processing the SVG document.
 class SVGStack
 {
@@ -154,14 +183,33 @@ public:
     //! Pushes the fill rule from aFillRule to the stack.
     bool pushFillRule(const RENDERER_FILLMODE &aFillRule);
 
+    //! Pops stroke from the stack to aStroke.
+    bool popStroke(SVGStroke &aStroke);
+
+    //! Pushes the stroke from aStroke to the stack.
+    bool pushStroke(const SVGStroke &aStroke);
+
 protected:
     SVGStackNodeTransformation *mTransformationStack;
     SVGStackNodePaint *mPaintStack;
     SVGStackNodeFillRule *mFillRuleStack;
+    SVGStackNodeStroke *mStrokeStack;
 
     SVGStackNodeTransformationPool mTransformationPool;
     SVGStackNodePaintPool mPaintPool;
     SVGStackNodeFillRulePool mFillRulePool;
+    SVGStackNodeStrokePool mStrokePool;
+};
+
+
+//! The state of the context that is saved and restored for each group.
+class SVGState
+{
+public:
+    MATRIX2D mTransformation;
+    SVGPaint mPaint;
+    RENDERER_FILLMODE mFillRule;
+    SVGStroke mStroke;
 };
 
 
@@ -184,6 +232,12 @@ public:
     //! Pops the state of the context from the stack.
     bool popState();
 
+    //! Stores the state of the context.
+    void getState(SVGState &aState);
+
+    //! Restores the state of the context.
+    void setState(const SVGState &aState);
+
     //! Sets the current transformation in the context.
     void setCurrentTransformation(const MATRIX2D &aTransformation);
 
@@ -199,6 +253,9 @@ public:
     //! Sets the fill off.
     void setFillOff();
 
+    //! Sets the current stroke.
+    void setCurrentStroke(const SVGStroke &aStroke);
+
     //! Returns the current transformation.
     const MATRIX2D & getCurrentTransformation();
 
@@ -214,66 +271,34 @@ public:
     //! Returns true if fill is off.
     bool isFillOff();
 
+    //! Returns the current stroke.
+    const SVGStroke & getCurrentStroke();
+
+    //! Returns true if the fill of the paths is visible.
+    bool isFillVisible();
+
+    //! Returns true if the stroke of the paths is visible.
+    bool isStrokeVisible();
+
     //! Returns a pointer to the shape maker.
     ShapeMaker * getShapeMaker();
 
 protected:
+    //! Sets the current state to the shape maker.
+    void updateState();
+
+    //! Sets the current stroke to the shape maker.
+    void updateStroke();
+
     MATRIX2D mCurrentTransformation;
     SVGPaint mCurrentPaint;
     RENDERER_FILLMODE mCurrentFillRule;
+    SVGStroke mCurrentStroke;
     ShapeMaker *mShapeMaker;
     SVGStack mStack;
 };
 
 
-//! A class for storing the tokens in the SVG path data.
-class SVGPathToken
-{
-    friend class SVGPathTokenizer;
-public:
-    //! Returns a pointer to the next token.
-    SVGPathToken *getNext();
-
-    //! Returns a pointer to the data of the token.
-    const char *getBuffer();
-
-protected:
-    //! Protected constructor
-    SVGPathToken(char *aBuffer);
-
-    //! Protected destructor.
-    ~SVGPathToken();
-
-    SVGPathToken *mNext;
-    char *mBuffer;
-};
-
-
-//! A class for tokenizing the SVG path data.
-class SVGPathTokenizer
-{
-public:
-    //! Constructor.
-    SVGPathTokenizer();
-
-    //! Destructor.
-    ~SVGPathTokenizer();
-
-    //! Tokenizes the input string.
-    bool tokenize(const char *aInput);
-
-    //! Returns a pointer to the first token (call this after calling tokenize()).
-    SVGPathToken *getFirstToken();
-
-protected:
-    //! Adds a token to the list of tokens.
-    bool addToken(const char *aBuffer);
-
-    SVGPathToken *mFirstToken;
-    SVGPathToken *mLastToken;
-};
-
-
 //! Base class for commands.
 class SVGCommand
 {
@@ -288,6 +313,9 @@ public:
     //! Executes the command, i.e. applies it to the context.
     virtual bool execute(SVGContext *aContext) = 0;
 
+    //! Compiles the command to a program.
+    virtual bool compile(SVGProgram *aProgram) = 0;
+
     //! Returns the next command.
     SVGCommand *getNextSibling();
 
@@ -309,6 +337,9 @@ public:
     //! Executes the commands.
     virtual bool execute(SVGContext *aContext);
 
+    //! Compiles the commands to a program.
+    virtual bool compile(SVGProgram *aProgram);
+
     //! Adds a new command to the set as the last child node.
     void addLastChild(SVGCommand *aCommand);
 
@@ -338,6 +369,9 @@ public:
     //! Executes the command, i.e. applies it to the context.
     virtual bool execute(SVGContext *aContext);
 
+    //! Compiles the command to a program.
+    virtual bool compile(SVGProgram *aProgram);
+
 protected:
     unsigned int mColor;
     bool mNone;
@@ -357,6 +391,9 @@ public:
     //! Executes the command, i.e. applies it to the context.
     virtual bool execute(SVGContext *aContext);
 
+    //! Compiles the command to a program.
+    virtual bool compile(SVGProgram *aProgram);
+
 protected:
     RATIONAL mOpacity;
 };
@@ -375,17 +412,64 @@ public:
     //! Executes the command, i.e. applies it to the context.
     virtual bool execute(SVGContext *aContext);
 
+    //! Compiles the command to a program.
+    virtual bool compile(SVGProgram *aProgram);
+
 protected:
     RENDERER_FILLMODE mFillRule;
 };
 
 
+// The stroke attributes set in a stroke command.
+#define SVG_STROKE_COLOR 0x01
+#define SVG_STROKE_OPACITY 0x02
+#define SVG_STROKE_WIDTH 0x04
+#define SVG_STROKE_JOIN 0x08
+#define SVG_STROKE_CAP 0x10
+#define SVG_STROKE_MITER_LIMIT 0x20
+#define SVG_STROKE_HAIRLINE 0x40
+
+//! A stroke definition command in SVG command tree.
+/*! A single command holds all the stroke attributes of an element. Only the
+ *  attributes that are set override the current stroke.
+ */
+class SVGStrokeCommand : public SVGCommand
+{
+public:
+    //! Constructor.
+    SVGStrokeCommand();
+
+    //! Builds a stroke command from the given strings.
+    /*! Returns NULL if none of the attributes is set or valid.
+     */
+    static SVGCommand * build(const char *aStroke, const char *aStrokeOpacity, const char *aStrokeWidth,
+                              const char *aLineJoin, const char *aLineCap, const char *aMiterLimit,
+                              const char *aVectorEffect);
+
+    //! Executes the command, i.e. applies it to the context.
+    virtual bool execute(SVGContext *aContext);
+
+    //! Compiles the command to a program.
+    virtual bool compile(SVGProgram *aProgram);
+
+    //! Applies the attributes of a stroke selected by a mask to the current stroke.
+    static void apply(SVGContext *aContext, const SVGStroke &aStroke, unsigned int aMask);
+
+protected:
+    unsigned int mMask;
+    SVGStroke mStroke;
+};
+
+
 //! A begin path command in SVG command tree.
 class SVGBeginPathCommand : public SVGCommand
 {
 public:
     //! Executes the command, i.e. applies it to the context.
     virtual bool execute(SVGContext *aContext);
+
+    //! Compiles the command to a program.
+    virtual bool compile(SVGProgram *aProgram);
 };
 
 
@@ -395,12 +479,35 @@ class SVGEndPathCommand : public SVGCommand
 public:
     //! Executes the command, i.e. applies it to the context.
     virtual bool execute(SVGContext *aContext);
+
+    //! Compiles the command to a program.
+    virtual bool compile(SVGProgram *aProgram);
 };
 
 
+//! A begin layer command in SVG command tree.
+class SVGBeginLayerCommand : public SVGCommand
+{
+public:
+    //! Executes the command, i.e. applies it to the context.
+    virtual bool execute(SVGContext *aContext);
+
+    //! Compiles the command to a program.
+    virtual bool compile(SVGProgram *aProgram);
+};
+
+
+// Significant digits used when parsing numbers in the path data.
+#define SVG_PATH_NUMBER_DIGITS 18
+
 //! A command representing the path data in SVG command tree.
+/*! The whole path data is parsed in a single pass to one array of command keys
+ *  and one array of arguments, so no memory is allocated per token or per
+ *  path command.
+ */
 class SVGPathCommand : public SVGCommand
 {
+    friend class SVGProgram;
 public:
     //! Constructor.
     SVGPathCommand();
@@ -411,12 +518,91 @@ public:
     //! Returns a list of path commands, NULL if fails
     static SVGCommand * build(const char *aPathData);
 
+    //! Returns a list of path commands for the points of a polygon or a polyline, NULL if fails.
+    static SVGCommand * buildPoints(const char *aPoints, bool aClosed);
+
     //! Executes the command, i.e. applies it to the context.
     virtual bool execute(SVGContext *aContext);
 
+    //! Compiles the command to a program.
+    virtual bool compile(SVGProgram *aProgram);
+
 protected:
-    char mCommand;
+    //! Parses the path data to the command and argument arrays.
+    bool parse(const char *aPathData);
+
+    //! Parses a list of points to line commands.
+    bool parsePoints(const char *aPoints, bool aClosed);
+
+    //! Adds a command key to the end of the command array.
+    bool addCommand(char aCommand);
+
+    //! Adds an argument to the end of the argument array.
+    bool addArgument(RATIONAL aArgument);
+
+    //! Returns the number of arguments of a path command, -1 if the command is unknown.
+    static int getArgumentCount(char aCommand);
+
+    //! Parses a number from the input and moves the input past it.
+    static bool parseNumber(const char *&aInput, RATIONAL &aValue);
+
+    //! Executes a single path command with the given arguments.
+    static bool executeCommand(ShapeMaker *aMaker, char aCommand, const RATIONAL *aData);
+
+    char *mCommands;
+    int mCommandCount;
+    int mCommandCapacity;
     RATIONAL *mData;
+    int mDataCount;
+    int mDataCapacity;
+};
+
+
+//! A rectangle command in SVG command tree.
+class SVGRectangleCommand : public SVGCommand
+{
+public:
+    //! Constructor.
+    SVGRectangleCommand(const VECTOR2D &aPosition, const VECTOR2D &aSize, const VECTOR2D &aRadius);
+
+    //! Returns a list of path commands for a rectangle, NULL if fails.
+    static SVGCommand * build(const char *aX, const char *aY, const char *aWidth, const char *aHeight,
+                              const char *aRx, const char *aRy);
+
+    //! Executes the command, i.e. applies it to the context.
+    virtual bool execute(SVGContext *aContext);
+
+    //! Compiles the command to a program.
+    virtual bool compile(SVGProgram *aProgram);
+
+protected:
+    VECTOR2D mPosition;
+    VECTOR2D mSize;
+    VECTOR2D mRadius;
+};
+
+
+//! An ellipse command in SVG command tree.
+/*! This is used for both circles and ellipses.
+ */
+class SVGEllipseCommand : public SVGCommand
+{
+public:
+    //! Constructor.
+    SVGEllipseCommand(const VECTOR2D &aCenter, const VECTOR2D &aRadius);
+
+    //! Returns a list of path commands for an ellipse, NULL if fails.
+    static SVGCommand * build(const char *aCx, const char *aCy, const char *aRx, const char *aRy);
+
+    //! Executes the command, i.e. applies it to the context.
+    virtual bool execute(SVGContext *aContext);
+
+    //! Compiles the command to a program.
+    virtual bool compile(SVGProgram *aProgram);
+
+protected:
+    VECTOR2D mCenter;
+    VECTOR2D mRadius;
 };
 
 
@@ -430,6 +616,9 @@ public:
     //! Executes the command, i.e. applies it to the context.
     virtual bool execute(SVGContext *aContext);
 
+    //! Compiles the command to a program.
+    virtual bool compile(SVGProgram *aProgram);
+
 protected:
     MATRIX2D mMatrix;
 };
@@ -438,12 +627,15 @@ protected:
 //! A command representing a document in SVG command tree.
 class SVGDocument : public SVGCommandSet
 {
+    friend class SVGReader;
 public:
     //! Constructor.
     SVGDocument();
 
     //! Loads the SVG document from a file.
-    static SVGDocument *load(const char *aFileName);
+    /*! If aLayers is true, each top level group is stored as a layer of its own.
+     */
+    static SVGDocument *load(const char *aFileName, bool aLayers = false);
 
     //! Sets the root level transformation for the SVG document.
     void setTransformation(const MATRIX2D &aMatrix);
@@ -451,17 +643,190 @@ public:
     //! Executes the command, i.e. applies it to the context.
     virtual bool execute(SVGContext *aContext);
 
+    //! Compiles the command to a program.
+    virtual bool compile(SVGProgram *aProgram);
+
+    //! Compiles the document to a program that can be executed repeatedly.
+    /*! The program does not refer to the document, so the document can be
+     *  deleted after this. Returns NULL if fails.
+     */
+    SVGProgram *createProgram();
+
 protected:
     //! Creates the SVG tree from the XML DOM.
-    static bool createTree(class TiXmlElement *aElement, SVGCommandSet *aSet);
+    static bool createTree(class TiXmlElement *aElement, SVGCommandSet *aSet, bool aLayers);
+
+    //! Creates a stroke command from the attributes of an element.
+    static SVGCommand * createStroke(class TiXmlElement *aElement);
 
     //! Creates a path command set from strings.
-    static SVGCommand * createPath(const char *aFill, const char *aFillOpacity, const char *aFillRule, const char *aPath);
+    static SVGCommand * createPath(const char *aFill, const char *aFillOpacity, const char *aFillRule, SVGCommand *aStroke, const char *aPath);
+
+    //! Creates a path command set for a shape from strings.
+    static SVGCommand * createShape(const char *aFill, const char *aFillOpacity, const char *aFillRule, SVGCommand *aStroke, SVGCommand *aShape);
+
+    //! Creates the path commands for a basic shape element, NULL if fails.
+    static SVGCommand * createBasicShape(class TiXmlElement *aElement);
 
     MATRIX2D mMatrix;
 };
 
+// The opcodes of a compiled SVG program. The operands of each opcode follow it
+// in the code:
+// - RESET, TRANSFORM: a matrix as six rationals
+// - COLOR: a color
+// - OPACITY: a rational
+// - FILL_RULE: an integer
+// - STROKE: a mask, a color and a none flag, followed by the opacity, width,
+//   join, cap, miter limit and hairline flag of the stroke
+// - PATH: the count of the following words, and for each path command the
+//   command key followed by its arguments
+// - RECTANGLE: the position, the size and the corner radii as six rationals
+// - ELLIPSE: the center and the radii as four rationals
+#define SVG_OPCODE_RESET 0
+#define SVG_OPCODE_TRANSFORM 1
+#define SVG_OPCODE_PUSH_STATE 2
+#define SVG_OPCODE_POP_STATE 3
+#define SVG_OPCODE_COLOR 4
+#define SVG_OPCODE_FILL_OFF 5
+#define SVG_OPCODE_OPACITY 6
+#define SVG_OPCODE_FILL_RULE 7
+#define SVG_OPCODE_STROKE 8
+#define SVG_OPCODE_BEGIN_PATH 9
+#define SVG_OPCODE_END_PATH 10
+#define SVG_OPCODE_BEGIN_LAYER 11
+#define SVG_OPCODE_PATH 12
+#define SVG_OPCODE_RECTANGLE 13
+#define SVG_OPCODE_ELLIPSE 14
+
+//! A word in the code of a compiled SVG program.
+union SVGCodeWord
+{
+    int mInt;
+    unsigned int mColor;
+    RATIONAL mRational;
+};
+
+
+//! An SVG command tree compiled to a flat stream of opcodes and operands.
+/*! Executing the program gives the same result as executing the command tree,
+ *  but without virtual calls or the pools of the context stack. The states of
+ *  the groups are saved to an array that is sized at compilation. The paths can
+ *  also be executed in ranges, so that the ranges can be tessellated in
+ *  separate shape makers.
+ */
+class SVGProgram
+{
+public:
+    //! Constructor.
+    SVGProgram();
+
+    //! Destructor.
+    ~SVGProgram();
+
+    //! Executes the program, i.e. applies it to the context.
+    bool execute(SVGContext *aContext);
+
+    //! Executes a range of the paths of the program.
+    bool execute(SVGContext *aContext, int aFirstPath, int aPathCount);
+
+    //! Returns the count of paths in the program.
+    int getPathCount();
+
+    //! Adds an opcode to the end of the code.
+    bool addOpcode(int aOpcode);
+
+    //! Adds an integer operand to the end of the code.
+    bool addInt(int aValue);
+
+    //! Adds a color operand to the end of the code.
+    bool addColor(unsigned int aColor);
+
+    //! Adds a rational operand to the end of the code.
+    bool addRational(RATIONAL aValue);
+
+    //! Adds a matrix operand to the end of the code.
+    bool addMatrix(const MATRIX2D &aMatrix);
+
+protected:
+    //! Executes a range of the paths of the program with the given state stack.
+    bool execute(SVGContext *aContext, int aFirstPath, int aPathCount, SVGState *aStates);
+
+    //! Adds a word to the end of the code.
+    bool addWord(const SVGCodeWord &aWord);
+
+    SVGCodeWord *mCode;
+    int mSize;
+    int mCapacity;
+    int mDepth;
+    int mMaxDepth;
+    int mPathCount;
+    SVGState *mStates;
+    int mStateCount;
+};
+
+
+// The minimum count of paths tessellated by a task when loading SVG files concurrently.
+#define SVG_LOADER_MIN_PATHS_PER_TASK 64
+
+// The maximum count of tessellation tasks per thread for a single SVG file.
+#define SVG_LOADER_TASKS_PER_THREAD 4
+
+//! A task for compiling an SVG file to a program.
+class SVGCompileTask : public TASKRUNNER_TASK
+{
+public:
+    //! Constructor.
+    SVGCompileTask();
+
+    //! Destructor.
+    virtual ~SVGCompileTask();
+
+    //! Runs the task.
+    virtual void run();
+
+    char *mFileName;
+    bool mLayers;
+    SVGProgram *mProgram;
+    bool mResult;
+};
+
+
+//! A task for tessellating a range of the paths of an SVG program.
+class SVGTessellationTask : public TASKRUNNER_TASK
+{
+public:
+    //! Constructor.
+    SVGTessellationTask();
+
+    //! Destructor.
+    virtual ~SVGTessellationTask();
+
+    //! Runs the task.
+    virtual void run();
+
+    SVGProgram *mProgram;
+    int mFirstPath;
+    int mPathCount;
+    bool mRetainCurves;
+    ShapeMaker *mShapeMaker;
+    bool mResult;
+};
+
+
 //! A static method for loading an SVG file (and optionally creating a tesselated dump of it) into a VectorGraphic object.
-VectorGraphic * loadSVGtoVectorGraphic(PolygonFactory *aFactory, const char *aPath, const char *aSVGName, const char *aSVGDumpName, const char *aBinaryDumpName);
+/*! If aLayers is true, the top level groups of the document are kept as layers in the VectorGraphic.
+ *  If aRetainCurves is true, the polygons keep the curves, so that they can be flattened again
+ *  for the scale they are rendered at.
+ */
+VectorGraphic * loadSVGtoVectorGraphic(PolygonFactory *aFactory, const char *aPath, const char *aSVGName, const char *aSVGDumpName, const char *aBinaryDumpName, bool aLayers = false, bool aRetainCurves = false);
+
+//! A static method for loading a set of SVG files concurrently into VectorGraphic objects.
+/*! The files are compiled in parallel, and the paths of each file are then tessellated
+ *  in parallel in ranges. The results are the same as with loadSVGtoVectorGraphic().
+ *  The dump name arrays may be NULL, and so may their items.
+ *  If aThreadCount is 0, one thread per processor is used.
+ */
+bool loadSVGstoVectorGraphics(PolygonFactory *aFactory, const char *aPath, const char * const *aSVGNames, const char * const *aSVGDumpNames, const char * const *aBinaryDumpNames, int aCount, VectorGraphic **aGraphics, bool aLayers = false, bool aRetainCurves = false, int aThreadCount = 0);
 
 #endif // SVG_H_INCLUDED
@@ -0,0 +1,162 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ * 
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief A streaming reader for SVG files.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+#ifndef SVG_READER_H_INCLUDED
+#define SVG_READER_H_INCLUDED
+
+class SVGContext;
+class SVGProgram;
+
+// The element types kept in the element stack of the reader.
+#define SVG_ELEMENT unsigned char
+#define SVG_ELEMENT_OTHER 0
+#define SVG_ELEMENT_GROUP 1
+#define SVG_ELEMENT_PATH 2
+#define SVG_ELEMENT_RECT 3
+#define SVG_ELEMENT_CIRCLE 4
+#define SVG_ELEMENT_ELLIPSE 5
+#define SVG_ELEMENT_POLYGON 6
+#define SVG_ELEMENT_POLYLINE 7
+
+// The attributes read from the group, path and basic shape elements.
+#define SVG_ATTRIBUTE_FILL 0
+#define SVG_ATTRIBUTE_FILL_OPACITY 1
+#define SVG_ATTRIBUTE_FILL_RULE 2
+#define SVG_ATTRIBUTE_STROKE 3
+#define SVG_ATTRIBUTE_STROKE_OPACITY 4
+#define SVG_ATTRIBUTE_STROKE_WIDTH 5
+#define SVG_ATTRIBUTE_STROKE_LINEJOIN 6
+#define SVG_ATTRIBUTE_STROKE_LINECAP 7
+#define SVG_ATTRIBUTE_STROKE_MITERLIMIT 8
+#define SVG_ATTRIBUTE_VECTOR_EFFECT 9
+#define SVG_ATTRIBUTE_D 10
+#define SVG_ATTRIBUTE_X 11
+#define SVG_ATTRIBUTE_Y 12
+#define SVG_ATTRIBUTE_WIDTH 13
+#define SVG_ATTRIBUTE_HEIGHT 14
+#define SVG_ATTRIBUTE_RX 15
+#define SVG_ATTRIBUTE_RY 16
+#define SVG_ATTRIBUTE_CX 17
+#define SVG_ATTRIBUTE_CY 18
+#define SVG_ATTRIBUTE_R 19
+#define SVG_ATTRIBUTE_POINTS 20
+#define SVG_ATTRIBUTE_COUNT 21
+
+//! A streaming reader for SVG files.
+/*! The file is memory mapped and the XML is tokenized one tag at a time. The
+ *  group, path and basic shape elements are applied to the context as soon as
+ *  they are read, so neither an XML DOM nor an SVG command tree is built. The
+ *  memory used by the reader depends on the nesting depth and the size of the
+ *  largest element, not on the size of the document. Alternatively the document
+ *  can be compiled to an SVGProgram, which can then be executed later, e.g. in
+ *  another thread.
+ */
+class SVGReader
+{
+public:
+    //! Constructor.
+    SVGReader(SVGContext *aContext);
+
+    //! Constructor for compiling the document to a program.
+    SVGReader(SVGProgram *aProgram);
+
+    //! Destructor.
+    ~SVGReader();
+
+    //! Loads an SVG file and applies it to the context or compiles it to the program.
+    bool load(const char *aFileName, bool aLayers = false);
+
+    //! Reads SVG data from memory and applies it to the context or compiles it to the program.
+    bool read(const char *aData, int aSize, bool aLayers = false);
+
+    //! Sets the root level transformation for the SVG document.
+    void setTransformation(const MATRIX2D &aMatrix);
+
+protected:
+    //! Initializer.
+    void init();
+
+    //! Reads the start tag of an element and begins the element.
+    bool readStartTag();
+
+    //! Reads the end tag of an element and ends the element.
+    bool readEndTag();
+
+    //! Reads an attribute of a start tag.
+    bool readAttribute(bool aStore);
+
+    //! Skips the input past the given string.
+    bool skipPast(const char *aString);
+
+    //! Skips a declaration such as DOCTYPE, including its internal subset.
+    bool skipDeclaration();
+
+    //! Skips the white space in the input.
+    void skipWhiteSpace();
+
+    //! Returns true if the input continues with the given string.
+    bool startsWith(const char *aString);
+
+    //! Stores an attribute value with the entity references decoded.
+    bool storeAttribute(int aAttribute, const char *aValue, int aLength);
+
+    //! Returns the value of an attribute of the current element, NULL if not set.
+    const char *getAttribute(int aAttribute);
+
+    //! Begins an element, i.e. applies a group, a path or a basic shape to the context.
+    bool beginElement(SVG_ELEMENT aElement);
+
+    //! Creates the path commands for a basic shape element, NULL if fails.
+    SVGCommand *createBasicShape(SVG_ELEMENT aElement);
+
+    //! Ends the current element.
+    bool endElement();
+
+    //! Pushes the state of the context.
+    bool pushState();
+
+    //! Pops the state of the context.
+    bool popState();
+
+    //! Begins a new layer.
+    bool beginLayer();
+
+    //! Executes or compiles a command and deletes it.
+    bool execute(SVGCommand *aCommand);
+
+    SVGContext *mContext;
+    SVGProgram *mProgram;
+    MATRIX2D mMatrix;
+    bool mLayers;
+
+    const char *mPosition;
+    const char *mEnd;
+
+    SVG_ELEMENT *mElements;
+    int mElementCount;
+    int mElementCapacity;
+    int mGroupDepth;
+    int mPathDepth;
+
+    int mAttributes[SVG_ATTRIBUTE_COUNT];
+    char *mBuffer;
+    int mBufferSize;
+    int mBufferCapacity;
+};
+
+#endif // !SVG_READER_H_INCLUDED
@@ -19,6 +19,12 @@
 #ifndef SHAPEMAKER_H_INCLUDED
 #define SHAPEMAKER_H_INCLUDED
 
+// The flatness of the strokes if the curves are split to a fixed amount of steps.
+#define SHAPEMAKER_STROKE_FLATNESS FLOAT_TO_RATIONAL(0.1f)
+
+// The length of the control vectors of a cubic bezier curve for a quarter of a
+// circle, relative to the radius.
+#define SHAPEMAKER_ARC_KAPPA 0.5522847498307936
 
 //! A utility class for building polygons out of SVG commands.
 class ShapeMaker
@@ -43,6 +49,28 @@ public:
      */
     void setFillRule(RENDERER_FILLMODE aFillMode);
 
+    //! Sets whether the paths are filled.
+    /*! Current fill is applied to the path at beginPath().
+     */
+    void setFillEnabled(bool aFillEnabled);
+
+    //! Sets the current stroke color.
+    /*! Current stroke color is applied to the path at beginPath().
+     */
+    void setStrokeColor(unsigned int aColor);
+
+    //! Sets the current stroke style.
+    /*! Current stroke style is applied to the path at beginPath(). The width is
+     *  scaled with the transformation, unless the stroke is a hairline.
+     */
+    void setStrokeStyle(const StrokeStyle &aStyle);
+
+    //! Sets whether the paths are stroked.
+    /*! Current stroke is applied to the path at beginPath(). A stroked path is
+     *  added to the shape data as a separate polygon after the fill.
+     */
+    void setStrokeEnabled(bool aStrokeEnabled);
+
     //! Starts a new shape and clears the shape data collected this far.
     /*! This must be called as the first thing before assigning any commands to
      *  the shape maker.
@@ -55,6 +83,11 @@ public:
     //! Ends the path.
     bool endPath();
 
+    //! Begins a new layer.
+    /*! The paths after this call belong to the new layer.
+     */
+    bool beginLayer();
+
     //! Moves the draw head to an absolute position.
     bool moveToAbsolute(const VECTOR2D &aPosition);
 
@@ -106,24 +139,53 @@ public:
     //! Closes the path being drawn.
     bool closePath();
 
+    //! Draws a rectangle with optionally rounded corners as a closed sub-path.
+    bool rectangle(const VECTOR2D &aPosition, const VECTOR2D &aSize, const VECTOR2D &aRadius);
+
+    //! Draws an ellipse as a closed sub-path.
+    bool ellipse(const VECTOR2D &aCenter, const VECTOR2D &aRadius);
+
     //! Sets the amount of bezier steps.
+    /*! This is used only if the flatness is zero.
+     */
     void setBezierSteps(int aSteps);
 
+    //! Sets the flatness tolerance of the bezier curves.
+    /*! The curves are split to the smallest amount of segments that keeps the
+     *  segments within aFlatness from the curve in transformed coordinates.
+     *  If aFlatness is zero, the curves are split to a fixed amount of bezier
+     *  steps.
+     */
+    void setFlatness(RATIONAL aFlatness);
+
+    //! Sets whether the curves are kept in the shape data.
+    /*! If enabled, each path is stored as a PathData with the curves in addition to
+     *  the flattened PolygonData, so that the curves can be flattened again for
+     *  different scales. This must be set before newShape().
+     */
+    void setRetainCurves(bool aRetainCurves);
+
     //! Inner class for handling the path data as a set of polygons.
     class ShapeData
     {
     public:
         //! Constructor.
-        ShapeData();
+        /*! \param aRetainCurves if true, the path data with the curves is stored as well.
+         */
+        ShapeData(bool aRetainCurves = false);
 
         //! Destructor.
         ~ShapeData();
 
         //! Begins a new polygon.
-        bool beginPolygon(unsigned long aColor, RENDERER_FILLMODE aFillMode);
+        bool beginPolygon(unsigned long aColor, RENDERER_FILLMODE aFillMode, bool aFill = true,
+                          unsigned long aStrokeColor = 0, const StrokeStyle *aStrokeStyle = NULL);
 
         //! Ends the polygon.
-        bool endPolygon();
+        bool endPolygon(RATIONAL aStrokeFlatness = SHAPEMAKER_STROKE_FLATNESS);
+
+        //! Begins a new layer at the next polygon.
+        bool beginLayer();
 
         //! Starts a new sub polygon.
         bool beginSubPolygon();
@@ -131,12 +193,28 @@ public:
         //! Ends the sub polygon.
         bool endSubPolygon();
 
+        //! Marks the current sub polygon closed.
+        void closeSubPolygon();
+
         //! Adds a vertex to current sub polygon.
         bool addVertex(const VECTOR2D &aVertex);
 
+        //! Adds a path point to current sub polygon.
+        bool addPathPoint(const VECTOR2D &aPoint, PATH_POINT_TAG aTag);
+
         //! Returns a pointer to the polygon data.
         const PolygonData * const * getPolygons() const;
 
+        //! Returns a pointer to the path data of the polygons.
+        /*! The entries are NULL if the curves are not retained.
+         */
+        const PathData * const * getPaths() const;
+
+        //! Returns a pointer to the stroke styles of the polygons.
+        /*! The entries are NULL for the fills.
+         */
+        const StrokeStyle * const * getStrokes() const;
+
         //! Returns a pointer to the color data.
         const unsigned long * getColors() const;
 
@@ -146,13 +224,19 @@ public:
         //! Returns the polygon count.
         int getPolygonCount() const;
 
+        //! Returns a pointer to the index of the first polygon of each layer.
+        const int * getLayerStarts() const;
+
+        //! Returns the layer count.
+        int getLayerCount() const;
+
     protected:
         //! Inner class for handling a single polygon in the ShapeData.
         class ShapeEntry
         {
         public:
             //! Constructor.
-            ShapeEntry();
+            ShapeEntry(bool aRetainCurves);
 
             //! Destructor.
             ~ShapeEntry();
@@ -162,26 +246,68 @@ public:
              */
             PolygonData * createPolygonData() const;
 
+            //! Creates a PathData from the contents of the shape entry.
+            /*! Returns NULL if the curves are not retained. Note that the ShapeEntry
+             *  owns the data the PathData refers to.
+             */
+            PathData * createPathData() const;
+
+            //! Creates a PolygonData from the stroked outline of the shape entry.
+            /*! Note that the ShapeEntry owns the data the PolygonData refers to.
+             */
+            PolygonData * createStrokeData() const;
+
+            //! Strokes the path of the shape entry.
+            bool stroke(Stroker &aStroker, const StrokeStyle &aStyle, RATIONAL aFlatness);
+
             //! Starts a new sub polygon.
             bool beginSubPolygon();
 
             //! Ends the sub polygon.
             bool endSubPolygon();
 
+            //! Marks the current sub polygon closed.
+            void closeSubPolygon();
+
             //! Adds a vertex to the shape entry.
             bool addVertex(const VECTOR2D &aVertex);
 
+            //! Adds a path point to the shape entry.
+            bool addPathPoint(const VECTOR2D &aPoint, PATH_POINT_TAG aTag);
+
         protected:
             RATIONAL **mVertexData;
             int *mVertexCounts;
             int mSubPolygonCount;
+            bool mRetainCurves;
+            RATIONAL **mPointData;
+            PATH_POINT_TAG **mTagData;
+            int *mPointCounts;
+            bool *mClosedData;
+            RATIONAL *mStrokeVertices;
+            RATIONAL **mStrokeData;
+            int *mStrokeCounts;
+            int mStrokeCount;
         };
 
+        //! Adds a polygon to the end of the arrays.
+        bool addPolygon(ShapeEntry *aShape, unsigned long aColor, RENDERER_FILLMODE aFillMode);
+
+        bool mRetainCurves;
         ShapeEntry **mShapes;
         PolygonData **mPolygons;
+        PathData **mPaths;
+        StrokeStyle **mStrokes;
         unsigned long *mColors;
         RENDERER_FILLMODE *mFillModes;
         int mPolygonCount;
+        int *mLayerStarts;
+        int mLayerCount;
+        bool mCurrentFill;
+        unsigned long mCurrentStrokeColor;
+        bool mCurrentStroke;
+        StrokeStyle mCurrentStrokeStyle;
+        Stroker mStroker;
     };
 
     //! Returns a pointer to the shape data gathered since the last call to newShape().
@@ -198,11 +324,31 @@ protected:
      */
     bool edgeTo(const VECTOR2D &aPosition);
 
+    //! Returns the amount of segments a curve is split to.
+    int getBezierSteps(RATIONAL aDifference, int aDegree) const;
+
+    //! Returns the amount of segments a quarter of an ellipse is split to.
+    int getArcSteps(const VECTOR2D &aCenter, const VECTOR2D &aRadius) const;
+
+    //! Draws a quarter of an ellipse from the current point.
+    bool arcTo(const VECTOR2D &aCenter, const VECTOR2D &aRadius, int aQuadrant, int aSteps);
+
+    //! Adds a path point if the curves are retained or the path is stroked.
+    /*! This uses the transformed coordinates.
+     */
+    bool pathTo(const VECTOR2D &aPoint, PATH_POINT_TAG aTag);
+
     ShapeData *mShapeData;
     MATRIX2D mTransformation;
     unsigned int mCurrentColor;
     RENDERER_FILLMODE mCurrentFillMode;
+    bool mCurrentFillEnabled;
+    unsigned int mCurrentStrokeColor;
+    StrokeStyle mCurrentStrokeStyle;
+    bool mCurrentStrokeEnabled;
     int mBezierSteps;
+    RATIONAL mFlatness;
+    bool mRetainCurves;
     VECTOR2D mCurrentPoint;
     VECTOR2D mCurrentControlPoint;
     VECTOR2D mStartPoint;
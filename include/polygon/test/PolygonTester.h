@@ -61,6 +61,9 @@ public:
     //! Sets the scale for the transformation of the given graphic.
     void setScale(RATIONAL aScale, int aVectorGraphic);
 
+    //! Sets the vector graphics to be rendered as a single scene.
+    void setSceneRendering(bool aSceneRendering);
+
     //! Runs one iteration of the test. This renders the graphic to aTarget.
     void runTest(RenderTargetWrapper *aTarget);
 
@@ -166,6 +169,9 @@ protected:
 
     //! Scale factors for the vector graphics.
     RATIONAL *mScales;
+
+    //! Flag for rendering the vector graphics as a single scene.
+    bool mSceneRendering;
 };
 
 #endif // !POLYGON_TESTER_H_INCLUDED
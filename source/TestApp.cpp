@@ -46,6 +46,15 @@
 // Toggles on saving of results.
 // #define SAVE_RESULTS
 
+// Toggles on gamma correct blending of the antialiased pixels.
+// #define GAMMA_CORRECTION
+
+// Toggles on rendering all polygons of a vector graphic in a single pass.
+// #define SCENE_RENDERING
+
+// Toggles on front to back occlusion culling in the scene rendering.
+// #define OCCLUSION_CULLING
+
 // Defines the svg path
 #define SVG_PATH "../../SVG/"
 
@@ -489,6 +498,16 @@ bool TestApp::init()
     if (fillers[0] == NULL || !((PolygonVersionF *)fillers[0])->init(WINDOW_WIDTH, WINDOW_HEIGHT, 300000))
         return false;
 
+#ifdef GAMMA_CORRECTION
+    if (!((PolygonVersionF *)fillers[0])->setGammaCorrection(true))
+        return false;
+#endif
+
+#ifdef OCCLUSION_CULLING
+    if (!((PolygonVersionF *)fillers[0])->setOcclusionCulling(true))
+        return false;
+#endif
+
 #ifdef TEST_ALL_VERSIONS
     fillers[1] = new PolygonVersionE();
     if (fillers[1] == NULL || !((PolygonVersionE *)fillers[1])->init(WINDOW_WIDTH, WINDOW_HEIGHT))
@@ -588,6 +607,10 @@ bool TestApp::init()
 
     mPolygonTester->setScale(GLOBAL_SCALE);
 
+#ifdef SCENE_RENDERING
+    mPolygonTester->setSceneRendering(true);
+#endif
+
 #ifdef GATHER_STATISTICS
     int vgCount = mPolygonTester->getVectorGraphicCount();
     for (n = 0; n < vgCount; n++)
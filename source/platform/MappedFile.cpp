@@ -0,0 +1,113 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ * 
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief A read-only memory mapped file implementation.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+#include <windows.h>
+#include "platform/MappedFile.h"
+
+//! Constructor.
+MappedFile::MappedFile()
+{
+    mFile = INVALID_HANDLE_VALUE;
+    mMapping = NULL;
+    mData = NULL;
+    mSize = 0;
+}
+
+
+//! Destructor. Closes the file if it is open.
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+
+//! Opens the file and maps it to memory.
+/*! Fails for empty files and for files that do not fit in the address space.
+ *  \param aFileName the name of the file.
+ *  \return true if the file was mapped, false otherwise.
+ */
+bool MappedFile::open(const char *aFileName)
+{
+    close();
+
+    HANDLE file = CreateFileA(aFileName,GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    DWORD sizeHigh = 0;
+    DWORD size = GetFileSize(file,&sizeHigh);
+    if (size == INVALID_FILE_SIZE || size == 0 || sizeHigh != 0 || size > 0x7fffffff)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file,NULL,PAGE_READONLY,0,0,NULL);
+    if (mapping == NULL)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    void *data = MapViewOfFile(mapping,FILE_MAP_READ,0,0,0);
+    if (data == NULL)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    mFile = file;
+    mMapping = mapping;
+    mData = (const char *)data;
+    mSize = (int)size;
+
+    return true;
+}
+
+
+//! Unmaps and closes the file.
+void MappedFile::close()
+{
+    if (mData)
+        UnmapViewOfFile(mData);
+    if (mMapping)
+        CloseHandle(mMapping);
+    if (mFile != INVALID_HANDLE_VALUE)
+        CloseHandle(mFile);
+
+    mFile = INVALID_HANDLE_VALUE;
+    mMapping = NULL;
+    mData = NULL;
+    mSize = 0;
+}
+
+
+//! Returns a pointer to the contents of the file, NULL if the file is not open.
+const char * MappedFile::getData()
+{
+    return mData;
+}
+
+
+//! Returns the size of the file in bytes.
+int MappedFile::getSize()
+{
+    return mSize;
+}
@@ -0,0 +1,119 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ * 
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief A task runner implementation.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+#include <windows.h>
+#include "platform/TaskRunner.h"
+
+//! Thread function of the threads started by the task runner.
+static DWORD WINAPI taskRunnerThread(LPVOID aTaskRunner)
+{
+    ((TaskRunner *)aTaskRunner)->runTasks();
+    return 0;
+}
+
+
+//! Virtual destructor.
+TaskRunnerTask::~TaskRunnerTask()
+{
+}
+
+
+//! Constructor.
+TaskRunner::TaskRunner()
+{
+    mThreadCount = 1;
+    mTasks = NULL;
+    mTaskCount = 0;
+    mNextTask = 0;
+}
+
+
+//! Initializer.
+/*! \param aThreadCount the count of threads, including the calling thread. If
+ *         this is 0, one thread per processor is used.
+ */
+void TaskRunner::init(int aThreadCount)
+{
+    if (aThreadCount <= 0)
+    {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        aThreadCount = (int)info.dwNumberOfProcessors;
+    }
+
+    if (aThreadCount < 1)
+        aThreadCount = 1;
+    if (aThreadCount > TASKRUNNER_MAX_THREADS)
+        aThreadCount = TASKRUNNER_MAX_THREADS;
+
+    mThreadCount = aThreadCount;
+}
+
+
+//! Returns the count of threads.
+int TaskRunner::getThreadCount()
+{
+    return mThreadCount;
+}
+
+
+//! Runs the tasks and returns when all of them are done.
+/*! The calling thread runs tasks as well. If the threads can not be started,
+ *  the tasks are run in fewer threads.
+ */
+void TaskRunner::run(TaskRunnerTask * const *aTasks, int aTaskCount)
+{
+    mTasks = aTasks;
+    mTaskCount = aTaskCount;
+    mNextTask = 0;
+
+    HANDLE threads[TASKRUNNER_MAX_THREADS];
+    int threadCount = 0;
+    int n;
+    for (n = 1; n < mThreadCount && n < aTaskCount; n++)
+    {
+        HANDLE thread = CreateThread(NULL,0,taskRunnerThread,this,0,NULL);
+        if (thread == NULL)
+            break;
+        threads[threadCount++] = thread;
+    }
+
+    runTasks();
+
+    if (threadCount > 0)
+        WaitForMultipleObjects(threadCount,threads,TRUE,INFINITE);
+
+    for (n = 0; n < threadCount; n++)
+        CloseHandle(threads[n]);
+
+    mTasks = NULL;
+    mTaskCount = 0;
+}
+
+
+//! Runs the tasks of the current run until none are left.
+void TaskRunner::runTasks()
+{
+    for (;;)
+    {
+        int task = (int)InterlockedIncrement(&mNextTask) - 1;
+        if (task >= mTaskCount)
+            break;
+        mTasks[task]->run();
+    }
+}
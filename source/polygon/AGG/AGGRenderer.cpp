@@ -30,6 +30,8 @@ AGGRenderer::AGGRenderer(RenderTargetWrapper *aTarget) :
     mConvTransformation(mPath, mMatrix)
 {
     MATRIX2D_MAKEIDENTITY(mCachedTransformation);
+    mClip = false;
+    mClipX1 = mClipY1 = mClipX2 = mClipY2 = 0;
 }
 
 
@@ -50,6 +52,8 @@ void AGGRenderer::render(RenderTargetWrapper *aTarget, PolygonWrapper *aPolygon,
         mPixf = pixfmt(*((AGGRenderTargetWrapper *)aTarget)->getBuffer());
         mRendererBase = agg::renderer_base<pixfmt>(mPixf);
         mRenderer = agg::renderer_scanline_aa_solid<agg::renderer_base<pixfmt> >(mRendererBase);
+        if (mClip)
+            mRendererBase.clip_box(mClipX1,mClipY1,mClipX2,mClipY2);
     }
 
     mMatrix = agg::trans_affine(MATRIX2D_GET_M11(aTransformation),
@@ -78,3 +82,15 @@ void AGGRenderer::render(RenderTargetWrapper *aTarget, PolygonWrapper *aPolygon,
 
     agg::render_scanlines(mRasterizer, mScanline, mRenderer);
 }
+
+
+//! Sets the clip rectangle for the renderer.
+void AGGRenderer::setClipRect(unsigned int aX, unsigned int aY, unsigned int aWidth, unsigned int aHeight)
+{
+    mClip = true;
+    mClipX1 = aX;
+    mClipY1 = aY;
+    mClipX2 = aX + aWidth - 1;
+    mClipY2 = aY + aHeight - 1;
+    mRendererBase.clip_box(mClipX1,mClipY1,mClipX2,mClipY2);
+}
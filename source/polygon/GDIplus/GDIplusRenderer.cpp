@@ -52,6 +52,21 @@ void GDIplusRenderer::render(RenderTargetWrapper *aTarget, PolygonWrapper *aPoly
 
     Graphics * graphics = ((GDIplusRenderTargetWrapper *)aTarget)->getGraphics();
 
+    // The clip is given in device coordinates, so it is set before the transformation.
+    graphics->ResetTransform();
+    if (mClip)
+        graphics->SetClip(mClipRect);
+    else
+        graphics->ResetClip();
+
     graphics->SetTransform(&transformation);
     graphics->FillPath(&brush,path);
 }
+
+
+//! Sets the clip rectangle for the renderer.
+void GDIplusRenderer::setClipRect(unsigned int aX, unsigned int aY, unsigned int aWidth, unsigned int aHeight)
+{
+    mClip = true;
+    mClipRect = Rect(aX,aY,aWidth,aHeight);
+}
@@ -0,0 +1,165 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ * 
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief A class for holding raw path data with curves.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+#include "polygon/base/Base.h"
+
+
+//! Flattens a sub-path to vertices.
+/*! The curves are split to the smallest amount of segments that keeps the
+ *  segments within aFlatness from the curve. The first vertex is the start
+ *  point of the sub-path.
+ *  \param aIndex the index of the sub-path.
+ *  \param aFlatness the maximum distance of the vertices from the curves.
+ *  \param aVertices the array for the vertices, two values per vertex, or NULL
+ *         for counting the vertices only.
+ *  \return the amount of vertices.
+ */
+int PathData::flatten(int aIndex, RATIONAL aFlatness, RATIONAL *aVertices) const
+{
+    const RATIONAL *points = mPointData[aIndex];
+    const PATH_POINT_TAG *tags = mTagData[aIndex];
+    int pointCount = mPointCounts[aIndex];
+
+    if (pointCount == 0)
+        return 0;
+
+    int vertexCount = 1;
+    if (aVertices)
+    {
+        aVertices[0] = points[0];
+        aVertices[1] = points[1];
+    }
+
+    int p = 1;
+    while (p < pointCount)
+    {
+        const RATIONAL *p0 = &points[(p - 1) * 2];
+
+        if (tags[p] == PATH_POINT_QUADRATIC && p + 1 < pointCount)
+        {
+            // P(t) = (1 - t)^2P0 + 2(1-t)tP1 + t^2P2
+            const RATIONAL *p1 = &points[p * 2];
+            const RATIONAL *p2 = &points[(p + 1) * 2];
+
+            RATIONAL dx = p0[0] - INT_TO_RATIONAL(2) * p1[0] + p2[0];
+            RATIONAL dy = p0[1] - INT_TO_RATIONAL(2) * p1[1] + p2[1];
+            int steps = getCurveSteps((RATIONAL)sqrt((double)(dx * dx + dy * dy)),2,aFlatness);
+
+            if (aVertices)
+            {
+                RATIONAL step = INT_TO_RATIONAL(1) / steps;
+                RATIONAL t = step;
+                RATIONAL it = INT_TO_RATIONAL(1) - t;
+                int n;
+                for (n = 0; n < steps - 1; n++)
+                {
+                    RATIONAL it2 = it * it;
+                    RATIONAL t2 = t * t;
+                    RATIONAL *vertex = &aVertices[(vertexCount + n) * 2];
+                    vertex[0] = it2 * p0[0] + INT_TO_RATIONAL(2) * it * t * p1[0] + t2 * p2[0];
+                    vertex[1] = it2 * p0[1] + INT_TO_RATIONAL(2) * it * t * p1[1] + t2 * p2[1];
+                    t += step;
+                    it -= step;
+                }
+                aVertices[(vertexCount + steps - 1) * 2] = p2[0];
+                aVertices[(vertexCount + steps - 1) * 2 + 1] = p2[1];
+            }
+
+            vertexCount += steps;
+            p += 2;
+        }
+        else if (tags[p] == PATH_POINT_CUBIC && p + 2 < pointCount)
+        {
+            // P(t) = (1 - t)^3P0 + 3(1-t)^2tP1 + 3(1-t)t^2P2 + t^3P3
+            const RATIONAL *p1 = &points[p * 2];
+            const RATIONAL *p2 = &points[(p + 1) * 2];
+            const RATIONAL *p3 = &points[(p + 2) * 2];
+
+            RATIONAL dx1 = p0[0] - INT_TO_RATIONAL(2) * p1[0] + p2[0];
+            RATIONAL dy1 = p0[1] - INT_TO_RATIONAL(2) * p1[1] + p2[1];
+            RATIONAL dx2 = p1[0] - INT_TO_RATIONAL(2) * p2[0] + p3[0];
+            RATIONAL dy2 = p1[1] - INT_TO_RATIONAL(2) * p2[1] + p3[1];
+            RATIONAL d1 = dx1 * dx1 + dy1 * dy1;
+            RATIONAL d2 = dx2 * dx2 + dy2 * dy2;
+            int steps = getCurveSteps((RATIONAL)sqrt((double)(d1 > d2 ? d1 : d2)),3,aFlatness);
+
+            if (aVertices)
+            {
+                RATIONAL step = INT_TO_RATIONAL(1) / steps;
+                RATIONAL t = step;
+                RATIONAL it = INT_TO_RATIONAL(1) - t;
+                int n;
+                for (n = 0; n < steps - 1; n++)
+                {
+                    RATIONAL it2 = it * it;
+                    RATIONAL it3 = it2 * it;
+                    RATIONAL t2 = t * t;
+                    RATIONAL t3 = t2 * t;
+                    RATIONAL *vertex = &aVertices[(vertexCount + n) * 2];
+                    vertex[0] = it3 * p0[0] + INT_TO_RATIONAL(3) * it2 * t * p1[0] +
+                                INT_TO_RATIONAL(3) * it * t2 * p2[0] + t3 * p3[0];
+                    vertex[1] = it3 * p0[1] + INT_TO_RATIONAL(3) * it2 * t * p1[1] +
+                                INT_TO_RATIONAL(3) * it * t2 * p2[1] + t3 * p3[1];
+                    t += step;
+                    it -= step;
+                }
+                aVertices[(vertexCount + steps - 1) * 2] = p3[0];
+                aVertices[(vertexCount + steps - 1) * 2 + 1] = p3[1];
+            }
+
+            vertexCount += steps;
+            p += 3;
+        }
+        else
+        {
+            // On-curve point, or a control point without enough points after it.
+            if (aVertices)
+            {
+                aVertices[vertexCount * 2] = points[p * 2];
+                aVertices[vertexCount * 2 + 1] = points[p * 2 + 1];
+            }
+
+            vertexCount++;
+            p++;
+        }
+    }
+
+    return vertexCount;
+}
+
+
+//! Returns the amount of segments a curve is split to for given flatness.
+/*! The amount is given by Wang's formula: a curve of degree n split to
+ *  sqrt(n(n-1)/8 * d / flatness) segments of equal parameter range stays within
+ *  the flatness from the curve, where d is the maximum length of the second
+ *  differences of the control points.
+ *  \param aDifference the maximum length of the second differences of the control points.
+ *  \param aDegree the degree of the curve.
+ *  \param aFlatness the maximum distance of the segments from the curve.
+ */
+int PathData::getCurveSteps(RATIONAL aDifference, int aDegree, RATIONAL aFlatness)
+{
+    double steps = sqrt((double)(aDegree * (aDegree - 1)) * aDifference / (8.0 * aFlatness));
+    if (steps >= PATH_DATA_MAX_CURVE_STEPS)
+        return PATH_DATA_MAX_CURVE_STEPS;
+
+    int n = (int)ceil(steps);
+    if (n < 1)
+        n = 1;
+    return n;
+}
@@ -0,0 +1,293 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ * 
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief A uniform grid for finding the polygons that intersect a rectangle.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+#include "polygon/base/Base.h"
+
+
+//! Constructor.
+PolygonGrid::PolygonGrid()
+{
+    mPolygonCount = 0;
+    mBounds = NULL;
+    mMinX = INT_TO_RATIONAL(0);
+    mMinY = INT_TO_RATIONAL(0);
+    mColumnScale = INT_TO_RATIONAL(0);
+    mRowScale = INT_TO_RATIONAL(0);
+    mColumns = 0;
+    mRows = 0;
+    mCellStart = NULL;
+    mCellPolygons = NULL;
+    mQueryBits = NULL;
+    mMovedPolygons = NULL;
+    mMovedCount = 0;
+    mMovedFlags = NULL;
+}
+
+
+//! Initializer.
+/*! \param aBounds the bounding boxes of the polygons, four values per polygon in
+ *         the order of minimum x, minimum y, maximum x and maximum y.
+ *  \param aPolygonCount the amount of polygons.
+ */
+bool PolygonGrid::init(const RATIONAL *aBounds, int aPolygonCount)
+{
+    if (aPolygonCount <= 0)
+        return false;
+
+    mBounds = new RATIONAL[aPolygonCount * 4];
+    if (mBounds == NULL)
+        return false;
+    MEMCPY(mBounds,aBounds,aPolygonCount * 4 * sizeof(RATIONAL));
+
+    mQueryBits = new unsigned int[(aPolygonCount + 31) / 32];
+    if (mQueryBits == NULL)
+        return false;
+    MEMSET(mQueryBits,0,((aPolygonCount + 31) / 32) * sizeof(unsigned int));
+
+    mMovedPolygons = new int[aPolygonCount];
+    if (mMovedPolygons == NULL)
+        return false;
+
+    mMovedFlags = new unsigned char[aPolygonCount];
+    if (mMovedFlags == NULL)
+        return false;
+    MEMSET(mMovedFlags,0,aPolygonCount);
+
+    mPolygonCount = aPolygonCount;
+
+    // Calculate the bounds of the whole grid.
+    RATIONAL maxX, maxY;
+    mMinX = aBounds[0];
+    mMinY = aBounds[1];
+    maxX = aBounds[2];
+    maxY = aBounds[3];
+
+    int n;
+    for (n = 1; n < aPolygonCount; n++)
+    {
+        const RATIONAL *bounds = &aBounds[n * 4];
+        if (bounds[0] < mMinX)
+            mMinX = bounds[0];
+        if (bounds[1] < mMinY)
+            mMinY = bounds[1];
+        if (bounds[2] > maxX)
+            maxX = bounds[2];
+        if (bounds[3] > maxY)
+            maxY = bounds[3];
+    }
+
+    // Choose the cell count so that there are about as many cells as polygons
+    // and the cells are roughly square.
+    RATIONAL width = maxX - mMinX;
+    RATIONAL height = maxY - mMinY;
+
+    mColumns = 1;
+    mRows = 1;
+    if (width > INT_TO_RATIONAL(0) && height > INT_TO_RATIONAL(0))
+    {
+        mColumns = (int)sqrt((double)aPolygonCount * width / height);
+        if (mColumns < 1)
+            mColumns = 1;
+        mRows = aPolygonCount / mColumns;
+    }
+    else if (width > INT_TO_RATIONAL(0))
+        mColumns = aPolygonCount;
+    else if (height > INT_TO_RATIONAL(0))
+        mRows = aPolygonCount;
+
+    if (mColumns > POLYGON_GRID_MAX_CELLS)
+        mColumns = POLYGON_GRID_MAX_CELLS;
+    if (mRows > POLYGON_GRID_MAX_CELLS)
+        mRows = POLYGON_GRID_MAX_CELLS;
+    if (mRows < 1)
+        mRows = 1;
+
+    mColumnScale = width > INT_TO_RATIONAL(0) ? (RATIONAL)mColumns / width : INT_TO_RATIONAL(0);
+    mRowScale = height > INT_TO_RATIONAL(0) ? (RATIONAL)mRows / height : INT_TO_RATIONAL(0);
+
+    int cellCount = mColumns * mRows;
+    mCellStart = new int[cellCount + 1];
+    if (mCellStart == NULL)
+        return false;
+    MEMSET(mCellStart,0,(cellCount + 1) * sizeof(int));
+
+    // Count the polygons of each cell.
+    for (n = 0; n < aPolygonCount; n++)
+    {
+        const RATIONAL *bounds = &aBounds[n * 4];
+        int minColumn = getColumn(bounds[0]);
+        int maxColumn = getColumn(bounds[2]);
+        int minRow = getRow(bounds[1]);
+        int maxRow = getRow(bounds[3]);
+
+        int y;
+        for (y = minRow; y <= maxRow; y++)
+        {
+            int x;
+            for (x = minColumn; x <= maxColumn; x++)
+                mCellStart[y * mColumns + x + 1]++;
+        }
+    }
+
+    for (n = 0; n < cellCount; n++)
+        mCellStart[n + 1] += mCellStart[n];
+
+    mCellPolygons = new int[mCellStart[cellCount]];
+    if (mCellPolygons == NULL)
+        return false;
+
+    // Fill in the polygons. The polygons are processed in order, so each cell lists
+    // them in ascending order. mCellStart is used as the insertion position and is
+    // restored afterwards.
+    for (n = 0; n < aPolygonCount; n++)
+    {
+        const RATIONAL *bounds = &aBounds[n * 4];
+        int minColumn = getColumn(bounds[0]);
+        int maxColumn = getColumn(bounds[2]);
+        int minRow = getRow(bounds[1]);
+        int maxRow = getRow(bounds[3]);
+
+        int y;
+        for (y = minRow; y <= maxRow; y++)
+        {
+            int x;
+            for (x = minColumn; x <= maxColumn; x++)
+                mCellPolygons[mCellStart[y * mColumns + x]++] = n;
+        }
+    }
+
+    for (n = cellCount; n > 0; n--)
+        mCellStart[n] = mCellStart[n - 1];
+    mCellStart[0] = 0;
+
+    return true;
+}
+
+
+//! Destructor.
+PolygonGrid::~PolygonGrid()
+{
+    delete[] mBounds;
+    delete[] mCellStart;
+    delete[] mCellPolygons;
+    delete[] mQueryBits;
+    delete[] mMovedPolygons;
+    delete[] mMovedFlags;
+}
+
+
+//! Finds the polygons whose bounding box intersects the given rectangle.
+/*! \param aMinX the minimum x of the rectangle.
+ *  \param aMinY the minimum y of the rectangle.
+ *  \param aMaxX the maximum x of the rectangle.
+ *  \param aMaxY the maximum y of the rectangle.
+ *  \param aResult the array for the polygon indices. It has to be able to hold all
+ *         polygons of the grid.
+ *  \return the amount of polygons found. The indices are in ascending order.
+ */
+int PolygonGrid::query(RATIONAL aMinX, RATIONAL aMinY, RATIONAL aMaxX, RATIONAL aMaxY, int *aResult)
+{
+    int minColumn = getColumn(aMinX);
+    int maxColumn = getColumn(aMaxX);
+    int minRow = getRow(aMinY);
+    int maxRow = getRow(aMaxY);
+
+    // A polygon may be listed in several cells, so the hits are collected to a bit
+    // array first. This also sorts them to the original order.
+    int minWord = mPolygonCount;
+    int maxWord = -1;
+
+    int n;
+    int y;
+    for (y = minRow; y <= maxRow; y++)
+    {
+        int x;
+        for (x = minColumn; x <= maxColumn; x++)
+        {
+            int cell = y * mColumns + x;
+            for (n = mCellStart[cell]; n < mCellStart[cell + 1]; n++)
+            {
+                int polygon = mCellPolygons[n];
+                const RATIONAL *bounds = &mBounds[polygon * 4];
+                if (bounds[0] <= aMaxX && bounds[2] >= aMinX &&
+                    bounds[1] <= aMaxY && bounds[3] >= aMinY)
+                {
+                    int word = polygon >> 5;
+                    mQueryBits[word] |= (unsigned int)1 << (polygon & 31);
+                    if (word < minWord)
+                        minWord = word;
+                    if (word > maxWord)
+                        maxWord = word;
+                }
+            }
+        }
+    }
+
+    // The moved polygons may not be listed in the cells they overlap.
+    for (n = 0; n < mMovedCount; n++)
+    {
+        int polygon = mMovedPolygons[n];
+        const RATIONAL *bounds = &mBounds[polygon * 4];
+        if (bounds[0] <= aMaxX && bounds[2] >= aMinX &&
+            bounds[1] <= aMaxY && bounds[3] >= aMinY)
+        {
+            int word = polygon >> 5;
+            mQueryBits[word] |= (unsigned int)1 << (polygon & 31);
+            if (word < minWord)
+                minWord = word;
+            if (word > maxWord)
+                maxWord = word;
+        }
+    }
+
+    int count = 0;
+    int word;
+    for (word = minWord; word <= maxWord; word++)
+    {
+        unsigned int bits = mQueryBits[word];
+        if (bits)
+        {
+            int bit;
+            for (bit = 0; bit < 32; bit++)
+            {
+                if (bits & ((unsigned int)1 << bit))
+                    aResult[count++] = (word << 5) + bit;
+            }
+            mQueryBits[word] = 0;
+        }
+    }
+
+    return count;
+}
+
+
+//! Updates the bounding box of a polygon.
+/*! The cells are not rebuilt. Instead, the polygon is added to a list of moved
+ *  polygons that every query checks. The grid should be rebuilt when the list
+ *  gets long.
+ */
+void PolygonGrid::update(int aIndex, const RATIONAL *aBounds)
+{
+    MEMCPY(&mBounds[aIndex * 4],aBounds,4 * sizeof(RATIONAL));
+
+    if (!mMovedFlags[aIndex])
+    {
+        mMovedFlags[aIndex] = 1;
+        mMovedPolygons[mMovedCount++] = aIndex;
+    }
+}
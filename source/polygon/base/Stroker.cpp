@@ -0,0 +1,465 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ * 
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief A class for converting strokes to polygons.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+#include "polygon/base/Base.h"
+
+#define STROKER_PI 3.14159265358979323846
+
+
+//! Constructor.
+Stroker::Stroker()
+{
+    mPathVertices = NULL;
+    mPathVertexCapacity = 0;
+    mVertices = NULL;
+    mVertexCount = 0;
+    mVertexCapacity = 0;
+    mSubPolygonStarts = NULL;
+    mSubPolygonData = NULL;
+    mSubPolygonCounts = NULL;
+    mSubPolygonCount = 0;
+    mSubPolygonCapacity = 0;
+    mHalfWidth = INT_TO_RATIONAL(0);
+    mFlatness = INT_TO_RATIONAL(0);
+}
+
+
+//! Destructor.
+Stroker::~Stroker()
+{
+    delete[] mPathVertices;
+    delete[] mVertices;
+    delete[] mSubPolygonStarts;
+    delete[] mSubPolygonData;
+    delete[] mSubPolygonCounts;
+}
+
+
+//! Strokes a path to polygons.
+/*! The result is kept until the next call.
+ *  \param aPathData the path.
+ *  \param aStyle the style of the stroke.
+ *  \param aWidth the width of the stroke in the coordinates of the path.
+ *  \param aFlatness the maximum distance of the polygons from the curves and
+ *         the round joins and caps.
+ */
+bool Stroker::stroke(const PathData *aPathData, const StrokeStyle &aStyle, RATIONAL aWidth, RATIONAL aFlatness)
+{
+    mVertexCount = 0;
+    mSubPolygonCount = 0;
+    mHalfWidth = aWidth / INT_TO_RATIONAL(2);
+    mFlatness = aFlatness;
+    mStyle = aStyle;
+
+    if (mHalfWidth <= INT_TO_RATIONAL(0))
+        return true;
+
+    int subPathCount = aPathData->getSubPathCount();
+    int n;
+    for (n = 0; n < subPathCount; n++)
+    {
+        int count = aPathData->flatten(n,aFlatness,NULL);
+        if (count > mPathVertexCapacity)
+        {
+            delete[] mPathVertices;
+            mPathVertices = new RATIONAL[count * 2];
+            if (mPathVertices == NULL)
+            {
+                mPathVertexCapacity = 0;
+                return false;
+            }
+            mPathVertexCapacity = count;
+        }
+        count = aPathData->flatten(n,aFlatness,mPathVertices);
+
+        // Remove the zero length segments, as they don't have a direction.
+        int p;
+        int vertexCount = count > 0 ? 1 : 0;
+        for (p = 1; p < count; p++)
+        {
+            if (mPathVertices[p * 2] != mPathVertices[(vertexCount - 1) * 2] ||
+                mPathVertices[p * 2 + 1] != mPathVertices[(vertexCount - 1) * 2 + 1])
+            {
+                mPathVertices[vertexCount * 2] = mPathVertices[p * 2];
+                mPathVertices[vertexCount * 2 + 1] = mPathVertices[p * 2 + 1];
+                vertexCount++;
+            }
+        }
+
+        bool closed = aPathData->isClosed(n);
+        if (closed && vertexCount > 1 &&
+            mPathVertices[(vertexCount - 1) * 2] == mPathVertices[0] &&
+            mPathVertices[(vertexCount - 1) * 2 + 1] == mPathVertices[1])
+        {
+            vertexCount--;
+        }
+
+        if (!strokeSubPath(vertexCount,closed))
+            return false;
+    }
+
+    // The vertex buffer may have been reallocated, so the pointers to the
+    // sub-polygons are set up at the end.
+    for (n = 0; n < mSubPolygonCount; n++)
+        mSubPolygonData[n] = &mVertices[mSubPolygonStarts[n] * 2];
+
+    return true;
+}
+
+
+//! Strokes the flattened sub-path in mPathVertices.
+/*! \param aCount the amount of vertices.
+ *  \param aClosed true if the sub-path is closed.
+ */
+bool Stroker::strokeSubPath(int aCount, bool aClosed)
+{
+    if (aCount == 0)
+        return true;
+
+    if (aCount == 1)
+    {
+        // A sub-path without length is drawn as a dot if it has round or square caps.
+        RATIONAL x = mPathVertices[0];
+        RATIONAL y = mPathVertices[1];
+        if (mStyle.mHairline || mStyle.mCap == STROKE_CAP_BUTT)
+            return true;
+
+        if (!beginSubPolygon())
+            return false;
+
+        if (mStyle.mCap == STROKE_CAP_ROUND)
+        {
+            if (!addVertex(x + mHalfWidth,y) ||
+                !addArc(x,y,mHalfWidth,INT_TO_RATIONAL(0),2.0 * STROKER_PI))
+                return false;
+        }
+        else
+        {
+            if (!addVertex(x - mHalfWidth,y - mHalfWidth) ||
+                !addVertex(x + mHalfWidth,y - mHalfWidth) ||
+                !addVertex(x + mHalfWidth,y + mHalfWidth) ||
+                !addVertex(x - mHalfWidth,y + mHalfWidth))
+                return false;
+        }
+
+        endSubPolygon();
+        return true;
+    }
+
+    if (aClosed)
+    {
+        // Both sides are separate outlines.
+        if (!beginSubPolygon() ||
+            !addSide(aCount,0,1,true))
+            return false;
+        endSubPolygon();
+
+        if (!beginSubPolygon() ||
+            !addSide(aCount,aCount - 1,-1,true))
+            return false;
+        endSubPolygon();
+    }
+    else
+    {
+        // One outline along both sides and around the ends.
+        if (!beginSubPolygon() ||
+            !addSide(aCount,0,1,false) ||
+            !addSide(aCount,aCount - 1,-1,false))
+            return false;
+        endSubPolygon();
+    }
+
+    return true;
+}
+
+
+//! Adds the offset vertices of one side of the flattened sub-path.
+/*! The vertices are offset to the left of the direction of travel, so the other
+ *  side is added by travelling the sub-path backwards. For open sub-paths a cap
+ *  is added at the end of the side.
+ *  \param aCount the amount of vertices.
+ *  \param aFirst the index of the first vertex.
+ *  \param aStep the direction of travel, 1 or -1.
+ *  \param aClosed true if the sub-path is closed.
+ */
+bool Stroker::addSide(int aCount, int aFirst, int aStep, bool aClosed)
+{
+    RATIONAL dx0 = INT_TO_RATIONAL(0);
+    RATIONAL dy0 = INT_TO_RATIONAL(0);
+
+    if (aClosed)
+    {
+        // The direction of the segment that ends at the first vertex.
+        int previous = (aFirst - aStep + aCount) % aCount;
+        RATIONAL dx = mPathVertices[aFirst * 2] - mPathVertices[previous * 2];
+        RATIONAL dy = mPathVertices[aFirst * 2 + 1] - mPathVertices[previous * 2 + 1];
+        RATIONAL length = (RATIONAL)sqrt((double)(dx * dx + dy * dy));
+        dx0 = dx / length;
+        dy0 = dy / length;
+    }
+
+    int segmentCount = aClosed ? aCount : aCount - 1;
+    int index = aFirst;
+    int k;
+    for (k = 0; k < segmentCount; k++)
+    {
+        int next = index + aStep;
+        if (next < 0 || next >= aCount)
+            next = aFirst;
+
+        RATIONAL x = mPathVertices[index * 2];
+        RATIONAL y = mPathVertices[index * 2 + 1];
+        RATIONAL dx = mPathVertices[next * 2] - x;
+        RATIONAL dy = mPathVertices[next * 2 + 1] - y;
+        RATIONAL length = (RATIONAL)sqrt((double)(dx * dx + dy * dy));
+        dx /= length;
+        dy /= length;
+
+        if (k == 0 && !aClosed)
+        {
+            if (!addVertex(x - dy * mHalfWidth,y + dx * mHalfWidth))
+                return false;
+        }
+        else
+        {
+            if (!addJoin(x,y,dx0,dy0,dx,dy))
+                return false;
+        }
+
+        dx0 = dx;
+        dy0 = dy;
+        index = next;
+    }
+
+    if (!aClosed)
+    {
+        RATIONAL x = mPathVertices[index * 2];
+        RATIONAL y = mPathVertices[index * 2 + 1];
+        if (!addVertex(x - dy0 * mHalfWidth,y + dx0 * mHalfWidth) ||
+            !addCap(x,y,dx0,dy0))
+            return false;
+    }
+
+    return true;
+}
+
+
+//! Adds a join between two segments.
+/*! The normal on the left of a direction (dx,dy) is (-dy,dx).
+ *  \param aX the x coordinate of the vertex.
+ *  \param aY the y coordinate of the vertex.
+ *  \param aDX0 the x component of the unit direction of the incoming segment.
+ *  \param aDY0 the y component of the unit direction of the incoming segment.
+ *  \param aDX1 the x component of the unit direction of the outgoing segment.
+ *  \param aDY1 the y component of the unit direction of the outgoing segment.
+ */
+bool Stroker::addJoin(RATIONAL aX, RATIONAL aY, RATIONAL aDX0, RATIONAL aDY0, RATIONAL aDX1, RATIONAL aDY1)
+{
+    RATIONAL x0 = aX - aDY0 * mHalfWidth;
+    RATIONAL y0 = aY + aDX0 * mHalfWidth;
+    RATIONAL x1 = aX - aDY1 * mHalfWidth;
+    RATIONAL y1 = aY + aDX1 * mHalfWidth;
+
+    RATIONAL cross = aDX0 * aDY1 - aDY0 * aDX1;
+    RATIONAL dot = aDX0 * aDX1 + aDY0 * aDY1;
+
+    if (cross == INT_TO_RATIONAL(0) && dot > INT_TO_RATIONAL(0))
+    {
+        // No turn.
+        return addVertex(x1,y1);
+    }
+
+    if (mStyle.mHairline)
+        return addVertex(x0,y0) && addVertex(x1,y1);
+
+    if (cross > INT_TO_RATIONAL(0))
+    {
+        // The turn is to the left, so this is the inner side.
+        return addVertex(x0,y0) && addVertex(aX,aY) && addVertex(x1,y1);
+    }
+
+    if (mStyle.mJoin == STROKE_JOIN_MITER)
+    {
+        // The miter length relative to the width is 1 / cos(a / 2), where a is the
+        // angle between the normals, and cos(a / 2)^2 = (1 + cos(a)) / 2.
+        RATIONAL halfCos2 = (INT_TO_RATIONAL(1) + dot) / INT_TO_RATIONAL(2);
+        if (halfCos2 * mStyle.mMiterLimit * mStyle.mMiterLimit >= INT_TO_RATIONAL(1))
+        {
+            RATIONAL scale = mHalfWidth / (INT_TO_RATIONAL(1) + dot);
+            return addVertex(aX - (aDY0 + aDY1) * scale,aY + (aDX0 + aDX1) * scale);
+        }
+    }
+    else if (mStyle.mJoin == STROKE_JOIN_ROUND)
+    {
+        return addVertex(x0,y0) &&
+               addArc(aX,aY,x0 - aX,y0 - aY,atan2((double)cross,(double)dot)) &&
+               addVertex(x1,y1);
+    }
+
+    // Bevel.
+    return addVertex(x0,y0) && addVertex(x1,y1);
+}
+
+
+//! Adds a cap at the end of a side.
+/*! The side ends at the offset vertex on the left, and the other side starts
+ *  from the offset vertex on the right.
+ *  \param aX the x coordinate of the end point.
+ *  \param aY the y coordinate of the end point.
+ *  \param aDX the x component of the unit direction of the last segment.
+ *  \param aDY the y component of the unit direction of the last segment.
+ */
+bool Stroker::addCap(RATIONAL aX, RATIONAL aY, RATIONAL aDX, RATIONAL aDY)
+{
+    if (mStyle.mHairline || mStyle.mCap == STROKE_CAP_BUTT)
+        return true;
+
+    RATIONAL nx = -aDY * mHalfWidth;
+    RATIONAL ny = aDX * mHalfWidth;
+
+    if (mStyle.mCap == STROKE_CAP_ROUND)
+        return addArc(aX,aY,nx,ny,-STROKER_PI);
+
+    RATIONAL ex = aX + aDX * mHalfWidth;
+    RATIONAL ey = aY + aDY * mHalfWidth;
+    return addVertex(ex + nx,ey + ny) && addVertex(ex - nx,ey - ny);
+}
+
+
+//! Adds the vertices of an arc between its end points.
+/*! The end points are not added. The arc is split to the smallest amount of
+ *  segments that keeps the segments within the flatness from the arc.
+ *  \param aX the x coordinate of the center.
+ *  \param aY the y coordinate of the center.
+ *  \param aVX the x component of the vector from the center to the start point.
+ *  \param aVY the y component of the vector from the center to the start point.
+ *  \param aAngle the angle of the arc in radians.
+ */
+bool Stroker::addArc(RATIONAL aX, RATIONAL aY, RATIONAL aVX, RATIONAL aVY, double aAngle)
+{
+    // A segment of angle a stays within r(1 - cos(a / 2)) from the arc.
+    double ratio = (double)(mFlatness / mHalfWidth);
+    double maxStep = STROKER_PI / 2.0;
+    if (ratio < 1.0 - cos(maxStep / 2.0))
+        maxStep = 2.0 * acos(1.0 - ratio);
+
+    int steps = (int)ceil(fabs(aAngle) / maxStep);
+    if (steps > STROKER_MAX_ARC_STEPS)
+        steps = STROKER_MAX_ARC_STEPS;
+
+    RATIONAL c = (RATIONAL)cos(aAngle / steps);
+    RATIONAL s = (RATIONAL)sin(aAngle / steps);
+    RATIONAL vx = aVX;
+    RATIONAL vy = aVY;
+    int n;
+    for (n = 1; n < steps; n++)
+    {
+        RATIONAL x = vx * c - vy * s;
+        vy = vx * s + vy * c;
+        vx = x;
+        if (!addVertex(aX + vx,aY + vy))
+            return false;
+    }
+
+    return true;
+}
+
+
+//! Begins a new sub-polygon.
+bool Stroker::beginSubPolygon()
+{
+    if (mSubPolygonCount == mSubPolygonCapacity)
+    {
+        int capacity = mSubPolygonCapacity + 0x10;
+        int *starts = new int[capacity];
+        RATIONAL **data = new RATIONAL*[capacity];
+        int *counts = new int[capacity];
+        if (starts == NULL || data == NULL || counts == NULL)
+        {
+            delete[] starts;
+            delete[] data;
+            delete[] counts;
+            return false;
+        }
+
+        int n;
+        for (n = 0; n < mSubPolygonCount; n++)
+        {
+            starts[n] = mSubPolygonStarts[n];
+            counts[n] = mSubPolygonCounts[n];
+        }
+
+        delete[] mSubPolygonStarts;
+        delete[] mSubPolygonData;
+        delete[] mSubPolygonCounts;
+        mSubPolygonStarts = starts;
+        mSubPolygonData = data;
+        mSubPolygonCounts = counts;
+        mSubPolygonCapacity = capacity;
+    }
+
+    mSubPolygonStarts[mSubPolygonCount] = mVertexCount;
+    mSubPolygonCounts[mSubPolygonCount] = 0;
+    mSubPolygonData[mSubPolygonCount] = NULL;
+    mSubPolygonCount++;
+
+    return true;
+}
+
+
+//! Ends the sub-polygon.
+/*! Sub-polygons with less than three vertices don't cover anything, so they are
+ *  dropped.
+ */
+void Stroker::endSubPolygon()
+{
+    int index = mSubPolygonCount - 1;
+    mSubPolygonCounts[index] = mVertexCount - mSubPolygonStarts[index];
+    if (mSubPolygonCounts[index] < 3)
+    {
+        mVertexCount = mSubPolygonStarts[index];
+        mSubPolygonCount--;
+    }
+}
+
+
+//! Adds a vertex to the current sub-polygon.
+bool Stroker::addVertex(RATIONAL aX, RATIONAL aY)
+{
+    if (mVertexCount == mVertexCapacity)
+    {
+        int capacity = mVertexCapacity * 2 + 0x100;
+        RATIONAL *vertices = new RATIONAL[capacity * 2];
+        if (vertices == NULL)
+            return false;
+
+        int n;
+        for (n = 0; n < mVertexCount * 2; n++)
+            vertices[n] = mVertices[n];
+
+        delete[] mVertices;
+        mVertices = vertices;
+        mVertexCapacity = capacity;
+    }
+
+    mVertices[mVertexCount * 2] = aX;
+    mVertices[mVertexCount * 2 + 1] = aY;
+    mVertexCount++;
+
+    return true;
+}
@@ -22,7 +22,18 @@
 VectorGraphic::VectorGraphic(PolygonWrapper **aPolygons, PaintWrapper **aColors, RENDERER_FILLMODE *aFillModes, int aPolygonCount) :
     mPolygons(aPolygons), mColors(aColors), mFillModes(aFillModes), mPolygonCount(aPolygonCount)
 {
-  
+    mGrid = NULL;
+    mVisiblePolygons = NULL;
+    mBounds = NULL;
+    mDamaged = false;
+    mFullDamage = false;
+
+    mDefaultLayerStarts[0] = 0;
+    mDefaultLayerStarts[1] = aPolygonCount;
+    mDefaultLayerVersion = 0;
+    mLayerStarts = mDefaultLayerStarts;
+    mLayerVersions = &mDefaultLayerVersion;
+    mLayerCount = 1;
 }
 
 
@@ -38,6 +49,15 @@ VectorGraphic::~VectorGraphic()
     delete[] mPolygons;
     delete[] mColors;
     delete[] mFillModes;
+    delete mGrid;
+    delete[] mVisiblePolygons;
+    delete[] mBounds;
+
+    if (mLayerStarts != mDefaultLayerStarts)
+    {
+        delete[] mLayerStarts;
+        delete[] mLayerVersions;
+    }
 }
 
 
@@ -58,7 +78,440 @@ void VectorGraphic::render(Renderer *aRenderer, RenderTargetWrapper *aTarget, co
 }
 
 
+//! Renders the polygons of the vector graphic that intersect a viewport.
+/*! Only the polygons whose bounding box intersects the viewport are passed to
+ *  the renderer, in the original order. The spatial index is used for finding
+ *  them if the graphic has one. Note that the polygons are not clipped to the
+ *  viewport.
+ *  /param aRenderer the class to use for rendering.
+ *  /param aTarget the render target.
+ *  /param aTransformation the transformation to use in the rendering.
+ *  /param aViewport the area of the target to render, in pixels.
+ */
+void VectorGraphic::render(Renderer *aRenderer, RenderTargetWrapper *aTarget, const MATRIX2D &aTransformation,
+                           const ClipRectangle &aViewport)
+{
+    RATIONAL det = MATRIX2D_GET_M11(aTransformation) * MATRIX2D_GET_M22(aTransformation) -
+                   MATRIX2D_GET_M12(aTransformation) * MATRIX2D_GET_M21(aTransformation);
+
+    if (mBounds == NULL || det == INT_TO_RATIONAL(0))
+    {
+        render(aRenderer,aTarget,aTransformation);
+        return;
+    }
+
+    // Transform the corners of the viewport to the object space with the inverse
+    // transformation and take the bounding box of the result.
+    RATIONAL corners[4][2] = {
+        { (RATIONAL)aViewport.getMinXi(), (RATIONAL)aViewport.getMinYi() },
+        { (RATIONAL)aViewport.getMaxXi(), (RATIONAL)aViewport.getMinYi() },
+        { (RATIONAL)aViewport.getMaxXi(), (RATIONAL)aViewport.getMaxYi() },
+        { (RATIONAL)aViewport.getMinXi(), (RATIONAL)aViewport.getMaxYi() }
+    };
+
+    RATIONAL minX = INT_TO_RATIONAL(0), minY = INT_TO_RATIONAL(0);
+    RATIONAL maxX = INT_TO_RATIONAL(0), maxY = INT_TO_RATIONAL(0);
+
+    int n;
+    for (n = 0; n < 4; n++)
+    {
+        RATIONAL u = corners[n][0] - MATRIX2D_GET_DX(aTransformation);
+        RATIONAL v = corners[n][1] - MATRIX2D_GET_DY(aTransformation);
+        RATIONAL x = (u * MATRIX2D_GET_M22(aTransformation) - v * MATRIX2D_GET_M21(aTransformation)) / det;
+        RATIONAL y = (v * MATRIX2D_GET_M11(aTransformation) - u * MATRIX2D_GET_M12(aTransformation)) / det;
+
+        if (n == 0 || x < minX)
+            minX = x;
+        if (n == 0 || x > maxX)
+            maxX = x;
+        if (n == 0 || y < minY)
+            minY = y;
+        if (n == 0 || y > maxY)
+            maxY = y;
+    }
+
+    int count = findPolygons(minX,minY,maxX,maxY);
+    for (n = 0; n < count; n++)
+    {
+        int index = mVisiblePolygons[n];
+        aRenderer->render(aTarget,mPolygons[index],mColors[index],mFillModes[index],aTransformation);
+    }
+
+    aTarget->onRenderDone();
+}
+
+
+//! Renders the vector graphic with given renderer as a single scene.
+/*! All polygons are passed to the renderer at once, so that the renderer can
+ *  composite them in a single pass over the target. Returns false if the
+ *  renderer fails.
+ *  /param aRenderer the class to use for rendering.
+ *  /param aTarget the render target.
+ *  /param aTransformation the transformation to use in the rendering.
+ */
+bool VectorGraphic::renderScene(Renderer *aRenderer, RenderTargetWrapper *aTarget, const MATRIX2D &aTransformation)
+{
+    bool success = aRenderer->renderScene(aTarget,mPolygons,mColors,mFillModes,mPolygonCount,aTransformation);
+
+    aTarget->onRenderDone();
+
+    return success;
+}
+
+
+//! Replaces the polygon at given index.
+/*! The area covered by the old and the new polygon is added to the damaged area.
+ *  /param aIndex the index of the polygon.
+ *  /param aData the new polygon data.
+ *  /param aFactory the factory for creating the polygon.
+ */
+bool VectorGraphic::setPolygon(int aIndex, const PolygonData *aData, PolygonFactory *aFactory)
+{
+    PolygonWrapper *polygon = aFactory->createPolygonWrapper(aData);
+    if (polygon == NULL)
+        return false;
+
+    addDamage(aIndex);
+    mLayerVersions[getLayer(aIndex)]++;
+
+    delete mPolygons[aIndex];
+    mPolygons[aIndex] = polygon;
+
+    if (mBounds)
+    {
+        aData->getBounds(&mBounds[aIndex * 4]);
+        addDamage(aIndex);
+
+        if (mGrid)
+        {
+            mGrid->update(aIndex,&mBounds[aIndex * 4]);
+
+            // Rebuild the grid when too many polygons have moved, as the queries
+            // check all of them.
+            if (mGrid->getMovedCount() > (mPolygonCount >> VECTOR_GRAPHIC_GRID_REBUILD_SHIFT))
+            {
+                delete mGrid;
+                mGrid = NULL;
+                initGrid();
+            }
+        }
+    }
+
+    return true;
+}
+
+
+//! Replaces the color of the polygon at given index.
+/*! The area covered by the polygon is added to the damaged area.
+ *  /param aIndex the index of the polygon.
+ *  /param aColor the new color.
+ *  /param aFactory the factory for creating the paint.
+ */
+bool VectorGraphic::setColor(int aIndex, unsigned long aColor, PolygonFactory *aFactory)
+{
+    PaintWrapper *color = aFactory->createPaintWrapper(aColor);
+    if (color == NULL)
+        return false;
+
+    delete mColors[aIndex];
+    mColors[aIndex] = color;
+
+    addDamage(aIndex);
+    mLayerVersions[getLayer(aIndex)]++;
+
+    return true;
+}
+
+
+//! Re-renders the damaged area of the vector graphic.
+/*! The damaged area is transformed to the target, the rendering is limited to it
+ *  with the damage rectangle of the renderer, the area is cleared with the background
+ *  color and only the polygons that intersect it are rendered. The limit is removed
+ *  with aClip afterwards. The target is expected to hold the result of an earlier rendering
+ *  with the same transformation.
+ *  /param aRenderer the class to use for rendering.
+ *  /param aTarget the render target.
+ *  /param aTransformation the transformation to use in the rendering.
+ *  /param aClip the normal clip rectangle of the rendering, in pixels.
+ *  /param aBackgroundColor the color for clearing the damaged area.
+ *  /param aFactory the factory for creating the background polygon.
+ */
+void VectorGraphic::renderChanges(Renderer *aRenderer, RenderTargetWrapper *aTarget, const MATRIX2D &aTransformation,
+                                  const ClipRectangle &aClip, unsigned long aBackgroundColor, PolygonFactory *aFactory)
+{
+    if (!mDamaged)
+        return;
+
+    int n;
+    ClipRectangle damage;
+    if (mFullDamage)
+        damage = aClip;
+    else
+    {
+        // Transform the damaged area to the target. The area is grown by one pixel
+        // for the antialiased pixels on the border.
+        RATIONAL corners[4][2] = {
+            { mDamage[0], mDamage[1] },
+            { mDamage[2], mDamage[1] },
+            { mDamage[2], mDamage[3] },
+            { mDamage[0], mDamage[3] }
+        };
+
+        RATIONAL minX = INT_TO_RATIONAL(0), minY = INT_TO_RATIONAL(0);
+        RATIONAL maxX = INT_TO_RATIONAL(0), maxY = INT_TO_RATIONAL(0);
+
+        for (n = 0; n < 4; n++)
+        {
+            VECTOR2D corner(corners[n][0],corners[n][1]);
+            VECTOR2D position;
+            MATRIX2D_TRANSFORM(aTransformation,corner,position);
+
+            if (n == 0 || VECTOR2D_GETX(position) < minX)
+                minX = VECTOR2D_GETX(position);
+            if (n == 0 || VECTOR2D_GETX(position) > maxX)
+                maxX = VECTOR2D_GETX(position);
+            if (n == 0 || VECTOR2D_GETY(position) < minY)
+                minY = VECTOR2D_GETY(position);
+            if (n == 0 || VECTOR2D_GETY(position) > maxY)
+                maxY = VECTOR2D_GETY(position);
+        }
+
+        damage.setClip((int)floor(minX) - 1,(int)floor(minY) - 1,
+                       (int)ceil(maxX) - (int)floor(minX) + 3,(int)ceil(maxY) - (int)floor(minY) + 3,1);
+        damage.intersect(aClip);
+    }
+
+    mDamaged = false;
+    mFullDamage = false;
+
+    if (damage.getMinXi() >= damage.getMaxXi() || damage.getMinYi() >= damage.getMaxYi())
+        return;
+
+    // Clear the damaged area with a pixel aligned rectangle, so that the polygons
+    // can be blended on it again.
+    RATIONAL rectangle[8] = {
+        INT_TO_RATIONAL(damage.getMinXi()), INT_TO_RATIONAL(damage.getMinYi()),
+        INT_TO_RATIONAL(damage.getMaxXi()), INT_TO_RATIONAL(damage.getMinYi()),
+        INT_TO_RATIONAL(damage.getMaxXi()), INT_TO_RATIONAL(damage.getMaxYi()),
+        INT_TO_RATIONAL(damage.getMinXi()), INT_TO_RATIONAL(damage.getMaxYi())
+    };
+    const RATIONAL *rectangleData = rectangle;
+    int rectangleCount = 4;
+    PolygonData rectanglePolygon(&rectangleData,&rectangleCount,1);
+
+    PolygonWrapper *background = aFactory->createPolygonWrapper(&rectanglePolygon);
+    PaintWrapper *backgroundColor = aFactory->createPaintWrapper(aBackgroundColor);
+    if (background == NULL || backgroundColor == NULL)
+    {
+        delete background;
+        delete backgroundColor;
+        return;
+    }
+
+    aRenderer->setDamageRect(damage.getMinXi(),damage.getMinYi(),
+                             damage.getMaxXi() - damage.getMinXi(),damage.getMaxYi() - damage.getMinYi());
+
+    aRenderer->clearDamageRect(aTarget,background,backgroundColor);
+
+    delete background;
+    delete backgroundColor;
+
+    // The polygons are searched with the damaged area in pixels, as the polygons
+    // around the changed ones cover parts of it as well.
+    render(aRenderer,aTarget,aTransformation,damage);
+
+    aRenderer->setDamageRect(aClip.getMinXi(),aClip.getMinYi(),
+                             aClip.getMaxXi() - aClip.getMinXi(),aClip.getMaxYi() - aClip.getMinYi());
+}
+
+
+//! Renders a range of layers of the vector graphic.
+/*! The target is not notified with onRenderDone(), so that several ranges can
+ *  be rendered to the same target.
+ *  /param aRenderer the class to use for rendering.
+ *  /param aTarget the render target.
+ *  /param aTransformation the transformation to use in the rendering.
+ *  /param aFirstLayer the first layer to render.
+ *  /param aLastLayer the last layer to render.
+ */
+void VectorGraphic::renderLayers(Renderer *aRenderer, RenderTargetWrapper *aTarget, const MATRIX2D &aTransformation,
+                                 int aFirstLayer, int aLastLayer)
+{
+    int last = mLayerStarts[aLastLayer + 1];
+    int n;
+    for (n = mLayerStarts[aFirstLayer]; n < last; n++)
+    {
+        aRenderer->render(aTarget,mPolygons[n],mColors[n],mFillModes[n],aTransformation);
+    }
+}
+
+
+//! Divides the polygons to layers.
+/*! Each layer is a range of consecutive polygons. Layers without polygons are
+ *  dropped.
+ *  /param aLayerStarts the index of the first polygon of each layer in ascending order.
+ *  /param aLayerCount the amount of layers.
+ */
+bool VectorGraphic::setLayers(const int *aLayerStarts, int aLayerCount)
+{
+    int *layerStarts = new int[aLayerCount + 2];
+    unsigned int *layerVersions = new unsigned int[aLayerCount + 1];
+    if (layerStarts == NULL || layerVersions == NULL)
+    {
+        delete[] layerStarts;
+        delete[] layerVersions;
+        return false;
+    }
+
+    // The first layer always starts from the first polygon.
+    int layerCount = 1;
+    layerStarts[0] = 0;
+
+    int n;
+    for (n = 0; n < aLayerCount; n++)
+    {
+        if (aLayerStarts[n] > layerStarts[layerCount - 1] && aLayerStarts[n] < mPolygonCount)
+            layerStarts[layerCount++] = aLayerStarts[n];
+    }
+    layerStarts[layerCount] = mPolygonCount;
+
+    for (n = 0; n < layerCount; n++)
+        layerVersions[n] = 0;
+
+    if (mLayerStarts != mDefaultLayerStarts)
+    {
+        delete[] mLayerStarts;
+        delete[] mLayerVersions;
+    }
+
+    mLayerStarts = layerStarts;
+    mLayerVersions = layerVersions;
+    mLayerCount = layerCount;
+
+    return true;
+}
+
+
+//! Stores the bounding boxes of the polygons.
+/*! The bounding boxes are used for the viewport and damage queries. A spatial
+ *  index is built for graphics with at least VECTOR_GRAPHIC_GRID_MIN_POLYGONS
+ *  polygons.
+ *  /param aPolygons the data the polygons of the graphic were created from.
+ */
+bool VectorGraphic::initBounds(const PolygonData * const *aPolygons)
+{
+    mVisiblePolygons = new int[mPolygonCount];
+    mBounds = new RATIONAL[mPolygonCount * 4];
+    if (mVisiblePolygons == NULL || mBounds == NULL)
+    {
+        delete[] mVisiblePolygons;
+        mVisiblePolygons = NULL;
+        delete[] mBounds;
+        mBounds = NULL;
+        return false;
+    }
+
+    int n;
+    for (n = 0; n < mPolygonCount; n++)
+        aPolygons[n]->getBounds(&mBounds[n * 4]);
+
+    // The spatial index only speeds up the queries, so failing to build it is not
+    // an error.
+    if (mPolygonCount >= VECTOR_GRAPHIC_GRID_MIN_POLYGONS)
+        initGrid();
+
+    return true;
+}
+
+
+//! Builds a spatial index for the polygons from the bounding boxes.
+bool VectorGraphic::initGrid()
+{
+    mGrid = new PolygonGrid();
+    if (mGrid == NULL || !mGrid->init(mBounds,mPolygonCount))
+    {
+        delete mGrid;
+        mGrid = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+
+//! Finds the polygons whose bounding box intersects a rectangle in object space.
+/*! The result is stored to mVisiblePolygons in the original order.
+ *  \return the amount of polygons found.
+ */
+int VectorGraphic::findPolygons(RATIONAL aMinX, RATIONAL aMinY, RATIONAL aMaxX, RATIONAL aMaxY)
+{
+    if (mGrid)
+        return mGrid->query(aMinX,aMinY,aMaxX,aMaxY,mVisiblePolygons);
+
+    int count = 0;
+    int n;
+    for (n = 0; n < mPolygonCount; n++)
+    {
+        const RATIONAL *bounds = &mBounds[n * 4];
+        if (bounds[0] <= aMaxX && bounds[2] >= aMinX &&
+            bounds[1] <= aMaxY && bounds[3] >= aMinY)
+            mVisiblePolygons[count++] = n;
+    }
+
+    return count;
+}
+
+
+//! Adds the bounding box of a polygon to the damaged area.
+void VectorGraphic::addDamage(int aIndex)
+{
+    if (mBounds == NULL)
+    {
+        mDamaged = true;
+        mFullDamage = true;
+        return;
+    }
+
+    const RATIONAL *bounds = &mBounds[aIndex * 4];
+    if (!mDamaged)
+    {
+        MEMCPY(mDamage,bounds,4 * sizeof(RATIONAL));
+        mDamaged = true;
+        return;
+    }
+
+    if (bounds[0] < mDamage[0])
+        mDamage[0] = bounds[0];
+    if (bounds[1] < mDamage[1])
+        mDamage[1] = bounds[1];
+    if (bounds[2] > mDamage[2])
+        mDamage[2] = bounds[2];
+    if (bounds[3] > mDamage[3])
+        mDamage[3] = bounds[3];
+}
+
+
+//! Returns the layer of the polygon at given index.
+int VectorGraphic::getLayer(int aIndex) const
+{
+    int first = 0;
+    int last = mLayerCount - 1;
+    while (first < last)
+    {
+        int middle = (first + last + 1) >> 1;
+        if (mLayerStarts[middle] <= aIndex)
+            first = middle;
+        else
+            last = middle - 1;
+    }
+
+    return first;
+}
+
+
 //! Static method for creating the vector graphic from data.
+/*! The bounding boxes of the polygons are stored with initBounds().
+ */
 VectorGraphic * VectorGraphic::create(const PolygonData * const *aPolygons, const unsigned long *aColors,
                                       const RENDERER_FILLMODE *aFillModes, int aPolygonCount, PolygonFactory *aFactory)
 {
@@ -113,5 +566,9 @@ VectorGraphic * VectorGraphic::create(const PolygonData * const *aPolygons, cons
         return NULL;
     }
 
+    // The bounding boxes and the spatial index are optional, so the graphic is
+    // usable even if their allocation fails.
+    vg->initBounds(aPolygons);
+
     return vg;
 }
@@ -0,0 +1,241 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ *
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief A clip region made of several rectangles.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+#include "polygon/base/Base.h"
+#include "polygon/implementation/Implementation.h"
+
+
+//! Constructor.
+ClipRegion::ClipRegion()
+{
+    mRectangles = NULL;
+    mRectangleCount = 0;
+    mRectangleCapacity = 0;
+    mBands = NULL;
+    mBandCount = 0;
+    mSpans = NULL;
+    mSpanCount = 0;
+    mMinX = 0;
+    mMinY = 0;
+    mMaxX = -1;
+    mMaxY = -1;
+}
+
+
+//! Destructor.
+ClipRegion::~ClipRegion()
+{
+    delete[] mRectangles;
+    delete[] mBands;
+    delete[] mSpans;
+}
+
+
+//! Removes all rectangles from the region.
+void ClipRegion::reset()
+{
+    mRectangleCount = 0;
+    mBandCount = 0;
+    mSpanCount = 0;
+    mMinX = 0;
+    mMinY = 0;
+    mMaxX = -1;
+    mMaxY = -1;
+}
+
+
+//! Adds a rectangle to the region.
+/*! \param aX the left edge of the rectangle in pixels.
+ *  \param aY the top edge of the rectangle in pixels.
+ *  \param aWidth the width of the rectangle in pixels.
+ *  \param aHeight the height of the rectangle in pixels.
+ */
+bool ClipRegion::addRectangle(int aX, int aY, int aWidth, int aHeight)
+{
+    if (aWidth <= 0 || aHeight <= 0)
+        return true;
+
+    if (mRectangleCount >= mRectangleCapacity)
+    {
+        // The resizing rule is 1.5 * size + 1
+        int newCapacity = mRectangleCapacity + mRectangleCapacity / 2 + 1;
+        int *newRectangles = new int[newCapacity * 4];
+        if (newRectangles == NULL)
+            return false;
+
+        if (mRectangles)
+            MEMCPY(newRectangles,mRectangles,sizeof(int)*4*mRectangleCount);
+
+        delete[] mRectangles;
+        mRectangles = newRectangles;
+        mRectangleCapacity = newCapacity;
+    }
+
+    int *rectangle = &mRectangles[mRectangleCount * 4];
+    rectangle[0] = aX;
+    rectangle[1] = aY;
+    rectangle[2] = aX + aWidth - 1;
+    rectangle[3] = aY + aHeight - 1;
+    mRectangleCount++;
+
+    if (!updateBands())
+    {
+        mRectangleCount--;
+        return false;
+    }
+
+    return true;
+}
+
+
+//! Builds the bands from the rectangles.
+/*! The region is expected to have only a few rectangles, so the bands are simply
+ *  rebuilt from all of them.
+ */
+bool ClipRegion::updateBands()
+{
+    // Each rectangle adds at most two band edges, and each band has at most one
+    // interval per rectangle.
+    int edgeCount = mRectangleCount * 2;
+    int *edges = new int[edgeCount];
+    ClipRegionBand *bands = new ClipRegionBand[edgeCount];
+    ClipRegionSpan *spans = new ClipRegionSpan[edgeCount * mRectangleCount];
+    if (edges == NULL || bands == NULL || spans == NULL)
+    {
+        delete[] edges;
+        delete[] bands;
+        delete[] spans;
+        return false;
+    }
+
+    // Sort the top edges and the scanlines after the bottom edges.
+    int n, k;
+    for (n = 0; n < mRectangleCount; n++)
+    {
+        edges[n * 2] = mRectangles[n * 4 + 1];
+        edges[n * 2 + 1] = mRectangles[n * 4 + 3] + 1;
+    }
+    for (n = 1; n < edgeCount; n++)
+    {
+        int edge = edges[n];
+        for (k = n; k > 0 && edges[k - 1] > edge; k--)
+            edges[k] = edges[k - 1];
+        edges[k] = edge;
+    }
+
+    int bandCount = 0;
+    int spanCount = 0;
+
+    for (n = 0; n + 1 < edgeCount; n++)
+    {
+        int minY = edges[n];
+        int maxY = edges[n + 1] - 1;
+        if (minY > maxY)
+            continue;
+
+        // Collect the intervals of the rectangles covering the band sorted by the
+        // left edge.
+        ClipRegionSpan *bandSpans = &spans[spanCount];
+        int count = 0;
+        int r;
+        for (r = 0; r < mRectangleCount; r++)
+        {
+            const int *rectangle = &mRectangles[r * 4];
+            if (rectangle[1] > minY || rectangle[3] < maxY)
+                continue;
+
+            for (k = count; k > 0 && bandSpans[k - 1].mMinX > rectangle[0]; k--)
+                bandSpans[k] = bandSpans[k - 1];
+            bandSpans[k].mMinX = rectangle[0];
+            bandSpans[k].mMaxX = rectangle[2];
+            count++;
+        }
+
+        // Merge the overlapping and adjacent intervals.
+        int merged = 0;
+        for (k = 0; k < count; k++)
+        {
+            if (merged > 0 && bandSpans[k].mMinX <= bandSpans[merged - 1].mMaxX + 1)
+            {
+                if (bandSpans[k].mMaxX > bandSpans[merged - 1].mMaxX)
+                    bandSpans[merged - 1].mMaxX = bandSpans[k].mMaxX;
+            }
+            else
+                bandSpans[merged++] = bandSpans[k];
+        }
+
+        if (merged == 0)
+            continue;
+
+        // Extend the previous band if it is adjacent and has the same intervals.
+        if (bandCount > 0)
+        {
+            ClipRegionBand &prevBand = bands[bandCount - 1];
+            if (prevBand.mMaxY + 1 == minY && prevBand.mSpanCount == merged)
+            {
+                const ClipRegionSpan *prevSpans = &spans[prevBand.mFirstSpan];
+                for (k = 0; k < merged; k++)
+                {
+                    if (prevSpans[k].mMinX != bandSpans[k].mMinX ||
+                        prevSpans[k].mMaxX != bandSpans[k].mMaxX)
+                        break;
+                }
+                if (k == merged)
+                {
+                    prevBand.mMaxY = maxY;
+                    continue;
+                }
+            }
+        }
+
+        ClipRegionBand &band = bands[bandCount++];
+        band.mMinY = minY;
+        band.mMaxY = maxY;
+        band.mFirstSpan = spanCount;
+        band.mSpanCount = merged;
+        spanCount += merged;
+    }
+
+    delete[] edges;
+    delete[] mBands;
+    delete[] mSpans;
+    mBands = bands;
+    mBandCount = bandCount;
+    mSpans = spans;
+    mSpanCount = spanCount;
+
+    // Update the bounds.
+    mMinX = 0;
+    mMinY = 0;
+    mMaxX = -1;
+    mMaxY = -1;
+    for (n = 0; n < mRectangleCount; n++)
+    {
+        const int *rectangle = &mRectangles[n * 4];
+        if (n == 0 || rectangle[0] < mMinX)
+            mMinX = rectangle[0];
+        if (n == 0 || rectangle[1] < mMinY)
+            mMinY = rectangle[1];
+        if (n == 0 || rectangle[2] > mMaxX)
+            mMaxX = rectangle[2];
+        if (n == 0 || rectangle[3] > mMaxY)
+            mMaxY = rectangle[3];
+    }
+
+    return true;
+}
@@ -0,0 +1,72 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ *
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief Lookup tables for gamma correct blending of the antialiased pixels.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+#include "polygon/base/Base.h"
+#include "polygon/implementation/Implementation.h"
+
+
+//! Constructor.
+GammaTable::GammaTable()
+{
+    int n;
+    for (n = 0; n < 256; n++)
+    {
+        double c = (double)n / 255.0;
+        double l;
+        if (c <= 0.04045)
+            l = c / 12.92;
+        else
+            l = pow((c + 0.055) / 1.055, 2.4);
+        mToLinear[n] = (unsigned short)(l * (double)GAMMA_LINEAR_MAX + 0.5);
+    }
+
+    for (n = 0; n <= GAMMA_LINEAR_MAX; n++)
+    {
+        double l = (double)n / (double)GAMMA_LINEAR_MAX;
+        double c;
+        if (l <= 0.0031308)
+            c = l * 12.92;
+        else
+            c = 1.055 * pow(l, 1.0 / 2.4) - 0.055;
+        mToSRGB[n] = (unsigned char)(c * 255.0 + 0.5);
+    }
+
+    // Make sure that the conversion back and forth doesn't modify the values
+    // that have a unique linear representation.
+    for (n = 0; n < 256; n++)
+        mToSRGB[mToLinear[n]] = (unsigned char)n;
+}
+
+
+//! Calculates the source terms of a color for all coverage levels.
+void GammaTable::initColorTable(GammaColorTable &aTable, unsigned long aColor)
+{
+    unsigned long rb = ((unsigned long)mToLinear[(aColor >> 16) & 0xff] << 16) |
+                       (unsigned long)mToLinear[aColor & 0xff];
+    unsigned long g = mToLinear[(aColor >> 8) & 0xff];
+
+    unsigned long n;
+    for (n = 0; n <= SUBPIXEL_COUNT; n++)
+    {
+        aTable.mSourceRB[n] = rb * n;
+        aTable.mSourceG[n] = g * n;
+    }
+
+    aTable.mColor = aColor;
+    aTable.mValid = true;
+}
@@ -0,0 +1,179 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ *
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief A cache for the rendering of the unchanged layers of a vector graphic.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+#include "polygon/base/Base.h"
+#include "polygon/implementation/Implementation.h"
+
+
+//! Constructor.
+LayerCache::LayerCache()
+{
+    mData = NULL;
+    mDataSize = 0;
+    mGraphic = NULL;
+    mWidth = 0;
+    mHeight = 0;
+    mPitch = 0;
+    mFormat = BitmapData::BITMAP_FORMAT_XRGB;
+    mTransformations = NULL;
+    mVersions = NULL;
+    mLayerCount = 0;
+    mLayerCapacity = 0;
+    mCachedLayerCount = 0;
+}
+
+
+//! Destructor.
+LayerCache::~LayerCache()
+{
+    delete[] mData;
+    delete[] mTransformations;
+    delete[] mVersions;
+}
+
+
+//! Renders the layers of a vector graphic, reusing the cached layers.
+/*! The target has to be cleared before the call, as the layers are rendered
+ *  on it when the cache is not valid.
+ *  \param aGraphic the vector graphic.
+ *  \param aRenderer the renderer.
+ *  \param aTarget the render target.
+ *  \param aTransformations the transformation of each layer.
+ */
+bool LayerCache::render(VectorGraphic *aGraphic, Renderer *aRenderer, BitmapData *aTarget, const MATRIX2D *aTransformations)
+{
+    int layerCount = aGraphic->getLayerCount();
+
+    if (aGraphic != mGraphic || layerCount != mLayerCount ||
+        aTarget->mWidth != mWidth || aTarget->mHeight != mHeight ||
+        aTarget->mPitch != mPitch || aTarget->mFormat != mFormat)
+    {
+        invalidate();
+        if (!resizeLayers(layerCount))
+            return false;
+
+        mGraphic = aGraphic;
+        mWidth = aTarget->mWidth;
+        mHeight = aTarget->mHeight;
+        mPitch = aTarget->mPitch;
+        mFormat = aTarget->mFormat;
+    }
+
+    // Find the layers from the bottom that are unchanged since the previous frame.
+    // The state of the layers is stored for the next frame at the same time.
+    int unchangedCount = 0;
+    bool unchanged = mLayerCount == layerCount;
+    int n;
+    for (n = 0; n < layerCount; n++)
+    {
+        unsigned int version = aGraphic->getLayerVersion(n);
+        if (unchanged &&
+            mVersions[n] == version &&
+            isEqual(mTransformations[n],aTransformations[n]))
+            unchangedCount++;
+        else
+            unchanged = false;
+
+        mTransformations[n] = aTransformations[n];
+        mVersions[n] = version;
+    }
+    mLayerCount = layerCount;
+
+    // The cache is usable if all layers in it are unchanged.
+    int firstLayer = 0;
+    if (mCachedLayerCount > 0 && mCachedLayerCount <= unchangedCount)
+    {
+        MEMCPY(aTarget->mData,mData,mDataSize);
+        firstLayer = mCachedLayerCount;
+    }
+    else
+        mCachedLayerCount = 0;
+
+    for (n = firstLayer; n < layerCount; n++)
+    {
+        aGraphic->renderLayers(aRenderer,aTarget,aTransformations[n],n,n);
+
+        // Store the target once all unchanged layers are in it. If there is no
+        // memory for the copy, the layers are just rendered every frame.
+        if (n + 1 == unchangedCount && unchangedCount > mCachedLayerCount)
+        {
+            unsigned int dataSize = mPitch * mHeight;
+            if (dataSize != mDataSize)
+            {
+                delete[] mData;
+                mData = new unsigned char[dataSize];
+                mDataSize = mData ? dataSize : 0;
+            }
+
+            if (mData)
+            {
+                MEMCPY(mData,aTarget->mData,mDataSize);
+                mCachedLayerCount = unchangedCount;
+            }
+        }
+    }
+
+    aTarget->onRenderDone();
+
+    return true;
+}
+
+
+//! Drops the cached layers.
+void LayerCache::invalidate()
+{
+    mCachedLayerCount = 0;
+    mLayerCount = 0;
+}
+
+
+//! Makes room for the state of aLayerCount layers.
+bool LayerCache::resizeLayers(int aLayerCount)
+{
+    if (aLayerCount <= mLayerCapacity)
+        return true;
+
+    MATRIX2D *transformations = new MATRIX2D[aLayerCount];
+    unsigned int *versions = new unsigned int[aLayerCount];
+    if (transformations == NULL || versions == NULL)
+    {
+        delete[] transformations;
+        delete[] versions;
+        return false;
+    }
+
+    delete[] mTransformations;
+    delete[] mVersions;
+    mTransformations = transformations;
+    mVersions = versions;
+    mLayerCapacity = aLayerCount;
+
+    return true;
+}
+
+
+//! Returns true if the matrices are equal.
+bool LayerCache::isEqual(const MATRIX2D &aMatrix1, const MATRIX2D &aMatrix2)
+{
+    return MATRIX2D_GET_M11(aMatrix1) == MATRIX2D_GET_M11(aMatrix2) &&
+           MATRIX2D_GET_M12(aMatrix1) == MATRIX2D_GET_M12(aMatrix2) &&
+           MATRIX2D_GET_M21(aMatrix1) == MATRIX2D_GET_M21(aMatrix2) &&
+           MATRIX2D_GET_M22(aMatrix1) == MATRIX2D_GET_M22(aMatrix2) &&
+           MATRIX2D_GET_DX(aMatrix1) == MATRIX2D_GET_DX(aMatrix2) &&
+           MATRIX2D_GET_DY(aMatrix1) == MATRIX2D_GET_DY(aMatrix2);
+}
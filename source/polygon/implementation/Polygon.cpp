@@ -26,6 +26,34 @@ Polygon::Polygon(SubPolygon **aSubPolygons, int aSubPolygonCount)
 {
     mSubPolygons = aSubPolygons;
     mSubPolygonCount = aSubPolygonCount;
+
+    // The bounding box is the union of the sub-polygon bounding boxes.
+    mMinimum = VECTOR2D(INT_TO_RATIONAL(0),INT_TO_RATIONAL(0));
+    mMaximum = VECTOR2D(INT_TO_RATIONAL(0),INT_TO_RATIONAL(0));
+    if (mSubPolygonCount > 0)
+    {
+        mMinimum = mSubPolygons[0]->getMinimum();
+        mMaximum = mSubPolygons[0]->getMaximum();
+    }
+
+    int n;
+    for (n = 1; n < mSubPolygonCount; n++)
+    {
+        const VECTOR2D &minimum = mSubPolygons[n]->getMinimum();
+        const VECTOR2D &maximum = mSubPolygons[n]->getMaximum();
+
+        if (VECTOR2D_GETX(minimum) < VECTOR2D_GETX(mMinimum))
+            VECTOR2D_SETX(mMinimum,VECTOR2D_GETX(minimum));
+        if (VECTOR2D_GETY(minimum) < VECTOR2D_GETY(mMinimum))
+            VECTOR2D_SETY(mMinimum,VECTOR2D_GETY(minimum));
+        if (VECTOR2D_GETX(maximum) > VECTOR2D_GETX(mMaximum))
+            VECTOR2D_SETX(mMaximum,VECTOR2D_GETX(maximum));
+        if (VECTOR2D_GETY(maximum) > VECTOR2D_GETY(mMaximum))
+            VECTOR2D_SETY(mMaximum,VECTOR2D_GETY(maximum));
+    }
+
+    mEvenOddEquivalent = checkEvenOddEquivalence();
+    mCurves = NULL;
 }
 
 
@@ -36,11 +64,81 @@ Polygon::~Polygon()
     for (n = 0; n < mSubPolygonCount; n++)
         delete mSubPolygons[n];
     delete[] mSubPolygons;
+    delete mCurves;
+}
+
+
+//! Returns the polygon to render with given transformation.
+/*! If the polygon has curves, this returns the polygon flattened for the scale
+ *  of the transformation. The polygon itself is used for scales from 1 to 2,
+ *  except for hairlines, and if the flattened polygon can't be created.
+ */
+const Polygon * Polygon::getLevel(const MATRIX2D &aTransformation) const
+{
+    if (mCurves == NULL)
+        return this;
+
+    int level = PolygonCurves::getLevel(aTransformation);
+    if (level == 0 && !mCurves->isHairline())
+        return this;
+
+    const Polygon *polygon = mCurves->getPolygon(level);
+    if (polygon == NULL)
+        return this;
+
+    return polygon;
+}
+
+
+//! Checks if even-odd fill gives the same result as non-zero winding fill.
+/*! The fills are the same if the winding number is never more than one or less
+ *  than minus one. The winding number of a simple sub-polygon is either 0 or its
+ *  orientation, so this is true if all sub-polygons are simple and the ones with
+ *  overlapping bounding boxes have opposite orientations. For example, a shape
+ *  with holes that have reversed orientation, or separate shapes, qualify.
+ */
+bool Polygon::checkEvenOddEquivalence() const
+{
+    int n, k;
+    for (n = 0; n < mSubPolygonCount; n++)
+    {
+        if (!mSubPolygons[n]->isSimple())
+            return false;
+    }
+
+    for (n = 0; n < mSubPolygonCount; n++)
+    {
+        const SubPolygon &poly1 = *mSubPolygons[n];
+        for (k = n + 1; k < mSubPolygonCount; k++)
+        {
+            const SubPolygon &poly2 = *mSubPolygons[k];
+
+            if (poly1.getOrientation() * poly2.getOrientation() <= 0)
+                continue;
+
+            // Touching bounding boxes are considered to overlap.
+            if (VECTOR2D_GETX(poly1.getMaximum()) < VECTOR2D_GETX(poly2.getMinimum()) ||
+                VECTOR2D_GETX(poly2.getMaximum()) < VECTOR2D_GETX(poly1.getMinimum()) ||
+                VECTOR2D_GETY(poly1.getMaximum()) < VECTOR2D_GETY(poly2.getMinimum()) ||
+                VECTOR2D_GETY(poly2.getMaximum()) < VECTOR2D_GETY(poly1.getMinimum()))
+                continue;
+
+            return false;
+        }
+    }
+
+    return true;
 }
 
 
 //! Static method for creating a polygon from the data.
-Polygon * Polygon::create(const PolygonData *aPolygonData)
+/*! \param aPolygonData the flattened polygon data.
+ *  \param aPathData the path data with the curves the polygon data was flattened
+ *         from, or NULL.
+ *  \param aStrokeStyle the style the polygon data was stroked from the path data
+ *         with, or NULL if the polygon data is a fill.
+ */
+Polygon * Polygon::create(const PolygonData *aPolygonData, const PathData *aPathData, const StrokeStyle *aStrokeStyle)
 {
     bool error = false;
 
@@ -96,6 +194,17 @@ Polygon * Polygon::create(const PolygonData *aPolygonData)
             error = true;
     }
 
+    if (!error && aPathData)
+    {
+        // The polygon owns the sub-polygons from here on.
+        polygon->mCurves = new PolygonCurves();
+        if (polygon->mCurves == NULL || !polygon->mCurves->init(aPathData,aStrokeStyle))
+        {
+            delete polygon;
+            return NULL;
+        }
+    }
+
     if (error)
     {
         int n;
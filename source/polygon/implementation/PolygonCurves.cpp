@@ -0,0 +1,289 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ *
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief A cache of the polygon flattened from curves for different scales.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+#include "polygon/base/Base.h"
+#include "polygon/implementation/Implementation.h"
+
+
+//! Constructor.
+PolygonCurves::PolygonCurves()
+{
+    mPointData = NULL;
+    mTagData = NULL;
+    mPointCounts = NULL;
+    mClosedData = NULL;
+    mPathData = NULL;
+    mStroke = false;
+    mMinimum = VECTOR2D(INT_TO_RATIONAL(0),INT_TO_RATIONAL(0));
+    mMaximum = VECTOR2D(INT_TO_RATIONAL(0),INT_TO_RATIONAL(0));
+    mUseCounter = 0;
+
+    int n;
+    for (n = 0; n < POLYGON_CURVES_CACHE_SIZE; n++)
+    {
+        mLevels[n] = 0;
+        mLastUse[n] = 0;
+        mPolygons[n] = NULL;
+    }
+}
+
+
+//! Destructor.
+PolygonCurves::~PolygonCurves()
+{
+    int n;
+    for (n = 0; n < POLYGON_CURVES_CACHE_SIZE; n++)
+        delete mPolygons[n];
+
+    if (mPathData)
+    {
+        for (n = 0; n < mPathData->getSubPathCount(); n++)
+        {
+            delete[] mPointData[n];
+            delete[] mTagData[n];
+        }
+    }
+    delete mPathData;
+    delete[] mPointData;
+    delete[] mTagData;
+    delete[] mPointCounts;
+    delete[] mClosedData;
+}
+
+
+//! Initializes the curves with a copy of the path data.
+/*! \param aPathData the path data.
+ *  \param aStrokeStyle the style for stroking the curves, or NULL if the curves
+ *         are filled.
+ */
+bool PolygonCurves::init(const PathData *aPathData, const StrokeStyle *aStrokeStyle)
+{
+    int subPathCount = aPathData->getSubPathCount();
+
+    if (aStrokeStyle)
+    {
+        mStroke = true;
+        mStrokeStyle = *aStrokeStyle;
+    }
+
+    mPointData = new RATIONAL*[subPathCount];
+    mTagData = new PATH_POINT_TAG*[subPathCount];
+    mPointCounts = new int[subPathCount];
+    mClosedData = new bool[subPathCount];
+    if (mPointData == NULL || mTagData == NULL || mPointCounts == NULL || mClosedData == NULL)
+        return false;
+
+    int n;
+    for (n = 0; n < subPathCount; n++)
+    {
+        mPointData[n] = NULL;
+        mTagData[n] = NULL;
+        mPointCounts[n] = 0;
+        mClosedData[n] = aPathData->isClosed(n);
+    }
+
+    // The path data is created first so that the destructor releases the arrays.
+    mPathData = new PathData(mPointData,mTagData,mPointCounts,subPathCount,mClosedData);
+    if (mPathData == NULL)
+        return false;
+
+    bool first = true;
+    for (n = 0; n < subPathCount; n++)
+    {
+        int pointCount = aPathData->getPointCount(n);
+        mPointData[n] = new RATIONAL[pointCount * 2];
+        mTagData[n] = new PATH_POINT_TAG[pointCount];
+        if (mPointData[n] == NULL || mTagData[n] == NULL)
+            return false;
+
+        const RATIONAL *points = aPathData->getPointData(n);
+        const PATH_POINT_TAG *tags = aPathData->getTagData(n);
+        int p;
+        for (p = 0; p < pointCount; p++)
+        {
+            RATIONAL x = points[p * 2];
+            RATIONAL y = points[p * 2 + 1];
+            mPointData[n][p * 2] = x;
+            mPointData[n][p * 2 + 1] = y;
+            mTagData[n][p] = tags[p];
+
+            if (first)
+            {
+                mMinimum = VECTOR2D(x,y);
+                mMaximum = VECTOR2D(x,y);
+                first = false;
+            }
+            else
+            {
+                if (x < VECTOR2D_GETX(mMinimum))
+                    VECTOR2D_SETX(mMinimum,x);
+                if (y < VECTOR2D_GETY(mMinimum))
+                    VECTOR2D_SETY(mMinimum,y);
+                if (x > VECTOR2D_GETX(mMaximum))
+                    VECTOR2D_SETX(mMaximum,x);
+                if (y > VECTOR2D_GETY(mMaximum))
+                    VECTOR2D_SETY(mMaximum,y);
+            }
+        }
+        mPointCounts[n] = pointCount;
+    }
+
+    return true;
+}
+
+
+//! Returns the polygon flattened for given level, or NULL if it can't be created.
+/*! \param aLevel the level from getLevel().
+ */
+Polygon * PolygonCurves::getPolygon(int aLevel)
+{
+    mUseCounter++;
+
+    int n;
+    int oldest = 0;
+    for (n = 0; n < POLYGON_CURVES_CACHE_SIZE; n++)
+    {
+        if (mPolygons[n] && mLevels[n] == aLevel)
+        {
+            mLastUse[n] = mUseCounter;
+            return mPolygons[n];
+        }
+
+        // Empty entries are used first, then the least recently used one.
+        if (mPolygons[oldest] && (mPolygons[n] == NULL || mLastUse[n] < mLastUse[oldest]))
+            oldest = n;
+    }
+
+    Polygon *polygon = createPolygon(aLevel);
+    if (polygon == NULL)
+        return NULL;
+
+    delete mPolygons[oldest];
+    mPolygons[oldest] = polygon;
+    mLevels[oldest] = aLevel;
+    mLastUse[oldest] = mUseCounter;
+
+    return polygon;
+}
+
+
+//! Returns the level of a transformation.
+/*! The level is the base two logarithm of the scale, rounded down. The scale is
+ *  the length of the longer transformed unit vector.
+ *  \param aTransformation the transformation matrix.
+ */
+int PolygonCurves::getLevel(const MATRIX2D &aTransformation)
+{
+    double m11 = MATRIX2D_GET_M11(aTransformation);
+    double m12 = MATRIX2D_GET_M12(aTransformation);
+    double m21 = MATRIX2D_GET_M21(aTransformation);
+    double m22 = MATRIX2D_GET_M22(aTransformation);
+
+    double scaleX = m11 * m11 + m12 * m12;
+    double scaleY = m21 * m21 + m22 * m22;
+    double scale = sqrt(scaleX > scaleY ? scaleX : scaleY);
+
+    // frexp() returns the scale as a mantissa in range of [0.5,1) and an exponent.
+    int exponent;
+    frexp(scale,&exponent);
+
+    int level = exponent - 1;
+    if (scale == 0.0 || level < POLYGON_CURVES_MIN_LEVEL)
+        level = POLYGON_CURVES_MIN_LEVEL;
+    else if (level > POLYGON_CURVES_MAX_LEVEL)
+        level = POLYGON_CURVES_MAX_LEVEL;
+
+    return level;
+}
+
+
+//! Creates a polygon flattened for given level.
+/*! The flatness is scaled so that the curves stay within POLYGON_CURVES_FLATNESS
+ *  pixels at the lower end of the level, and within twice that at the upper end.
+ *  \param aLevel the level from getLevel().
+ */
+Polygon * PolygonCurves::createPolygon(int aLevel) const
+{
+    RATIONAL flatness = (RATIONAL)ldexp((double)POLYGON_CURVES_FLATNESS,-aLevel);
+
+    if (mStroke)
+        return createStrokePolygon(aLevel,flatness);
+
+    int subPathCount = mPathData->getSubPathCount();
+    RATIONAL **vertexData = new RATIONAL*[subPathCount];
+    int *vertexCounts = new int[subPathCount];
+    if (vertexData == NULL || vertexCounts == NULL)
+    {
+        delete[] vertexData;
+        delete[] vertexCounts;
+        return NULL;
+    }
+
+    bool error = false;
+    int n;
+    for (n = 0; n < subPathCount; n++)
+    {
+        vertexCounts[n] = 0;
+        vertexData[n] = NULL;
+        if (!error)
+        {
+            int vertexCount = mPathData->flatten(n,flatness,NULL);
+            vertexData[n] = new RATIONAL[vertexCount * 2];
+            if (vertexData[n] == NULL)
+                error = true;
+            else
+                vertexCounts[n] = mPathData->flatten(n,flatness,vertexData[n]);
+        }
+    }
+
+    // The polygon makes a copy of the vertices.
+    Polygon *polygon = NULL;
+    if (!error)
+    {
+        PolygonData polygonData(vertexData,vertexCounts,subPathCount);
+        polygon = Polygon::create(&polygonData);
+    }
+
+    for (n = 0; n < subPathCount; n++)
+        delete[] vertexData[n];
+    delete[] vertexData;
+    delete[] vertexCounts;
+
+    return polygon;
+}
+
+
+//! Creates a stroked outline of the curves for given level.
+/*! The width of a hairline is given in pixels, so it is scaled for the middle of
+ *  the level.
+ *  \param aLevel the level from getLevel().
+ *  \param aFlatness the flatness of the curves for the level.
+ */
+Polygon * PolygonCurves::createStrokePolygon(int aLevel, RATIONAL aFlatness) const
+{
+    RATIONAL width = mStrokeStyle.mWidth;
+    if (mStrokeStyle.mHairline)
+        width = (RATIONAL)ldexp((double)width / 1.5,-aLevel);
+
+    Stroker stroker;
+    if (!stroker.stroke(mPathData,mStrokeStyle,width,aFlatness))
+        return NULL;
+
+    PolygonData polygonData(stroker.getVertexData(),stroker.getVertexCounts(),stroker.getSubPolygonCount());
+    return Polygon::create(&polygonData);
+}
@@ -26,9 +26,30 @@ PolygonVersionF::PolygonVersionF()
 {
     mMaskBuffer = NULL;
     mWindingBuffer = NULL;
+    mCoverageBuffer = NULL;
     mEdgeTable = NULL;
     mEdgeCount = 0;
     mCurrentEdge = 0;
+    mCurveEdges = NULL;
+    mCurveEdgeCount = 0;
+    mCurrentCurveEdge = 0;
+    mGammaTable = NULL;
+    mScenePolygons = NULL;
+    mScenePolygonCount = 0;
+    mSceneEdgeLines = NULL;
+    mSceneEdgeLineCount = 0;
+    mSceneStartTable = NULL;
+    mSceneActivePolygons = NULL;
+    mOcclusionBuffer = NULL;
+    mDeferredPixels = NULL;
+    mDeferredPixelCount = 0;
+    mCurrentDeferredPixel = 0;
+    mClipMasks = NULL;
+    mClipMaskCount = 0;
+    mClipMaskCapacity = 0;
+    mClipRegion = NULL;
+    mClipRegionBand = 0;
+    mDamageClip = false;
     // Scale the coordinates by SUBPIXEL_COUNT in vertical direction
     VECTOR2D scale(INT_TO_RATIONAL(1),INT_TO_RATIONAL(SUBPIXEL_COUNT));
     MATRIX2D_MAKESCALING(mRemappingMatrix,scale);
@@ -62,10 +83,14 @@ bool PolygonVersionF::init(unsigned int aWidth, unsigned int aHeight, unsigned i
         return false;
     MEMSET(mMaskBuffer,0,bufferWidth*sizeof(SUBPIXEL_DATA));
 
-    mWindingBuffer = new NonZeroMask[bufferWidth];
+    mWindingBuffer = new NonZeroPackedMask[bufferWidth];
     if (mWindingBuffer == NULL)
         return false;
-    MEMSET(mWindingBuffer,0,bufferWidth*sizeof(NonZeroMask));
+    MEMSET(mWindingBuffer,0,bufferWidth*sizeof(NonZeroPackedMask));
+
+    mCoverageBuffer = new unsigned char[bufferWidth];
+    if (mCoverageBuffer == NULL)
+        return false;
 
     mEdgeTable = new PolygonScanEdge*[aHeight];
     if (mEdgeTable == NULL)
@@ -77,11 +102,20 @@ bool PolygonVersionF::init(unsigned int aWidth, unsigned int aHeight, unsigned i
         return false;
     mEdgeCount = aEdgeCount;
 
+    mSceneStartTable = new int[aHeight];
+    if (mSceneStartTable == NULL)
+        return false;
+    unsigned int n;
+    for (n = 0; n < aHeight; n++)
+        mSceneStartTable[n] = -1;
+
     mWidth = aWidth;
     mBufferWidth = bufferWidth;
     mHeight = aHeight;
 
     mClipRect.setClip(0,0,mWidth,mHeight,SUBPIXEL_COUNT);
+    mDamageRect.setClip(0,0,mWidth,mHeight,1);
+    mDamageClip = false;
 
     return true;
 }
@@ -92,8 +126,25 @@ PolygonVersionF::~PolygonVersionF()
 {
     delete[] mMaskBuffer;
     delete[] mWindingBuffer;
+    delete[] mCoverageBuffer;
     delete[] mEdgeTable;
     delete[] mEdgeStorage;
+    delete[] mCurveEdges;
+    delete mGammaTable;
+    delete[] mScenePolygons;
+    delete[] mSceneEdgeLines;
+    delete[] mSceneStartTable;
+    delete[] mSceneActivePolygons;
+    delete[] mOcclusionBuffer;
+    delete[] mDeferredPixels;
+
+    int n;
+    for (n = 0; n < mClipMaskCapacity; n++)
+    {
+        delete[] mClipMasks[n].mCoverage;
+        delete[] mClipMasks[n].mRows;
+    }
+    delete[] mClipMasks;
 }
 
 
@@ -113,6 +164,7 @@ void PolygonVersionF::renderEvenOdd(BitmapData *aTarget, const Polygon *aPolygon
 
     mVerticalExtents.reset();
     mCurrentEdge = 0;
+    mCurrentCurveEdge = 0;
 
     MATRIX2D transform = aTransformation;
     MATRIX2D_MULTIPLY(transform,mRemappingMatrix);
@@ -121,9 +173,36 @@ void PolygonVersionF::renderEvenOdd(BitmapData *aTarget, const Polygon *aPolygon
     clipRect.setClip(0,0,aTarget->mWidth,aTarget->mHeight,SUBPIXEL_COUNT);
     clipRect.intersect(mClipRect);
 
+    // Skip the polygon if it is completely outside.
+    if (!intersectClipMask(clipRect) ||
+        !intersectClipRegion(clipRect) ||
+        aPolygon->getBoundsClip(transform,clipRect) == POLYGON_BOUNDS_OUTSIDE)
+        return;
+
+    // The curves are rendered directly if they fit in the clip rectangle. Otherwise
+    // the polygon flattened for the scale of the transformation is used.
+    bool curveEdges = useCurveEdges(aPolygon,transform,clipRect);
+    if (!curveEdges)
+        aPolygon = aPolygon->getLevel(aTransformation);
+
+    // Axis-aligned rectangles are filled directly without the edges.
+    ScanRectangle rectangle;
+    if (!isClipped() && !aTarget->isFloatFormat() &&
+        getScanRectangle(aPolygon,transform,clipRect,rectangle))
+    {
+        fillRectangle(aTarget,rectangle,aColor);
+        return;
+    }
+
     bool success = true;
 
     int subPolyCount = aPolygon->getSubPolygonCount();
+    if (curveEdges)
+    {
+        success = addCurveEdges(aPolygon->getCurves()->getPathData(),transform);
+        subPolyCount = 0;
+    }
+
     int n = 0;
     while (n < subPolyCount && success)
     {
@@ -148,6 +227,7 @@ void PolygonVersionF::renderEvenOdd(BitmapData *aTarget, const Polygon *aPolygon
                 int firstLine = edges[p].mFirstLine >> SUBPIXEL_SHIFT;
                 int lastLine = edges[p].mLastLine >> SUBPIXEL_SHIFT;
 
+                edges[p].mCurve = -1;
                 edges[p].mNextEdge = mEdgeTable[firstLine];
                 mEdgeTable[firstLine] = &edges[p];
 
@@ -180,7 +260,14 @@ void PolygonVersionF::renderEvenOdd(BitmapData *aTarget, const Polygon *aPolygon
     // success = false;
 
     if (success)
-        fillEvenOdd(aTarget,aColor);
+    {
+        if (aTarget->isFloatFormat())
+            fillEvenOddFloat(aTarget,aColor);
+        else if (!isClipped() && !curveEdges && aPolygon->isConvex())
+            fillConvex(aTarget,aColor);
+        else
+            fillEvenOdd(aTarget,aColor);
+    }
     else
     {
         unsigned int y;
@@ -206,6 +293,7 @@ void PolygonVersionF::renderNonZeroWinding(BitmapData *aTarget, const Polygon *a
 
     mVerticalExtents.reset();
     mCurrentEdge = 0;
+    mCurrentCurveEdge = 0;
 
     MATRIX2D transform = aTransformation;
     MATRIX2D_MULTIPLY(transform,mRemappingMatrix);
@@ -214,9 +302,40 @@ void PolygonVersionF::renderNonZeroWinding(BitmapData *aTarget, const Polygon *a
     clipRect.setClip(0,0,aTarget->mWidth,aTarget->mHeight,SUBPIXEL_COUNT);
     clipRect.intersect(mClipRect);
 
+    // Skip the polygon if it is completely outside.
+    if (!intersectClipMask(clipRect) ||
+        !intersectClipRegion(clipRect) ||
+        aPolygon->getBoundsClip(transform,clipRect) == POLYGON_BOUNDS_OUTSIDE)
+        return;
+
+    // The curves are rendered directly if they fit in the clip rectangle. Otherwise
+    // the polygon flattened for the scale of the transformation is used.
+    bool curveEdges = useCurveEdges(aPolygon,transform,clipRect);
+    if (!curveEdges)
+        aPolygon = aPolygon->getLevel(aTransformation);
+
+    // Use the cheaper even-odd fill when it gives the same result for the
+    // polygon that is rendered.
+    bool evenOdd = aPolygon->isEvenOddEquivalent();
+
+    // Axis-aligned rectangles are filled directly without the edges.
+    ScanRectangle rectangle;
+    if (!isClipped() && !aTarget->isFloatFormat() &&
+        getScanRectangle(aPolygon,transform,clipRect,rectangle))
+    {
+        fillRectangle(aTarget,rectangle,aColor);
+        return;
+    }
+
     bool success = true;
 
     int subPolyCount = aPolygon->getSubPolygonCount();
+    if (curveEdges)
+    {
+        success = addCurveEdges(aPolygon->getCurves()->getPathData(),transform);
+        subPolyCount = 0;
+    }
+
     int n = 0;
     while (n < subPolyCount && success)
     {
@@ -241,6 +360,7 @@ void PolygonVersionF::renderNonZeroWinding(BitmapData *aTarget, const Polygon *a
                 int firstLine = edges[p].mFirstLine >> SUBPIXEL_SHIFT;
                 int lastLine = edges[p].mLastLine >> SUBPIXEL_SHIFT;
 
+                edges[p].mCurve = -1;
                 edges[p].mNextEdge = mEdgeTable[firstLine];
                 mEdgeTable[firstLine] = &edges[p];
 
@@ -272,7 +392,24 @@ void PolygonVersionF::renderNonZeroWinding(BitmapData *aTarget, const Polygon *a
 //    success = false;
 
     if (success)
-        fillNonZero(aTarget,aColor,clipRect);
+    {
+        if (aTarget->isFloatFormat())
+        {
+            if (evenOdd)
+                fillEvenOddFloat(aTarget,aColor);
+            else
+                fillNonZeroFloat(aTarget,aColor);
+        }
+        else if (!isClipped() && !curveEdges && aPolygon->isConvex())
+        {
+            // A convex polygon has the same coverage with both fill rules.
+            fillConvex(aTarget,aColor);
+        }
+        else if (evenOdd)
+            fillEvenOdd(aTarget,aColor);
+        else
+            fillNonZero(aTarget,aColor,clipRect);
+    }
     else
     {
         unsigned int y;
@@ -282,410 +419,713 @@ void PolygonVersionF::renderNonZeroWinding(BitmapData *aTarget, const Polygon *a
 }
 
 
-//! Sets the clip rectangle for the polygon filler.
-void PolygonVersionF::setClipRect(unsigned int aX, unsigned int aY, unsigned int aWidth, unsigned int aHeight)
-{
-    unsigned int x = aX;
-    unsigned int y = aY;
-
-    if (x > mWidth)
-        x = mWidth;
-
-    if (y > mHeight)
-        y = mHeight;
-
-    unsigned int maxX = x + aWidth;
-    unsigned int maxY = y + aHeight;
-
-    if (maxX > mWidth)
-        maxX = mWidth;
-
-    if (maxY > mHeight)
-        maxY = mHeight;
-
-    mClipRect.setClip(x, y, maxX - x, maxY - y, SUBPIXEL_COUNT);
-}
-
-
-//! Adds an edge.
-bool PolygonVersionF::addEdge(const PolygonEdge &aEdge)
+//! Renders a set of polygons in painter's order in a single pass.
+/*! The edges of all polygons are collected to a global edge table first. Then
+ *  the target is processed one scanline at a time, and all polygons covering
+ *  the scanline are resolved in painter's order while the scanline is in cache.
+ *  Returns false if the storage for the scene cannot be allocated.
+ */
+bool PolygonVersionF::renderScene(RenderTargetWrapper *aTarget, PolygonWrapper * const *aPolygons, PaintWrapper * const *aColors,
+                                  const RENDERER_FILLMODE *aFillModes, int aPolygonCount, const MATRIX2D &aTransformation)
 {
-    /* Note that this is unused code. Current implementation uses
-       SubPolygon::getScanEdges(). */
-
-    // Enough edges in the storage?
-    if (mCurrentEdge >= mEdgeCount)
-    {
-        // Resize if not, exit if resize fails.
-        // The resizing rule is 1.5 * size + 1
-        if (!resizeEdgeStorage(mEdgeCount / 2 + 1))
-            return false;
-    }
-
-    PolygonScanEdge *edge = &mEdgeStorage[mCurrentEdge++];
+    BitmapData *target = (BitmapData *)aTarget;
 
-    edge->mFirstLine = aEdge.mFirstLine;
-    edge->mLastLine = aEdge.mLastLine;
-    edge->mWinding = aEdge.mWinding;
-    edge->mX = rationalToFixed(aEdge.mX);
-    edge->mSlope = rationalToFixed(aEdge.mSlope);
-
-    // Calculate the index for first and last line.
-    int firstLine = aEdge.mFirstLine >> SUBPIXEL_SHIFT;
-    int lastLine = aEdge.mLastLine >> SUBPIXEL_SHIFT;
-
-    mVerticalExtents.mark(firstLine,lastLine);
+    if (!isSupported(target->mFormat))
+        return false;
 
-    // Add to the edge table.
-    edge->mNextEdge = mEdgeTable[firstLine];
-    mEdgeTable[firstLine] = edge;
+    // Floating point targets are rendered one polygon at a time.
+    if (target->isFloatFormat() || !resizeScenePolygons(aPolygonCount))
+        return PolygonFiller::renderScene(aTarget,aPolygons,aColors,aFillModes,aPolygonCount,aTransformation);
 
-    return true;
-}
+    // Sets the round down mode in case it has been modified.
+    setRoundDownMode();
 
+    mCurrentEdge = 0;
+    mCurrentCurveEdge = 0;
 
-//! Renders the edges from the current vertical index using even-odd fill.
-inline void PolygonVersionF::renderEvenOddEdges(PolygonScanEdge * &aActiveEdgeTable, SpanExtents &aEdgeExtents, int aCurrentLine)
-{
-    static const FIXED_POINT offsets[SUBPIXEL_COUNT] = SUBPIXEL_OFFSETS_FIXED;
+    MATRIX2D transform = aTransformation;
+    MATRIX2D_MULTIPLY(transform,mRemappingMatrix);
 
-    // First, process edges in the active edge table. These are either full height edges
-    // or edges that end before the last line. Remove those that end within the scan line.
+    ClipRectangle clipRect;
+    clipRect.setClip(0,0,target->mWidth,target->mHeight,SUBPIXEL_COUNT);
+    clipRect.intersect(mClipRect);
 
-    // Then, fetch the edges from the edge table. These are either such that the edge is
-    // fully within this scanline or the edge starts from within the scanline and continues
-    // to the next scanline. Add those that continue to the next scanline to the active
-    // edge table. Clear the edge table.
+    if (!intersectClipMask(clipRect) ||
+        !intersectClipRegion(clipRect))
+        return true;
 
-    PolygonScanEdge *prevEdge = NULL;
-    PolygonScanEdge *currentEdge = aActiveEdgeTable;
+    SpanExtents sceneExtents;
+    sceneExtents.reset();
 
-    while (currentEdge)
+    bool success = true;
+    int edgeLineCount = 0;
+
+    // Axis-aligned rectangles are filled without the edges and convex polygons
+    // without the mask buffer. The occlusion culling and the clipping handle only
+    // the mask buffer.
+    bool useSampleSpans = mOcclusionBuffer == NULL && !isClipped();
+
+    // With the occlusion culling the rectangles in front hide the polygons behind
+    // them before their edges are set up. The clipping may leave holes in them.
+    bool useOccluders = mOcclusionBuffer != NULL && !isClipped();
+    SceneOccluder occluders[SCENE_OCCLUDER_COUNT];
+    int occluderCount = 0;
+
+    // The polygons are processed in reverse order, so that the lists in the start
+    // table end up in painter's order.
+    int n = aPolygonCount - 1;
+    while (n >= 0 && success)
     {
-        // The plotting of all edges in the AET starts from the top of the scanline.
-        // The plotting is divided to two stages: those that end on this scanline and
-        // those that span over the full scanline.
-
-        int lastLine = currentEdge->mLastLine >> SUBPIXEL_SHIFT;
+        // The curves are rendered directly if they fit in the clip rectangle.
+        const Polygon *scenePolygon = (const Polygon *)aPolygons[n];
+        bool curveEdges = useCurveEdges(scenePolygon,transform,clipRect);
+        if (!curveEdges)
+            scenePolygon = scenePolygon->getLevel(aTransformation);
 
-        if (lastLine == aCurrentLine)
+        if (useOccluders)
         {
-            FIXED_POINT x = currentEdge->mX;
-            FIXED_POINT slope = currentEdge->mSlope;
+            if (isSceneOccluded(scenePolygon,curveEdges,transform,clipRect,occluders,occluderCount))
+            {
+                n--;
+                continue;
+            }
 
-            // First x value rounded down.
-            int xs = FIXED_TO_INT(x);
-            int ye = currentEdge->mLastLine & (SUBPIXEL_COUNT - 1);
+            ScanRectangle occluder;
+            if (getScanRectangle(scenePolygon,transform,clipRect,occluder))
+                addSceneOccluder(occluder,occluders,occluderCount);
+        }
 
-            SUBPIXEL_DATA mask = 1;
-            int ySub;
-            for (ySub = 0; ySub <= ye; ySub++)
+        ScenePolygon &rectanglePolygon = mScenePolygons[n];
+        if (useSampleSpans &&
+            getScanRectangle(scenePolygon,transform,clipRect,rectanglePolygon.mRectangle))
+        {
+            const ScanRectangle &rectangle = rectanglePolygon.mRectangle;
+            if (rectangle.mFirstLine <= rectangle.mLastLine &&
+                rectangle.mMinX < rectangle.mMaxX)
             {
-                int xp = FIXED_TO_INT(x + offsets[ySub]);
-                mMaskBuffer[xp] ^= mask;
-                mask <<= 1;
-                x += slope;
+                int minY = rectangle.mFirstLine >> SUBPIXEL_SHIFT;
+                int maxY = rectangle.mLastLine >> SUBPIXEL_SHIFT;
+
+                rectanglePolygon.mIsRectangle = true;
+                rectanglePolygon.mIsConvex = false;
+                rectanglePolygon.mActiveEdges = NULL;
+                rectanglePolygon.mCurrentEdgeLine = edgeLineCount;
+                rectanglePolygon.mLastEdgeLine = edgeLineCount - 1;
+                rectanglePolygon.mLastLine = maxY;
+                rectanglePolygon.mColor = ((DefaultPaintWrapper *)aColors[n])->getColor();
+                rectanglePolygon.mFillMode = aFillModes[n];
+
+                rectanglePolygon.mNext = mSceneStartTable[minY];
+                mSceneStartTable[minY] = n;
+
+                sceneExtents.mark(minY,maxY);
             }
+            n--;
+            continue;
+        }
 
-            // Last x-value rounded down.
-            int xe = FIXED_TO_INT(x - slope);
-
-            // Mark the span.
-            aEdgeExtents.markWithSort(xs,xe);
+        mVerticalExtents.reset();
 
-            // Remove the edge from the active edge table
-            currentEdge = currentEdge->mNextEdge;
-            if (prevEdge)
-                prevEdge->mNextEdge = currentEdge;
-            else
-                aActiveEdgeTable = currentEdge;
-        }
-        else
-        {
-            FIXED_POINT x = currentEdge->mX;
-            FIXED_POINT slope = currentEdge->mSlope;
+        success = addPolygonEdges(scenePolygon,transform,clipRect);
 
-            // First x value rounded down.
-            int xs = FIXED_TO_INT(x);
-            int xe;
+        int minY = mVerticalExtents.mMinimum;
+        int maxY = mVerticalExtents.mMaximum;
 
-            EVENODD_LINE_UNROLL_INIT();
+        if (success && minY <= maxY)
+        {
+            ScenePolygon &polygon = mScenePolygons[n];
+            polygon.mIsRectangle = false;
+            polygon.mIsConvex = useSampleSpans && !curveEdges && scenePolygon->isConvex();
+            polygon.mActiveEdges = NULL;
+            polygon.mCurrentEdgeLine = edgeLineCount;
+            polygon.mLastLine = maxY;
+            polygon.mColor = ((DefaultPaintWrapper *)aColors[n])->getColor();
+            polygon.mFillMode = aFillModes[n];
+            if (scenePolygon->isEvenOddEquivalent())
+                polygon.mFillMode = RENDERER_FILLMODE_EVENODD;
+
+            // Move the edges from the edge table to the edge line list of the polygon.
+            // Edge indices are stored instead of pointers, as the edge storage may be
+            // reallocated by the following polygons.
+            int y;
+            for (y = minY; y <= maxY; y++)
+            {
+                if (mEdgeTable[y])
+                {
+                    if ((unsigned int)edgeLineCount >= mSceneEdgeLineCount &&
+                        !resizeSceneEdgeLines(mSceneEdgeLineCount / 2 + 1))
+                    {
+                        success = false;
+                        break;
+                    }
 
-            EVENODD_LINE_UNROLL_0(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_1(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_2(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_3(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_4(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_5(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_6(mMaskBuffer,x,slope,offsets);
-#if SUBPIXEL_COUNT == 8
-            xe = FIXED_TO_INT(x);
-#endif
-            EVENODD_LINE_UNROLL_7(mMaskBuffer,x,slope,offsets);
+                    mSceneEdgeLines[edgeLineCount].mLine = y;
+                    mSceneEdgeLines[edgeLineCount].mEdgeIndex = (int)(mEdgeTable[y] - mEdgeStorage);
+                    edgeLineCount++;
+                    mEdgeTable[y] = NULL;
+                }
+            }
+            polygon.mLastEdgeLine = edgeLineCount - 1;
 
-#if SUBPIXEL_COUNT > 8
-            EVENODD_LINE_UNROLL_8(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_9(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_10(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_11(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_12(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_13(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_14(mMaskBuffer,x,slope,offsets);
-#if SUBPIXEL_COUNT == 16
-            xe = FIXED_TO_INT(x);
-#endif
-            EVENODD_LINE_UNROLL_15(mMaskBuffer,x,slope,offsets);
-#endif
+            polygon.mNext = mSceneStartTable[minY];
+            mSceneStartTable[minY] = n;
 
-#if SUBPIXEL_COUNT > 16
-            EVENODD_LINE_UNROLL_16(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_17(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_18(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_19(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_20(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_21(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_22(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_23(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_24(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_25(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_26(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_27(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_28(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_29(mMaskBuffer,x,slope,offsets);
-            EVENODD_LINE_UNROLL_30(mMaskBuffer,x,slope,offsets);
-            xe = FIXED_TO_INT(x);
-            EVENODD_LINE_UNROLL_31(mMaskBuffer,x,slope,offsets);
-#endif
+            sceneExtents.mark(minY,maxY);
+        }
 
-            // Mark the span.
-            aEdgeExtents.markWithSort(xs,xe);
+        n--;
+    }
 
-            // Update the edge
-            if ((aCurrentLine & SLOPE_FIX_SCANLINE_MASK) == 0)
-                currentEdge->mX = x + currentEdge->mSlopeFix;
-            else
-                currentEdge->mX = x;
+    int y;
 
-            // Proceed forward in the AET.
-            prevEdge = currentEdge;
-            currentEdge = currentEdge->mNextEdge;
+    if (!success)
+    {
+        for (y = 0; y < (int)mHeight; y++)
+        {
+            mEdgeTable[y] = NULL;
+            mSceneStartTable[y] = -1;
         }
+        return false;
     }
 
-    // Fetch edges from the edge table.
-    currentEdge = mEdgeTable[aCurrentLine];
+    unsigned int pitch = target->mPitch / 4;
+    unsigned long *row = &target->mData[sceneExtents.mMinimum * pitch];
 
-    if (currentEdge)
+    int activePolygons = -1;
+    SpanExtents edgeExtents;
+    SpanExtents occlusionExtents;
+    SampleSpan sampleSpan;
+
+    for (y = sceneExtents.mMinimum; y <= sceneExtents.mMaximum; y++)
     {
-        // Clear the edge table for this line.
-        mEdgeTable[aCurrentLine] = NULL;
+        // Add the polygons starting from this scanline to the active list.
+        if (mSceneStartTable[y] >= 0)
+        {
+            activePolygons = mergeScenePolygons(activePolygons,mSceneStartTable[y]);
+            mSceneStartTable[y] = -1;
+        }
 
-        do
+        // Collect the polygons of this scanline in painter's order. The polygons
+        // ending on this scanline are removed from the active list.
+        int activeCount = 0;
+        int prevPolygon = -1;
+        int currentPolygon = activePolygons;
+        while (currentPolygon >= 0)
         {
-            // The plotting of all edges in the edge table starts somewhere from the middle
-            // of the scanline, and ends either at the end or at the last scanline. This leads
-            // to two cases: either the scanning starts and stops within this scanline, or
-            // it continues to the next as well.
+            ScenePolygon &polygon = mScenePolygons[currentPolygon];
+            mSceneActivePolygons[activeCount++] = currentPolygon;
 
-            int lastLine = currentEdge->mLastLine >> SUBPIXEL_SHIFT;
+            int nextPolygon = polygon.mNext;
+            if (y == polygon.mLastLine)
+            {
+                if (prevPolygon >= 0)
+                    mScenePolygons[prevPolygon].mNext = nextPolygon;
+                else
+                    activePolygons = nextPolygon;
+            }
+            else
+                prevPolygon = currentPolygon;
 
-            if (lastLine == aCurrentLine)
+            currentPolygon = nextPolygon;
+        }
+
+        // The occlusion culling is not used with the clip mask and region, as the
+        // clipped spans are not fully covered.
+        if (mOcclusionBuffer == NULL || isClipped())
+        {
+            for (n = 0; n < activeCount; n++)
             {
-                FIXED_POINT x = currentEdge->mX;
-                FIXED_POINT slope = currentEdge->mSlope;
+                ScenePolygon &polygon = mScenePolygons[mSceneActivePolygons[n]];
 
-                // First x value rounded down.
-                int xs = FIXED_TO_INT(x);
+                const GammaColorTable *gammaColor = NULL;
+                if (mGammaTable)
+                    gammaColor = mGammaTable->getColorTable(polygon.mColor);
 
-                int ys = currentEdge->mFirstLine & (SUBPIXEL_COUNT - 1);
-                int ye = currentEdge->mLastLine & (SUBPIXEL_COUNT - 1);
+                if (polygon.mIsRectangle)
+                {
+                    fillRectangleSpan(row,polygon.mRectangle,y,polygon.mColor,gammaColor);
+                    continue;
+                }
 
-                SUBPIXEL_DATA mask = 1 << ys;
-                int ySub;
-                for (ySub = ys; ySub <= ye; ySub++)
+                if (polygon.mIsConvex)
                 {
-                    int xp = FIXED_TO_INT(x + offsets[ySub]);
-                    mMaskBuffer[xp] ^= mask;
-                    mask <<= 1;
-                    x += slope;
+                    renderSceneConvexEdges(polygon,sampleSpan,y);
+                    if (sampleSpan.mFirstSub <= sampleSpan.mLastSub)
+                        fillSampleSpan(row,sampleSpan,polygon.mColor,gammaColor);
+                    continue;
                 }
 
-                // Last x-value rounded down.
-                int xe = FIXED_TO_INT(x - slope);
+                edgeExtents.reset();
+                renderScenePolygonEdges(polygon,edgeExtents,y);
 
-                // Mark the span.
-                aEdgeExtents.markWithSort(xs,xe);
+                int minX = edgeExtents.mMinimum;
+                int maxX = edgeExtents.mMaximum + 1;
+                if (minX >= maxX)
+                    continue;
 
-                // Ignore the edge (don't add to AET)
+                if (isClipped())
+                {
+                    if (polygon.mFillMode == RENDERER_FILLMODE_EVENODD)
+                        fillEvenOddClippedSpan(row,y,minX,maxX,polygon.mColor,gammaColor);
+                    else
+                        fillNonZeroClippedSpan(row,y,minX,maxX,polygon.mColor,gammaColor);
+                }
+                else
+                {
+                    if (polygon.mFillMode == RENDERER_FILLMODE_EVENODD)
+                        fillEvenOddSpan(row,minX,maxX,polygon.mColor,gammaColor);
+                    else
+                        fillNonZeroSpan(row,minX,maxX,polygon.mColor,gammaColor);
+                }
             }
-            else
+        }
+        else
+        {
+            // Process the polygons front to back. Fully covered pixels are written
+            // directly and marked as occluded, so the polygons behind skip them.
+            // Antialiased pixels are blended afterwards in painter's order.
+            occlusionExtents.reset();
+            mCurrentDeferredPixel = 0;
+
+            for (n = activeCount - 1; n >= 0; n--)
             {
-                FIXED_POINT x = currentEdge->mX;
-                FIXED_POINT slope = currentEdge->mSlope;
+                ScenePolygon &polygon = mScenePolygons[mSceneActivePolygons[n]];
 
-                // First x value rounded down.
-                int xs = FIXED_TO_INT(x);
+                edgeExtents.reset();
+                renderScenePolygonEdges(polygon,edgeExtents,y);
 
-                int ys = currentEdge->mFirstLine & (SUBPIXEL_COUNT - 1);
+                int minX = edgeExtents.mMinimum;
+                int maxX = edgeExtents.mMaximum + 1;
+                if (minX >= maxX)
+                    continue;
 
-                SUBPIXEL_DATA mask = 1 << ys;
-                int ySub;
-                for (ySub = ys; ySub < SUBPIXEL_COUNT; ySub++)
+                // Skip the span if it is already fully covered. The mask still has to
+                // be cleared for the following polygons.
+                bool occluded = findUnoccludedPixel(minX) > maxX;
+                if (occluded ||
+                    !resizeDeferredPixels(mCurrentDeferredPixel + maxX - minX + 1))
                 {
-                    int xp = FIXED_TO_INT(x + offsets[ySub]);
-                    mMaskBuffer[xp] ^= mask;
-                    mask <<= 1;
-                    x += slope;
+                    if (polygon.mFillMode == RENDERER_FILLMODE_EVENODD)
+                        MEMSET(&mMaskBuffer[minX],0,(maxX - minX + 2) * sizeof(SUBPIXEL_DATA));
+                    else
+                        MEMSET(&mWindingBuffer[minX],0,(maxX - minX + 2) * sizeof(NonZeroPackedMask));
+
+                    if (occluded)
+                        continue;
+
+                    // The polygons behind this one cannot be blended in the right
+                    // order without the deferred pixels, so the rendering is stopped.
+                    // The tables are reset for the next scene.
+                    int x;
+                    for (x = occlusionExtents.mMinimum; x <= occlusionExtents.mMaximum; x++)
+                        mOcclusionBuffer[x] = x;
+                    mCurrentDeferredPixel = 0;
+
+                    for (y = y + 1; y <= sceneExtents.mMaximum; y++)
+                        mSceneStartTable[y] = -1;
+
+                    return false;
                 }
 
-                // Last x-value rounded down.
-                int xe = FIXED_TO_INT(x - slope);
-
-                // Mark the span.
-                aEdgeExtents.markWithSort(xs,xe);
-
-                // Update the edge
-                currentEdge->mX = x;
-
-                // Add the edge to AET
-                if (prevEdge)
-                    prevEdge->mNextEdge = currentEdge;
+                if (polygon.mFillMode == RENDERER_FILLMODE_EVENODD)
+                    fillEvenOddOccludedSpan(row,minX,maxX,polygon.mColor,occlusionExtents);
                 else
-                    aActiveEdgeTable = currentEdge;
-
-                prevEdge = currentEdge;
+                    fillNonZeroOccludedSpan(row,minX,maxX,polygon.mColor,occlusionExtents);
             }
-        
-            currentEdge = currentEdge->mNextEdge;
+
+            blendDeferredPixels(row);
+
+            // Reset the occlusion buffer for the next scanline.
+            int x;
+            for (x = occlusionExtents.mMinimum; x <= occlusionExtents.mMaximum; x++)
+                mOcclusionBuffer[x] = x;
         }
-        while (currentEdge);
+
+        row += pitch;
     }
 
-    if (prevEdge)
-        prevEdge->mNextEdge = NULL;
+    return true;
 }
 
 
-//! Renders the mask to the canvas with even-odd fill.
-void PolygonVersionF::fillEvenOdd(BitmapData *aTarget, unsigned long aColor)
+//! Sets the clip rectangle for the polygon filler.
+void PolygonVersionF::setClipRect(unsigned int aX, unsigned int aY, unsigned int aWidth, unsigned int aHeight)
 {
-    int y;
+    unsigned int x = aX;
+    unsigned int y = aY;
 
-    int minY = mVerticalExtents.mMinimum;
-    int maxY = mVerticalExtents.mMaximum;
+    if (x > mWidth)
+        x = mWidth;
 
-    unsigned long cs1 = aColor & 0xff00ff;
-    unsigned long cs2 = (aColor >> 8) & 0xff00ff;
+    if (y > mHeight)
+        y = mHeight;
 
-    unsigned int pitch = aTarget->mPitch / 4;
-    unsigned long *target = &aTarget->mData[minY * pitch];
+    unsigned int maxX = x + aWidth;
+    unsigned int maxY = y + aHeight;
 
-    PolygonScanEdge *activeEdges = NULL;
-    SpanExtents edgeExtents;
+    if (maxX > mWidth)
+        maxX = mWidth;
 
-    for (y = minY; y <= maxY; y++)
+    if (maxY > mHeight)
+        maxY = mHeight;
+
+    mClipRect.setClip(x, y, maxX - x, maxY - y, SUBPIXEL_COUNT);
+    mDamageRect.setClip(0,0,mWidth,mHeight,1);
+    mDamageClip = false;
+}
+
+
+//! Limits the rendering to a damaged area of the target.
+/*! Clipping the edges to the area would restart their stepping on the clip
+ *  border and move the samples there. Instead the edges are clipped to the
+ *  clip rectangle as in a full rendering, and the spans are limited to the
+ *  area in the same way as with a clip region.
+ */
+void PolygonVersionF::setDamageRect(unsigned int aX, unsigned int aY, unsigned int aWidth, unsigned int aHeight)
+{
+    unsigned int x = aX;
+    unsigned int y = aY;
+
+    if (x > mWidth)
+        x = mWidth;
+
+    if (y > mHeight)
+        y = mHeight;
+
+    unsigned int maxX = x + aWidth;
+    unsigned int maxY = y + aHeight;
+
+    if (maxX > mWidth)
+        maxX = mWidth;
+
+    if (maxY > mHeight)
+        maxY = mHeight;
+
+    mDamageRect.setClip(x, y, maxX - x, maxY - y, 1);
+
+    // An area covering the clip rectangle does not limit anything.
+    mDamageClip = mDamageRect.getMinXi() > mClipRect.getMinXi() ||
+                  mDamageRect.getMinYi() * SUBPIXEL_COUNT > mClipRect.getMinYi() ||
+                  mDamageRect.getMaxXi() < mClipRect.getMaxXi() ||
+                  mDamageRect.getMaxYi() * SUBPIXEL_COUNT < mClipRect.getMaxYi();
+}
+
+
+//! Replaces the pixels of the damaged area with a color.
+/*! \param aTarget the target bitmap.
+ *  \param aArea the pixel aligned rectangle of the damaged area.
+ *  \param aColor the color for the area.
+ */
+void PolygonVersionF::clearDamageRect(RenderTargetWrapper *aTarget, PolygonWrapper *aArea, PaintWrapper *aColor)
+{
+    BitmapData *target = (BitmapData *)aTarget;
+
+    if (!isSupported(target->mFormat))
+        return;
+
+    if (target->isFloatFormat())
     {
-        edgeExtents.reset();
+        Renderer::clearDamageRect(aTarget,aArea,aColor);
+        return;
+    }
 
-        renderEvenOddEdges(activeEdges,edgeExtents,y);
+    ClipRectangle area = mDamageRect;
+    area.intersect(ClipRectangle(mClipRect.getMinXi(),mClipRect.getMinYi() / SUBPIXEL_COUNT,
+                                 mClipRect.getMaxXi() - mClipRect.getMinXi(),
+                                 (mClipRect.getMaxYi() - mClipRect.getMinYi()) / SUBPIXEL_COUNT,1));
 
-        int minX = edgeExtents.mMinimum;
-        // Offset values are not taken into account when calculating the extents, so add
-        // one to the maximum. This makes sure that full spans are included, as offset
-        // values are in the range of 0 to 1.
-        int maxX = edgeExtents.mMaximum + 1;
+    unsigned long color = ((DefaultPaintWrapper *)aColor)->getColor();
+    unsigned int pitch = target->mPitch / 4;
+    unsigned long *row = &target->mData[area.getMinYi() * pitch];
 
-        if (minX < maxX)
+    int y;
+    for (y = area.getMinYi(); y < area.getMaxYi(); y++)
+    {
+        int x;
+        for (x = area.getMinXi(); x < area.getMaxXi(); x++)
+            row[x] = color;
+        row += pitch;
+    }
+}
+
+
+//! Enables or disables the gamma correct blending of antialiased pixels.
+/*! When enabled, the antialiased pixels are blended in linear light instead
+ *  of sRGB. This makes thin features look correct instead of too dark.
+ */
+bool PolygonVersionF::setGammaCorrection(bool aEnabled)
+{
+    if (aEnabled)
+    {
+        if (mGammaTable == NULL)
+        {
+            mGammaTable = new GammaTable();
+            if (mGammaTable == NULL)
+                return false;
+        }
+    }
+    else
+    {
+        delete mGammaTable;
+        mGammaTable = NULL;
+    }
+
+    return true;
+}
+
+
+//! Enables or disables the occlusion culling in the scene rendering.
+/*! When enabled, renderScene() processes the polygons of each scanline front
+ *  to back and skips the pixels that are already fully covered by the polygons
+ *  in front. The output is identical to the painter's order. Has to be called
+ *  after init().
+ */
+bool PolygonVersionF::setOcclusionCulling(bool aEnabled)
+{
+    if (aEnabled)
+    {
+        if (mOcclusionBuffer == NULL)
+        {
+            mOcclusionBuffer = new int[mBufferWidth];
+            if (mOcclusionBuffer == NULL)
+                return false;
+
+            // Each entry points to the next pixel that is not occluded, so an entry
+            // pointing to itself is not occluded.
+            unsigned int n;
+            for (n = 0; n < mBufferWidth; n++)
+                mOcclusionBuffer[n] = n;
+        }
+    }
+    else
+    {
+        delete[] mOcclusionBuffer;
+        mOcclusionBuffer = NULL;
+    }
+
+    return true;
+}
+
+
+//! Pushes a clip polygon to the clip mask stack.
+/*! The polygon is rasterized once to a coverage mask, which is intersected
+ *  with the mask on top of the stack. The coverage of the following fills is
+ *  multiplied with the mask until it is removed with popClipPolygon(). Has to
+ *  be called after init().
+ *  \param aPolygon the clip polygon.
+ *  \param aTransformation the transformation matrix.
+ *  \param aFillMode the fill mode of the clip polygon.
+ */
+bool PolygonVersionF::pushClipPolygon(const Polygon *aPolygon, const MATRIX2D &aTransformation, RENDERER_FILLMODE aFillMode)
+{
+    if (!resizeClipMasks(mClipMaskCount + 1))
+        return false;
+
+    ClipMask &mask = mClipMasks[mClipMaskCount];
+    if (mask.mRows == NULL)
+    {
+        mask.mRows = new ClipMaskRow[mHeight];
+        if (mask.mRows == NULL)
+            return false;
+    }
+
+    // Sets the round down mode in case it has been modified.
+    setRoundDownMode();
+
+    mVerticalExtents.reset();
+    mCurrentEdge = 0;
+    mCurrentCurveEdge = 0;
+
+    MATRIX2D transform = aTransformation;
+    MATRIX2D_MULTIPLY(transform,mRemappingMatrix);
+
+    // The mask is not limited by the clip rectangle, only by the previous mask.
+    ClipRectangle clipRect;
+    clipRect.setClip(0,0,mWidth,mHeight,SUBPIXEL_COUNT);
+
+    SpanExtents horizontalExtents;
+    SpanExtents verticalExtents;
+    horizontalExtents.reset();
+    verticalExtents.reset();
+
+    if (intersectClipMask(clipRect))
+    {
+        const Polygon *polygon = aPolygon;
+        if (!useCurveEdges(polygon,transform,clipRect))
+            polygon = polygon->getLevel(aTransformation);
+
+        if (!addPolygonEdges(polygon,transform,clipRect))
+        {
+            unsigned int y;
+            for (y = 0; y < mHeight; y++)
+                mEdgeTable[y] = NULL;
+            return false;
+        }
+
+        int minY = mVerticalExtents.mMinimum;
+        int maxY = mVerticalExtents.mMaximum;
+
+        PolygonScanEdge *activeEdges = NULL;
+        SpanExtents edgeExtents;
+        int coverageSize = 0;
+
+        int y;
+        for (y = minY; y <= maxY; y++)
         {
-            unsigned long *tp = &target[minX];
-            SUBPIXEL_DATA *mb = &mMaskBuffer[minX];
-            SUBPIXEL_DATA *end = &mMaskBuffer[maxX + 1];
+            ClipMaskRow &row = mask.mRows[y];
+            row.mMinX = (int)mWidth;
+            row.mMaxX = -1;
+            row.mFullMinX = 0;
+            row.mFullMaxX = -1;
+            row.mOffset = coverageSize;
+
+            edgeExtents.reset();
 
-            // Place a marker data at the end position.
-            // Since marker data is placed after the last entry to be rendered (thus mask is 0),
-            // it forces a state change. This drops the control to the outer while loop, which
-            // terminates because of the compare.
-            *end = SUBPIXEL_FULL_COVERAGE;
+            if (aFillMode == RENDERER_FILLMODE_EVENODD)
+                renderEvenOddEdges(activeEdges,edgeExtents,y);
+            else
+                renderNonZeroEdges(activeEdges,edgeExtents,y);
+
+            int minX = edgeExtents.mMinimum;
+            int maxX = edgeExtents.mMaximum + 1;
+            if (minX >= maxX)
+                continue;
+
+            if (aFillMode == RENDERER_FILLMODE_EVENODD)
+                resolveEvenOddSpan(minX,maxX);
+            else
+                resolveNonZeroSpan(minX,maxX);
 
-            SUBPIXEL_DATA mask = *mb;
-            *mb++ = 0;
+            if (mClipMaskCount > 0)
+                clipMaskSpan(y,minX,maxX);
 
-            while (mb <= end)
+            if (maxX > (int)mWidth - 1)
+                maxX = (int)mWidth - 1;
+
+            // Find the extents and the longest run of full coverage on the scanline.
+            const unsigned char *cb = mCoverageBuffer;
+            int runStart = 0;
+            int x;
+            for (x = minX; x <= maxX; x++)
             {
-                // The straightforward implementation reads in the value, modifies the mask with it,
-                // calculates the coverage from the mask and renders the result with it.
+                unsigned char coverage = cb[x];
+                if (coverage == 0)
+                    continue;
+
+                if (x < row.mMinX)
+                    row.mMinX = x;
+                row.mMaxX = x;
 
-                // Here the mask value is fetched in the previous round. Therefore the write operation
-                // needs to be done before the new mask value is changed. This also means that the
-                // end marker will never be rendered, as the loop terminates before that.
-                if (mask == 0)
+                if (coverage == SUBPIXEL_COUNT)
                 {
-                    // Mask is empty, scan forward until mask changes.
-                    SUBPIXEL_DATA *sb = mb;
-                    do
+                    if (x == minX || cb[x - 1] != SUBPIXEL_COUNT)
+                        runStart = x;
+                    if (x - runStart > row.mFullMaxX - row.mFullMinX)
                     {
-                        mask = *mb++;
+                        row.mFullMinX = runStart;
+                        row.mFullMaxX = x;
                     }
-                    while (mask == 0); // && mb <= end);
-                    mb[-1] = 0;
-                    tp += mb - sb;
                 }
-                else if (mask == SUBPIXEL_FULL_COVERAGE)
+            }
+
+            // A run reaching the right edge is extended over the end of the buffers,
+            // as the spans may extend there even though there is no coverage.
+            if (row.mFullMaxX == (int)mWidth - 1)
+                row.mFullMaxX = mBufferWidth;
+
+            if (row.mMinX <= row.mMaxX)
+            {
+                // Store the coverage between the extents.
+                int width = row.mMaxX - row.mMinX + 1;
+                if (!resizeClipMaskCoverage(mask,coverageSize + width))
                 {
-                    // Mask has full coverage, fill with aColor until mask changes.
-                    SUBPIXEL_DATA temp;
-                    do
-                    {
-#ifdef GATHER_STATISTICS
-                        if (*tp != STATISTICS_BG_COLOR)
-                            mStatistics.mOverdrawPixels++;
-                        mStatistics.mFilledPixels++;
-#endif
-                        *tp++ = aColor;
-                        temp = *mb++;
-                    }
-                    while (temp == 0); // && mb <= end);
-                    mb[-1] = 0;
-                    mask ^= temp;
+                    for (y = 0; y < (int)mHeight; y++)
+                        mEdgeTable[y] = NULL;
+                    return false;
                 }
-                else
-                {
-                    // Mask is semitransparent.
-                    do
-                    {
-#ifdef GATHER_STATISTICS
-                        if (*tp != STATISTICS_BG_COLOR)
-                            mStatistics.mOverdrawPixels++;
-                        mStatistics.mAntialiasPixels++;
-#endif
-                        unsigned long alpha = SUBPIXEL_COVERAGE(mask);
+                MEMCPY(&mask.mCoverage[coverageSize],&cb[row.mMinX],width);
+                coverageSize += width;
+
+                horizontalExtents.mark(row.mMinX,row.mMaxX);
+                verticalExtents.mark(y,y);
+            }
+        }
+    }
 
-                        // alpha is in range of 0 to SUBPIXEL_COUNT
-                        unsigned long invAlpha = SUBPIXEL_COUNT - alpha;
+    mask.mMinX = horizontalExtents.mMinimum;
+    mask.mMaxX = horizontalExtents.mMaximum;
+    mask.mMinY = verticalExtents.mMinimum;
+    mask.mMaxY = verticalExtents.mMaximum;
 
-                        unsigned long ct1 = (*tp & 0xff00ff) * invAlpha;
-                        unsigned long ct2 = ((*tp >> 8) & 0xff00ff) * invAlpha;
+    mClipMaskCount++;
 
-                        ct1 = ((ct1 + cs1 * alpha) >> SUBPIXEL_SHIFT) & 0xff00ff;
-                        ct2 = ((ct2 + cs2 * alpha) << (8 - SUBPIXEL_SHIFT)) & 0xff00ff00;
+    return true;
+}
 
-                        *tp++ = ct1 + ct2;
 
-                        mask ^= *mb;
-                        *mb++ = 0;
-                    }
-                    while (!(mask == 0 || mask == SUBPIXEL_FULL_COVERAGE)); // && mb <= end);
-                }
-            }
-        }
+//! Removes the topmost clip polygon from the clip mask stack.
+void PolygonVersionF::popClipPolygon()
+{
+    // The buffers are kept for the following masks.
+    if (mClipMaskCount > 0)
+        mClipMaskCount--;
+}
 
-        target += pitch;
+
+//! Sets the clip region for the polygon filler.
+/*! The fills are limited to the region in addition to the clip rectangle.
+ *  The edges are clipped once to the bounds of the region, and the spans
+ *  of each scanline are limited to the intervals of the region. The region
+ *  is not copied, so it has to exist as long as it is set. NULL removes
+ *  the region.
+ */
+void PolygonVersionF::setClipRegion(const ClipRegion *aRegion)
+{
+    mClipRegion = aRegion;
+    mClipRegionBand = 0;
+}
+
+
+//! Adds an edge.
+bool PolygonVersionF::addEdge(const PolygonEdge &aEdge)
+{
+    /* Note that this is unused code. Current implementation uses
+       SubPolygon::getScanEdges(). */
+
+    // Enough edges in the storage?
+    if (mCurrentEdge >= mEdgeCount)
+    {
+        // Resize if not, exit if resize fails.
+        // The resizing rule is 1.5 * size + 1
+        if (!resizeEdgeStorage(mEdgeCount / 2 + 1))
+            return false;
     }
+
+    PolygonScanEdge *edge = &mEdgeStorage[mCurrentEdge++];
+
+    edge->mFirstLine = aEdge.mFirstLine;
+    edge->mLastLine = aEdge.mLastLine;
+    edge->mWinding = aEdge.mWinding;
+    edge->mX = rationalToFixed(aEdge.mX);
+    edge->mSlope = rationalToFixed(aEdge.mSlope);
+    edge->mCurve = -1;
+
+    // Calculate the index for first and last line.
+    int firstLine = aEdge.mFirstLine >> SUBPIXEL_SHIFT;
+    int lastLine = aEdge.mLastLine >> SUBPIXEL_SHIFT;
+
+    mVerticalExtents.mark(firstLine,lastLine);
+
+    // Add to the edge table.
+    edge->mNextEdge = mEdgeTable[firstLine];
+    mEdgeTable[firstLine] = edge;
+
+    return true;
 }
 
 
-//! Renders the edges from the current vertical index using non-zero winding fill.
-inline void PolygonVersionF::renderNonZeroEdges(PolygonScanEdge * &aActiveEdgeTable, SpanExtents &aEdgeExtents, int aCurrentLine)
+//! Renders the edges from the current vertical index using even-odd fill.
+inline void PolygonVersionF::renderEvenOddEdges(PolygonScanEdge * &aActiveEdgeTable, SpanExtents &aEdgeExtents, int aCurrentLine)
 {
     static const FIXED_POINT offsets[SUBPIXEL_COUNT] = SUBPIXEL_OFFSETS_FIXED;
 
@@ -710,30 +1150,33 @@ inline void PolygonVersionF::renderNonZeroEdges(PolygonScanEdge * &aActiveEdgeTa
 
         if (lastLine == aCurrentLine)
         {
-            FIXED_POINT x = currentEdge->mX;
-            FIXED_POINT slope = currentEdge->mSlope;
-            NON_ZERO_MASK_DATA_UNIT winding = (NON_ZERO_MASK_DATA_UNIT)currentEdge->mWinding;
+            if (currentEdge->mCurve >= 0)
+                plotEvenOddCurveEdge(currentEdge,aEdgeExtents,aCurrentLine,0,currentEdge->mLastLine & (SUBPIXEL_COUNT - 1));
+            else
+            {
+                FIXED_POINT x = currentEdge->mX;
+                FIXED_POINT slope = currentEdge->mSlope;
 
-            // First x value rounded down.
-            int xs = FIXED_TO_INT(x);
-            int ye = currentEdge->mLastLine & (SUBPIXEL_COUNT - 1);
+                // First x value rounded down.
+                int xs = FIXED_TO_INT(x);
+                int ye = currentEdge->mLastLine & (SUBPIXEL_COUNT - 1);
 
-            SUBPIXEL_DATA mask = 1;
-            int ySub;
-            for (ySub = 0; ySub <= ye; ySub++)
-            {
-                int xp = FIXED_TO_INT(x + offsets[ySub]);
-                mWindingBuffer[xp].mMask |= mask;
-                mWindingBuffer[xp].mBuffer[ySub] += winding;
-                mask <<= 1;
-                x += slope;
-            }
+                SUBPIXEL_DATA mask = 1;
+                int ySub;
+                for (ySub = 0; ySub <= ye; ySub++)
+                {
+                    int xp = FIXED_TO_INT(x + offsets[ySub]);
+                    mMaskBuffer[xp] ^= mask;
+                    mask <<= 1;
+                    x += slope;
+                }
 
-            // Last x-value rounded down.
-            int xe = FIXED_TO_INT(x - slope);
+                // Last x-value rounded down.
+                int xe = FIXED_TO_INT(x - slope);
 
-            // Mark the span.
-            aEdgeExtents.markWithSort(xs,xe);
+                // Mark the span.
+                aEdgeExtents.markWithSort(xs,xe);
+            }
 
             // Remove the edge from the active edge table
             currentEdge = currentEdge->mNextEdge;
@@ -744,69 +1187,74 @@ inline void PolygonVersionF::renderNonZeroEdges(PolygonScanEdge * &aActiveEdgeTa
         }
         else
         {
-            FIXED_POINT x = currentEdge->mX;
-            FIXED_POINT slope = currentEdge->mSlope;
-            NON_ZERO_MASK_DATA_UNIT winding = (NON_ZERO_MASK_DATA_UNIT)currentEdge->mWinding;
+            if (currentEdge->mCurve >= 0)
+                plotEvenOddCurveEdge(currentEdge,aEdgeExtents,aCurrentLine,0,SUBPIXEL_COUNT - 1);
+            else
+            {
+                FIXED_POINT x = currentEdge->mX;
+                FIXED_POINT slope = currentEdge->mSlope;
 
-            // First x value rounded down.
-            int xs = FIXED_TO_INT(x);
-            int xe;
+                // First x value rounded down.
+                int xs = FIXED_TO_INT(x);
+                int xe;
 
-            NONZERO_LINE_UNROLL_INIT();
+                EVENODD_LINE_UNROLL_INIT();
 
-            NONZERO_LINE_UNROLL_0(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_1(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_2(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_3(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_4(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_5(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_6(mWindingBuffer,x,slope,offsets,winding);
+                EVENODD_LINE_UNROLL_0(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_1(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_2(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_3(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_4(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_5(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_6(mMaskBuffer,x,slope,offsets);
 #if SUBPIXEL_COUNT == 8
-            xe = FIXED_TO_INT(x);
+                xe = FIXED_TO_INT(x);
 #endif
-            NONZERO_LINE_UNROLL_7(mWindingBuffer,x,slope,offsets,winding);
+                EVENODD_LINE_UNROLL_7(mMaskBuffer,x,slope,offsets);
 
 #if SUBPIXEL_COUNT > 8
-            NONZERO_LINE_UNROLL_8(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_9(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_10(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_11(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_12(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_13(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_14(mWindingBuffer,x,slope,offsets,winding);
+                EVENODD_LINE_UNROLL_8(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_9(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_10(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_11(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_12(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_13(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_14(mMaskBuffer,x,slope,offsets);
 #if SUBPIXEL_COUNT == 16
-            xe = FIXED_TO_INT(x);
+                xe = FIXED_TO_INT(x);
 #endif
-            NONZERO_LINE_UNROLL_15(mWindingBuffer,x,slope,offsets,winding);
+                EVENODD_LINE_UNROLL_15(mMaskBuffer,x,slope,offsets);
 #endif
 
 #if SUBPIXEL_COUNT > 16
-            NONZERO_LINE_UNROLL_16(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_17(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_18(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_19(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_20(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_21(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_22(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_23(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_24(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_25(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_26(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_27(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_28(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_29(mWindingBuffer,x,slope,offsets,winding);
-            NONZERO_LINE_UNROLL_30(mWindingBuffer,x,slope,offsets,winding);
-            xe = FIXED_TO_INT(x);
-            NONZERO_LINE_UNROLL_31(mWindingBuffer,x,slope,offsets,winding);
+                EVENODD_LINE_UNROLL_16(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_17(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_18(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_19(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_20(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_21(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_22(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_23(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_24(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_25(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_26(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_27(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_28(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_29(mMaskBuffer,x,slope,offsets);
+                EVENODD_LINE_UNROLL_30(mMaskBuffer,x,slope,offsets);
+                xe = FIXED_TO_INT(x);
+                EVENODD_LINE_UNROLL_31(mMaskBuffer,x,slope,offsets);
 #endif
-            // Mark the span.
-            aEdgeExtents.markWithSort(xs,xe);
 
-            // Update the edge
-            if ((aCurrentLine & SLOPE_FIX_SCANLINE_MASK) == 0)
-                currentEdge->mX = x + currentEdge->mSlopeFix;
-            else
-                currentEdge->mX = x;
+                // Mark the span.
+                aEdgeExtents.markWithSort(xs,xe);
+
+                // Update the edge
+                if ((aCurrentLine & SLOPE_FIX_SCANLINE_MASK) == 0)
+                    currentEdge->mX = x + currentEdge->mSlopeFix;
+                else
+                    currentEdge->mX = x;
+            }
 
             // Proceed forward in the AET.
             prevEdge = currentEdge;
@@ -833,65 +1281,71 @@ inline void PolygonVersionF::renderNonZeroEdges(PolygonScanEdge * &aActiveEdgeTa
 
             if (lastLine == aCurrentLine)
             {
-                FIXED_POINT x = currentEdge->mX;
-                FIXED_POINT slope = currentEdge->mSlope;
-                NON_ZERO_MASK_DATA_UNIT winding = (NON_ZERO_MASK_DATA_UNIT)currentEdge->mWinding;
+                if (currentEdge->mCurve >= 0)
+                    plotEvenOddCurveEdge(currentEdge,aEdgeExtents,aCurrentLine,currentEdge->mFirstLine & (SUBPIXEL_COUNT - 1),currentEdge->mLastLine & (SUBPIXEL_COUNT - 1));
+                else
+                {
+                    FIXED_POINT x = currentEdge->mX;
+                    FIXED_POINT slope = currentEdge->mSlope;
 
-                // First x value rounded down.
-                int xs = FIXED_TO_INT(x);
+                    // First x value rounded down.
+                    int xs = FIXED_TO_INT(x);
 
-                int ys = currentEdge->mFirstLine & (SUBPIXEL_COUNT - 1);
-                int ye = currentEdge->mLastLine & (SUBPIXEL_COUNT - 1);
+                    int ys = currentEdge->mFirstLine & (SUBPIXEL_COUNT - 1);
+                    int ye = currentEdge->mLastLine & (SUBPIXEL_COUNT - 1);
 
-                SUBPIXEL_DATA mask = 1 << ys;
-                int ySub;
-                for (ySub = ys; ySub <= ye; ySub++)
-                {
-                    int xp = FIXED_TO_INT(x + offsets[ySub]);
-                    mWindingBuffer[xp].mMask |= mask;
-                    mWindingBuffer[xp].mBuffer[ySub] += winding;
-                    mask <<= 1;
-                    x += slope;
-                }
+                    SUBPIXEL_DATA mask = 1 << ys;
+                    int ySub;
+                    for (ySub = ys; ySub <= ye; ySub++)
+                    {
+                        int xp = FIXED_TO_INT(x + offsets[ySub]);
+                        mMaskBuffer[xp] ^= mask;
+                        mask <<= 1;
+                        x += slope;
+                    }
 
-                // Last x-value rounded down.
-                int xe = FIXED_TO_INT(x - slope);
+                    // Last x-value rounded down.
+                    int xe = FIXED_TO_INT(x - slope);
 
-                // Mark the span.
-                aEdgeExtents.markWithSort(xs,xe);
+                    // Mark the span.
+                    aEdgeExtents.markWithSort(xs,xe);
+                }
 
                 // Ignore the edge (don't add to AET)
             }
             else
             {
-                FIXED_POINT x = currentEdge->mX;
-                FIXED_POINT slope = currentEdge->mSlope;
-                NON_ZERO_MASK_DATA_UNIT winding = (NON_ZERO_MASK_DATA_UNIT)currentEdge->mWinding;
+                if (currentEdge->mCurve >= 0)
+                    plotEvenOddCurveEdge(currentEdge,aEdgeExtents,aCurrentLine,currentEdge->mFirstLine & (SUBPIXEL_COUNT - 1),SUBPIXEL_COUNT - 1);
+                else
+                {
+                    FIXED_POINT x = currentEdge->mX;
+                    FIXED_POINT slope = currentEdge->mSlope;
 
-                // First x value rounded down.
-                int xs = FIXED_TO_INT(x);
+                    // First x value rounded down.
+                    int xs = FIXED_TO_INT(x);
 
-                int ys = currentEdge->mFirstLine & (SUBPIXEL_COUNT - 1);
+                    int ys = currentEdge->mFirstLine & (SUBPIXEL_COUNT - 1);
 
-                SUBPIXEL_DATA mask = 1 << ys;
-                int ySub;
-                for (ySub = ys; ySub < SUBPIXEL_COUNT; ySub++)
-                {
-                    int xp = FIXED_TO_INT(x + offsets[ySub]);
-                    mWindingBuffer[xp].mMask |= mask;
-                    mWindingBuffer[xp].mBuffer[ySub] += winding;
-                    mask <<= 1;
-                    x += slope;
-                }
+                    SUBPIXEL_DATA mask = 1 << ys;
+                    int ySub;
+                    for (ySub = ys; ySub < SUBPIXEL_COUNT; ySub++)
+                    {
+                        int xp = FIXED_TO_INT(x + offsets[ySub]);
+                        mMaskBuffer[xp] ^= mask;
+                        mask <<= 1;
+                        x += slope;
+                    }
 
-                // Last x-value rounded down.
-                int xe = FIXED_TO_INT(x - slope);
+                    // Last x-value rounded down.
+                    int xe = FIXED_TO_INT(x - slope);
 
-                // Mark the span.
-                aEdgeExtents.markWithSort(xs,xe);
+                    // Mark the span.
+                    aEdgeExtents.markWithSort(xs,xe);
 
-                // Update the edge
-                currentEdge->mX = x;
+                    // Update the edge
+                    currentEdge->mX = x;
+                }
 
                 // Add the edge to AET
                 if (prevEdge)
@@ -905,7 +1359,6 @@ inline void PolygonVersionF::renderNonZeroEdges(PolygonScanEdge * &aActiveEdgeTa
             currentEdge = currentEdge->mNextEdge;
         }
         while (currentEdge);
-
     }
 
     if (prevEdge)
@@ -913,23 +1366,161 @@ inline void PolygonVersionF::renderNonZeroEdges(PolygonScanEdge * &aActiveEdgeTa
 }
 
 
-//! Renders the mask to the canvas with non-zero winding fill.
-void PolygonVersionF::fillNonZero(BitmapData *aTarget, unsigned long aColor, const ClipRectangle &aClipRect)
+//! Renders one scanline of the mask to the canvas with even-odd fill.
+/*! \param aTarget the target scanline.
+ *  \param aMinX the first pixel of the span.
+ *  \param aMaxX the last pixel of the span.
+ *  \param aColor the color to be used for rendering.
+ *  \param aGammaColor the gamma correction table for the color, or NULL.
+ */
+inline void PolygonVersionF::fillEvenOddSpan(unsigned long *aTarget, int aMinX, int aMaxX, unsigned long aColor, const GammaColorTable *aGammaColor)
+{
+    unsigned long cs1 = aColor & 0xff00ff;
+    unsigned long cs2 = (aColor >> 8) & 0xff00ff;
+
+    unsigned long *tp = &aTarget[aMinX];
+    SUBPIXEL_DATA *mb = &mMaskBuffer[aMinX];
+    SUBPIXEL_DATA *end = &mMaskBuffer[aMaxX + 1];
+
+    // Place a marker data at the end position.
+    // Since marker data is placed after the last entry to be rendered (thus mask is 0),
+    // it forces a state change. This drops the control to the outer while loop, which
+    // terminates because of the compare.
+    *end = SUBPIXEL_FULL_COVERAGE;
+
+    SUBPIXEL_DATA mask = *mb;
+    *mb++ = 0;
+
+    while (mb <= end)
+    {
+        // The straightforward implementation reads in the value, modifies the mask with it,
+        // calculates the coverage from the mask and renders the result with it.
+
+        // Here the mask value is fetched in the previous round. Therefore the write operation
+        // needs to be done before the new mask value is changed. This also means that the
+        // end marker will never be rendered, as the loop terminates before that.
+        if (mask == 0)
+        {
+            // Mask is empty, scan forward until mask changes.
+            SUBPIXEL_DATA *sb = mb;
+            do
+            {
+                mask = *mb++;
+            }
+            while (mask == 0); // && mb <= end);
+            mb[-1] = 0;
+            tp += mb - sb;
+        }
+        else if (mask == SUBPIXEL_FULL_COVERAGE)
+        {
+            // Mask has full coverage, fill with aColor until mask changes.
+            SUBPIXEL_DATA temp;
+            do
+            {
+#ifdef GATHER_STATISTICS
+                if (*tp != STATISTICS_BG_COLOR)
+                    mStatistics.mOverdrawPixels++;
+                mStatistics.mFilledPixels++;
+#endif
+                *tp++ = aColor;
+                temp = *mb++;
+            }
+            while (temp == 0); // && mb <= end);
+            mb[-1] = 0;
+            mask ^= temp;
+        }
+        else if (aGammaColor)
+        {
+            // Mask is semitransparent, blend in linear light.
+            do
+            {
+#ifdef GATHER_STATISTICS
+                if (*tp != STATISTICS_BG_COLOR)
+                    mStatistics.mOverdrawPixels++;
+                mStatistics.mAntialiasPixels++;
+#endif
+                unsigned long alpha = SUBPIXEL_COVERAGE(mask);
+
+                *tp = mGammaTable->blend(aGammaColor,*tp,alpha);
+                tp++;
+
+                mask ^= *mb;
+                *mb++ = 0;
+            }
+            while (!(mask == 0 || mask == SUBPIXEL_FULL_COVERAGE)); // && mb <= end);
+        }
+        else
+        {
+            // Mask is semitransparent.
+            do
+            {
+#ifdef GATHER_STATISTICS
+                if (*tp != STATISTICS_BG_COLOR)
+                    mStatistics.mOverdrawPixels++;
+                mStatistics.mAntialiasPixels++;
+#endif
+                unsigned long alpha = SUBPIXEL_COVERAGE(mask);
+
+                // alpha is in range of 0 to SUBPIXEL_COUNT
+                unsigned long invAlpha = SUBPIXEL_COUNT - alpha;
+
+                unsigned long ct1 = (*tp & 0xff00ff) * invAlpha;
+                unsigned long ct2 = ((*tp >> 8) & 0xff00ff) * invAlpha;
+
+                ct1 = ((ct1 + cs1 * alpha) >> SUBPIXEL_SHIFT) & 0xff00ff;
+                ct2 = ((ct2 + cs2 * alpha) << (8 - SUBPIXEL_SHIFT)) & 0xff00ff00;
+
+                *tp++ = ct1 + ct2;
+
+                mask ^= *mb;
+                *mb++ = 0;
+            }
+            while (!(mask == 0 || mask == SUBPIXEL_FULL_COVERAGE)); // && mb <= end);
+        }
+    }
+}
+
+
+//! Renders one scanline of the mask to the canvas with even-odd fill, limited by the clip mask and region.
+/*! \param aTarget the target scanline.
+ *  \param aY the index of the scanline.
+ *  \param aMinX the first pixel of the span.
+ *  \param aMaxX the last pixel of the span.
+ *  \param aColor the color to be used for rendering.
+ *  \param aGammaColor the gamma correction table for the color, or NULL.
+ */
+inline void PolygonVersionF::fillEvenOddClippedSpan(unsigned long *aTarget, int aY, int aMinX, int aMaxX, unsigned long aColor, const GammaColorTable *aGammaColor)
+{
+    CLIP_SPAN clip = getClipSpan(aY,aMinX,aMaxX);
+
+    if (clip == CLIP_SPAN_FULL)
+        fillEvenOddSpan(aTarget,aMinX,aMaxX,aColor,aGammaColor);
+    else if (clip == CLIP_SPAN_EMPTY)
+        MEMSET(&mMaskBuffer[aMinX],0,(aMaxX - aMinX + 2) * sizeof(SUBPIXEL_DATA));
+    else
+    {
+        resolveEvenOddSpan(aMinX,aMaxX);
+        clipCoverageSpan(aY,aMinX,aMaxX);
+        blendCoverageSpan(aTarget,aMinX,aMaxX,aColor,aGammaColor);
+    }
+}
+
+
+//! Renders the mask to the canvas with even-odd fill.
+void PolygonVersionF::fillEvenOdd(BitmapData *aTarget, unsigned long aColor)
 {
-    static const FIXED_POINT offsets[SUBPIXEL_COUNT] = SUBPIXEL_OFFSETS_FIXED;
     int y;
 
     int minY = mVerticalExtents.mMinimum;
     int maxY = mVerticalExtents.mMaximum;
 
-    unsigned long cs1 = aColor & 0xff00ff;
-    unsigned long cs2 = (aColor >> 8) & 0xff00ff;
+    const GammaColorTable *gammaColor = NULL;
+    if (mGammaTable)
+        gammaColor = mGammaTable->getColorTable(aColor);
 
     unsigned int pitch = aTarget->mPitch / 4;
     unsigned long *target = &aTarget->mData[minY * pitch];
 
-    NonZeroMask values;
-
     PolygonScanEdge *activeEdges = NULL;
     SpanExtents edgeExtents;
 
@@ -937,7 +1528,7 @@ void PolygonVersionF::fillNonZero(BitmapData *aTarget, unsigned long aColor, con
     {
         edgeExtents.reset();
 
-        renderNonZeroEdges(activeEdges,edgeExtents,y);
+        renderEvenOddEdges(activeEdges,edgeExtents,y);
 
         int minX = edgeExtents.mMinimum;
         // Offset values are not taken into account when calculating the extents, so add
@@ -947,140 +1538,2469 @@ void PolygonVersionF::fillNonZero(BitmapData *aTarget, unsigned long aColor, con
 
         if (minX < maxX)
         {
-            unsigned long *tp = &target[minX];
-            NonZeroMask *wb = &mWindingBuffer[minX];
-            NonZeroMask *end = &mWindingBuffer[maxX + 1];
+            if (isClipped())
+                fillEvenOddClippedSpan(target,y,minX,maxX,aColor,gammaColor);
+            else
+                fillEvenOddSpan(target,minX,maxX,aColor,gammaColor);
+        }
+
+        target += pitch;
+    }
+}
+
+
+//! Renders the edges from the current vertical index using non-zero winding fill.
+inline void PolygonVersionF::renderNonZeroEdges(PolygonScanEdge * &aActiveEdgeTable, SpanExtents &aEdgeExtents, int aCurrentLine)
+{
+    static const FIXED_POINT offsets[SUBPIXEL_COUNT] = SUBPIXEL_OFFSETS_FIXED;
+
+    // First, process edges in the active edge table. These are either full height edges
+    // or edges that end before the last line. Remove those that end within the scan line.
+
+    // Then, fetch the edges from the edge table. These are either such that the edge is
+    // fully within this scanline or the edge starts from within the scanline and continues
+    // to the next scanline. Add those that continue to the next scanline to the active
+    // edge table. Clear the edge table.
 
-            // Place a marker data at the end position.
-            // Since marker data is placed after the last entry to be rendered (thus mask is 0),
-            // it forces a state change. This drops the control to the outer while loop, which
-            // terminates because of the compare.
-            MEMSET(end,0xff,sizeof(NonZeroMask));
+    PolygonScanEdge *prevEdge = NULL;
+    PolygonScanEdge *currentEdge = aActiveEdgeTable;
+
+    while (currentEdge)
+    {
+        // The plotting of all edges in the AET starts from the top of the scanline.
+        // The plotting is divided to two stages: those that end on this scanline and
+        // those that span over the full scanline.
 
-            NonZeroMask *temp = wb++;
-            NonZeroMaskC::reset(*temp,values);
+        int lastLine = currentEdge->mLastLine >> SUBPIXEL_SHIFT;
 
-            while (wb <= end)
+        if (lastLine == aCurrentLine)
+        {
+            if (currentEdge->mCurve >= 0)
+                plotNonZeroCurveEdge(currentEdge,aEdgeExtents,aCurrentLine,0,currentEdge->mLastLine & (SUBPIXEL_COUNT - 1));
+            else
             {
-                // The straightforward implementation reads in the value, modifies the mask with it,
-                // calculates the coverage from the mask and renders the result with it.
+                FIXED_POINT x = currentEdge->mX;
+                FIXED_POINT slope = currentEdge->mSlope;
+                int winding = currentEdge->mWinding;
+
+                // First x value rounded down.
+                int xs = FIXED_TO_INT(x);
+                int ye = currentEdge->mLastLine & (SUBPIXEL_COUNT - 1);
 
-                // Here the mask value is fetched in the previous round. Therefore the write operation
-                // needs to be done before the new mask value is changed. This also means that the
-                // end marker will never be rendered, as the loop terminates before that.
-                if (values.mMask == 0)
+                int ySub;
+                for (ySub = 0; ySub <= ye; ySub++)
                 {
-                    do
-                    {
-                        // Mask is empty, scan forward until mask changes.
-                        NonZeroMask *sb = wb;
-                        do
-                        {
-                            temp = wb++;
-                        }
-                        while (temp->mMask == 0 && wb <= end);
-
-                        int count = wb - sb;
-                        tp += count;
-
-                        NonZeroMaskC::init(*temp,values);
-                    }
-                    while (values.mMask == 0); // && wb <= end);
+                    int xp = FIXED_TO_INT(x + offsets[ySub]);
+                    NonZeroMaskD::plot(mWindingBuffer[xp],ySub,winding);
+                    x += slope;
                 }
-                else if (values.mMask == SUBPIXEL_FULL_COVERAGE)
-                {
-                    do
-                    {
-#ifdef GATHER_STATISTICS
-                        if (*tp != STATISTICS_BG_COLOR)
-                            mStatistics.mOverdrawPixels++;
-                        mStatistics.mFilledPixels++;
-#endif
 
-                        // Mask has full coverage, fill with aColor until mask changes.
-                        *tp++ = aColor;
-                        temp = wb++;
+                // Last x-value rounded down.
+                int xe = FIXED_TO_INT(x - slope);
 
-                        if (temp->mMask)
-                        {
-                            NonZeroMaskC::apply(*temp,values);
+                // Mark the span.
+                aEdgeExtents.markWithSort(xs,xe);
+            }
 
-                            // A safeguard is needed if the winding value overflows and end marker is not
-                            // detected correctly
-                            if (wb > end)
-                                break;
-                        }
-                    }
-                    while (values.mMask == SUBPIXEL_FULL_COVERAGE); // && wb <= end);
+            // Remove the edge from the active edge table
+            currentEdge = currentEdge->mNextEdge;
+            if (prevEdge)
+                prevEdge->mNextEdge = currentEdge;
+            else
+                aActiveEdgeTable = currentEdge;
+        }
+        else
+        {
+            if (currentEdge->mCurve >= 0)
+                plotNonZeroCurveEdge(currentEdge,aEdgeExtents,aCurrentLine,0,SUBPIXEL_COUNT - 1);
+            else
+            {
+                FIXED_POINT x = currentEdge->mX;
+                FIXED_POINT slope = currentEdge->mSlope;
+                int winding = currentEdge->mWinding;
+
+                // First x value rounded down.
+                int xs = FIXED_TO_INT(x);
+
+                int ySub;
+                for (ySub = 0; ySub < SUBPIXEL_COUNT; ySub++)
+                {
+                    int xp = FIXED_TO_INT(x + offsets[ySub]);
+                    NonZeroMaskD::plot(mWindingBuffer[xp],ySub,winding);
+                    x += slope;
                 }
+
+                // Last x-value rounded down.
+                int xe = FIXED_TO_INT(x - slope);
+
+                // Mark the span.
+                aEdgeExtents.markWithSort(xs,xe);
+
+                // Update the edge
+                if ((aCurrentLine & SLOPE_FIX_SCANLINE_MASK) == 0)
+                    currentEdge->mX = x + currentEdge->mSlopeFix;
+                else
+                    currentEdge->mX = x;
+            }
+
+            // Proceed forward in the AET.
+            prevEdge = currentEdge;
+            currentEdge = currentEdge->mNextEdge;
+        }
+    }
+
+    // Fetch edges from the edge table.
+    currentEdge = mEdgeTable[aCurrentLine];
+
+    if (currentEdge)
+    {
+        // Clear the edge table for this line.
+        mEdgeTable[aCurrentLine] = NULL;
+
+        do
+        {
+            // The plotting of all edges in the edge table starts somewhere from the middle
+            // of the scanline, and ends either at the end or at the last scanline. This leads
+            // to two cases: either the scanning starts and stops within this scanline, or
+            // it continues to the next as well.
+
+            int lastLine = currentEdge->mLastLine >> SUBPIXEL_SHIFT;
+
+            if (lastLine == aCurrentLine)
+            {
+                if (currentEdge->mCurve >= 0)
+                    plotNonZeroCurveEdge(currentEdge,aEdgeExtents,aCurrentLine,currentEdge->mFirstLine & (SUBPIXEL_COUNT - 1),currentEdge->mLastLine & (SUBPIXEL_COUNT - 1));
                 else
                 {
-                    // Mask is semitransparent.
-                    unsigned long alpha = SUBPIXEL_COVERAGE(values.mMask);
+                    FIXED_POINT x = currentEdge->mX;
+                    FIXED_POINT slope = currentEdge->mSlope;
+                    int winding = currentEdge->mWinding;
 
-                    // alpha is in range of 0 to SUBPIXEL_COUNT
-                    unsigned long invAlpha = SUBPIXEL_COUNT - alpha;
-                    unsigned long cs1a = cs1 * alpha;
-                    unsigned long cs2a = cs2 * alpha;
+                    // First x value rounded down.
+                    int xs = FIXED_TO_INT(x);
 
-                    do
+                    int ys = currentEdge->mFirstLine & (SUBPIXEL_COUNT - 1);
+                    int ye = currentEdge->mLastLine & (SUBPIXEL_COUNT - 1);
+
+                    int ySub;
+                    for (ySub = ys; ySub <= ye; ySub++)
                     {
-#ifdef GATHER_STATISTICS
-                        if (*tp != STATISTICS_BG_COLOR)
-                            mStatistics.mOverdrawPixels++;
-                        mStatistics.mAntialiasPixels++;
-#endif
+                        int xp = FIXED_TO_INT(x + offsets[ySub]);
+                        NonZeroMaskD::plot(mWindingBuffer[xp],ySub,winding);
+                        x += slope;
+                    }
 
-                        unsigned long ct1 = (*tp & 0xff00ff) * invAlpha;
-                        unsigned long ct2 = ((*tp >> 8) & 0xff00ff) * invAlpha;
+                    // Last x-value rounded down.
+                    int xe = FIXED_TO_INT(x - slope);
 
-                        ct1 = ((ct1 + cs1a) >> SUBPIXEL_SHIFT) & 0xff00ff;
-                        ct2 = ((ct2 + cs2a) << (8 - SUBPIXEL_SHIFT)) & 0xff00ff00;
+                    // Mark the span.
+                    aEdgeExtents.markWithSort(xs,xe);
+                }
 
-                        *tp++ = ct1 + ct2;
+                // Ignore the edge (don't add to AET)
+            }
+            else
+            {
+                if (currentEdge->mCurve >= 0)
+                    plotNonZeroCurveEdge(currentEdge,aEdgeExtents,aCurrentLine,currentEdge->mFirstLine & (SUBPIXEL_COUNT - 1),SUBPIXEL_COUNT - 1);
+                else
+                {
+                    FIXED_POINT x = currentEdge->mX;
+                    FIXED_POINT slope = currentEdge->mSlope;
+                    int winding = currentEdge->mWinding;
 
-                        temp = wb++;
-                        if (temp->mMask)
-                        {
-                            NonZeroMaskC::apply(*temp,values);
+                    // First x value rounded down.
+                    int xs = FIXED_TO_INT(x);
 
-                            alpha = SUBPIXEL_COVERAGE(values.mMask);
-                            invAlpha = SUBPIXEL_COUNT - alpha;
-                            cs1a = cs1 * alpha;
-                            cs2a = cs2 * alpha;
+                    int ys = currentEdge->mFirstLine & (SUBPIXEL_COUNT - 1);
 
-                            // A safeguard is needed if the winding value overflows and end marker is not
-                            // detected correctly
-                            if (wb > end)
-                                break;
-                        }
+                    int ySub;
+                    for (ySub = ys; ySub < SUBPIXEL_COUNT; ySub++)
+                    {
+                        int xp = FIXED_TO_INT(x + offsets[ySub]);
+                        NonZeroMaskD::plot(mWindingBuffer[xp],ySub,winding);
+                        x += slope;
                     }
-                    while (values.mMask != 0 && values.mMask != SUBPIXEL_FULL_COVERAGE); // && wb <= end);
+
+                    // Last x-value rounded down.
+                    int xe = FIXED_TO_INT(x - slope);
+
+                    // Mark the span.
+                    aEdgeExtents.markWithSort(xs,xe);
+
+                    // Update the edge
+                    currentEdge->mX = x;
                 }
+
+                // Add the edge to AET
+                if (prevEdge)
+                    prevEdge->mNextEdge = currentEdge;
+                else
+                    aActiveEdgeTable = currentEdge;
+
+                prevEdge = currentEdge;
             }
+        
+            currentEdge = currentEdge->mNextEdge;
         }
+        while (currentEdge);
 
-        target += pitch;
     }
 
+    if (prevEdge)
+        prevEdge->mNextEdge = NULL;
 }
 
 
-//! Checks if a surface format is supported.
-bool PolygonVersionF::isSupported(BitmapData::BitmapFormat aFormat)
+//! Renders one scanline of the winding buffer to the canvas with non-zero winding fill.
+/*! \param aTarget the target scanline.
+ *  \param aMinX the first pixel of the span.
+ *  \param aMaxX the last pixel of the span.
+ *  \param aColor the color to be used for rendering.
+ *  \param aGammaColor the gamma correction table for the color, or NULL.
+ */
+inline void PolygonVersionF::fillNonZeroSpan(unsigned long *aTarget, int aMinX, int aMaxX, unsigned long aColor, const GammaColorTable *aGammaColor)
 {
-    // Only non-alpha target formats are supported.
-    if (aFormat == BitmapData::BITMAP_FORMAT_XRGB ||
-        aFormat == BitmapData::BITMAP_FORMAT_XBGR ||
-        aFormat == BitmapData::BITMAP_FORMAT_RGBX ||
-        aFormat == BitmapData::BITMAP_FORMAT_BGRX)
-    {
-        return true;
-    }
-    else
+    unsigned long cs1 = aColor & 0xff00ff;
+    unsigned long cs2 = (aColor >> 8) & 0xff00ff;
+
+    NonZeroPackedSum values;
+    SUBPIXEL_DATA mask;
+
+    unsigned long *tp = &aTarget[aMinX];
+    NonZeroPackedMask *wb = &mWindingBuffer[aMinX];
+    NonZeroPackedMask *end = &mWindingBuffer[aMaxX + 1];
+
+    // Place a marker data at the end position.
+    // Since marker data is placed after the last entry to be rendered (thus mask is 0),
+    // it forces a state change. This drops the control to the outer while loop, which
+    // terminates because of the compare.
+    MEMSET(end,0xff,sizeof(NonZeroPackedMask));
+
+    NonZeroPackedMask *temp = wb++;
+    mask = NonZeroMaskD::init(*temp,values);
+
+    while (wb <= end)
     {
-        return false;
-    }
+        // The straightforward implementation reads in the value, modifies the mask with it,
+        // calculates the coverage from the mask and renders the result with it.
+
+        // Here the mask value is fetched in the previous round. Therefore the write operation
+        // needs to be done before the new mask value is changed. This also means that the
+        // end marker will never be rendered, as the loop terminates before that.
+        if (mask == 0)
+        {
+            do
+            {
+                // Mask is empty, scan forward until mask changes.
+                NonZeroPackedMask *sb = wb;
+                do
+                {
+                    temp = wb++;
+                }
+                while (NonZeroMaskD::isEmpty(*temp) && wb <= end);
+
+                int count = wb - sb;
+                tp += count;
+
+                mask = NonZeroMaskD::init(*temp,values);
+            }
+            while (mask == 0); // && wb <= end);
+        }
+        else if (mask == SUBPIXEL_FULL_COVERAGE)
+        {
+            do
+            {
+#ifdef GATHER_STATISTICS
+                if (*tp != STATISTICS_BG_COLOR)
+                    mStatistics.mOverdrawPixels++;
+                mStatistics.mFilledPixels++;
+#endif
+
+                // Mask has full coverage, fill with aColor until mask changes.
+                *tp++ = aColor;
+                temp = wb++;
+
+                if (!NonZeroMaskD::isEmpty(*temp))
+                {
+                    mask = NonZeroMaskD::apply(*temp,values,mask);
+
+                    // A safeguard is needed if the winding value overflows and end marker is not
+                    // detected correctly
+                    if (wb > end)
+                        break;
+                }
+            }
+            while (mask == SUBPIXEL_FULL_COVERAGE); // && wb <= end);
+        }
+        else if (aGammaColor)
+        {
+            // Mask is semitransparent, blend in linear light.
+            unsigned long alpha = SUBPIXEL_COVERAGE(mask);
+
+            do
+            {
+#ifdef GATHER_STATISTICS
+                if (*tp != STATISTICS_BG_COLOR)
+                    mStatistics.mOverdrawPixels++;
+                mStatistics.mAntialiasPixels++;
+#endif
+
+                *tp = mGammaTable->blend(aGammaColor,*tp,alpha);
+                tp++;
+
+                temp = wb++;
+                if (!NonZeroMaskD::isEmpty(*temp))
+                {
+                    mask = NonZeroMaskD::apply(*temp,values,mask);
+
+                    alpha = SUBPIXEL_COVERAGE(mask);
+
+                    // A safeguard is needed if the winding value overflows and end marker is not
+                    // detected correctly
+                    if (wb > end)
+                        break;
+                }
+            }
+            while (mask != 0 && mask != SUBPIXEL_FULL_COVERAGE); // && wb <= end);
+        }
+        else
+        {
+            // Mask is semitransparent.
+            unsigned long alpha = SUBPIXEL_COVERAGE(mask);
+
+            // alpha is in range of 0 to SUBPIXEL_COUNT
+            unsigned long invAlpha = SUBPIXEL_COUNT - alpha;
+            unsigned long cs1a = cs1 * alpha;
+            unsigned long cs2a = cs2 * alpha;
+
+            do
+            {
+#ifdef GATHER_STATISTICS
+                if (*tp != STATISTICS_BG_COLOR)
+                    mStatistics.mOverdrawPixels++;
+                mStatistics.mAntialiasPixels++;
+#endif
+
+                unsigned long ct1 = (*tp & 0xff00ff) * invAlpha;
+                unsigned long ct2 = ((*tp >> 8) & 0xff00ff) * invAlpha;
+
+                ct1 = ((ct1 + cs1a) >> SUBPIXEL_SHIFT) & 0xff00ff;
+                ct2 = ((ct2 + cs2a) << (8 - SUBPIXEL_SHIFT)) & 0xff00ff00;
+
+                *tp++ = ct1 + ct2;
+
+                temp = wb++;
+                if (!NonZeroMaskD::isEmpty(*temp))
+                {
+                    mask = NonZeroMaskD::apply(*temp,values,mask);
+
+                    alpha = SUBPIXEL_COVERAGE(mask);
+                    invAlpha = SUBPIXEL_COUNT - alpha;
+                    cs1a = cs1 * alpha;
+                    cs2a = cs2 * alpha;
+
+                    // A safeguard is needed if the winding value overflows and end marker is not
+                    // detected correctly
+                    if (wb > end)
+                        break;
+                }
+            }
+            while (mask != 0 && mask != SUBPIXEL_FULL_COVERAGE); // && wb <= end);
+        }
+    }
+}
+
+
+//! Renders one scanline of the winding buffer to the canvas with non-zero winding fill, limited by the clip mask and region.
+/*! \param aTarget the target scanline.
+ *  \param aY the index of the scanline.
+ *  \param aMinX the first pixel of the span.
+ *  \param aMaxX the last pixel of the span.
+ *  \param aColor the color to be used for rendering.
+ *  \param aGammaColor the gamma correction table for the color, or NULL.
+ */
+inline void PolygonVersionF::fillNonZeroClippedSpan(unsigned long *aTarget, int aY, int aMinX, int aMaxX, unsigned long aColor, const GammaColorTable *aGammaColor)
+{
+    CLIP_SPAN clip = getClipSpan(aY,aMinX,aMaxX);
+
+    if (clip == CLIP_SPAN_FULL)
+        fillNonZeroSpan(aTarget,aMinX,aMaxX,aColor,aGammaColor);
+    else if (clip == CLIP_SPAN_EMPTY)
+        MEMSET(&mWindingBuffer[aMinX],0,(aMaxX - aMinX + 2) * sizeof(NonZeroPackedMask));
+    else
+    {
+        resolveNonZeroSpan(aMinX,aMaxX);
+        clipCoverageSpan(aY,aMinX,aMaxX);
+        blendCoverageSpan(aTarget,aMinX,aMaxX,aColor,aGammaColor);
+    }
+}
+
+
+//! Renders the mask to the canvas with non-zero winding fill.
+void PolygonVersionF::fillNonZero(BitmapData *aTarget, unsigned long aColor, const ClipRectangle &aClipRect)
+{
+    int y;
+
+    int minY = mVerticalExtents.mMinimum;
+    int maxY = mVerticalExtents.mMaximum;
+
+    const GammaColorTable *gammaColor = NULL;
+    if (mGammaTable)
+        gammaColor = mGammaTable->getColorTable(aColor);
+
+    unsigned int pitch = aTarget->mPitch / 4;
+    unsigned long *target = &aTarget->mData[minY * pitch];
+
+    PolygonScanEdge *activeEdges = NULL;
+    SpanExtents edgeExtents;
+
+    for (y = minY; y <= maxY; y++)
+    {
+        edgeExtents.reset();
+
+        renderNonZeroEdges(activeEdges,edgeExtents,y);
+
+        int minX = edgeExtents.mMinimum;
+        // Offset values are not taken into account when calculating the extents, so add
+        // one to the maximum. This makes sure that full spans are included, as offset
+        // values are in the range of 0 to 1.
+        int maxX = edgeExtents.mMaximum + 1;
+
+        if (minX < maxX)
+        {
+            if (isClipped())
+                fillNonZeroClippedSpan(target,y,minX,maxX,aColor,gammaColor);
+            else
+                fillNonZeroSpan(target,minX,maxX,aColor,gammaColor);
+        }
+
+        target += pitch;
+    }
+
+}
+
+
+//! Renders one scanline of the mask to the canvas with even-odd fill, skipping occluded pixels.
+/*! Fully covered pixels that are not occluded are written to the target and marked
+ *  as occluded. Antialiased pixels that are not occluded are added to the deferred
+ *  pixels. The caller has to make sure that there is room for aMaxX - aMinX + 1
+ *  deferred pixels.
+ *  \param aTarget the target scanline.
+ *  \param aMinX the first pixel of the span.
+ *  \param aMaxX the last pixel of the span.
+ *  \param aColor the color to be used for rendering.
+ *  \param aOcclusionExtents the extents of the occluded pixels on the scanline.
+ */
+inline void PolygonVersionF::fillEvenOddOccludedSpan(unsigned long *aTarget, int aMinX, int aMaxX, unsigned long aColor, SpanExtents &aOcclusionExtents)
+{
+    int *ob = mOcclusionBuffer;
+    SceneDeferredPixel *dp = &mDeferredPixels[mCurrentDeferredPixel];
+
+    int x = aMinX;
+    SUBPIXEL_DATA *mb = &mMaskBuffer[aMinX];
+    SUBPIXEL_DATA *end = &mMaskBuffer[aMaxX + 1];
+
+    // Place a marker data at the end position, see fillEvenOddSpan().
+    *end = SUBPIXEL_FULL_COVERAGE;
+
+    SUBPIXEL_DATA mask = *mb;
+    *mb++ = 0;
+
+    while (mb <= end)
+    {
+        if (mask == 0)
+        {
+            // Mask is empty, scan forward until mask changes.
+            SUBPIXEL_DATA *sb = mb;
+            do
+            {
+                mask = *mb++;
+            }
+            while (mask == 0);
+            mb[-1] = 0;
+            x += mb - sb;
+        }
+        else if (mask == SUBPIXEL_FULL_COVERAGE)
+        {
+            // Mask has full coverage, fill the pixels that are not occluded.
+            int firstX = x;
+            SUBPIXEL_DATA temp;
+            do
+            {
+                if (ob[x] == x)
+                {
+#ifdef GATHER_STATISTICS
+                    if (aTarget[x] != STATISTICS_BG_COLOR)
+                        mStatistics.mOverdrawPixels++;
+                    mStatistics.mFilledPixels++;
+#endif
+                    aTarget[x] = aColor;
+                    ob[x] = x + 1;
+                }
+                x++;
+                temp = *mb++;
+            }
+            while (temp == 0);
+            mb[-1] = 0;
+            mask ^= temp;
+
+            aOcclusionExtents.mark(firstX,x - 1);
+        }
+        else
+        {
+            // Mask is semitransparent, defer the pixels that are not occluded.
+            do
+            {
+                if (ob[x] == x)
+                {
+                    dp->mX = x;
+                    dp->mAlpha = SUBPIXEL_COVERAGE(mask);
+                    dp->mColor = aColor;
+                    dp++;
+                }
+                x++;
+
+                mask ^= *mb;
+                *mb++ = 0;
+            }
+            while (!(mask == 0 || mask == SUBPIXEL_FULL_COVERAGE));
+        }
+    }
+
+    mCurrentDeferredPixel = dp - mDeferredPixels;
+}
+
+
+//! Renders one scanline of the winding buffer to the canvas with non-zero winding fill, skipping occluded pixels.
+/*! Fully covered pixels that are not occluded are written to the target and marked
+ *  as occluded. Antialiased pixels that are not occluded are added to the deferred
+ *  pixels. The caller has to make sure that there is room for aMaxX - aMinX + 1
+ *  deferred pixels.
+ *  \param aTarget the target scanline.
+ *  \param aMinX the first pixel of the span.
+ *  \param aMaxX the last pixel of the span.
+ *  \param aColor the color to be used for rendering.
+ *  \param aOcclusionExtents the extents of the occluded pixels on the scanline.
+ */
+inline void PolygonVersionF::fillNonZeroOccludedSpan(unsigned long *aTarget, int aMinX, int aMaxX, unsigned long aColor, SpanExtents &aOcclusionExtents)
+{
+    int *ob = mOcclusionBuffer;
+    SceneDeferredPixel *dp = &mDeferredPixels[mCurrentDeferredPixel];
+
+    NonZeroPackedSum values;
+    SUBPIXEL_DATA mask;
+
+    int x = aMinX;
+    NonZeroPackedMask *wb = &mWindingBuffer[aMinX];
+    NonZeroPackedMask *end = &mWindingBuffer[aMaxX + 1];
+
+    // Place a marker data at the end position, see fillNonZeroSpan().
+    MEMSET(end,0xff,sizeof(NonZeroPackedMask));
+
+    NonZeroPackedMask *temp = wb++;
+    mask = NonZeroMaskD::init(*temp,values);
+
+    while (wb <= end)
+    {
+        if (mask == 0)
+        {
+            do
+            {
+                // Mask is empty, scan forward until mask changes.
+                NonZeroPackedMask *sb = wb;
+                do
+                {
+                    temp = wb++;
+                }
+                while (NonZeroMaskD::isEmpty(*temp) && wb <= end);
+
+                x += wb - sb;
+
+                mask = NonZeroMaskD::init(*temp,values);
+            }
+            while (mask == 0);
+        }
+        else if (mask == SUBPIXEL_FULL_COVERAGE)
+        {
+            // Mask has full coverage, fill the pixels that are not occluded.
+            int firstX = x;
+            do
+            {
+                if (ob[x] == x)
+                {
+#ifdef GATHER_STATISTICS
+                    if (aTarget[x] != STATISTICS_BG_COLOR)
+                        mStatistics.mOverdrawPixels++;
+                    mStatistics.mFilledPixels++;
+#endif
+                    aTarget[x] = aColor;
+                    ob[x] = x + 1;
+                }
+                x++;
+
+                temp = wb++;
+                if (!NonZeroMaskD::isEmpty(*temp))
+                {
+                    mask = NonZeroMaskD::apply(*temp,values,mask);
+
+                    // A safeguard is needed if the winding value overflows and end marker is not
+                    // detected correctly
+                    if (wb > end)
+                        break;
+                }
+            }
+            while (mask == SUBPIXEL_FULL_COVERAGE);
+
+            aOcclusionExtents.mark(firstX,x - 1);
+        }
+        else
+        {
+            // Mask is semitransparent, defer the pixels that are not occluded.
+            do
+            {
+                if (ob[x] == x)
+                {
+                    dp->mX = x;
+                    dp->mAlpha = SUBPIXEL_COVERAGE(mask);
+                    dp->mColor = aColor;
+                    dp++;
+                }
+                x++;
+
+                temp = wb++;
+                if (!NonZeroMaskD::isEmpty(*temp))
+                {
+                    mask = NonZeroMaskD::apply(*temp,values,mask);
+
+                    // A safeguard is needed if the winding value overflows and end marker is not
+                    // detected correctly
+                    if (wb > end)
+                        break;
+                }
+            }
+            while (mask != 0 && mask != SUBPIXEL_FULL_COVERAGE);
+        }
+    }
+
+    mCurrentDeferredPixel = dp - mDeferredPixels;
+}
+
+
+//! Blends the deferred antialiased pixels of a scanline in painter's order.
+/*! The pixels are deferred front to back, so they are blended in reverse order.
+ *  \param aTarget the target scanline.
+ */
+void PolygonVersionF::blendDeferredPixels(unsigned long *aTarget)
+{
+    int n;
+
+    if (mGammaTable)
+    {
+        const GammaColorTable *gammaColor = NULL;
+        unsigned long gammaColorValue = 0;
+
+        for (n = mCurrentDeferredPixel - 1; n >= 0; n--)
+        {
+            const SceneDeferredPixel &pixel = mDeferredPixels[n];
+            unsigned long *tp = &aTarget[pixel.mX];
+
+#ifdef GATHER_STATISTICS
+            if (*tp != STATISTICS_BG_COLOR)
+                mStatistics.mOverdrawPixels++;
+            mStatistics.mAntialiasPixels++;
+#endif
+
+            if (gammaColor == NULL || gammaColorValue != pixel.mColor)
+            {
+                gammaColor = mGammaTable->getColorTable(pixel.mColor);
+                gammaColorValue = pixel.mColor;
+            }
+            *tp = mGammaTable->blend(gammaColor,*tp,pixel.mAlpha);
+        }
+        return;
+    }
+
+    for (n = mCurrentDeferredPixel - 1; n >= 0; n--)
+    {
+        const SceneDeferredPixel &pixel = mDeferredPixels[n];
+        unsigned long *tp = &aTarget[pixel.mX];
+        unsigned long alpha = pixel.mAlpha;
+
+#ifdef GATHER_STATISTICS
+        if (*tp != STATISTICS_BG_COLOR)
+            mStatistics.mOverdrawPixels++;
+        mStatistics.mAntialiasPixels++;
+#endif
+
+        unsigned long cs1 = pixel.mColor & 0xff00ff;
+        unsigned long cs2 = (pixel.mColor >> 8) & 0xff00ff;
+
+        // alpha is in range of 0 to SUBPIXEL_COUNT
+        unsigned long invAlpha = SUBPIXEL_COUNT - alpha;
+
+        unsigned long ct1 = (*tp & 0xff00ff) * invAlpha;
+        unsigned long ct2 = ((*tp >> 8) & 0xff00ff) * invAlpha;
+
+        ct1 = ((ct1 + cs1 * alpha) >> SUBPIXEL_SHIFT) & 0xff00ff;
+        ct2 = ((ct2 + cs2 * alpha) << (8 - SUBPIXEL_SHIFT)) & 0xff00ff00;
+
+        *tp = ct1 + ct2;
+    }
+}
+
+
+//! Renders the mask to a floating point canvas with even-odd fill.
+void PolygonVersionF::fillEvenOddFloat(BitmapData *aTarget, unsigned long aColor)
+{
+    int y;
+
+    int minY = mVerticalExtents.mMinimum;
+    int maxY = mVerticalExtents.mMaximum;
+
+    PolygonScanEdge *activeEdges = NULL;
+    SpanExtents edgeExtents;
+
+    for (y = minY; y <= maxY; y++)
+    {
+        edgeExtents.reset();
+
+        renderEvenOddEdges(activeEdges,edgeExtents,y);
+
+        int minX = edgeExtents.mMinimum;
+        // Offset values are not taken into account when calculating the extents, so add
+        // one to the maximum. This makes sure that full spans are included, as offset
+        // values are in the range of 0 to 1.
+        int maxX = edgeExtents.mMaximum + 1;
+
+        if (minX < maxX)
+        {
+            CLIP_SPAN clip = CLIP_SPAN_FULL;
+            if (isClipped())
+                clip = getClipSpan(y,minX,maxX);
+
+            if (clip == CLIP_SPAN_EMPTY)
+                MEMSET(&mMaskBuffer[minX],0,(maxX - minX + 2) * sizeof(SUBPIXEL_DATA));
+            else
+            {
+                resolveEvenOddSpan(minX,maxX);
+                if (clip == CLIP_SPAN_PARTIAL)
+                    clipCoverageSpan(y,minX,maxX);
+                blendFloatSpan(aTarget,aColor,y,minX,maxX);
+            }
+        }
+    }
+}
+
+
+//! Renders the mask to a floating point canvas with non-zero winding fill.
+void PolygonVersionF::fillNonZeroFloat(BitmapData *aTarget, unsigned long aColor)
+{
+    int y;
+
+    int minY = mVerticalExtents.mMinimum;
+    int maxY = mVerticalExtents.mMaximum;
+
+    PolygonScanEdge *activeEdges = NULL;
+    SpanExtents edgeExtents;
+
+    for (y = minY; y <= maxY; y++)
+    {
+        edgeExtents.reset();
+
+        renderNonZeroEdges(activeEdges,edgeExtents,y);
+
+        int minX = edgeExtents.mMinimum;
+        // Offset values are not taken into account when calculating the extents, so add
+        // one to the maximum. This makes sure that full spans are included, as offset
+        // values are in the range of 0 to 1.
+        int maxX = edgeExtents.mMaximum + 1;
+
+        if (minX < maxX)
+        {
+            CLIP_SPAN clip = CLIP_SPAN_FULL;
+            if (isClipped())
+                clip = getClipSpan(y,minX,maxX);
+
+            if (clip == CLIP_SPAN_EMPTY)
+                MEMSET(&mWindingBuffer[minX],0,(maxX - minX + 2) * sizeof(NonZeroPackedMask));
+            else
+            {
+                resolveNonZeroSpan(minX,maxX);
+                if (clip == CLIP_SPAN_PARTIAL)
+                    clipCoverageSpan(y,minX,maxX);
+                blendFloatSpan(aTarget,aColor,y,minX,maxX);
+            }
+        }
+    }
+}
+
+
+//! Blends a span of the coverage buffer to a floating point canvas.
+/*! The color is converted to floats once. Half float pixels are converted to
+ *  floats and back in chunks, so that both formats use the same blend loop.
+ */
+void PolygonVersionF::blendFloatSpan(BitmapData *aTarget, unsigned long aColor, int aY, int aMinX, int aMaxX)
+{
+    static const float scale = 1.0f / 255.0f;
+
+    float color[4];
+    color[0] = (float)((aColor >> 16) & 0xff) * scale;
+    color[1] = (float)((aColor >> 8) & 0xff) * scale;
+    color[2] = (float)(aColor & 0xff) * scale;
+    color[3] = 1.0f;
+
+    // The end of the span may be outside the bitmap, as the buffers are wider.
+    int maxX = aMaxX;
+    if (maxX > (int)aTarget->mWidth - 1)
+        maxX = (int)aTarget->mWidth - 1;
+
+    if (maxX < aMinX)
+        return;
+
+    const unsigned char *cb = &mCoverageBuffer[aMinX];
+    unsigned char *row = (unsigned char *)aTarget->mData + aY * aTarget->mPitch;
+    int count = maxX - aMinX + 1;
+
+#ifdef GATHER_STATISTICS
+    int n;
+    for (n = 0; n < count; n++)
+    {
+        if (cb[n] == SUBPIXEL_COUNT)
+            mStatistics.mFilledPixels++;
+        else if (cb[n])
+            mStatistics.mAntialiasPixels++;
+    }
+#endif
+
+    if (aTarget->mFormat == BitmapData::BITMAP_FORMAT_RGBA32F)
+    {
+        blendFloatPixels((float *)row + aMinX * 4,cb,count,color);
+        return;
+    }
+
+    float buffer[FLOAT_SPAN_CHUNK_SIZE * 4];
+    unsigned short *tp = (unsigned short *)row + aMinX * 4;
+    while (count > 0)
+    {
+        int chunk = count;
+        if (chunk > FLOAT_SPAN_CHUNK_SIZE)
+            chunk = FLOAT_SPAN_CHUNK_SIZE;
+
+        halfToFloat(tp,buffer,chunk * 4);
+        blendFloatPixels(buffer,cb,chunk,color);
+        floatToHalf(buffer,tp,chunk * 4);
+
+        tp += chunk * 4;
+        cb += chunk;
+        count -= chunk;
+    }
+}
+
+
+//! Blends a span of the coverage buffer to the canvas.
+/*! \param aTarget the target scanline.
+ *  \param aMinX the first pixel of the span.
+ *  \param aMaxX the last pixel of the span.
+ *  \param aColor the color to be used for rendering.
+ *  \param aGammaColor the gamma correction table for the color, or NULL.
+ */
+void PolygonVersionF::blendCoverageSpan(unsigned long *aTarget, int aMinX, int aMaxX, unsigned long aColor, const GammaColorTable *aGammaColor)
+{
+    unsigned long cs1 = aColor & 0xff00ff;
+    unsigned long cs2 = (aColor >> 8) & 0xff00ff;
+
+    const unsigned char *cb = &mCoverageBuffer[aMinX];
+    unsigned long *tp = &aTarget[aMinX];
+    int x;
+
+    if (aGammaColor)
+    {
+        for (x = aMinX; x <= aMaxX; x++)
+        {
+            unsigned long alpha = *cb++;
+            if (alpha == SUBPIXEL_COUNT)
+            {
+#ifdef GATHER_STATISTICS
+                if (*tp != STATISTICS_BG_COLOR)
+                    mStatistics.mOverdrawPixels++;
+                mStatistics.mFilledPixels++;
+#endif
+                *tp = aColor;
+            }
+            else if (alpha)
+            {
+#ifdef GATHER_STATISTICS
+                if (*tp != STATISTICS_BG_COLOR)
+                    mStatistics.mOverdrawPixels++;
+                mStatistics.mAntialiasPixels++;
+#endif
+                *tp = mGammaTable->blend(aGammaColor,*tp,alpha);
+            }
+            tp++;
+        }
+        return;
+    }
+
+    for (x = aMinX; x <= aMaxX; x++)
+    {
+        unsigned long alpha = *cb++;
+        if (alpha == SUBPIXEL_COUNT)
+        {
+#ifdef GATHER_STATISTICS
+            if (*tp != STATISTICS_BG_COLOR)
+                mStatistics.mOverdrawPixels++;
+            mStatistics.mFilledPixels++;
+#endif
+            *tp = aColor;
+        }
+        else if (alpha)
+        {
+#ifdef GATHER_STATISTICS
+            if (*tp != STATISTICS_BG_COLOR)
+                mStatistics.mOverdrawPixels++;
+            mStatistics.mAntialiasPixels++;
+#endif
+            // alpha is in range of 0 to SUBPIXEL_COUNT
+            unsigned long invAlpha = SUBPIXEL_COUNT - alpha;
+
+            unsigned long ct1 = (*tp & 0xff00ff) * invAlpha;
+            unsigned long ct2 = ((*tp >> 8) & 0xff00ff) * invAlpha;
+
+            ct1 = ((ct1 + cs1 * alpha) >> SUBPIXEL_SHIFT) & 0xff00ff;
+            ct2 = ((ct2 + cs2 * alpha) << (8 - SUBPIXEL_SHIFT)) & 0xff00ff00;
+
+            *tp = ct1 + ct2;
+        }
+        tp++;
+    }
+}
+
+
+//! Calculates the rectangle of an axis-aligned rectangle polygon.
+/*! The rectangle is clipped the same way as SubPolygon::getScanEdges() clips the
+ *  edges, so the result is identical to the rendering of the edges.
+ *  \param aPolygon the polygon.
+ *  \param aTransformation the transformation matrix including the remapping.
+ *  \param aClipRect the clip rectangle.
+ *  \param aRectangle the result rectangle.
+ *  \return true if the polygon is a single rectangle that stays axis-aligned in
+ *          the transformation, false otherwise.
+ */
+bool PolygonVersionF::getScanRectangle(const Polygon *aPolygon, const MATRIX2D &aTransformation, const ClipRectangle &aClipRect, ScanRectangle &aRectangle) const
+{
+    if (aPolygon->getSubPolygonCount() != 1)
+        return false;
+
+    const SubPolygon &poly = aPolygon->getSubPolygon(0);
+    if (!poly.isRectangle() ||
+        MATRIX2D_GET_M12(aTransformation) != INT_TO_RATIONAL(0) ||
+        MATRIX2D_GET_M21(aTransformation) != INT_TO_RATIONAL(0))
+        return false;
+
+    VECTOR2D corner1, corner2;
+    MATRIX2D_TRANSFORM(aTransformation,poly.getMinimum(),corner1);
+    MATRIX2D_TRANSFORM(aTransformation,poly.getMaximum(),corner2);
+
+    RATIONAL minX = VECTOR2D_GETX(corner1);
+    RATIONAL maxX = VECTOR2D_GETX(corner2);
+    if (minX > maxX)
+    {
+        minX = VECTOR2D_GETX(corner2);
+        maxX = VECTOR2D_GETX(corner1);
+    }
+
+    RATIONAL minY = VECTOR2D_GETY(corner1);
+    RATIONAL maxY = VECTOR2D_GETY(corner2);
+    if (minY > maxY)
+    {
+        minY = VECTOR2D_GETY(corner2);
+        maxY = VECTOR2D_GETY(corner1);
+    }
+
+    // Clip the vertical edges to the left and right.
+    if (minX < aClipRect.getMinXf())
+        minX = aClipRect.getMinXf();
+    else if (minX >= aClipRect.getMaxXf())
+        minX = aClipRect.getMaxXf();
+
+    if (maxX < aClipRect.getMinXf())
+        maxX = aClipRect.getMinXf();
+    else if (maxX >= aClipRect.getMaxXf())
+        maxX = aClipRect.getMaxXf();
+
+    aRectangle.mMinX = rationalToFixed(minX);
+    aRectangle.mMaxX = rationalToFixed(maxX);
+
+    // The edges start from the line after the top vertex and end on the line of
+    // the bottom vertex. Clipped vertices are placed to the lines of the clip
+    // rectangle.
+    if (minY < aClipRect.getMinYf())
+        aRectangle.mFirstLine = aClipRect.getMinYi() + 1;
+    else if (minY >= aClipRect.getMaxYf())
+        aRectangle.mFirstLine = aClipRect.getMaxYi();
+    else
+        aRectangle.mFirstLine = rationalToIntRoundDown(minY) + 1;
+
+    if (maxY < aClipRect.getMinYf())
+        aRectangle.mLastLine = aClipRect.getMinYi();
+    else if (maxY >= aClipRect.getMaxYf())
+        aRectangle.mLastLine = aClipRect.getMaxYi() - 1;
+    else
+        aRectangle.mLastLine = rationalToIntRoundDown(maxY);
+
+    return true;
+}
+
+
+//! Renders an axis-aligned rectangle to the canvas.
+/*! \param aTarget the target bitmap.
+ *  \param aRectangle the rectangle from getScanRectangle().
+ *  \param aColor the color to be used for rendering.
+ */
+void PolygonVersionF::fillRectangle(BitmapData *aTarget, const ScanRectangle &aRectangle, unsigned long aColor)
+{
+    if (aRectangle.mFirstLine > aRectangle.mLastLine)
+        return;
+
+    int minY = aRectangle.mFirstLine >> SUBPIXEL_SHIFT;
+    int maxY = aRectangle.mLastLine >> SUBPIXEL_SHIFT;
+
+    const GammaColorTable *gammaColor = NULL;
+    if (mGammaTable)
+        gammaColor = mGammaTable->getColorTable(aColor);
+
+    unsigned int pitch = aTarget->mPitch / 4;
+    unsigned long *target = &aTarget->mData[minY * pitch];
+
+    int y;
+    for (y = minY; y <= maxY; y++)
+    {
+        fillRectangleSpan(target,aRectangle,y,aColor,gammaColor);
+        target += pitch;
+    }
+}
+
+
+//! Renders one scanline of an axis-aligned rectangle to the canvas.
+/*! \param aTarget the target scanline.
+ *  \param aRectangle the rectangle from getScanRectangle().
+ *  \param aY the scanline.
+ *  \param aColor the color to be used for rendering.
+ *  \param aGammaColor the gamma correction table for the color, or NULL.
+ */
+inline void PolygonVersionF::fillRectangleSpan(unsigned long *aTarget, const ScanRectangle &aRectangle, int aY, unsigned long aColor, const GammaColorTable *aGammaColor)
+{
+    static const FIXED_POINT offsets[SUBPIXEL_COUNT] = SUBPIXEL_OFFSETS_FIXED;
+
+    // The first and the last scanline may be covered only partially.
+    SampleSpan span;
+    span.mFirstSub = 0;
+    span.mLastSub = SUBPIXEL_COUNT - 1;
+    if (aY == aRectangle.mFirstLine >> SUBPIXEL_SHIFT)
+        span.mFirstSub = aRectangle.mFirstLine & (SUBPIXEL_COUNT - 1);
+    if (aY == aRectangle.mLastLine >> SUBPIXEL_SHIFT)
+        span.mLastSub = aRectangle.mLastLine & (SUBPIXEL_COUNT - 1);
+
+    int s;
+    for (s = span.mFirstSub; s <= span.mLastSub; s++)
+    {
+        span.mLeft[s] = FIXED_TO_INT(aRectangle.mMinX + offsets[s]);
+        span.mRight[s] = FIXED_TO_INT(aRectangle.mMaxX + offsets[s]);
+    }
+
+    fillSampleSpan(aTarget,span,aColor,aGammaColor);
+}
+
+
+//! Renders the samples of a span to the canvas.
+/*! The coverage is calculated from the samples without the mask buffer. The pixels
+ *  that are covered on all sub-scanlines of the span are written directly.
+ *  \param aTarget the target scanline.
+ *  \param aSpan the samples of the span.
+ *  \param aColor the color to be used for rendering.
+ *  \param aGammaColor the gamma correction table for the color, or NULL.
+ */
+void PolygonVersionF::fillSampleSpan(unsigned long *aTarget, const SampleSpan &aSpan, unsigned long aColor, const GammaColorTable *aGammaColor)
+{
+    SpanExtents leftExtents;
+    SpanExtents rightExtents;
+    leftExtents.reset();
+    rightExtents.reset();
+
+    int coveredCount = 0;
+    int s;
+    for (s = aSpan.mFirstSub; s <= aSpan.mLastSub; s++)
+    {
+        if (aSpan.mLeft[s] < aSpan.mRight[s])
+        {
+            leftExtents.mark(aSpan.mLeft[s],aSpan.mLeft[s]);
+            rightExtents.mark(aSpan.mRight[s],aSpan.mRight[s]);
+            coveredCount++;
+        }
+    }
+
+    if (coveredCount == 0)
+        return;
+
+    int minX = leftExtents.mMinimum;
+    int maxX = rightExtents.mMaximum - 1;
+
+    // The pixels between these are covered on all sub-scanlines that have samples.
+    int interiorMinX = leftExtents.mMaximum;
+    int interiorMaxX = rightExtents.mMinimum - 1;
+
+    unsigned char *cb = mCoverageBuffer;
+    int x;
+    for (x = minX; x <= maxX; x++)
+    {
+        if (x >= interiorMinX && x <= interiorMaxX)
+        {
+            // Skip the fully covered interior.
+            if (coveredCount == SUBPIXEL_COUNT)
+            {
+                x = interiorMaxX;
+                continue;
+            }
+            cb[x] = (unsigned char)coveredCount;
+        }
+        else
+        {
+            unsigned char coverage = 0;
+            for (s = aSpan.mFirstSub; s <= aSpan.mLastSub; s++)
+            {
+                if (x >= aSpan.mLeft[s] && x < aSpan.mRight[s])
+                    coverage++;
+            }
+            cb[x] = coverage;
+        }
+    }
+
+    if (coveredCount == SUBPIXEL_COUNT && interiorMinX <= interiorMaxX)
+    {
+        blendCoverageSpan(aTarget,minX,interiorMinX - 1,aColor,aGammaColor);
+
+        unsigned long *tp = &aTarget[interiorMinX];
+        for (x = interiorMinX; x <= interiorMaxX; x++)
+        {
+#ifdef GATHER_STATISTICS
+            if (*tp != STATISTICS_BG_COLOR)
+                mStatistics.mOverdrawPixels++;
+            mStatistics.mFilledPixels++;
+#endif
+            *tp++ = aColor;
+        }
+
+        blendCoverageSpan(aTarget,interiorMaxX + 1,maxX,aColor,aGammaColor);
+    }
+    else
+        blendCoverageSpan(aTarget,minX,maxX,aColor,aGammaColor);
+}
+
+
+//! Stores the samples of a convex polygon edge on the current scanline to a span.
+/*! The first edge crossing a sub-scanline sets both ends of the span, and the
+ *  second one extends it to the left or right.
+ *  \param aEdge the edge.
+ *  \param aSpan the span.
+ *  \param aSampleMask the sub-scanlines that have an odd amount of samples.
+ *  \param aCurrentLine the scanline.
+ *  \return true if the edge continues to the next scanline.
+ */
+inline bool PolygonVersionF::plotConvexEdge(PolygonScanEdge *aEdge, SampleSpan &aSpan, SUBPIXEL_DATA &aSampleMask, int aCurrentLine)
+{
+    static const FIXED_POINT offsets[SUBPIXEL_COUNT] = SUBPIXEL_OFFSETS_FIXED;
+
+    int firstSub = 0;
+    int lastSub = SUBPIXEL_COUNT - 1;
+    bool continues = true;
+
+    if ((aEdge->mFirstLine >> SUBPIXEL_SHIFT) == aCurrentLine)
+        firstSub = aEdge->mFirstLine & (SUBPIXEL_COUNT - 1);
+    if ((aEdge->mLastLine >> SUBPIXEL_SHIFT) == aCurrentLine)
+    {
+        lastSub = aEdge->mLastLine & (SUBPIXEL_COUNT - 1);
+        continues = false;
+    }
+
+    if (firstSub < aSpan.mFirstSub)
+        aSpan.mFirstSub = firstSub;
+    if (lastSub > aSpan.mLastSub)
+        aSpan.mLastSub = lastSub;
+
+    FIXED_POINT x = aEdge->mX;
+    FIXED_POINT slope = aEdge->mSlope;
+
+    SUBPIXEL_DATA mask = (SUBPIXEL_DATA)1 << firstSub;
+    int s;
+    for (s = firstSub; s <= lastSub; s++)
+    {
+        int xp = FIXED_TO_INT(x + offsets[s]);
+        if (aSampleMask & mask)
+        {
+            if (xp < aSpan.mLeft[s])
+                aSpan.mLeft[s] = xp;
+            else
+                aSpan.mRight[s] = xp;
+        }
+        else
+        {
+            aSpan.mLeft[s] = xp;
+            aSpan.mRight[s] = xp;
+        }
+        aSampleMask ^= mask;
+        mask <<= 1;
+        x += slope;
+    }
+
+    aEdge->mX = x;
+
+    return continues;
+}
+
+
+//! Renders the edges of a convex polygon from the current vertical index to a span.
+/*! Each sub-scanline of a convex polygon is crossed by exactly two edges, so the
+ *  samples of the edges define the span directly and the mask buffer is not needed.
+ */
+inline void PolygonVersionF::renderConvexEdges(PolygonScanEdge * &aActiveEdgeTable, SampleSpan &aSpan, int aCurrentLine)
+{
+    aSpan.mFirstSub = SUBPIXEL_COUNT;
+    aSpan.mLastSub = -1;
+
+    int s;
+    for (s = 0; s < SUBPIXEL_COUNT; s++)
+    {
+        aSpan.mLeft[s] = 0;
+        aSpan.mRight[s] = 0;
+    }
+
+    SUBPIXEL_DATA sampleMask = 0;
+
+    // First, process edges in the active edge table. Remove those that end within
+    // the scanline.
+    PolygonScanEdge *prevEdge = NULL;
+    PolygonScanEdge *currentEdge = aActiveEdgeTable;
+
+    while (currentEdge)
+    {
+        if (plotConvexEdge(currentEdge,aSpan,sampleMask,aCurrentLine))
+        {
+            if ((aCurrentLine & SLOPE_FIX_SCANLINE_MASK) == 0)
+                currentEdge->mX += currentEdge->mSlopeFix;
+
+            prevEdge = currentEdge;
+            currentEdge = currentEdge->mNextEdge;
+        }
+        else
+        {
+            currentEdge = currentEdge->mNextEdge;
+            if (prevEdge)
+                prevEdge->mNextEdge = currentEdge;
+            else
+                aActiveEdgeTable = currentEdge;
+        }
+    }
+
+    // Then, fetch the edges from the edge table. Add those that continue to the next
+    // scanline to the active edge table.
+    currentEdge = mEdgeTable[aCurrentLine];
+    mEdgeTable[aCurrentLine] = NULL;
+
+    while (currentEdge)
+    {
+        PolygonScanEdge *nextEdge = currentEdge->mNextEdge;
+
+        if (plotConvexEdge(currentEdge,aSpan,sampleMask,aCurrentLine))
+        {
+            if (prevEdge)
+                prevEdge->mNextEdge = currentEdge;
+            else
+                aActiveEdgeTable = currentEdge;
+
+            prevEdge = currentEdge;
+        }
+
+        currentEdge = nextEdge;
+    }
+
+    if (prevEdge)
+        prevEdge->mNextEdge = NULL;
+}
+
+
+//! Renders the edges of a convex polygon to the canvas.
+/*! \param aTarget the target bitmap.
+ *  \param aColor the color to be used for rendering.
+ */
+void PolygonVersionF::fillConvex(BitmapData *aTarget, unsigned long aColor)
+{
+    int y;
+
+    int minY = mVerticalExtents.mMinimum;
+    int maxY = mVerticalExtents.mMaximum;
+
+    const GammaColorTable *gammaColor = NULL;
+    if (mGammaTable)
+        gammaColor = mGammaTable->getColorTable(aColor);
+
+    unsigned int pitch = aTarget->mPitch / 4;
+    unsigned long *target = &aTarget->mData[minY * pitch];
+
+    PolygonScanEdge *activeEdges = NULL;
+    SampleSpan span;
+
+    for (y = minY; y <= maxY; y++)
+    {
+        renderConvexEdges(activeEdges,span,y);
+
+        if (span.mFirstSub <= span.mLastSub)
+            fillSampleSpan(target,span,aColor,gammaColor);
+
+        target += pitch;
+    }
+}
+
+
+//! Resolves the coverage of a span of the mask buffer to the coverage buffer.
+/*! The mask buffer is cleared at the same time.
+ */
+inline void PolygonVersionF::resolveEvenOddSpan(int aMinX, int aMaxX)
+{
+    SUBPIXEL_DATA *mb = &mMaskBuffer[aMinX];
+    unsigned char *cb = &mCoverageBuffer[aMinX];
+    SUBPIXEL_DATA mask = 0;
+    int x;
+    for (x = aMinX; x <= aMaxX; x++)
+    {
+        mask ^= *mb;
+        *mb++ = 0;
+        *cb++ = (unsigned char)SUBPIXEL_COVERAGE(mask);
+    }
+}
+
+
+//! Resolves the coverage of a span of the winding buffer to the coverage buffer.
+/*! The winding buffer is cleared at the same time. The coverage changes only at
+ *  the pixels with winding changes, so the runs between them are filled at once.
+ */
+inline void PolygonVersionF::resolveNonZeroSpan(int aMinX, int aMaxX)
+{
+    NonZeroPackedSum values;
+    SUBPIXEL_DATA mask;
+
+    NonZeroPackedMask *wb = &mWindingBuffer[aMinX];
+    NonZeroPackedMask *end = &mWindingBuffer[aMaxX + 1];
+    unsigned char *cb = &mCoverageBuffer[aMinX];
+
+    mask = NonZeroMaskD::init(*wb++,values);
+    unsigned char coverage = (unsigned char)SUBPIXEL_COVERAGE(mask);
+    *cb++ = coverage;
+
+    while (wb < end)
+    {
+        // Scan forward until the winding changes.
+        NonZeroPackedMask *sb = wb;
+        while (wb < end && NonZeroMaskD::isEmpty(*wb))
+            wb++;
+
+        int count = wb - sb;
+        MEMSET(cb,coverage,count);
+        cb += count;
+
+        if (wb < end)
+        {
+            mask = NonZeroMaskD::apply(*wb++,values,mask);
+            coverage = (unsigned char)SUBPIXEL_COVERAGE(mask);
+            *cb++ = coverage;
+        }
+    }
+}
+
+
+//! Classifies a span against the clip mask and the clip region.
+inline CLIP_SPAN PolygonVersionF::getClipSpan(int aY, int aMinX, int aMaxX)
+{
+    CLIP_SPAN clip = CLIP_SPAN_FULL;
+    if (mClipMaskCount > 0)
+        clip = getClipMaskSpan(aY,aMinX,aMaxX);
+
+    if (mClipRegion && clip != CLIP_SPAN_EMPTY)
+    {
+        CLIP_SPAN regionClip = getClipRegionSpan(aY,aMinX,aMaxX);
+        if (regionClip != CLIP_SPAN_FULL)
+            clip = regionClip;
+    }
+
+    if (mDamageClip && clip != CLIP_SPAN_EMPTY)
+    {
+        CLIP_SPAN damageClip = getDamageSpan(aY,aMinX,aMaxX);
+        if (damageClip != CLIP_SPAN_FULL)
+            clip = damageClip;
+    }
+
+    return clip;
+}
+
+
+//! Classifies a span against the clip region.
+inline CLIP_SPAN PolygonVersionF::getClipRegionSpan(int aY, int aMinX, int aMaxX)
+{
+    int band = mClipRegion->findBand(aY,mClipRegionBand);
+    if (band < 0)
+        return CLIP_SPAN_EMPTY;
+    mClipRegionBand = band;
+
+    const ClipRegionBand &regionBand = mClipRegion->getBand(band);
+    const ClipRegionSpan *spans = mClipRegion->getSpans(regionBand);
+
+    // The spans may extend over the right edge of the bitmap, even though there
+    // is no coverage there.
+    int n;
+    for (n = 0; n < regionBand.mSpanCount; n++)
+    {
+        if (spans[n].mMaxX < aMinX)
+            continue;
+        if (spans[n].mMinX > aMaxX)
+            break;
+        if (spans[n].mMinX <= aMinX &&
+            (spans[n].mMaxX >= aMaxX || spans[n].mMaxX >= (int)mWidth - 1))
+            return CLIP_SPAN_FULL;
+        return CLIP_SPAN_PARTIAL;
+    }
+
+    return CLIP_SPAN_EMPTY;
+}
+
+
+//! Limits a span of the coverage buffer with the clip mask and the clip region.
+void PolygonVersionF::clipCoverageSpan(int aY, int aMinX, int aMaxX)
+{
+    if (mClipMaskCount > 0)
+        clipMaskSpan(aY,aMinX,aMaxX);
+
+    if (mClipRegion)
+        clipRegionSpan(aY,aMinX,aMaxX);
+
+    if (mDamageClip)
+        clipDamageSpan(aY,aMinX,aMaxX);
+}
+
+
+//! Multiplies a span of the coverage buffer with the clip mask on top of the stack.
+void PolygonVersionF::clipMaskSpan(int aY, int aMinX, int aMaxX)
+{
+    const ClipMask &mask = mClipMasks[mClipMaskCount - 1];
+    const ClipMaskRow &row = mask.mRows[aY];
+    const unsigned char *mb = &mask.mCoverage[row.mOffset];
+    unsigned char *cb = mCoverageBuffer;
+
+    int minX = aMinX;
+    if (minX < row.mMinX)
+        minX = row.mMinX;
+    int maxX = aMaxX;
+    if (maxX > row.mMaxX)
+        maxX = row.mMaxX;
+
+    int x;
+    for (x = aMinX; x < minX && x <= aMaxX; x++)
+        cb[x] = 0;
+
+    for (x = minX; x <= maxX; x++)
+        cb[x] = (unsigned char)((cb[x] * mb[x - row.mMinX] + SUBPIXEL_COUNT / 2) >> SUBPIXEL_SHIFT);
+
+    if (x < minX)
+        x = minX;
+    for (; x <= aMaxX; x++)
+        cb[x] = 0;
+}
+
+
+//! Clears the pixels of a span of the coverage buffer that are outside of the clip region.
+void PolygonVersionF::clipRegionSpan(int aY, int aMinX, int aMaxX)
+{
+    unsigned char *cb = mCoverageBuffer;
+    int x = aMinX;
+
+    int band = mClipRegion->findBand(aY,mClipRegionBand);
+    if (band >= 0)
+    {
+        mClipRegionBand = band;
+
+        const ClipRegionBand &regionBand = mClipRegion->getBand(band);
+        const ClipRegionSpan *spans = mClipRegion->getSpans(regionBand);
+
+        int n;
+        for (n = 0; n < regionBand.mSpanCount && x <= aMaxX; n++)
+        {
+            if (spans[n].mMaxX < x)
+                continue;
+
+            for (; x < spans[n].mMinX && x <= aMaxX; x++)
+                cb[x] = 0;
+            x = spans[n].mMaxX + 1;
+        }
+    }
+
+    for (; x <= aMaxX; x++)
+        cb[x] = 0;
+}
+
+
+//! Clears the pixels of a span of the coverage buffer that are outside of the damage rectangle.
+void PolygonVersionF::clipDamageSpan(int aY, int aMinX, int aMaxX)
+{
+    unsigned char *cb = mCoverageBuffer;
+    int x = aMinX;
+
+    if (aY >= mDamageRect.getMinYi() && aY < mDamageRect.getMaxYi())
+    {
+        for (; x < mDamageRect.getMinXi() && x <= aMaxX; x++)
+            cb[x] = 0;
+
+        if (x < mDamageRect.getMaxXi())
+            x = mDamageRect.getMaxXi();
+    }
+
+    for (; x <= aMaxX; x++)
+        cb[x] = 0;
+}
+
+
+//! Intersects a clip rectangle with the bounds of the clip mask on top of the stack.
+/*! Returns false if the clip mask is empty.
+ */
+bool PolygonVersionF::intersectClipMask(ClipRectangle &aClipRect) const
+{
+    if (mClipMaskCount == 0)
+        return true;
+
+    const ClipMask &mask = mClipMasks[mClipMaskCount - 1];
+    if (mask.mMinX > mask.mMaxX || mask.mMinY > mask.mMaxY)
+        return false;
+
+    ClipRectangle bounds(mask.mMinX,mask.mMinY,mask.mMaxX - mask.mMinX + 1,mask.mMaxY - mask.mMinY + 1,SUBPIXEL_COUNT);
+    aClipRect.intersect(bounds);
+
+    return true;
+}
+
+
+//! Intersects a clip rectangle with the bounds of the clip region.
+/*! Returns false if the clip region is empty.
+ */
+bool PolygonVersionF::intersectClipRegion(ClipRectangle &aClipRect) const
+{
+    if (mClipRegion == NULL)
+        return true;
+
+    if (mClipRegion->isEmpty())
+        return false;
+
+    ClipRectangle bounds(mClipRegion->getMinX(),mClipRegion->getMinY(),
+                         mClipRegion->getMaxX() - mClipRegion->getMinX() + 1,
+                         mClipRegion->getMaxY() - mClipRegion->getMinY() + 1,SUBPIXEL_COUNT);
+    aClipRect.intersect(bounds);
+
+    return true;
+}
+
+
+//! Checks if a surface format is supported.
+bool PolygonVersionF::isSupported(BitmapData::BitmapFormat aFormat)
+{
+    // Only non-alpha target formats and floating point formats are supported.
+    if (aFormat == BitmapData::BITMAP_FORMAT_XRGB ||
+        aFormat == BitmapData::BITMAP_FORMAT_XBGR ||
+        aFormat == BitmapData::BITMAP_FORMAT_RGBX ||
+        aFormat == BitmapData::BITMAP_FORMAT_BGRX ||
+        aFormat == BitmapData::BITMAP_FORMAT_RGBA32F ||
+        aFormat == BitmapData::BITMAP_FORMAT_RGBA16F)
+    {
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+}
+
+
+//! Adds the edges of a polygon to the edge table.
+bool PolygonVersionF::addPolygonEdges(const Polygon *aPolygon, const MATRIX2D &aTransformation, const ClipRectangle &aClipRect)
+{
+    // Skip the polygon if it is completely outside.
+    if (aPolygon->getBoundsClip(aTransformation,aClipRect) == POLYGON_BOUNDS_OUTSIDE)
+        return true;
+
+    if (useCurveEdges(aPolygon,aTransformation,aClipRect))
+        return addCurveEdges(aPolygon->getCurves()->getPathData(),aTransformation);
+
+    int subPolyCount = aPolygon->getSubPolygonCount();
+    int n;
+    for (n = 0; n < subPolyCount; n++)
+    {
+        const SubPolygon &poly = aPolygon->getSubPolygon(n);
+
+        int count = poly.getVertexCount();
+        // The maximum amount of edges is 3 x the vertices.
+        int freeCount = getFreeEdgeCount() - count * 3;
+        if (freeCount < 0 &&
+            !resizeEdgeStorage(-freeCount))
+        {
+            return false;
+        }
+
+        PolygonScanEdge *edges = &mEdgeStorage[mCurrentEdge];
+        int edgeCount = poly.getScanEdges(edges,aTransformation,aClipRect);
+
+        int p;
+        for (p = 0; p < edgeCount; p++)
+        {
+            int firstLine = edges[p].mFirstLine >> SUBPIXEL_SHIFT;
+            int lastLine = edges[p].mLastLine >> SUBPIXEL_SHIFT;
+
+            edges[p].mCurve = -1;
+            edges[p].mNextEdge = mEdgeTable[firstLine];
+            mEdgeTable[firstLine] = &edges[p];
+
+            mVerticalExtents.mark(firstLine,lastLine);
+        }
+        mCurrentEdge += edgeCount;
+    }
+
+    return true;
+}
+
+
+//! Adds the edges of a path with curves to the edge table.
+/*! The path is transformed and each segment is added as line or curve edges.
+ *  The path has to be completely inside the clip rectangle, as the edges are
+ *  not clipped.
+ *  \param aPathData the path data.
+ *  \param aTransformation the transformation matrix.
+ */
+bool PolygonVersionF::addCurveEdges(const PathData *aPathData, const MATRIX2D &aTransformation)
+{
+    int subPathCount = aPathData->getSubPathCount();
+    int n;
+    for (n = 0; n < subPathCount; n++)
+    {
+        int pointCount = aPathData->getPointCount(n);
+        if (pointCount == 0)
+            continue;
+
+        // A curve is split to at most as many monotonic edges as it has points, and
+        // the closing line adds one edge.
+        int freeCount = getFreeEdgeCount() - (pointCount + 1);
+        if (freeCount < 0 &&
+            !resizeEdgeStorage(-freeCount))
+        {
+            return false;
+        }
+
+        freeCount = (int)mCurveEdgeCount - (int)mCurrentCurveEdge - pointCount;
+        if (freeCount < 0 &&
+            !resizeCurveEdges(-freeCount))
+        {
+            return false;
+        }
+
+        const RATIONAL *points = aPathData->getPointData(n);
+        const PATH_POINT_TAG *tags = aPathData->getTagData(n);
+
+        VECTOR2D start;
+        MATRIX2D_TRANSFORM(aTransformation,VECTOR2D(points[0],points[1]),start);
+
+        VECTOR2D segment[4];
+        segment[0] = start;
+
+        int p = 1;
+        while (p < pointCount)
+        {
+            int degree = 1;
+            if (tags[p] == PATH_POINT_QUADRATIC && p + 1 < pointCount)
+                degree = 2;
+            else if (tags[p] == PATH_POINT_CUBIC && p + 2 < pointCount)
+                degree = 3;
+
+            int k;
+            for (k = 1; k <= degree; k++)
+            {
+                const RATIONAL *point = &points[(p + k - 1) * 2];
+                MATRIX2D_TRANSFORM(aTransformation,VECTOR2D(point[0],point[1]),segment[k]);
+            }
+
+            if (!addSegmentEdges(segment,degree))
+                return false;
+
+            segment[0] = segment[degree];
+            p += degree;
+        }
+
+        // The sub-paths are closed implicitly.
+        segment[1] = start;
+        if (!addSegmentEdges(segment,1))
+            return false;
+    }
+
+    return true;
+}
+
+
+//! Adds the edges of a line or a curve segment to the edge table.
+/*! Curves are split to pieces that are monotonic in y at the extrema of y.
+ *  \param aPoints the points of the segment.
+ *  \param aDegree the degree of the segment: 1 for lines, 2 for quadratic and
+ *         3 for cubic curves.
+ */
+bool PolygonVersionF::addSegmentEdges(const VECTOR2D *aPoints, int aDegree)
+{
+    if (aDegree == 1)
+    {
+        addLineEdge(aPoints[0],aPoints[1]);
+        return true;
+    }
+
+    RATIONAL y0 = VECTOR2D_GETY(aPoints[0]);
+    RATIONAL y1 = VECTOR2D_GETY(aPoints[1]);
+    RATIONAL y2 = VECTOR2D_GETY(aPoints[2]);
+
+    // Find the parameter values where the derivative of y is zero.
+    RATIONAL splits[2];
+    int splitCount = 0;
+    RATIONAL t;
+
+    if (aDegree == 2)
+    {
+        RATIONAL d = y0 - INT_TO_RATIONAL(2) * y1 + y2;
+        if (d != INT_TO_RATIONAL(0))
+        {
+            t = (y0 - y1) / d;
+            if (t > INT_TO_RATIONAL(0) && t < INT_TO_RATIONAL(1))
+                splits[splitCount++] = t;
+        }
+    }
+    else
+    {
+        // y'(t) / 3 = at^2 + bt + c
+        RATIONAL y3 = VECTOR2D_GETY(aPoints[3]);
+        RATIONAL a = y3 - y0 + INT_TO_RATIONAL(3) * (y1 - y2);
+        RATIONAL b = INT_TO_RATIONAL(2) * (y0 - INT_TO_RATIONAL(2) * y1 + y2);
+        RATIONAL c = y1 - y0;
+
+        if (a == INT_TO_RATIONAL(0))
+        {
+            if (b != INT_TO_RATIONAL(0))
+            {
+                t = -c / b;
+                if (t > INT_TO_RATIONAL(0) && t < INT_TO_RATIONAL(1))
+                    splits[splitCount++] = t;
+            }
+        }
+        else
+        {
+            // A double root doesn't change the direction of y.
+            RATIONAL discriminant = b * b - INT_TO_RATIONAL(4) * a * c;
+            if (discriminant > INT_TO_RATIONAL(0))
+            {
+                RATIONAL root = (RATIONAL)sqrt((double)discriminant);
+                RATIONAL t1 = (-b - root) / (INT_TO_RATIONAL(2) * a);
+                RATIONAL t2 = (-b + root) / (INT_TO_RATIONAL(2) * a);
+                if (t1 > t2)
+                {
+                    t = t1;
+                    t1 = t2;
+                    t2 = t;
+                }
+
+                if (t1 > INT_TO_RATIONAL(0) && t1 < INT_TO_RATIONAL(1))
+                    splits[splitCount++] = t1;
+                if (t2 > INT_TO_RATIONAL(0) && t2 < INT_TO_RATIONAL(1))
+                    splits[splitCount++] = t2;
+            }
+        }
+    }
+
+    VECTOR2D piece[4];
+    int n;
+    for (n = 0; n <= aDegree; n++)
+        piece[n] = aPoints[n];
+
+    RATIONAL previousT = INT_TO_RATIONAL(0);
+    for (n = 0; n < splitCount; n++)
+    {
+        // The split parameter is relative to the remaining piece.
+        VECTOR2D first[4];
+        VECTOR2D second[4];
+        splitCurve(piece,aDegree,(splits[n] - previousT) / (INT_TO_RATIONAL(1) - previousT),first,second);
+        addCurveEdge(first,aDegree);
+
+        int k;
+        for (k = 0; k <= aDegree; k++)
+            piece[k] = second[k];
+        previousT = splits[n];
+    }
+
+    addCurveEdge(piece,aDegree);
+
+    return true;
+}
+
+
+//! Adds a line edge to the edge table.
+/*! The edge is set up the same way as SubPolygon::getScanEdges() sets up the
+ *  edges that are not clipped. There has to be room for the edge in the storage.
+ *  \param aStart the start point of the line.
+ *  \param aEnd the end point of the line.
+ */
+void PolygonVersionF::addLineEdge(const VECTOR2D &aStart, const VECTOR2D &aEnd)
+{
+    VECTOR2D start = aStart;
+    VECTOR2D end = aEnd;
+    short winding = 1;
+    if (VECTOR2D_GETY(aStart) > VECTOR2D_GETY(aEnd))
+    {
+        start = aEnd;
+        end = aStart;
+        winding = -1;
+    }
+
+    int firstLine = rationalToIntRoundDown(VECTOR2D_GETY(start)) + 1;
+    int lastLine = rationalToIntRoundDown(VECTOR2D_GETY(end));
+    if (lastLine < firstLine)
+        return;
+
+    RATIONAL slope = (VECTOR2D_GETX(end) - VECTOR2D_GETX(start)) /
+                     (VECTOR2D_GETY(end) - VECTOR2D_GETY(start));
+    RATIONAL startX = VECTOR2D_GETX(start) + ((RATIONAL)firstLine - VECTOR2D_GETY(start)) * slope;
+
+    PolygonScanEdge *edge = &mEdgeStorage[mCurrentEdge++];
+    edge->mFirstLine = firstLine;
+    edge->mLastLine = lastLine;
+    edge->mWinding = winding;
+    edge->mX = rationalToFixed(startX);
+    edge->mSlope = rationalToFixed(slope);
+    edge->mCurve = -1;
+
+    if (lastLine - firstLine >= SLOPE_FIX_STEP)
+        edge->mSlopeFix = rationalToFixed(slope * SLOPE_FIX_STEP) - (edge->mSlope << SLOPE_FIX_SHIFT);
+    else
+        edge->mSlopeFix = INT_TO_FIXED(0);
+
+    firstLine >>= SUBPIXEL_SHIFT;
+    lastLine >>= SUBPIXEL_SHIFT;
+
+    edge->mNextEdge = mEdgeTable[firstLine];
+    mEdgeTable[firstLine] = edge;
+
+    mVerticalExtents.mark(firstLine,lastLine);
+}
+
+
+//! Adds a curve edge that is monotonic in y to the edge table.
+/*! The curve is stepped with forward differencing in fixed point. The amount of
+ *  steps is the power of two that keeps the steps within CURVE_EDGE_FLATNESS
+ *  pixels from the curve, up to 2^CURVE_EDGE_MAX_STEP_SHIFT steps. There has to
+ *  be room for the edge in the storage.
+ *  \param aPoints the points of the curve.
+ *  \param aDegree the degree of the curve, 2 or 3.
+ */
+void PolygonVersionF::addCurveEdge(const VECTOR2D *aPoints, int aDegree)
+{
+    VECTOR2D points[4];
+    short winding = 1;
+    int n;
+    if (VECTOR2D_GETY(aPoints[0]) > VECTOR2D_GETY(aPoints[aDegree]))
+    {
+        for (n = 0; n <= aDegree; n++)
+            points[n] = aPoints[aDegree - n];
+        winding = -1;
+    }
+    else
+    {
+        for (n = 0; n <= aDegree; n++)
+            points[n] = aPoints[n];
+    }
+
+    int firstLine = rationalToIntRoundDown(VECTOR2D_GETY(points[0])) + 1;
+    int lastLine = rationalToIntRoundDown(VECTOR2D_GETY(points[aDegree]));
+    if (lastLine < firstLine)
+        return;
+
+    // The coefficients of P(t) = at^3 + bt^2 + ct + d are calculated from the
+    // control points rounded to fixed point, so that they are exact. The y is in
+    // sub-scanlines, so it needs 64 bits in fixed point.
+    FIXED_POINT x[4];
+    INTEGER64 y[4];
+    for (n = 0; n <= aDegree; n++)
+    {
+        x[n] = rationalToFixed(VECTOR2D_GETX(points[n]));
+        y[n] = (INTEGER64)((double)VECTOR2D_GETY(points[n]) * (double)(1 << FIXED_POINT_SHIFT));
+    }
+
+    // The maximum length of the second differences of the control points in pixels.
+    RATIONAL dx = FIXED_TO_RATIONAL(x[0] - 2 * x[1] + x[2]);
+    RATIONAL dy = FIXED_TO_RATIONAL(y[0] - 2 * y[1] + y[2]) / SUBPIXEL_COUNT;
+    RATIONAL difference = dx * dx + dy * dy;
+
+    INTEGER64 ax, ay, bx, by, cx, cy;
+    if (aDegree == 2)
+    {
+        ax = 0;
+        ay = 0;
+        bx = (INTEGER64)x[0] - 2 * (INTEGER64)x[1] + x[2];
+        by = y[0] - 2 * y[1] + y[2];
+        cx = 2 * ((INTEGER64)x[1] - x[0]);
+        cy = 2 * (y[1] - y[0]);
+    }
+    else
+    {
+        ax = (INTEGER64)x[3] - x[0] + 3 * ((INTEGER64)x[1] - x[2]);
+        ay = y[3] - y[0] + 3 * (y[1] - y[2]);
+        bx = 3 * ((INTEGER64)x[0] - 2 * (INTEGER64)x[1] + x[2]);
+        by = 3 * (y[0] - 2 * y[1] + y[2]);
+        cx = 3 * ((INTEGER64)x[1] - x[0]);
+        cy = 3 * (y[1] - y[0]);
+
+        dx = FIXED_TO_RATIONAL(x[1] - 2 * x[2] + x[3]);
+        dy = FIXED_TO_RATIONAL(y[1] - 2 * y[2] + y[3]) / SUBPIXEL_COUNT;
+        if (dx * dx + dy * dy > difference)
+            difference = dx * dx + dy * dy;
+    }
+
+    int steps = PathData::getCurveSteps((RATIONAL)sqrt((double)difference),aDegree,CURVE_EDGE_FLATNESS);
+    int shift = 0;
+    while ((1 << shift) < steps && shift < CURVE_EDGE_MAX_STEP_SHIFT)
+        shift++;
+
+    // With h = 1 / s and s = 2^shift, the differences scaled by s^3 are
+    // a + bs + cs^2, 6a + 2bs and 6a.
+    INTEGER64 s = 1 << shift;
+    PolygonCurveEdge &curve = mCurveEdges[mCurrentCurveEdge];
+    curve.mStepX = x[0] * s * s * s;
+    curve.mStepY = y[0] * s * s * s;
+    curve.mDX = ax + bx * s + cx * s * s;
+    curve.mDY = ay + by * s + cy * s * s;
+    curve.mDDX = 6 * ax + 2 * bx * s;
+    curve.mDDY = 6 * ay + 2 * by * s;
+    curve.mDDDX = 6 * ax;
+    curve.mDDDY = 6 * ay;
+    curve.mSlope = 0;
+    curve.mX = x[0];
+    curve.mY = y[0];
+    curve.mPrevX = x[0];
+    curve.mPrevY = y[0];
+    curve.mSteps = 1 << shift;
+    curve.mShift = 3 * shift;
+
+    PolygonScanEdge *edge = &mEdgeStorage[mCurrentEdge++];
+    edge->mFirstLine = firstLine;
+    edge->mLastLine = lastLine;
+    edge->mWinding = winding;
+    edge->mX = x[0];
+    edge->mSlope = INT_TO_FIXED(0);
+    edge->mSlopeFix = INT_TO_FIXED(0);
+    edge->mCurve = mCurrentCurveEdge++;
+
+    firstLine >>= SUBPIXEL_SHIFT;
+    lastLine >>= SUBPIXEL_SHIFT;
+
+    edge->mNextEdge = mEdgeTable[firstLine];
+    mEdgeTable[firstLine] = edge;
+
+    mVerticalExtents.mark(firstLine,lastLine);
+}
+
+
+//! Splits a curve to two at given parameter value.
+/*! \param aPoints the points of the curve.
+ *  \param aDegree the degree of the curve.
+ *  \param aT the parameter value of the split.
+ *  \param aFirst the points of the first part.
+ *  \param aSecond the points of the second part.
+ */
+void PolygonVersionF::splitCurve(const VECTOR2D *aPoints, int aDegree, RATIONAL aT, VECTOR2D *aFirst, VECTOR2D *aSecond)
+{
+    // de Casteljau's algorithm.
+    VECTOR2D points[4];
+    int n, k;
+    for (n = 0; n <= aDegree; n++)
+        points[n] = aPoints[n];
+
+    aFirst[0] = points[0];
+    aSecond[aDegree] = points[aDegree];
+    for (n = 1; n <= aDegree; n++)
+    {
+        for (k = 0; k <= aDegree - n; k++)
+        {
+            VECTOR2D_SETX(points[k],VECTOR2D_GETX(points[k]) + (VECTOR2D_GETX(points[k + 1]) - VECTOR2D_GETX(points[k])) * aT);
+            VECTOR2D_SETY(points[k],VECTOR2D_GETY(points[k]) + (VECTOR2D_GETY(points[k + 1]) - VECTOR2D_GETY(points[k])) * aT);
+        }
+        aFirst[n] = points[0];
+        aSecond[aDegree - n] = points[aDegree - n];
+    }
+}
+
+
+//! Returns the x position of a curve edge at given sub-scanline.
+/*! The curve is stepped forward until it reaches the sub-scanline, so the
+ *  sub-scanlines have to be queried in increasing order.
+ *  \param aCurve the curve edge.
+ *  \param aLine the sub-scanline.
+ *  \return the x position in fixed point.
+ */
+inline FIXED_POINT PolygonVersionF::getCurveEdgeX(PolygonCurveEdge &aCurve, int aLine)
+{
+    INTEGER64 y = (INTEGER64)aLine << FIXED_POINT_SHIFT;
+    if (aCurve.mY < y && aCurve.mSteps > 0)
+    {
+        do
+        {
+            aCurve.mPrevX = aCurve.mX;
+            aCurve.mPrevY = aCurve.mY;
+            aCurve.mStepX += aCurve.mDX;
+            aCurve.mStepY += aCurve.mDY;
+            aCurve.mDX += aCurve.mDDX;
+            aCurve.mDY += aCurve.mDDY;
+            aCurve.mDDX += aCurve.mDDDX;
+            aCurve.mDDY += aCurve.mDDDY;
+            aCurve.mX = (FIXED_POINT)(aCurve.mStepX >> aCurve.mShift);
+            aCurve.mY = aCurve.mStepY >> aCurve.mShift;
+            aCurve.mSteps--;
+        }
+        while (aCurve.mY < y && aCurve.mSteps > 0);
+
+        // The slope of the step in fixed point, so that a sub-scanline costs
+        // only a multiplication.
+        if (aCurve.mY > aCurve.mPrevY)
+            aCurve.mSlope = ((INTEGER64)(aCurve.mX - aCurve.mPrevX) << FIXED_POINT_SHIFT) / (aCurve.mY - aCurve.mPrevY);
+        else
+            aCurve.mSlope = 0;
+    }
+
+    if (y >= aCurve.mY || aCurve.mY <= aCurve.mPrevY)
+        return aCurve.mX;
+    if (y <= aCurve.mPrevY)
+        return aCurve.mPrevX;
+
+    return aCurve.mPrevX + (FIXED_POINT)((aCurve.mSlope * (y - aCurve.mPrevY)) >> FIXED_POINT_SHIFT);
+}
+
+
+//! Plots a curve edge to the mask buffer on the given sub-scanlines of a scanline.
+/*! The position of the curve is evaluated separately for each sub-scanline.
+ *  \param aEdge the edge.
+ *  \param aEdgeExtents the extents of the plotted edges.
+ *  \param aCurrentLine the scanline.
+ *  \param aFirstSub the first sub-scanline to plot.
+ *  \param aLastSub the last sub-scanline to plot.
+ */
+inline void PolygonVersionF::plotEvenOddCurveEdge(const PolygonScanEdge *aEdge, SpanExtents &aEdgeExtents, int aCurrentLine, int aFirstSub, int aLastSub)
+{
+    static const FIXED_POINT offsets[SUBPIXEL_COUNT] = SUBPIXEL_OFFSETS_FIXED;
+
+    PolygonCurveEdge &curve = mCurveEdges[aEdge->mCurve];
+    int line = (aCurrentLine << SUBPIXEL_SHIFT) + aFirstSub;
+
+    FIXED_POINT x = getCurveEdgeX(curve,line);
+    FIXED_POINT minX = x;
+    FIXED_POINT maxX = x;
+
+    SUBPIXEL_DATA mask = 1 << aFirstSub;
+    int ySub = aFirstSub;
+    for (;;)
+    {
+        int xp = FIXED_TO_INT(x + offsets[ySub]);
+        mMaskBuffer[xp] ^= mask;
+        mask <<= 1;
+
+        if (++ySub > aLastSub)
+            break;
+
+        x = getCurveEdgeX(curve,++line);
+        if (x < minX)
+            minX = x;
+        else if (x > maxX)
+            maxX = x;
+    }
+
+    aEdgeExtents.mark(FIXED_TO_INT(minX),FIXED_TO_INT(maxX));
+}
+
+
+//! Plots a curve edge to the winding buffer on the given sub-scanlines of a scanline.
+/*! The position of the curve is evaluated separately for each sub-scanline.
+ *  \param aEdge the edge.
+ *  \param aEdgeExtents the extents of the plotted edges.
+ *  \param aCurrentLine the scanline.
+ *  \param aFirstSub the first sub-scanline to plot.
+ *  \param aLastSub the last sub-scanline to plot.
+ */
+inline void PolygonVersionF::plotNonZeroCurveEdge(const PolygonScanEdge *aEdge, SpanExtents &aEdgeExtents, int aCurrentLine, int aFirstSub, int aLastSub)
+{
+    static const FIXED_POINT offsets[SUBPIXEL_COUNT] = SUBPIXEL_OFFSETS_FIXED;
+
+    PolygonCurveEdge &curve = mCurveEdges[aEdge->mCurve];
+    int line = (aCurrentLine << SUBPIXEL_SHIFT) + aFirstSub;
+    int winding = aEdge->mWinding;
+
+    FIXED_POINT x = getCurveEdgeX(curve,line);
+    FIXED_POINT minX = x;
+    FIXED_POINT maxX = x;
+
+    int ySub = aFirstSub;
+    for (;;)
+    {
+        int xp = FIXED_TO_INT(x + offsets[ySub]);
+        NonZeroMaskD::plot(mWindingBuffer[xp],ySub,winding);
+
+        if (++ySub > aLastSub)
+            break;
+
+        x = getCurveEdgeX(curve,++line);
+        if (x < minX)
+            minX = x;
+        else if (x > maxX)
+            maxX = x;
+    }
+
+    aEdgeExtents.mark(FIXED_TO_INT(minX),FIXED_TO_INT(maxX));
+}
+
+
+//! Renders the edges of a scene polygon for the given scanline.
+inline void PolygonVersionF::renderScenePolygonEdges(ScenePolygon &aPolygon, SpanExtents &aEdgeExtents, int aCurrentLine)
+{
+    // The edges of the polygon starting from this scanline are placed to the
+    // edge table, where the edge rendering functions fetch them from.
+    if (aPolygon.mCurrentEdgeLine <= aPolygon.mLastEdgeLine &&
+        mSceneEdgeLines[aPolygon.mCurrentEdgeLine].mLine == aCurrentLine)
+    {
+        mEdgeTable[aCurrentLine] = &mEdgeStorage[mSceneEdgeLines[aPolygon.mCurrentEdgeLine].mEdgeIndex];
+        aPolygon.mCurrentEdgeLine++;
+    }
+
+    if (aPolygon.mFillMode == RENDERER_FILLMODE_EVENODD)
+        renderEvenOddEdges(aPolygon.mActiveEdges,aEdgeExtents,aCurrentLine);
+    else
+        renderNonZeroEdges(aPolygon.mActiveEdges,aEdgeExtents,aCurrentLine);
+}
+
+
+//! Renders the edges of a convex scene polygon for the given scanline to a span.
+inline void PolygonVersionF::renderSceneConvexEdges(ScenePolygon &aPolygon, SampleSpan &aSpan, int aCurrentLine)
+{
+    if (aPolygon.mCurrentEdgeLine <= aPolygon.mLastEdgeLine &&
+        mSceneEdgeLines[aPolygon.mCurrentEdgeLine].mLine == aCurrentLine)
+    {
+        mEdgeTable[aCurrentLine] = &mEdgeStorage[mSceneEdgeLines[aPolygon.mCurrentEdgeLine].mEdgeIndex];
+        aPolygon.mCurrentEdgeLine++;
+    }
+
+    renderConvexEdges(aPolygon.mActiveEdges,aSpan,aCurrentLine);
+}
+
+
+//! Returns true if a scene polygon is inside one of the occluders.
+/*! The pixels of the polygon are limited by the bounding box of its vertices or
+ *  the control points of its curves with a margin for the sample offsets.
+ *  \param aPolygon the polygon to test.
+ *  \param aCurveEdges true if the curves of the polygon are rendered as curve edges.
+ *  \param aTransformation the transformation including the remapping matrix.
+ *  \param aClipRect the clip rectangle.
+ *  \param aOccluders the occluders.
+ *  \param aOccluderCount the amount of occluders.
+ *  \return true if all pixels of the polygon are hidden by an occluder.
+ */
+bool PolygonVersionF::isSceneOccluded(const Polygon *aPolygon, bool aCurveEdges, const MATRIX2D &aTransformation, const ClipRectangle &aClipRect,
+                                      const SceneOccluder *aOccluders, int aOccluderCount) const
+{
+    if (aOccluderCount == 0 ||
+        aPolygon->getSubPolygonCount() == 0)
+        return false;
+
+    VECTOR2D minimum, maximum;
+    if (aCurveEdges)
+    {
+        const PolygonCurves *curves = aPolygon->getCurves();
+        SubPolygon::getBounds(curves->getMinimum(),curves->getMaximum(),aTransformation,minimum,maximum);
+    }
+    else
+        aPolygon->getBounds(aTransformation,minimum,maximum);
+
+    // The bounds are limited to the clip rectangle first to keep them in the
+    // range of the integers.
+    RATIONAL minX = VECTOR2D_GETX(minimum);
+    RATIONAL maxX = VECTOR2D_GETX(maximum);
+    RATIONAL minY = VECTOR2D_GETY(minimum);
+    RATIONAL maxY = VECTOR2D_GETY(maximum);
+
+    if (minX < aClipRect.getMinXf())
+        minX = aClipRect.getMinXf();
+    if (maxX > aClipRect.getMaxXf())
+        maxX = aClipRect.getMaxXf();
+    if (minY < aClipRect.getMinYf())
+        minY = aClipRect.getMinYf();
+    if (maxY > aClipRect.getMaxYf())
+        maxY = aClipRect.getMaxYf();
+
+    if (minX > maxX || minY > maxY)
+        return false;
+
+    int pixelMinX = rationalToIntRoundDown(minX) - 1;
+    int pixelMaxX = rationalToIntRoundDown(maxX) + 1;
+    int pixelMinY = rationalToIntRoundDown(minY) >> SUBPIXEL_SHIFT;
+    int pixelMaxY = rationalToIntRoundDown(maxY) >> SUBPIXEL_SHIFT;
+
+    int n;
+    for (n = 0; n < aOccluderCount; n++)
+    {
+        const SceneOccluder &occluder = aOccluders[n];
+        if (occluder.mMinX <= pixelMinX && pixelMaxX <= occluder.mMaxX &&
+            occluder.mMinY <= pixelMinY && pixelMaxY <= occluder.mMaxY)
+            return true;
+    }
+
+    return false;
+}
+
+
+//! Adds the fully covered pixels of a rectangle polygon to the occluders.
+/*! A pixel is fully covered when all of its sub-scanlines are inside the
+ *  rectangle and all sample offsets land inside it. When the occluders are
+ *  full, the smallest one is replaced by a larger rectangle.
+ *  \param aRectangle the rectangle from getScanRectangle().
+ *  \param aOccluders the occluders.
+ *  \param aOccluderCount the amount of occluders, updated by the call.
+ */
+void PolygonVersionF::addSceneOccluder(const ScanRectangle &aRectangle, SceneOccluder *aOccluders, int &aOccluderCount)
+{
+    SceneOccluder occluder;
+    occluder.mMinX = FIXED_TO_INT(aRectangle.mMinX) + 1;
+    occluder.mMaxX = FIXED_TO_INT(aRectangle.mMaxX) - 1;
+    occluder.mMinY = (aRectangle.mFirstLine + SUBPIXEL_COUNT - 1) >> SUBPIXEL_SHIFT;
+    occluder.mMaxY = ((aRectangle.mLastLine + 1) >> SUBPIXEL_SHIFT) - 1;
+
+    if (occluder.mMinX > occluder.mMaxX ||
+        occluder.mMinY > occluder.mMaxY)
+        return;
+
+    if (aOccluderCount < SCENE_OCCLUDER_COUNT)
+    {
+        aOccluders[aOccluderCount] = occluder;
+        aOccluderCount++;
+        return;
+    }
+
+    int area = (occluder.mMaxX - occluder.mMinX + 1) * (occluder.mMaxY - occluder.mMinY + 1);
+    int smallest = -1;
+    int smallestArea = area;
+
+    int n;
+    for (n = 0; n < aOccluderCount; n++)
+    {
+        int occluderArea = (aOccluders[n].mMaxX - aOccluders[n].mMinX + 1) *
+                           (aOccluders[n].mMaxY - aOccluders[n].mMinY + 1);
+        if (occluderArea < smallestArea)
+        {
+            smallest = n;
+            smallestArea = occluderArea;
+        }
+    }
+
+    if (smallest >= 0)
+        aOccluders[smallest] = occluder;
+}
+
+
+//! Merges two lists of scene polygons sorted by the polygon index.
+int PolygonVersionF::mergeScenePolygons(int aFirst, int aSecond)
+{
+    int head = -1;
+    int tail = -1;
+
+    while (aFirst >= 0 || aSecond >= 0)
+    {
+        int next;
+        if (aSecond < 0 || (aFirst >= 0 && aFirst < aSecond))
+        {
+            next = aFirst;
+            aFirst = mScenePolygons[aFirst].mNext;
+        }
+        else
+        {
+            next = aSecond;
+            aSecond = mScenePolygons[aSecond].mNext;
+        }
+
+        if (tail >= 0)
+            mScenePolygons[tail].mNext = next;
+        else
+            head = next;
+        tail = next;
+    }
+
+    if (tail >= 0)
+        mScenePolygons[tail].mNext = -1;
+
+    return head;
+}
+
+
+//! Resizes the scene polygon storage.
+bool PolygonVersionF::resizeScenePolygons(int aPolygonCount)
+{
+    if ((unsigned int)aPolygonCount <= mScenePolygonCount)
+        return true;
+
+    ScenePolygon *newPolygons = new ScenePolygon[aPolygonCount];
+    if (newPolygons == NULL)
+        return false;
+
+    int *newActivePolygons = new int[aPolygonCount];
+    if (newActivePolygons == NULL)
+    {
+        delete[] newPolygons;
+        return false;
+    }
+
+    delete[] mScenePolygons;
+    mScenePolygons = newPolygons;
+    delete[] mSceneActivePolygons;
+    mSceneActivePolygons = newActivePolygons;
+    mScenePolygonCount = aPolygonCount;
+
+    return true;
+}
+
+
+//! Resizes the scene edge line storage.
+bool PolygonVersionF::resizeSceneEdgeLines(int aIncrement)
+{
+    unsigned int newCount = mSceneEdgeLineCount + aIncrement;
+
+    SceneEdgeLine *newLines = new SceneEdgeLine[newCount];
+    if (newLines == NULL)
+        return false;
+
+    if (mSceneEdgeLines)
+        MEMCPY(newLines,mSceneEdgeLines,sizeof(SceneEdgeLine)*mSceneEdgeLineCount);
+
+    delete[] mSceneEdgeLines;
+    mSceneEdgeLines = newLines;
+    mSceneEdgeLineCount = newCount;
+
+    return true;
+}
+
+
+//! Resizes the deferred pixel storage.
+/*! The storage is grown to hold at least aPixelCount pixels. The current pixels
+ *  are preserved.
+ */
+bool PolygonVersionF::resizeDeferredPixels(int aPixelCount)
+{
+    if ((unsigned int)aPixelCount <= mDeferredPixelCount)
+        return true;
+
+    unsigned int newCount = mDeferredPixelCount + mDeferredPixelCount / 2;
+    if (newCount < (unsigned int)aPixelCount)
+        newCount = aPixelCount;
+
+    SceneDeferredPixel *newPixels = new SceneDeferredPixel[newCount];
+    if (newPixels == NULL)
+        return false;
+
+    if (mDeferredPixels)
+        MEMCPY(newPixels,mDeferredPixels,sizeof(SceneDeferredPixel)*mCurrentDeferredPixel);
+
+    delete[] mDeferredPixels;
+    mDeferredPixels = newPixels;
+    mDeferredPixelCount = newCount;
+
+    return true;
+}
+
+
+//! Resizes the clip mask stack.
+/*! The buffers of the new levels are allocated when they are used.
+ */
+bool PolygonVersionF::resizeClipMasks(int aMaskCount)
+{
+    if (aMaskCount <= mClipMaskCapacity)
+        return true;
+
+    ClipMask *newMasks = new ClipMask[aMaskCount];
+    if (newMasks == NULL)
+        return false;
+
+    if (mClipMasks)
+        MEMCPY(newMasks,mClipMasks,sizeof(ClipMask)*mClipMaskCapacity);
+
+    int n;
+    for (n = mClipMaskCapacity; n < aMaskCount; n++)
+    {
+        newMasks[n].mCoverage = NULL;
+        newMasks[n].mCoverageSize = 0;
+        newMasks[n].mRows = NULL;
+    }
+
+    delete[] mClipMasks;
+    mClipMasks = newMasks;
+    mClipMaskCapacity = aMaskCount;
+
+    return true;
+}
+
+
+//! Resizes the coverage buffer of a clip mask.
+/*! The buffer is grown to hold at least aSize pixels. The current coverage is
+ *  preserved.
+ */
+bool PolygonVersionF::resizeClipMaskCoverage(ClipMask &aMask, int aSize)
+{
+    if (aSize <= aMask.mCoverageSize)
+        return true;
+
+    int newSize = aMask.mCoverageSize * 2 + 0x100;
+    if (newSize < aSize)
+        newSize = aSize;
+
+    unsigned char *newCoverage = new unsigned char[newSize];
+    if (newCoverage == NULL)
+        return false;
+
+    if (aMask.mCoverage)
+        MEMCPY(newCoverage,aMask.mCoverage,aMask.mCoverageSize);
+
+    delete[] aMask.mCoverage;
+    aMask.mCoverage = newCoverage;
+    aMask.mCoverageSize = newSize;
+
+    return true;
+}
+
+
+//! Resizes the curve edge storage.
+/*! The edges refer to the curve edges by index, so the storage can be copied.
+ */
+bool PolygonVersionF::resizeCurveEdges(int aIncrement)
+{
+    unsigned int newCount = mCurveEdgeCount + aIncrement;
+
+    PolygonCurveEdge *newStorage = new PolygonCurveEdge[newCount];
+    if (newStorage == NULL)
+        return false;
+
+    if (mCurveEdges)
+        MEMCPY(newStorage,mCurveEdges,sizeof(PolygonCurveEdge)*mCurveEdgeCount);
+
+    delete[] mCurveEdges;
+    mCurveEdges = newStorage;
+    mCurveEdgeCount = newCount;
+
+    return true;
 }
 
 
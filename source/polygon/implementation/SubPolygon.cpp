@@ -28,6 +28,10 @@ SubPolygon::SubPolygon(VECTOR2D *aVertices, int aVertexCount)
     mVertices = aVertices;
     mVertexCount = aVertexCount;
     mVertexData = NULL;
+    mRectangle = false;
+    mConvex = false;
+    mSimple = false;
+    mOrientation = 0;
 }
 
 
@@ -37,6 +41,49 @@ bool SubPolygon::init()
     mVertexData = new VertexData[mVertexCount + 1];
     if (mVertexData == NULL)
         return false;
+
+    // Calculate the bounding box in object space.
+    mMinimum = VECTOR2D(INT_TO_RATIONAL(0),INT_TO_RATIONAL(0));
+    mMaximum = VECTOR2D(INT_TO_RATIONAL(0),INT_TO_RATIONAL(0));
+    if (mVertexCount > 0)
+    {
+        mMinimum = mVertices[0];
+        mMaximum = mVertices[0];
+    }
+
+    int n;
+    for (n = 1; n < mVertexCount; n++)
+    {
+        if (VECTOR2D_GETX(mVertices[n]) < VECTOR2D_GETX(mMinimum))
+            VECTOR2D_SETX(mMinimum,VECTOR2D_GETX(mVertices[n]));
+        else if (VECTOR2D_GETX(mVertices[n]) > VECTOR2D_GETX(mMaximum))
+            VECTOR2D_SETX(mMaximum,VECTOR2D_GETX(mVertices[n]));
+
+        if (VECTOR2D_GETY(mVertices[n]) < VECTOR2D_GETY(mMinimum))
+            VECTOR2D_SETY(mMinimum,VECTOR2D_GETY(mVertices[n]));
+        else if (VECTOR2D_GETY(mVertices[n]) > VECTOR2D_GETY(mMaximum))
+            VECTOR2D_SETY(mMaximum,VECTOR2D_GETY(mVertices[n]));
+    }
+
+    // Check if the sub-polygon is an axis-aligned rectangle. The first edge may be
+    // either vertical or horizontal.
+    mRectangle = false;
+    if (mVertexCount == 4)
+    {
+        const VECTOR2D *v = mVertices;
+        if ((VECTOR2D_GETX(v[0]) == VECTOR2D_GETX(v[1]) && VECTOR2D_GETY(v[1]) == VECTOR2D_GETY(v[2]) &&
+             VECTOR2D_GETX(v[2]) == VECTOR2D_GETX(v[3]) && VECTOR2D_GETY(v[3]) == VECTOR2D_GETY(v[0])) ||
+            (VECTOR2D_GETY(v[0]) == VECTOR2D_GETY(v[1]) && VECTOR2D_GETX(v[1]) == VECTOR2D_GETX(v[2]) &&
+             VECTOR2D_GETY(v[2]) == VECTOR2D_GETY(v[3]) && VECTOR2D_GETX(v[3]) == VECTOR2D_GETX(v[0])))
+        {
+            mRectangle = true;
+        }
+    }
+
+    mConvex = checkConvexity();
+    mSimple = checkSimplicity();
+    mOrientation = calculateOrientation();
+
     return true;
 }
 
@@ -49,6 +96,384 @@ SubPolygon::~SubPolygon()
 }
 
 
+//! Checks if the sub-polygon is strictly convex.
+/*! All corners have to turn to the same direction, and the polygon may wind around
+ *  only once, which is true if the vertical direction of the edges changes only
+ *  twice. Collinear edges are not accepted, so that the rounding errors of the
+ *  transformation can't make the polygon concave. Repeated vertices are skipped.
+ */
+bool SubPolygon::checkConvexity() const
+{
+    if (mVertexCount < 3)
+        return false;
+
+    RATIONAL firstDX = INT_TO_RATIONAL(0);
+    RATIONAL firstDY = INT_TO_RATIONAL(0);
+    RATIONAL prevDX = INT_TO_RATIONAL(0);
+    RATIONAL prevDY = INT_TO_RATIONAL(0);
+    int edgeCount = 0;
+    int turn = 0;
+    int firstDirection = 0;
+    int direction = 0;
+    int directionChanges = 0;
+
+    int n;
+    for (n = 0; n <= mVertexCount; n++)
+    {
+        RATIONAL dx, dy;
+        if (n < mVertexCount)
+        {
+            const VECTOR2D &start = mVertices[n];
+            const VECTOR2D &end = mVertices[n + 1 < mVertexCount ? n + 1 : 0];
+            dx = VECTOR2D_GETX(end) - VECTOR2D_GETX(start);
+            dy = VECTOR2D_GETY(end) - VECTOR2D_GETY(start);
+
+            if (dx == INT_TO_RATIONAL(0) && dy == INT_TO_RATIONAL(0))
+                continue;
+
+            int edgeDirection = 0;
+            if (dy > INT_TO_RATIONAL(0))
+                edgeDirection = 1;
+            else if (dy < INT_TO_RATIONAL(0))
+                edgeDirection = -1;
+
+            if (edgeDirection != 0)
+            {
+                if (direction == 0)
+                    firstDirection = edgeDirection;
+                else if (edgeDirection != direction)
+                    directionChanges++;
+                direction = edgeDirection;
+            }
+        }
+        else
+        {
+            // The corner between the last and the first edge.
+            dx = firstDX;
+            dy = firstDY;
+        }
+
+        if (edgeCount == 0)
+        {
+            firstDX = dx;
+            firstDY = dy;
+        }
+        else
+        {
+            RATIONAL cross = prevDX * dy - prevDY * dx;
+            int cornerTurn = cross > INT_TO_RATIONAL(0) ? 1 : -1;
+            if (cross == INT_TO_RATIONAL(0) ||
+                (turn != 0 && cornerTurn != turn))
+                return false;
+            turn = cornerTurn;
+        }
+
+        prevDX = dx;
+        prevDY = dy;
+        edgeCount++;
+    }
+
+    if (direction != firstDirection)
+        directionChanges++;
+
+    return turn != 0 && directionChanges <= 2;
+}
+
+
+//! Checks if none of the edges of the sub-polygon intersect.
+/*! The edges are sorted to horizontal buckets, and only the edges sharing a
+ *  bucket are tested against each other. Adjacent edges are not tested, and
+ *  repeated vertices are skipped. Touching edges are considered to intersect.
+ *  If the check can't be done, the sub-polygon is considered to be non-simple.
+ */
+bool SubPolygon::checkSimplicity() const
+{
+    // A convex sub-polygon is always simple.
+    if (mConvex)
+        return true;
+
+    int *data = new int[mVertexCount * 4 + 1];
+    if (data == NULL)
+        return false;
+
+    int *vertices = data;
+    int *firstBucket = &data[mVertexCount];
+    int *lastBucket = &data[mVertexCount * 2];
+    int *bucketStart = &data[mVertexCount * 3];
+
+    // Collect the vertices without repeats.
+    int count = 0;
+    int n;
+    for (n = 0; n < mVertexCount; n++)
+    {
+        if (count > 0 &&
+            VECTOR2D_GETX(mVertices[n]) == VECTOR2D_GETX(mVertices[vertices[count - 1]]) &&
+            VECTOR2D_GETY(mVertices[n]) == VECTOR2D_GETY(mVertices[vertices[count - 1]]))
+            continue;
+        vertices[count++] = n;
+    }
+    while (count > 1 &&
+           VECTOR2D_GETX(mVertices[vertices[count - 1]]) == VECTOR2D_GETX(mVertices[vertices[0]]) &&
+           VECTOR2D_GETY(mVertices[vertices[count - 1]]) == VECTOR2D_GETY(mVertices[vertices[0]]))
+        count--;
+
+    // With less than four edges, all edges are adjacent.
+    if (count < 4)
+    {
+        delete[] data;
+        return true;
+    }
+
+    RATIONAL minY = VECTOR2D_GETY(mMinimum);
+    RATIONAL height = VECTOR2D_GETY(mMaximum) - minY;
+
+    // Calculate the buckets of each edge. The bucket count starts from the edge count.
+    int bucketCount = count;
+    int total;
+    for (;;)
+    {
+        RATIONAL scale = INT_TO_RATIONAL(0);
+        if (height > INT_TO_RATIONAL(0))
+            scale = (RATIONAL)bucketCount / height;
+
+        total = 0;
+        for (n = 0; n < count; n++)
+        {
+            RATIONAL startY = VECTOR2D_GETY(mVertices[vertices[n]]);
+            RATIONAL endY = VECTOR2D_GETY(mVertices[vertices[n + 1 < count ? n + 1 : 0]]);
+            if (startY > endY)
+            {
+                RATIONAL temp = startY;
+                startY = endY;
+                endY = temp;
+            }
+
+            firstBucket[n] = (int)((startY - minY) * scale);
+            lastBucket[n] = (int)((endY - minY) * scale);
+            if (firstBucket[n] >= bucketCount)
+                firstBucket[n] = bucketCount - 1;
+            if (lastBucket[n] >= bucketCount)
+                lastBucket[n] = bucketCount - 1;
+
+            total += lastBucket[n] - firstBucket[n] + 1;
+        }
+
+        if (total <= count * SUBPOLYGON_SIMPLE_BUCKET_LIMIT)
+            break;
+
+        bucketCount /= 2;
+        if (bucketCount < count / SUBPOLYGON_SIMPLE_BUCKET_LIMIT || bucketCount == 0)
+        {
+            delete[] data;
+            return false;
+        }
+    }
+
+    for (n = 0; n <= bucketCount; n++)
+        bucketStart[n] = 0;
+    for (n = 0; n < count; n++)
+    {
+        int bucket;
+        for (bucket = firstBucket[n]; bucket <= lastBucket[n]; bucket++)
+            bucketStart[bucket + 1]++;
+    }
+
+    int *bucketEdges = new int[total];
+    if (bucketEdges == NULL)
+    {
+        delete[] data;
+        return false;
+    }
+
+    for (n = 0; n < bucketCount; n++)
+        bucketStart[n + 1] += bucketStart[n];
+
+    // The bucket start values are used as insertion positions and restored afterwards.
+    for (n = 0; n < count; n++)
+    {
+        int bucket;
+        for (bucket = firstBucket[n]; bucket <= lastBucket[n]; bucket++)
+            bucketEdges[bucketStart[bucket]++] = n;
+    }
+    for (n = bucketCount; n > 0; n--)
+        bucketStart[n] = bucketStart[n - 1];
+    bucketStart[0] = 0;
+
+    bool simple = true;
+    int bucket;
+    for (bucket = 0; bucket < bucketCount && simple; bucket++)
+    {
+        int i, j;
+        for (i = bucketStart[bucket]; i < bucketStart[bucket + 1] && simple; i++)
+        {
+            int edge1 = bucketEdges[i];
+            for (j = i + 1; j < bucketStart[bucket + 1]; j++)
+            {
+                int edge2 = bucketEdges[j];
+
+                // Test each pair only in the first bucket they share.
+                int sharedBucket = firstBucket[edge1] > firstBucket[edge2] ? firstBucket[edge1] : firstBucket[edge2];
+                if (sharedBucket != bucket)
+                    continue;
+
+                int difference = edge2 > edge1 ? edge2 - edge1 : edge1 - edge2;
+                if (difference == 1 || difference == count - 1)
+                    continue;
+
+                if (edgesIntersect(mVertices[vertices[edge1]],mVertices[vertices[edge1 + 1 < count ? edge1 + 1 : 0]],
+                                   mVertices[vertices[edge2]],mVertices[vertices[edge2 + 1 < count ? edge2 + 1 : 0]]))
+                {
+                    simple = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    delete[] bucketEdges;
+    delete[] data;
+
+    return simple;
+}
+
+
+//! Calculates the orientation of the sub-polygon.
+/*! \return 1 for positive signed area, -1 for negative and 0 for no area.
+ */
+int SubPolygon::calculateOrientation() const
+{
+    if (mVertexCount < 3)
+        return 0;
+
+    // The area is calculated relative to the first vertex for better accuracy.
+    RATIONAL originX = VECTOR2D_GETX(mVertices[0]);
+    RATIONAL originY = VECTOR2D_GETY(mVertices[0]);
+    RATIONAL area = INT_TO_RATIONAL(0);
+
+    int n;
+    for (n = 1; n + 1 < mVertexCount; n++)
+    {
+        area += (VECTOR2D_GETX(mVertices[n]) - originX) * (VECTOR2D_GETY(mVertices[n + 1]) - originY) -
+                (VECTOR2D_GETX(mVertices[n + 1]) - originX) * (VECTOR2D_GETY(mVertices[n]) - originY);
+    }
+
+    if (area > INT_TO_RATIONAL(0))
+        return 1;
+    else if (area < INT_TO_RATIONAL(0))
+        return -1;
+    return 0;
+}
+
+
+//! Checks if two edges intersect or touch.
+bool SubPolygon::edgesIntersect(const VECTOR2D &aStart1, const VECTOR2D &aEnd1, const VECTOR2D &aStart2, const VECTOR2D &aEnd2)
+{
+    RATIONAL x1 = VECTOR2D_GETX(aStart1);
+    RATIONAL y1 = VECTOR2D_GETY(aStart1);
+    RATIONAL x2 = VECTOR2D_GETX(aEnd1);
+    RATIONAL y2 = VECTOR2D_GETY(aEnd1);
+    RATIONAL x3 = VECTOR2D_GETX(aStart2);
+    RATIONAL y3 = VECTOR2D_GETY(aStart2);
+    RATIONAL x4 = VECTOR2D_GETX(aEnd2);
+    RATIONAL y4 = VECTOR2D_GETY(aEnd2);
+
+    // Reject by the bounding boxes. This also handles the collinear edges.
+    if ((x1 < x3 && x1 < x4 && x2 < x3 && x2 < x4) ||
+        (x1 > x3 && x1 > x4 && x2 > x3 && x2 > x4) ||
+        (y1 < y3 && y1 < y4 && y2 < y3 && y2 < y4) ||
+        (y1 > y3 && y1 > y4 && y2 > y3 && y2 > y4))
+        return false;
+
+    // The end points of each edge have to be on different sides of the other edge.
+    RATIONAL side3 = (x2 - x1) * (y3 - y1) - (y2 - y1) * (x3 - x1);
+    RATIONAL side4 = (x2 - x1) * (y4 - y1) - (y2 - y1) * (x4 - x1);
+    if ((side3 > INT_TO_RATIONAL(0) && side4 > INT_TO_RATIONAL(0)) ||
+        (side3 < INT_TO_RATIONAL(0) && side4 < INT_TO_RATIONAL(0)))
+        return false;
+
+    RATIONAL side1 = (x4 - x3) * (y1 - y3) - (y4 - y3) * (x1 - x3);
+    RATIONAL side2 = (x4 - x3) * (y2 - y3) - (y4 - y3) * (x2 - x3);
+    if ((side1 > INT_TO_RATIONAL(0) && side2 > INT_TO_RATIONAL(0)) ||
+        (side1 < INT_TO_RATIONAL(0) && side2 < INT_TO_RATIONAL(0)))
+        return false;
+
+    return true;
+}
+
+
+//! Calculates the bounding box of a bounding box after transformation.
+/*! \param aMinimum the minimum corner of the bounding box.
+ *  \param aMaximum the maximum corner of the bounding box.
+ *  \param aTransformation the transformation matrix.
+ *  \param aTransformedMinimum the minimum corner of the result.
+ *  \param aTransformedMaximum the maximum corner of the result.
+ */
+void SubPolygon::getBounds(const VECTOR2D &aMinimum, const VECTOR2D &aMaximum, const MATRIX2D &aTransformation,
+                           VECTOR2D &aTransformedMinimum, VECTOR2D &aTransformedMaximum)
+{
+    VECTOR2D corners[4];
+    corners[0] = aMinimum;
+    corners[1] = VECTOR2D(VECTOR2D_GETX(aMaximum),VECTOR2D_GETY(aMinimum));
+    corners[2] = aMaximum;
+    corners[3] = VECTOR2D(VECTOR2D_GETX(aMinimum),VECTOR2D_GETY(aMaximum));
+
+    VECTOR2D minimum, maximum;
+    MATRIX2D_TRANSFORM(aTransformation,corners[0],minimum);
+    maximum = minimum;
+
+    int n;
+    for (n = 1; n < 4; n++)
+    {
+        VECTOR2D corner;
+        MATRIX2D_TRANSFORM(aTransformation,corners[n],corner);
+
+        if (VECTOR2D_GETX(corner) < VECTOR2D_GETX(minimum))
+            VECTOR2D_SETX(minimum,VECTOR2D_GETX(corner));
+        else if (VECTOR2D_GETX(corner) > VECTOR2D_GETX(maximum))
+            VECTOR2D_SETX(maximum,VECTOR2D_GETX(corner));
+
+        if (VECTOR2D_GETY(corner) < VECTOR2D_GETY(minimum))
+            VECTOR2D_SETY(minimum,VECTOR2D_GETY(corner));
+        else if (VECTOR2D_GETY(corner) > VECTOR2D_GETY(maximum))
+            VECTOR2D_SETY(maximum,VECTOR2D_GETY(corner));
+    }
+
+    aTransformedMinimum = minimum;
+    aTransformedMaximum = maximum;
+}
+
+
+//! Classifies a bounding box against the clip rectangle after transformation.
+/*! \param aMinimum the minimum corner of the bounding box.
+ *  \param aMaximum the maximum corner of the bounding box.
+ *  \param aTransformation the transformation matrix.
+ *  \param aClipRectangle the clip rectangle.
+ *  \return one of POLYGON_BOUNDS_CLIP values.
+ */
+int SubPolygon::getBoundsClip(const VECTOR2D &aMinimum, const VECTOR2D &aMaximum, const MATRIX2D &aTransformation, const ClipRectangle &aClipRectangle)
+{
+    VECTOR2D minimum, maximum;
+    getBounds(aMinimum,aMaximum,aTransformation,minimum,maximum);
+
+    // Everything above or below the clip rectangle produces no edges. Everything
+    // on the left or right side produces only vertical edges on the clip border,
+    // which cancel each other out.
+    if (VECTOR2D_GETY(maximum) < aClipRectangle.getMinYf() - POLYGON_BOUNDS_MARGIN ||
+        VECTOR2D_GETY(minimum) >= aClipRectangle.getMaxYf() + POLYGON_BOUNDS_MARGIN ||
+        VECTOR2D_GETX(maximum) < aClipRectangle.getMinXf() - POLYGON_BOUNDS_MARGIN ||
+        VECTOR2D_GETX(minimum) >= aClipRectangle.getMaxXf() + POLYGON_BOUNDS_MARGIN)
+        return POLYGON_BOUNDS_OUTSIDE;
+
+    if (VECTOR2D_GETY(minimum) >= aClipRectangle.getMinYf() + POLYGON_BOUNDS_MARGIN &&
+        VECTOR2D_GETY(maximum) < aClipRectangle.getMaxYf() - POLYGON_BOUNDS_MARGIN &&
+        VECTOR2D_GETX(minimum) >= aClipRectangle.getMinXf() + POLYGON_BOUNDS_MARGIN &&
+        VECTOR2D_GETX(maximum) < aClipRectangle.getMaxXf() - POLYGON_BOUNDS_MARGIN)
+        return POLYGON_BOUNDS_INSIDE;
+
+    return POLYGON_BOUNDS_PARTIAL;
+}
+
+
 //! Calculates the edges of the polygon with transformation and clipping to aEdges array.
 /*! \param aFirstVertex the index for the first vertex.
  *  \param aVertexCount the amount of vertices to convert.
@@ -64,6 +489,9 @@ int SubPolygon::getEdges(int aFirstVertex, int aVertexCount, PolygonEdge *aEdges
     if (endIndex > mVertexCount)
         endIndex = mVertexCount;
 
+    if (getBoundsClip(mMinimum,mMaximum,aTransformation,aClipRectangle) == POLYGON_BOUNDS_OUTSIDE)
+        return 0;
+
     VECTOR2D prevPosition = mVertices[startIndex];
     MATRIX2D_TRANSFORM(aTransformation,mVertices[startIndex],prevPosition);
     int prevClipFlags = getClipFlags(prevPosition, aClipRectangle);
@@ -344,6 +772,11 @@ bool SubPolygon::getVerticalEdge(RATIONAL aStartY, RATIONAL aEndY, RATIONAL aX,
  */
 int SubPolygon::getScanEdges(PolygonScanEdge *aEdges, const MATRIX2D &aTransformation, const ClipRectangle &aClipRectangle) const
 {
+    // Reject the sub-polygon before any vertex work if it is completely outside.
+    int boundsClip = getBoundsClip(mMinimum,mMaximum,aTransformation,aClipRectangle);
+    if (boundsClip == POLYGON_BOUNDS_OUTSIDE)
+        return 0;
+
     int n;
     for (n = 0; n < mVertexCount; n++)
     {
@@ -351,37 +784,55 @@ int SubPolygon::getScanEdges(PolygonScanEdge *aEdges, const MATRIX2D &aTransform
         MATRIX2D_TRANSFORM(aTransformation,mVertices[n],mVertexData[n].mPosition);
     }
 
-    for (n = 0; n < mVertexCount; n++)
+    if (boundsClip == POLYGON_BOUNDS_INSIDE)
     {
-        // Calculate clip flags for all vertices.
-        mVertexData[n].mClipFlags = getClipFlags(mVertexData[n].mPosition, aClipRectangle);
-
-        // Calculate line of the vertex. If the vertex is clipped by top or bottom, the line
-        // is determined by the clip rectangle.
-        if (mVertexData[n].mClipFlags & POLYGON_CLIP_TOP)
+        // The sub-polygon is completely inside, so none of the vertices clip.
+        for (n = 0; n < mVertexCount; n++)
         {
-            mVertexData[n].mLine = aClipRectangle.getMinYi();
-        }
-        else if (mVertexData[n].mClipFlags & POLYGON_CLIP_BOTTOM)
-        {
-            mVertexData[n].mLine = aClipRectangle.getMaxYi() - 1;
+            mVertexData[n].mClipFlags = POLYGON_CLIP_NONE;
+            mVertexData[n].mLine = rationalToIntRoundDown(VECTOR2D_GETY(mVertexData[n].mPosition));
         }
-        else
+    }
+    else
+    {
+        for (n = 0; n < mVertexCount; n++)
         {
-            mVertexData[n].mLine = rationalToIntRoundDown(VECTOR2D_GETY(mVertexData[n].mPosition));
+            // Calculate clip flags for all vertices.
+            mVertexData[n].mClipFlags = getClipFlags(mVertexData[n].mPosition, aClipRectangle);
+
+            // Calculate line of the vertex. If the vertex is clipped by top or bottom, the line
+            // is determined by the clip rectangle.
+            if (mVertexData[n].mClipFlags & POLYGON_CLIP_TOP)
+            {
+                mVertexData[n].mLine = aClipRectangle.getMinYi();
+            }
+            else if (mVertexData[n].mClipFlags & POLYGON_CLIP_BOTTOM)
+            {
+                mVertexData[n].mLine = aClipRectangle.getMaxYi() - 1;
+            }
+            else
+            {
+                mVertexData[n].mLine = rationalToIntRoundDown(VECTOR2D_GETY(mVertexData[n].mPosition));
+            }
         }
     }
 
+#ifdef SUBPOLYGON_COALESCE_EDGES
+    int vertexCount = coalesceVertices();
+#else
+    int vertexCount = mVertexCount;
+#endif
+
     // Copy the data from 0 to the last entry to make the data to loop.
-    mVertexData[mVertexCount] = mVertexData[0];
+    mVertexData[vertexCount] = mVertexData[0];
 
     // Transform the first vertex; store.
-    // Process mVertexCount - 1 times, next is n+1
+    // Process vertexCount - 1 times, next is n+1
     // copy the first vertex to
     // Process 1 time, next is n
 
     int edgeCount = 0;
-    for (n = 0; n < mVertexCount; n++)
+    for (n = 0; n < vertexCount; n++)
     {
         int clipSum = mVertexData[n].mClipFlags | mVertexData[n + 1].mClipFlags;
         int clipUnion = mVertexData[n].mClipFlags & mVertexData[n + 1].mClipFlags;
@@ -712,6 +1163,138 @@ int SubPolygon::getScanEdges(PolygonScanEdge *aEdges, const MATRIX2D &aTransform
     return edgeCount;
 }
 
+
+#ifdef SUBPOLYGON_COALESCE_EDGES
+//! Calculates the sample pixels of an unclipped edge between two vertices.
+/*! The edge is set up and stepped exactly like getScanEdge() and the fillers
+ *  do. The pixel of each sub-scanline is stored by its distance from aStart,
+ *  so that the first sub-scanline after aStart goes to aPixels[0].
+ *  \param aStart the vertex the edge starts from in the vertex order.
+ *  \param aEnd the vertex the edge ends to in the vertex order.
+ *  \param aPixels the array for the pixels.
+ */
+inline void SubPolygon::getEdgeSamples(const VertexData &aStart, const VertexData &aEnd, int *aPixels) const
+{
+    static const FIXED_POINT offsets[SUBPIXEL_COUNT] = SUBPIXEL_OFFSETS_FIXED;
+
+    bool downwards = VECTOR2D_GETY(aStart.mPosition) < VECTOR2D_GETY(aEnd.mPosition);
+    const VertexData &top = downwards ? aStart : aEnd;
+    const VertexData &bottom = downwards ? aEnd : aStart;
+
+    int firstLine = top.mLine + 1;
+    int lastLine = bottom.mLine;
+    if (firstLine > lastLine)
+        return;
+
+    RATIONAL slope = (VECTOR2D_GETX(bottom.mPosition) - VECTOR2D_GETX(top.mPosition)) /
+                     (VECTOR2D_GETY(bottom.mPosition) - VECTOR2D_GETY(top.mPosition));
+    RATIONAL startx = VECTOR2D_GETX(top.mPosition) +
+                      ((RATIONAL)firstLine - VECTOR2D_GETY(top.mPosition)) * slope;
+
+    FIXED_POINT x = rationalToFixed(startx);
+    FIXED_POINT fixedSlope = rationalToFixed(slope);
+
+    int line;
+    for (line = firstLine; line <= lastLine; line++)
+    {
+        int index = downwards ? line - aStart.mLine - 1 : aStart.mLine - line;
+        aPixels[index] = FIXED_TO_INT(x + offsets[line & (SUBPIXEL_COUNT - 1)]);
+        x += fixedSlope;
+    }
+}
+
+
+//! Removes the transformed vertices that don't change the samples of the edges.
+/*! Runs of vertices that are strictly monotonic in y and not clipped are merged
+ *  to a single edge, if the run spans at most SUBPIXEL_COUNT sub-scanlines and
+ *  the merged edge hits the same pixel on each of them as the original edges.
+ *  The edges are short enough that the slope fix is never used, so the
+ *  coverage is identical to the unmerged edges.
+ *  The vertex data is compacted in place.
+ *  \return the amount of vertices left.
+ */
+int SubPolygon::coalesceVertices() const
+{
+    if (mVertexCount < 3)
+        return mVertexCount;
+
+    // The samples of the original edges of the run, and the ones of the merged edge.
+    int pixels[SUBPIXEL_COUNT];
+    int merged[SUBPIXEL_COUNT];
+
+    int count = 1;
+    VertexData pending = mVertexData[1];
+    RATIONAL direction = VECTOR2D_GETY(pending.mPosition) - VECTOR2D_GETY(mVertexData[0].mPosition);
+
+    int lines = mVertexData[1].mLine - mVertexData[0].mLine;
+    if (lines < 0)
+        lines = -lines;
+    bool sampled = (mVertexData[0].mClipFlags | pending.mClipFlags) == POLYGON_CLIP_NONE &&
+                   lines <= SUBPIXEL_COUNT;
+    if (sampled)
+        getEdgeSamples(mVertexData[0],pending,pixels);
+
+    int n;
+    for (n = 2; n < mVertexCount; n++)
+    {
+        const VertexData &start = mVertexData[count - 1];
+        const VertexData &vertex = mVertexData[n];
+
+        RATIONAL step = VECTOR2D_GETY(vertex.mPosition) - VECTOR2D_GETY(pending.mPosition);
+        int runLines = vertex.mLine - start.mLine;
+        if (runLines < 0)
+            runLines = -runLines;
+
+        bool merge = sampled && vertex.mClipFlags == POLYGON_CLIP_NONE &&
+                     runLines <= SUBPIXEL_COUNT &&
+                     ((direction > INT_TO_RATIONAL(0) && step > INT_TO_RATIONAL(0)) ||
+                      (direction < INT_TO_RATIONAL(0) && step < INT_TO_RATIONAL(0)));
+
+        if (merge)
+        {
+            // Add the samples of the edge to the vertex to the run, then compare
+            // them to the samples of the merged edge.
+            getEdgeSamples(pending,vertex,&pixels[lines]);
+            getEdgeSamples(start,vertex,merged);
+
+            int i;
+            for (i = 0; i < runLines; i++)
+            {
+                if (merged[i] != pixels[i])
+                    merge = false;
+            }
+        }
+
+        if (merge)
+        {
+            // The pending vertex is removed, and the vertex becomes the end of the run.
+            lines = runLines;
+        }
+        else
+        {
+            // The pending vertex ends the run and starts a new one.
+            mVertexData[count] = pending;
+            count++;
+            direction = step;
+
+            lines = vertex.mLine - pending.mLine;
+            if (lines < 0)
+                lines = -lines;
+            sampled = (pending.mClipFlags | vertex.mClipFlags) == POLYGON_CLIP_NONE &&
+                      lines <= SUBPIXEL_COUNT;
+            if (sampled)
+                getEdgeSamples(pending,vertex,pixels);
+        }
+        pending = vertex;
+    }
+
+    mVertexData[count] = pending;
+    count++;
+
+    return count;
+}
+#endif
+
 #ifdef SUBPOLYGON_DEBUG
 
 //! A debug routine for checking that generated edge is valid.
@@ -19,6 +19,7 @@
 #include "polygon/base/Base.h"
 #include "polygon/svg/ShapeMaker.h"
 #include "polygon/svg/SVG.h"
+#include "polygon/svg/SVGReader.h"
 #include "polygon/svg/DumpSVG.h"
 #include "../libs/tinyxml/tinyxml.h"
 
@@ -83,7 +84,7 @@ void StackNodePool::putNodes(StackNode *aNode)
     StackNode *node = aNode;
     while (node)
     {
-        StackNode *nextNode = node;
+        StackNode *nextNode = node->mNext;
         put(node);
         node = nextNode;
     }
@@ -139,6 +140,17 @@ StackNode * SVGStackNodeFillRulePool::createNode()
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// A pool for stroke stack nodes.
+///////////////////////////////////////////////////////////////////////////////
+
+//! Virtual method for implementations for creating the nodes.
+StackNode * SVGStackNodeStrokePool::createNode()
+{
+    return new SVGStackNodeStroke();
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 //! A stack used while processing the SVG document.
 ///////////////////////////////////////////////////////////////////////////////
@@ -149,6 +161,7 @@ SVGStack::SVGStack()
     mTransformationStack = NULL;
     mPaintStack = NULL;
     mFillRuleStack = NULL;
+    mStrokeStack = NULL;
 }
 
 
@@ -158,6 +171,7 @@ SVGStack::~SVGStack()
     mTransformationPool.putNodes(mTransformationStack);
     mPaintPool.putNodes(mPaintStack);
     mFillRulePool.putNodes(mFillRuleStack);
+    mStrokePool.putNodes(mStrokeStack);
 }
 
 
@@ -166,7 +180,8 @@ bool SVGStack::init(int aStackSize, int aStackIncrement)
 {
     if (!mTransformationPool.init(aStackSize,aStackIncrement) ||
         !mPaintPool.init(aStackSize,aStackIncrement) ||
-        !mFillRulePool.init(aStackSize,aStackIncrement))
+        !mFillRulePool.init(aStackSize,aStackIncrement) ||
+        !mStrokePool.init(aStackSize,aStackIncrement))
         return false;
 
     return true;
@@ -260,6 +275,35 @@ bool SVGStack::pushFillRule(const RENDERER_FILLMODE &aFillRule)
 }
 
 
+//! Pops stroke from the stack to aStroke.
+bool SVGStack::popStroke(SVGStroke &aStroke)
+{
+    SVGStackNodeStroke *node = mStrokeStack;
+    if (node == NULL)
+        return false;
+    
+    mStrokeStack = (SVGStackNodeStroke *)node->mNext;
+    aStroke = node->mStroke;
+    mStrokePool.put(node);
+
+    return true;
+}
+
+
+//! Pushes the stroke from aStroke to the stack.
+bool SVGStack::pushStroke(const SVGStroke &aStroke)
+{
+    SVGStackNodeStroke *node =
+        (SVGStackNodeStroke *)mStrokePool.get();
+    if (node == NULL)
+        return false;
+    node->mStroke = aStroke;
+    node->mNext = mStrokeStack;
+    mStrokeStack = node;
+    return true;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // A class that is used for decomposing the SVG tree to polygons.
 ///////////////////////////////////////////////////////////////////////////////
@@ -286,6 +330,11 @@ void SVGContext::reset()
     mCurrentPaint.mColor = 0xff000000;
     mCurrentPaint.mNone = false;
     mCurrentFillRule = RENDERER_FILLMODE_EVENODD;
+    mCurrentStroke.mColor = 0;
+    mCurrentStroke.mOpacity = INT_TO_RATIONAL(1);
+    mCurrentStroke.mNone = true;
+    mCurrentStroke.mStyle = StrokeStyle();
+    updateStroke();
 }
 
 
@@ -294,7 +343,8 @@ bool SVGContext::pushState()
 {
     if (!mStack.pushPaint(mCurrentPaint) ||
         !mStack.pushTransformation(mCurrentTransformation) ||
-        !mStack.pushFillRule(mCurrentFillRule))
+        !mStack.pushFillRule(mCurrentFillRule) ||
+        !mStack.pushStroke(mCurrentStroke))
         return false;
 
     return true;
@@ -306,17 +356,38 @@ bool SVGContext::popState()
 {
     if (!mStack.popTransformation(mCurrentTransformation) ||
         !mStack.popPaint(mCurrentPaint) ||
-        !mStack.popFillRule(mCurrentFillRule))
+        !mStack.popFillRule(mCurrentFillRule) ||
+        !mStack.popStroke(mCurrentStroke))
         return false;
 
-    mShapeMaker->setTransformation(mCurrentTransformation);
-    mShapeMaker->setColor(mCurrentPaint.mColor);
-    mShapeMaker->setFillRule(mCurrentFillRule);
+    updateState();
 
     return true;
 }
 
 
+//! Stores the state of the context.
+void SVGContext::getState(SVGState &aState)
+{
+    aState.mTransformation = mCurrentTransformation;
+    aState.mPaint = mCurrentPaint;
+    aState.mFillRule = mCurrentFillRule;
+    aState.mStroke = mCurrentStroke;
+}
+
+
+//! Restores the state of the context.
+void SVGContext::setState(const SVGState &aState)
+{
+    mCurrentTransformation = aState.mTransformation;
+    mCurrentPaint = aState.mPaint;
+    mCurrentFillRule = aState.mFillRule;
+    mCurrentStroke = aState.mStroke;
+
+    updateState();
+}
+
+
 //! Sets the current transformation in the context.
 void SVGContext::setCurrentTransformation(const MATRIX2D &aTransformation)
 {
@@ -359,6 +430,14 @@ void SVGContext::setFillOff()
 }
 
 
+//! Sets the current stroke.
+void SVGContext::setCurrentStroke(const SVGStroke &aStroke)
+{
+    mCurrentStroke = aStroke;
+    updateStroke();
+}
+
+
 //! Returns the current transformation.
 const MATRIX2D & SVGContext::getCurrentTransformation()
 {
@@ -394,185 +473,53 @@ bool SVGContext::isFillOff()
 }
 
 
-//! Returns a pointer to the shape maker.
-ShapeMaker * SVGContext::getShapeMaker()
-{
-    return mShapeMaker;
-}
-
-
-///////////////////////////////////////////////////////////////////////////////
-// A class for storing the tokens in the SVG path data.
-///////////////////////////////////////////////////////////////////////////////
-
-//! Returns a pointer to the next token.
-SVGPathToken * SVGPathToken::getNext()
-{
-    return mNext;
-}
-
-
-//! Returns a pointer to the data of the token.
-const char * SVGPathToken::getBuffer()
-{
-    return mBuffer;
-}
-
-
-//! Protected constructor
-SVGPathToken::SVGPathToken(char *aBuffer)
-{
-    mNext = NULL;
-    mBuffer = aBuffer;
-}
-
-
-//! Protected destructor.
-SVGPathToken::~SVGPathToken()
+//! Returns the current stroke.
+const SVGStroke & SVGContext::getCurrentStroke()
 {
-    delete[] mBuffer;
+    return mCurrentStroke;
 }
 
 
-///////////////////////////////////////////////////////////////////////////////
-// A class for tokenizing the SVG path data.
-///////////////////////////////////////////////////////////////////////////////
-
-//! Constructor.
-SVGPathTokenizer::SVGPathTokenizer()
+//! Returns true if the fill of the paths is visible.
+bool SVGContext::isFillVisible()
 {
-    mFirstToken = mLastToken = NULL;
+    return !mCurrentPaint.mNone && getCurrentOpacity() > FLOAT_TO_RATIONAL(0.0001f);
 }
 
 
-//! Destructor.
-SVGPathTokenizer::~SVGPathTokenizer()
+//! Returns true if the stroke of the paths is visible.
+bool SVGContext::isStrokeVisible()
 {
-    SVGPathToken *token = mFirstToken;
-    while (token)
-    {
-        SVGPathToken *nextToken = token->getNext();
-        delete token;
-        token = nextToken;
-    }
+    return !mCurrentStroke.mNone &&
+           mCurrentStroke.mOpacity > FLOAT_TO_RATIONAL(0.0001f) &&
+           mCurrentStroke.mStyle.mWidth > INT_TO_RATIONAL(0);
 }
 
 
-//! Tokenizes the input string.
-bool SVGPathTokenizer::tokenize(const char *aInput)
+//! Sets the current state to the shape maker.
+void SVGContext::updateState()
 {
-    if (aInput == NULL)
-        return false;
-    /*
-    - spaces are allowed (except within a number) as well as ','
-    - a number starts with '-' or number.
-    - a number ends when the next character is not a number or '.'
-    - a command is a letter. Allowed letters are:
-      Z z - closePath (0)
-      L l - lineto (2)
-      H h - horizontal lineto (1)
-      V v - vertical lineto (1)
-      C c - curveto (6)
-      S s - smooth curveto (4)
-      Q q - quadratic bezier curveto (4)
-      T t - smooth quadratic bezier curveto (2)
-      A a - elliptical arc (7)
-    - Each command is followed by n arguments. The arguments can be
-      repeated by multiply of n to mark up another similar command.
-    */
-
-    char buffer[100];
-    int bufferIndex = 0;
-
-    bool parsingNumber = false;
-    char i;
-    do
-    {
-        i = *aInput++;
-
-        if (i == ' ' || i == ',' || i == '\r' || i == '\t' || i == '\n')
-        {
-            // Previous token ends.
-            buffer[bufferIndex] = '\0';
-            if (!addToken(buffer))
-                return false;
-            bufferIndex = 0;
-            parsingNumber = false;
-        }
-        else if (i == '-' || (i >= '0' && i <= '9') || i == '.')
-        {
-            // previous wasn't a number or '-' breaks the number reading
-            if (!parsingNumber || i == '-')
-            {
-                // Previous token ends.
-                buffer[bufferIndex] = '\0';
-                if (!addToken(buffer))
-                    return false;
-                bufferIndex = 0;
-            }
-            buffer[bufferIndex++] = i;
-            parsingNumber = true;
-        }
-        else
-        {
-            // Any other character. This is interpreted as individual token
-            // at this stage.
-            buffer[bufferIndex] = '\0';
-            if (!addToken(buffer))
-                return false;
-            bufferIndex = 0;
-            buffer[bufferIndex++] = i;
-            parsingNumber = false;
-        }
-
-        if (bufferIndex == 100)
-            return false;
-    }
-    while(i);
-
-    return true;
+    mShapeMaker->setTransformation(mCurrentTransformation);
+    mShapeMaker->setColor(mCurrentPaint.mColor);
+    mShapeMaker->setFillRule(mCurrentFillRule);
+    updateStroke();
 }
 
 
-//! Returns a pointer to the first token (call this after calling tokenize()).
-SVGPathToken * SVGPathTokenizer::getFirstToken()
+//! Sets the current stroke to the shape maker.
+void SVGContext::updateStroke()
 {
-    return mFirstToken;
+    unsigned int opacity = (int)(INT_TO_RATIONAL(255) * mCurrentStroke.mOpacity);
+    opacity <<= 24;
+    mShapeMaker->setStrokeColor((mCurrentStroke.mColor & 0x00ffffff) | (opacity & 0xff000000));
+    mShapeMaker->setStrokeStyle(mCurrentStroke.mStyle);
 }
 
 
-//! Adds a token to the list of tokens.
-bool SVGPathTokenizer::addToken(const char *aBuffer)
+//! Returns a pointer to the shape maker.
+ShapeMaker * SVGContext::getShapeMaker()
 {
-    int len = STRLEN(aBuffer);
-
-    if (len == 0)
-        return true;
-
-    char *buffer = new char[len+1];
-
-    if (buffer == NULL)
-        return false;
-
-    int n;
-    for (n = 0; n < len; n++)
-        buffer[n] = aBuffer[n];
-    buffer[len] = '\0';
-
-    SVGPathToken *token = new SVGPathToken(buffer);
-    if (token == NULL)
-    {
-        delete[] buffer;
-        return false;
-    }
-
-    if (mLastToken)
-        mLastToken->mNext = token;
-    else
-        mFirstToken = token;
-    mLastToken = token;
-
-    return true;
+    return mShapeMaker;
 }
 
 
@@ -652,6 +599,33 @@ bool SVGCommandSet::execute(SVGContext *aContext)
 }
 
 
+//! Compiles the commands to a program.
+bool SVGCommandSet::compile(SVGProgram *aProgram)
+{
+    if (mUseStack)
+    {
+        if (!aProgram->addOpcode(SVG_OPCODE_PUSH_STATE))
+            return false;
+    }
+
+    SVGCommand *command = mFirstChild;
+    while (command)
+    {
+        if (!command->compile(aProgram))
+            return false;
+        command = command->getNextSibling();
+    }
+
+    if (mUseStack)
+    {
+        if (!aProgram->addOpcode(SVG_OPCODE_POP_STATE))
+            return false;
+    }
+
+    return true;
+}
+
+
 //! Adds a new command to the set as the last child node.
 void SVGCommandSet::addLastChild(SVGCommand *aCommand)
 {
@@ -726,6 +700,17 @@ bool SVGColorCommand::execute(SVGContext *aContext)
 }
 
 
+//! Compiles the command to a program.
+bool SVGColorCommand::compile(SVGProgram *aProgram)
+{
+    if (mNone)
+        return aProgram->addOpcode(SVG_OPCODE_FILL_OFF);
+
+    return aProgram->addOpcode(SVG_OPCODE_COLOR) &&
+           aProgram->addColor(mColor);
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // An opacity definition command in SVG command tree.
 ///////////////////////////////////////////////////////////////////////////////
@@ -761,6 +746,14 @@ bool SVGOpacityCommand::execute(SVGContext *aContext)
 }
 
 
+//! Compiles the command to a program.
+bool SVGOpacityCommand::compile(SVGProgram *aProgram)
+{
+    return aProgram->addOpcode(SVG_OPCODE_OPACITY) &&
+           aProgram->addRational(mOpacity);
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // A fill rule definition command in SVG command tree.
 ///////////////////////////////////////////////////////////////////////////////
@@ -799,6 +792,173 @@ bool SVGFillRuleCommand::execute(SVGContext *aContext)
 }
 
 
+//! Compiles the command to a program.
+bool SVGFillRuleCommand::compile(SVGProgram *aProgram)
+{
+    return aProgram->addOpcode(SVG_OPCODE_FILL_RULE) &&
+           aProgram->addInt(mFillRule);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// A stroke definition command in SVG command tree.
+///////////////////////////////////////////////////////////////////////////////
+
+//! Constructor.
+SVGStrokeCommand::SVGStrokeCommand()
+{
+    mMask = 0;
+    mStroke.mColor = 0;
+    mStroke.mOpacity = INT_TO_RATIONAL(1);
+    mStroke.mNone = true;
+}
+
+
+//! Builds a stroke command from the given strings.
+/*! Returns NULL if none of the attributes is set or valid. The invalid attributes
+ *  are ignored.
+ */
+SVGCommand * SVGStrokeCommand::build(const char *aStroke, const char *aStrokeOpacity, const char *aStrokeWidth,
+                                     const char *aLineJoin, const char *aLineCap, const char *aMiterLimit,
+                                     const char *aVectorEffect)
+{
+    SVGStrokeCommand *cmd = new SVGStrokeCommand();
+    if (cmd == NULL)
+        return NULL;
+
+    if (aStroke)
+    {
+        unsigned int color;
+        if (STREQ(aStroke,"none"))
+        {
+            cmd->mStroke.mNone = true;
+            cmd->mMask |= SVG_STROKE_COLOR;
+        }
+        else if (SSCANF(aStroke,"#%x",&color) == 1)
+        {
+            cmd->mStroke.mColor = color;
+            cmd->mStroke.mNone = false;
+            cmd->mMask |= SVG_STROKE_COLOR;
+        }
+    }
+
+    float value;
+    if (aStrokeOpacity && SSCANF(aStrokeOpacity,"%f",&value) == 1)
+    {
+        cmd->mStroke.mOpacity = (RATIONAL)value;
+        cmd->mMask |= SVG_STROKE_OPACITY;
+    }
+
+    if (aStrokeWidth && SSCANF(aStrokeWidth,"%f",&value) == 1)
+    {
+        cmd->mStroke.mStyle.mWidth = (RATIONAL)value;
+        cmd->mMask |= SVG_STROKE_WIDTH;
+    }
+
+    if (aLineJoin)
+    {
+        cmd->mMask |= SVG_STROKE_JOIN;
+        if (STREQ(aLineJoin,"miter"))
+            cmd->mStroke.mStyle.mJoin = STROKE_JOIN_MITER;
+        else if (STREQ(aLineJoin,"round"))
+            cmd->mStroke.mStyle.mJoin = STROKE_JOIN_ROUND;
+        else if (STREQ(aLineJoin,"bevel"))
+            cmd->mStroke.mStyle.mJoin = STROKE_JOIN_BEVEL;
+        else
+            cmd->mMask &= ~SVG_STROKE_JOIN;
+    }
+
+    if (aLineCap)
+    {
+        cmd->mMask |= SVG_STROKE_CAP;
+        if (STREQ(aLineCap,"butt"))
+            cmd->mStroke.mStyle.mCap = STROKE_CAP_BUTT;
+        else if (STREQ(aLineCap,"round"))
+            cmd->mStroke.mStyle.mCap = STROKE_CAP_ROUND;
+        else if (STREQ(aLineCap,"square"))
+            cmd->mStroke.mStyle.mCap = STROKE_CAP_SQUARE;
+        else
+            cmd->mMask &= ~SVG_STROKE_CAP;
+    }
+
+    if (aMiterLimit && SSCANF(aMiterLimit,"%f",&value) == 1 && value >= 1.0f)
+    {
+        cmd->mStroke.mStyle.mMiterLimit = (RATIONAL)value;
+        cmd->mMask |= SVG_STROKE_MITER_LIMIT;
+    }
+
+    // Non-scaling strokes are drawn as hairlines that are the width in pixels.
+    if (aVectorEffect)
+    {
+        cmd->mStroke.mStyle.mHairline = STREQ(aVectorEffect,"non-scaling-stroke");
+        cmd->mMask |= SVG_STROKE_HAIRLINE;
+    }
+
+    if (cmd->mMask == 0)
+    {
+        delete cmd;
+        return NULL;
+    }
+
+    return cmd;
+}
+
+
+//! Executes the command, i.e. applies it to the context.
+bool SVGStrokeCommand::execute(SVGContext *aContext)
+{
+    apply(aContext,mStroke,mMask);
+    return true;
+}
+
+
+//! Compiles the command to a program.
+bool SVGStrokeCommand::compile(SVGProgram *aProgram)
+{
+    return aProgram->addOpcode(SVG_OPCODE_STROKE) &&
+           aProgram->addInt(mMask) &&
+           aProgram->addColor(mStroke.mColor) &&
+           aProgram->addInt(mStroke.mNone) &&
+           aProgram->addRational(mStroke.mOpacity) &&
+           aProgram->addRational(mStroke.mStyle.mWidth) &&
+           aProgram->addInt(mStroke.mStyle.mJoin) &&
+           aProgram->addInt(mStroke.mStyle.mCap) &&
+           aProgram->addRational(mStroke.mStyle.mMiterLimit) &&
+           aProgram->addInt(mStroke.mStyle.mHairline);
+}
+
+
+//! Applies the attributes of a stroke selected by a mask to the current stroke.
+/*! \param aContext the context.
+ *  \param aStroke the stroke to take the attributes from.
+ *  \param aMask the SVG_STROKE_* bits of the attributes to apply.
+ */
+void SVGStrokeCommand::apply(SVGContext *aContext, const SVGStroke &aStroke, unsigned int aMask)
+{
+    SVGStroke stroke = aContext->getCurrentStroke();
+
+    if (aMask & SVG_STROKE_COLOR)
+    {
+        stroke.mColor = aStroke.mColor;
+        stroke.mNone = aStroke.mNone;
+    }
+    if (aMask & SVG_STROKE_OPACITY)
+        stroke.mOpacity = aStroke.mOpacity;
+    if (aMask & SVG_STROKE_WIDTH)
+        stroke.mStyle.mWidth = aStroke.mStyle.mWidth;
+    if (aMask & SVG_STROKE_JOIN)
+        stroke.mStyle.mJoin = aStroke.mStyle.mJoin;
+    if (aMask & SVG_STROKE_CAP)
+        stroke.mStyle.mCap = aStroke.mStyle.mCap;
+    if (aMask & SVG_STROKE_MITER_LIMIT)
+        stroke.mStyle.mMiterLimit = aStroke.mStyle.mMiterLimit;
+    if (aMask & SVG_STROKE_HAIRLINE)
+        stroke.mStyle.mHairline = aStroke.mStyle.mHairline;
+
+    aContext->setCurrentStroke(stroke);
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // A begin path command in SVG command tree.
 ///////////////////////////////////////////////////////////////////////////////
@@ -807,10 +967,19 @@ bool SVGFillRuleCommand::execute(SVGContext *aContext)
 bool SVGBeginPathCommand::execute(SVGContext *aContext)
 {
     ShapeMaker *maker = aContext->getShapeMaker();
+    maker->setFillEnabled(aContext->isFillVisible());
+    maker->setStrokeEnabled(aContext->isStrokeVisible());
     return maker->beginPath();
 }
 
 
+//! Compiles the command to a program.
+bool SVGBeginPathCommand::compile(SVGProgram *aProgram)
+{
+    return aProgram->addOpcode(SVG_OPCODE_BEGIN_PATH);
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // An end path command in SVG command tree.
 ///////////////////////////////////////////////////////////////////////////////
@@ -823,583 +992,1552 @@ bool SVGEndPathCommand::execute(SVGContext *aContext)
 }
 
 
+//! Compiles the command to a program.
+bool SVGEndPathCommand::compile(SVGProgram *aProgram)
+{
+    return aProgram->addOpcode(SVG_OPCODE_END_PATH);
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
-// A command representing the path data in SVG command tree.
+// A begin layer command in SVG command tree.
 ///////////////////////////////////////////////////////////////////////////////
 
-//! Constructor.
-SVGPathCommand::SVGPathCommand()
+//! Executes the command, i.e. applies it to the context.
+bool SVGBeginLayerCommand::execute(SVGContext *aContext)
 {
-    mCommand = 0;
-    mData = NULL;
+    ShapeMaker *maker = aContext->getShapeMaker();
+    return maker->beginLayer();
 }
 
 
-//! Virtual destructor.
-SVGPathCommand::~SVGPathCommand()
+//! Compiles the command to a program.
+bool SVGBeginLayerCommand::compile(SVGProgram *aProgram)
 {
-    delete mData;
+    return aProgram->addOpcode(SVG_OPCODE_BEGIN_LAYER);
 }
 
 
-//! Returns a list of path commands, NULL if fails
-SVGCommand * SVGPathCommand::build(const char *aPathData)
+//! Creates a set of a begin path command, the given shape command and an end path command.
+/*! The set takes the ownership of the shape command. Returns NULL if fails.
+ */
+static SVGCommand * createPathSet(SVGCommand *aShape)
 {
-    SVGPathTokenizer tokenizer;
-    if (!tokenizer.tokenize(aPathData))
-        return NULL;
-
     SVGCommandSet *commands = new SVGCommandSet();
     if (!commands)
+    {
+        delete aShape;
         return NULL;
+    }
 
     SVGBeginPathCommand *begin = new SVGBeginPathCommand();
     if (!begin)
     {
+        delete aShape;
         delete commands;
         return NULL;
     }
 
     commands->addLastChild(begin);
+    commands->addLastChild(aShape);
 
-    SVGPathToken *token = tokenizer.getFirstToken();
-
-    int numberCount = 0;
-    int numbersRead = 0;
-    char currentCommand = 0;
-    RATIONAL numbers[7];
-    bool requireNumber = false;
-    while(token)
+    SVGEndPathCommand *end = new SVGEndPathCommand();
+    if (!end)
     {
-        const char *buffer = token->getBuffer();
-        if (((buffer[0] >= 'a' && buffer[0] <= 'z') ||
-             (buffer[0] >= 'A' && buffer[0] <= 'Z')) &&
-             buffer[1] == '\0')
-        {
-            // A command was encountered.
-
+        delete commands;
+        return NULL;
+    }
+
+    commands->addLastChild(end);
+    return commands;
+}
+
+
+//! Reads a length from an attribute.
+/*! Returns aDefault if the attribute is not set or can't be read. The units are
+ *  ignored.
+ */
+static RATIONAL getLength(const char *aLength, RATIONAL aDefault)
+{
+    float value;
+    if (aLength == NULL || SSCANF(aLength,"%f",&value) != 1)
+        return aDefault;
+    return (RATIONAL)value;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// A command representing the path data in SVG command tree.
+///////////////////////////////////////////////////////////////////////////////
+
+//! Constructor.
+SVGPathCommand::SVGPathCommand()
+{
+    mCommands = NULL;
+    mCommandCount = 0;
+    mCommandCapacity = 0;
+    mData = NULL;
+    mDataCount = 0;
+    mDataCapacity = 0;
+}
+
+
+//! Virtual destructor.
+SVGPathCommand::~SVGPathCommand()
+{
+    delete[] mCommands;
+    delete[] mData;
+}
+
+
+//! Returns a list of path commands, NULL if fails
+SVGCommand * SVGPathCommand::build(const char *aPathData)
+{
+    SVGPathCommand *path = new SVGPathCommand();
+    if (!path)
+        return NULL;
+
+    if (!path->parse(aPathData))
+    {
+        delete path;
+        return NULL;
+    }
+
+    return createPathSet(path);
+}
+
+
+//! Returns a list of path commands for the points of a polygon or a polyline, NULL if fails.
+/*! \param aPoints the points attribute, or NULL.
+ *  \param aClosed true for a polygon, false for a polyline.
+ */
+SVGCommand * SVGPathCommand::buildPoints(const char *aPoints, bool aClosed)
+{
+    SVGPathCommand *path = new SVGPathCommand();
+    if (!path)
+        return NULL;
+
+    if (!path->parsePoints(aPoints,aClosed))
+    {
+        delete path;
+        return NULL;
+    }
+
+    return createPathSet(path);
+}
+
+
+//! Executes the command, i.e. applies it to the context.
+bool SVGPathCommand::execute(SVGContext *aContext)
+{
+    if (!aContext->isFillVisible() && !aContext->isStrokeVisible())
+        return true;
+
+    ShapeMaker *maker = aContext->getShapeMaker();
+    const RATIONAL *data = mData;
+    int n;
+    for (n = 0; n < mCommandCount; n++)
+    {
+        char command = mCommands[n];
+        if (!executeCommand(maker,command,data))
+            return false;
+        data += getArgumentCount(command);
+    }
+
+    return true;
+}
+
+
+//! Compiles the command to a program.
+bool SVGPathCommand::compile(SVGProgram *aProgram)
+{
+    if (!aProgram->addOpcode(SVG_OPCODE_PATH) ||
+        !aProgram->addInt(mCommandCount + mDataCount))
+        return false;
+
+    const RATIONAL *data = mData;
+    int n;
+    for (n = 0; n < mCommandCount; n++)
+    {
+        char command = mCommands[n];
+        if (!aProgram->addInt(command))
+            return false;
+
+        int count = getArgumentCount(command);
+        int m;
+        for (m = 0; m < count; m++)
+        {
+            if (!aProgram->addRational(data[m]))
+                return false;
+        }
+        data += count;
+    }
+
+    return true;
+}
+
+
+//! Parses the path data to the command and argument arrays.
+/*! Only the explicit close path commands close the sub-paths for stroking.
+ *  \param aPathData the path data.
+ */
+bool SVGPathCommand::parse(const char *aPathData)
+{
+    if (aPathData == NULL)
+        return false;
+    /*
+    - spaces are allowed (except within a number) as well as ','
+    - a number starts with a sign, a number or '.'
+    - a number ends when the next character can not continue it, so for
+      instance "1-2" and "1.5.5" are both two numbers.
+    - a command is a letter, see getArgumentCount() for the allowed letters.
+    - Each command is followed by n arguments. The arguments can be
+      repeated by multiply of n to mark up another similar command.
+    */
+
+    const char *input = aPathData;
+    char currentCommand = 0;
+    int numberCount = 0;
+    int numbersRead = 0;
+    bool requireNumber = false;
+
+    char i;
+    while ((i = *input) != '\0')
+    {
+        if (i == ' ' || i == ',' || i == '\r' || i == '\t' || i == '\n')
+        {
+            input++;
+        }
+        else if ((i >= 'a' && i <= 'z') || (i >= 'A' && i <= 'Z'))
+        {
+            // A command was encountered.
+
             // This should be a number. Fail.
             if (requireNumber)
-            {
-                delete commands;
-                return NULL;
-            }
+                return false;
+
+            numberCount = getArgumentCount(i);
+            if (numberCount < 0)
+                return false;
 
-            currentCommand = buffer[0];
+            currentCommand = i;
+            input++;
 
-            switch(currentCommand)
+            if (numberCount == 0)
             {
-                // Z z - closePath (0)
-                case 'Z':
-                case 'z':
-                    numberCount = 0;
-                    break;
-                // H h - horizontal lineto (1)
-                case 'H':
-                case 'h':
-                // V v - vertical lineto (1)
-                case 'V':
-                case 'v':
-                    numberCount = 1;
-                    break;
-                // M m - moveto (2)
-                case 'M':
-                case 'm':
-                // L l - lineto (2)
-                case 'L':
-                case 'l':
-                // T t - smooth quadratic bezier curveto (2)
-                case 'T':
-                case 't':
-                    numberCount = 2;
-                    break;
-                // S s - smooth curveto (4)
-                case 'S':
-                case 's':
-                // Q q - quadratic bezier curveto (4)
-                case 'Q':
-                case 'q':
-                    numberCount = 4;
-                    break;
-                // C c - curveto (6)
-                case 'C':
-                case 'c':
-                    numberCount = 6;
-                    break;
-                // A a - elliptical arc (7)
-                case 'A':
-                case 'a':
-                    // Unsupported.
-                    numberCount = 7;
-                    break;
-                default:
-                    delete commands;
-                    return NULL;
+                if (!addCommand(currentCommand))
+                    return false;
             }
-
-            requireNumber = true;
+            else
+                requireNumber = true;
         }
         else
         {
-            // No number allowed in the start.
-            if (currentCommand == 0)
-            {
-                delete commands;
-                return NULL;
-            }
-
-            // Should be a number.
-            float num;
-            int count = SSCANF(buffer,"%f",&num);
-            if (count != 1)
-            {
-                delete commands;
-                return NULL;
-            }
+            // No number allowed in the start or after a command without
+            // arguments.
+            if (numberCount == 0)
+                return false;
 
-            numbers[numbersRead++] = (RATIONAL)num;
-        }
+            RATIONAL number;
+            if (!parseNumber(input,number) ||
+                !addArgument(number))
+                return false;
+            numbersRead++;
 
-        // If enough numbers were read, close the command.
-        if (numbersRead == numberCount)
-        {
-            SVGPathCommand *cmd = new SVGPathCommand();
-            if (cmd == NULL)
+            // If enough numbers were read, close the command.
+            if (numbersRead == numberCount)
             {
-                delete commands;
-                return NULL;
-            }
+                if (!addCommand(currentCommand))
+                    return false;
 
-            cmd->mCommand = currentCommand;
-            if (numbersRead > 0)
-            {
-                cmd->mData = new RATIONAL[numbersRead];
-                if (cmd->mData == NULL)
-                {
-                    delete cmd;
-                    delete commands;
-                    return NULL;
-                }
+                // Reset read numbers, but keep the command key. There may be
+                // following sequences of data for the same key.
+                numbersRead = 0;
+                requireNumber = false;
             }
+        }
+    }
 
-            int n;
-            for (n = 0; n < numbersRead; n++)
-            {
-                cmd->mData[n] = numbers[n];
-            }
+    // Arguments of an incomplete command are ignored. The path is left open
+    // unless it ends with a close path, so that it is not closed when stroked.
+    // Filling closes it implicitly.
+    mDataCount -= numbersRead;
 
-            commands->addLastChild(cmd);
+    return true;
+}
 
-            // Reset read numbers, but keep the command key. There may be
-            // following sequences of data for the same key.
-            numbersRead = 0;
-            requireNumber = false;
-        }
 
-        token = token->getNext();
-    }
+//! Parses a list of points to line commands.
+/*! The first point is a move and the rest are lines. A polyline is left open,
+ *  so that it is not closed when stroked. Filling closes it implicitly.
+ *  \param aPoints the points attribute, or NULL for no points.
+ *  \param aClosed if true, the path is closed after the last point.
+ */
+bool SVGPathCommand::parsePoints(const char *aPoints, bool aClosed)
+{
+    if (aPoints == NULL)
+        return true;
+
+    const char *input = aPoints;
+    int pointCount = 0;
+    int numbersRead = 0;
 
-    // Add close path as the last command.
-    if (currentCommand != 'z' && currentCommand != 'Z')
+    char i;
+    while ((i = *input) != '\0')
     {
-        SVGPathCommand *cmd = new SVGPathCommand();
-        if (cmd == NULL)
+        if (i == ' ' || i == ',' || i == '\r' || i == '\t' || i == '\n')
         {
-            delete commands;
-            return NULL;
+            input++;
+            continue;
         }
 
-        cmd->mCommand = 'z';
-        commands->addLastChild(cmd);
+        RATIONAL number;
+        if (!parseNumber(input,number) ||
+            !addArgument(number))
+            return false;
+        numbersRead++;
+
+        if (numbersRead == 2)
+        {
+            if (!addCommand(pointCount == 0 ? 'M' : 'L'))
+                return false;
+            pointCount++;
+            numbersRead = 0;
+        }
     }
 
-    SVGEndPathCommand *end = new SVGEndPathCommand();
-    if (!end)
+    // An odd coordinate at the end is ignored.
+    mDataCount -= numbersRead;
+
+    if (aClosed && pointCount > 0)
+        return addCommand('z');
+
+    return true;
+}
+
+
+//! Adds a command key to the end of the command array.
+bool SVGPathCommand::addCommand(char aCommand)
+{
+    if (mCommandCount == mCommandCapacity)
     {
-        delete commands;
-        return NULL;
+        int capacity = mCommandCapacity * 2 + 0x40;
+        char *commands = new char[capacity];
+        if (commands == NULL)
+            return false;
+
+        int n;
+        for (n = 0; n < mCommandCount; n++)
+            commands[n] = mCommands[n];
+
+        delete[] mCommands;
+        mCommands = commands;
+        mCommandCapacity = capacity;
     }
 
-    commands->addLastChild(end);
-    return commands;
+    mCommands[mCommandCount++] = aCommand;
+    return true;
 }
 
 
-//! Executes the command, i.e. applies it to the context.
-bool SVGPathCommand::execute(SVGContext *aContext)
+//! Adds an argument to the end of the argument array.
+bool SVGPathCommand::addArgument(RATIONAL aArgument)
 {
-    if (aContext->getCurrentOpacity() <= FLOAT_TO_RATIONAL(0.0001f) ||
-        aContext->isFillOff())
-        return true;
+    if (mDataCount == mDataCapacity)
+    {
+        int capacity = mDataCapacity * 2 + 0x100;
+        RATIONAL *data = new RATIONAL[capacity];
+        if (data == NULL)
+            return false;
 
-    ShapeMaker *maker = aContext->getShapeMaker();
-    bool result = false;
-    VECTOR2D p1, p2, p3;
-    switch (mCommand)
+        int n;
+        for (n = 0; n < mDataCount; n++)
+            data[n] = mData[n];
+
+        delete[] mData;
+        mData = data;
+        mDataCapacity = capacity;
+    }
+
+    mData[mDataCount++] = aArgument;
+    return true;
+}
+
+
+//! Returns the number of arguments of a path command, -1 if the command is unknown.
+int SVGPathCommand::getArgumentCount(char aCommand)
+{
+    switch(aCommand)
     {
         // Z z - closePath (0)
         case 'Z':
         case 'z':
-            result = maker->closePath();
-            break;
+            return 0;
         // H h - horizontal lineto (1)
         case 'H':
-            result = maker->horizontalLineToAbsolute(mData[0]);
-            break;
         case 'h':
-            result = maker->horizontalLineToRelative(mData[0]);
-            break;
         // V v - vertical lineto (1)
         case 'V':
-            result = maker->verticalLineToAbsolute(mData[0]);
-            break;
         case 'v':
-            result = maker->verticalLineToRelative(mData[0]);
-            break;
+            return 1;
         // M m - moveto (2)
         case 'M':
-            VECTOR2D_SETX(p1,mData[0]);
-            VECTOR2D_SETY(p1,mData[1]);
-            result = maker->moveToAbsolute(p1);
-            break;
         case 'm':
-            VECTOR2D_SETX(p1,mData[0]);
-            VECTOR2D_SETY(p1,mData[1]);
-            result = maker->moveToRelative(p1);
-            break;
         // L l - lineto (2)
         case 'L':
-            VECTOR2D_SETX(p1,mData[0]);
-            VECTOR2D_SETY(p1,mData[1]);
-            result = maker->lineToAbsolute(p1);
-            break;
         case 'l':
-            VECTOR2D_SETX(p1,mData[0]);
-            VECTOR2D_SETY(p1,mData[1]);
-            result = maker->lineToRelative(p1);
-            break;
         // T t - smooth quadratic bezier curveto (2)
         case 'T':
-            VECTOR2D_SETX(p1,mData[0]);
-            VECTOR2D_SETY(p1,mData[1]);
-            result = maker->smoothQuadraticCurveToAbsolute(p1);
-            break;
         case 't':
-            VECTOR2D_SETX(p1,mData[0]);
-            VECTOR2D_SETY(p1,mData[1]);
-            result = maker->smoothQuadraticCurveToRelative(p1);
-            break;
+            return 2;
         // S s - smooth curveto (4)
         case 'S':
-            VECTOR2D_SETX(p1,mData[0]);
-            VECTOR2D_SETY(p1,mData[1]);
-            VECTOR2D_SETX(p2,mData[2]);
-            VECTOR2D_SETY(p2,mData[3]);
-            result = maker->smoothCurveToAbsolute(p1,p2);
-            break;
         case 's':
-            VECTOR2D_SETX(p1,mData[0]);
-            VECTOR2D_SETY(p1,mData[1]);
-            VECTOR2D_SETX(p2,mData[2]);
-            VECTOR2D_SETY(p2,mData[3]);
-            result = maker->smoothCurveToRelative(p1,p2);
-            break;
         // Q q - quadratic bezier curveto (4)
         case 'Q':
-            VECTOR2D_SETX(p1,mData[0]);
-            VECTOR2D_SETY(p1,mData[1]);
-            VECTOR2D_SETX(p2,mData[2]);
-            VECTOR2D_SETY(p2,mData[3]);
-            result = maker->quadraticCurveToAbsolute(p1,p2);
-            break;
         case 'q':
-            VECTOR2D_SETX(p1,mData[0]);
-            VECTOR2D_SETY(p1,mData[1]);
-            VECTOR2D_SETX(p2,mData[2]);
-            VECTOR2D_SETY(p2,mData[3]);
-            result = maker->quadraticCurveToRelative(p1,p2);
-            break;
+            return 4;
         // C c - curveto (6)
         case 'C':
-            VECTOR2D_SETX(p1,mData[0]);
-            VECTOR2D_SETY(p1,mData[1]);
-            VECTOR2D_SETX(p2,mData[2]);
-            VECTOR2D_SETY(p2,mData[3]);
-            VECTOR2D_SETX(p3,mData[4]);
-            VECTOR2D_SETY(p3,mData[5]);
-            result = maker->curveToAbsolute(p1,p2,p3);
-            break;
         case 'c':
-            VECTOR2D_SETX(p1,mData[0]);
-            VECTOR2D_SETY(p1,mData[1]);
-            VECTOR2D_SETX(p2,mData[2]);
-            VECTOR2D_SETY(p2,mData[3]);
-            VECTOR2D_SETX(p3,mData[4]);
-            VECTOR2D_SETY(p3,mData[5]);
-            result = maker->curveToRelative(p1,p2,p3);
-            break;
+            return 6;
         // A a - elliptical arc (7)
         case 'A':
-            // Unsupported. Replace with a line to keep the image closed.
-            VECTOR2D_SETX(p1,mData[5]);
-            VECTOR2D_SETY(p1,mData[6]);
-            result = maker->lineToAbsolute(p1);
-            break;
         case 'a':
-            // Unsupported. Replace with a line to keep the image closed.
-            VECTOR2D_SETX(p1,mData[5]);
-            VECTOR2D_SETY(p1,mData[6]);
-            result = maker->lineToRelative(p1);
-            break;
+            // Unsupported.
+            return 7;
+    }
+
+    return -1;
+}
+
+
+//! Parses a number from the input and moves the input past it.
+/*! The number is of form [sign] digits [. digits] [e [sign] digits], where
+ *  either the integer or the fraction digits may be missing. The digits
+ *  beyond SVG_PATH_NUMBER_DIGITS significant ones are ignored.
+ *  \param aInput the input, moved to the first character after the number.
+ *  \param aValue the parsed value.
+ *  \return true if a number was found, false otherwise.
+ */
+bool SVGPathCommand::parseNumber(const char *&aInput, RATIONAL &aValue)
+{
+    static const double powers[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char *input = aInput;
+
+    bool negative = false;
+    if (*input == '-' || *input == '+')
+    {
+        negative = *input == '-';
+        input++;
+    }
+
+    double mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool found = false;
+
+    while (*input >= '0' && *input <= '9')
+    {
+        if (digits < SVG_PATH_NUMBER_DIGITS)
+        {
+            mantissa = mantissa * 10 + (*input - '0');
+            if (mantissa != 0)
+                digits++;
+        }
+        else
+            exponent++;
+        found = true;
+        input++;
+    }
+
+    if (*input == '.')
+    {
+        input++;
+        while (*input >= '0' && *input <= '9')
+        {
+            if (digits < SVG_PATH_NUMBER_DIGITS)
+            {
+                mantissa = mantissa * 10 + (*input - '0');
+                if (mantissa != 0)
+                    digits++;
+                exponent--;
+            }
+            found = true;
+            input++;
+        }
     }
 
-    if (!result)
+    if (!found)
         return false;
 
+    // The exponent is part of the number only if it has digits.
+    if (*input == 'e' || *input == 'E')
+    {
+        const char *exponentInput = input + 1;
+        bool negativeExponent = false;
+        if (*exponentInput == '-' || *exponentInput == '+')
+        {
+            negativeExponent = *exponentInput == '-';
+            exponentInput++;
+        }
+
+        if (*exponentInput >= '0' && *exponentInput <= '9')
+        {
+            int value = 0;
+            while (*exponentInput >= '0' && *exponentInput <= '9')
+            {
+                if (value < 1000)
+                    value = value * 10 + (*exponentInput - '0');
+                exponentInput++;
+            }
+            exponent += negativeExponent ? -value : value;
+            input = exponentInput;
+        }
+    }
+
+    double value = mantissa;
+    if (mantissa == 0)
+        exponent = 0;
+
+    if (exponent > 22)
+        value *= pow(10.0,exponent);
+    else if (exponent > 0)
+        value *= powers[exponent];
+    else if (exponent < -22)
+        value /= pow(10.0,-exponent);
+    else if (exponent < 0)
+        value /= powers[-exponent];
+
+    aValue = (RATIONAL)(negative ? -value : value);
+    aInput = input;
     return true;
 }
 
 
-///////////////////////////////////////////////////////////////////////////////
-// A transformation command in SVG command tree.
-///////////////////////////////////////////////////////////////////////////////
-
-//! Constructor.
-SVGTransformationCommand::SVGTransformationCommand(const MATRIX2D &aMatrix)
+//! Executes a single path command with the given arguments.
+bool SVGPathCommand::executeCommand(ShapeMaker *aMaker, char aCommand, const RATIONAL *aData)
 {
-    mMatrix = aMatrix;
-}
-
+    bool result = false;
+    VECTOR2D p1, p2, p3;
+    switch (aCommand)
+    {
+        // Z z - closePath (0)
+        case 'Z':
+        case 'z':
+            result = aMaker->closePath();
+            break;
+        // H h - horizontal lineto (1)
+        case 'H':
+            result = aMaker->horizontalLineToAbsolute(aData[0]);
+            break;
+        case 'h':
+            result = aMaker->horizontalLineToRelative(aData[0]);
+            break;
+        // V v - vertical lineto (1)
+        case 'V':
+            result = aMaker->verticalLineToAbsolute(aData[0]);
+            break;
+        case 'v':
+            result = aMaker->verticalLineToRelative(aData[0]);
+            break;
+        // M m - moveto (2)
+        case 'M':
+            VECTOR2D_SETX(p1,aData[0]);
+            VECTOR2D_SETY(p1,aData[1]);
+            result = aMaker->moveToAbsolute(p1);
+            break;
+        case 'm':
+            VECTOR2D_SETX(p1,aData[0]);
+            VECTOR2D_SETY(p1,aData[1]);
+            result = aMaker->moveToRelative(p1);
+            break;
+        // L l - lineto (2)
+        case 'L':
+            VECTOR2D_SETX(p1,aData[0]);
+            VECTOR2D_SETY(p1,aData[1]);
+            result = aMaker->lineToAbsolute(p1);
+            break;
+        case 'l':
+            VECTOR2D_SETX(p1,aData[0]);
+            VECTOR2D_SETY(p1,aData[1]);
+            result = aMaker->lineToRelative(p1);
+            break;
+        // T t - smooth quadratic bezier curveto (2)
+        case 'T':
+            VECTOR2D_SETX(p1,aData[0]);
+            VECTOR2D_SETY(p1,aData[1]);
+            result = aMaker->smoothQuadraticCurveToAbsolute(p1);
+            break;
+        case 't':
+            VECTOR2D_SETX(p1,aData[0]);
+            VECTOR2D_SETY(p1,aData[1]);
+            result = aMaker->smoothQuadraticCurveToRelative(p1);
+            break;
+        // S s - smooth curveto (4)
+        case 'S':
+            VECTOR2D_SETX(p1,aData[0]);
+            VECTOR2D_SETY(p1,aData[1]);
+            VECTOR2D_SETX(p2,aData[2]);
+            VECTOR2D_SETY(p2,aData[3]);
+            result = aMaker->smoothCurveToAbsolute(p1,p2);
+            break;
+        case 's':
+            VECTOR2D_SETX(p1,aData[0]);
+            VECTOR2D_SETY(p1,aData[1]);
+            VECTOR2D_SETX(p2,aData[2]);
+            VECTOR2D_SETY(p2,aData[3]);
+            result = aMaker->smoothCurveToRelative(p1,p2);
+            break;
+        // Q q - quadratic bezier curveto (4)
+        case 'Q':
+            VECTOR2D_SETX(p1,aData[0]);
+            VECTOR2D_SETY(p1,aData[1]);
+            VECTOR2D_SETX(p2,aData[2]);
+            VECTOR2D_SETY(p2,aData[3]);
+            result = aMaker->quadraticCurveToAbsolute(p1,p2);
+            break;
+        case 'q':
+            VECTOR2D_SETX(p1,aData[0]);
+            VECTOR2D_SETY(p1,aData[1]);
+            VECTOR2D_SETX(p2,aData[2]);
+            VECTOR2D_SETY(p2,aData[3]);
+            result = aMaker->quadraticCurveToRelative(p1,p2);
+            break;
+        // C c - curveto (6)
+        case 'C':
+            VECTOR2D_SETX(p1,aData[0]);
+            VECTOR2D_SETY(p1,aData[1]);
+            VECTOR2D_SETX(p2,aData[2]);
+            VECTOR2D_SETY(p2,aData[3]);
+            VECTOR2D_SETX(p3,aData[4]);
+            VECTOR2D_SETY(p3,aData[5]);
+            result = aMaker->curveToAbsolute(p1,p2,p3);
+            break;
+        case 'c':
+            VECTOR2D_SETX(p1,aData[0]);
+            VECTOR2D_SETY(p1,aData[1]);
+            VECTOR2D_SETX(p2,aData[2]);
+            VECTOR2D_SETY(p2,aData[3]);
+            VECTOR2D_SETX(p3,aData[4]);
+            VECTOR2D_SETY(p3,aData[5]);
+            result = aMaker->curveToRelative(p1,p2,p3);
+            break;
+        // A a - elliptical arc (7)
+        case 'A':
+            // Unsupported. Replace with a line to keep the image closed.
+            VECTOR2D_SETX(p1,aData[5]);
+            VECTOR2D_SETY(p1,aData[6]);
+            result = aMaker->lineToAbsolute(p1);
+            break;
+        case 'a':
+            // Unsupported. Replace with a line to keep the image closed.
+            VECTOR2D_SETX(p1,aData[5]);
+            VECTOR2D_SETY(p1,aData[6]);
+            result = aMaker->lineToRelative(p1);
+            break;
+    }
+
+    return result;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// A rectangle command in SVG command tree.
+///////////////////////////////////////////////////////////////////////////////
+
+//! Constructor.
+SVGRectangleCommand::SVGRectangleCommand(const VECTOR2D &aPosition, const VECTOR2D &aSize, const VECTOR2D &aRadius)
+{
+    mPosition = aPosition;
+    mSize = aSize;
+    mRadius = aRadius;
+}
+
+
+//! Returns a list of path commands for a rectangle, NULL if fails.
+/*! The attributes are those of the 'rect' element, NULL if not set. If only one
+ *  of the corner radii is set, it is used for both.
+ */
+SVGCommand * SVGRectangleCommand::build(const char *aX, const char *aY, const char *aWidth, const char *aHeight,
+                                        const char *aRx, const char *aRy)
+{
+    RATIONAL rx = getLength(aRx,INT_TO_RATIONAL(-1));
+    RATIONAL ry = getLength(aRy,INT_TO_RATIONAL(-1));
+    if (rx < INT_TO_RATIONAL(0))
+        rx = ry;
+    if (ry < INT_TO_RATIONAL(0))
+        ry = rx;
+
+    VECTOR2D position(getLength(aX,INT_TO_RATIONAL(0)),getLength(aY,INT_TO_RATIONAL(0)));
+    VECTOR2D size(getLength(aWidth,INT_TO_RATIONAL(0)),getLength(aHeight,INT_TO_RATIONAL(0)));
+    VECTOR2D radius(rx,ry);
+
+    SVGRectangleCommand *cmd = new SVGRectangleCommand(position,size,radius);
+    if (!cmd)
+        return NULL;
+
+    return createPathSet(cmd);
+}
+
+
+//! Executes the command, i.e. applies it to the context.
+bool SVGRectangleCommand::execute(SVGContext *aContext)
+{
+    if (!aContext->isFillVisible() && !aContext->isStrokeVisible())
+        return true;
+
+    return aContext->getShapeMaker()->rectangle(mPosition,mSize,mRadius);
+}
+
+
+//! Compiles the command to a program.
+bool SVGRectangleCommand::compile(SVGProgram *aProgram)
+{
+    return aProgram->addOpcode(SVG_OPCODE_RECTANGLE) &&
+           aProgram->addRational(VECTOR2D_GETX(mPosition)) &&
+           aProgram->addRational(VECTOR2D_GETY(mPosition)) &&
+           aProgram->addRational(VECTOR2D_GETX(mSize)) &&
+           aProgram->addRational(VECTOR2D_GETY(mSize)) &&
+           aProgram->addRational(VECTOR2D_GETX(mRadius)) &&
+           aProgram->addRational(VECTOR2D_GETY(mRadius));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// An ellipse command in SVG command tree.
+///////////////////////////////////////////////////////////////////////////////
+
+//! Constructor.
+SVGEllipseCommand::SVGEllipseCommand(const VECTOR2D &aCenter, const VECTOR2D &aRadius)
+{
+    mCenter = aCenter;
+    mRadius = aRadius;
+}
+
+
+//! Returns a list of path commands for an ellipse, NULL if fails.
+/*! The attributes are those of the 'ellipse' element, NULL if not set. For the
+ *  'circle' element, the radius is given as both radii.
+ */
+SVGCommand * SVGEllipseCommand::build(const char *aCx, const char *aCy, const char *aRx, const char *aRy)
+{
+    VECTOR2D center(getLength(aCx,INT_TO_RATIONAL(0)),getLength(aCy,INT_TO_RATIONAL(0)));
+    VECTOR2D radius(getLength(aRx,INT_TO_RATIONAL(0)),getLength(aRy,INT_TO_RATIONAL(0)));
+
+    SVGEllipseCommand *cmd = new SVGEllipseCommand(center,radius);
+    if (!cmd)
+        return NULL;
+
+    return createPathSet(cmd);
+}
+
+
+//! Executes the command, i.e. applies it to the context.
+bool SVGEllipseCommand::execute(SVGContext *aContext)
+{
+    if (!aContext->isFillVisible() && !aContext->isStrokeVisible())
+        return true;
+
+    return aContext->getShapeMaker()->ellipse(mCenter,mRadius);
+}
+
+
+//! Compiles the command to a program.
+bool SVGEllipseCommand::compile(SVGProgram *aProgram)
+{
+    return aProgram->addOpcode(SVG_OPCODE_ELLIPSE) &&
+           aProgram->addRational(VECTOR2D_GETX(mCenter)) &&
+           aProgram->addRational(VECTOR2D_GETY(mCenter)) &&
+           aProgram->addRational(VECTOR2D_GETX(mRadius)) &&
+           aProgram->addRational(VECTOR2D_GETY(mRadius));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// A transformation command in SVG command tree.
+///////////////////////////////////////////////////////////////////////////////
+
+//! Constructor.
+SVGTransformationCommand::SVGTransformationCommand(const MATRIX2D &aMatrix)
+{
+    mMatrix = aMatrix;
+}
+
+
+//! Executes the command, i.e. applies it to the context.
+bool SVGTransformationCommand::execute(SVGContext *aContext)
+{
+    aContext->setCurrentTransformation(mMatrix);
+    return true;
+}
+
+
+//! Compiles the command to a program.
+bool SVGTransformationCommand::compile(SVGProgram *aProgram)
+{
+    return aProgram->addOpcode(SVG_OPCODE_TRANSFORM) &&
+           aProgram->addMatrix(mMatrix);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// A command representing a document in SVG command tree.
+///////////////////////////////////////////////////////////////////////////////
+
+//! Constructor.
+SVGDocument::SVGDocument()
+{
+    mMatrix.makeIdentity();
+}
+
+
+//! Loads the SVG document from a file.
+/*! If aLayers is true, each top level group is stored as a layer of its own.
+ */
+SVGDocument * SVGDocument::load(const char *aFileName, bool aLayers)
+{
+    SVGDocument *svgdoc = NULL;
+    TiXmlDocument *xmldoc = new TiXmlDocument();
+
+    TiXmlElement *root = NULL;
+    if (xmldoc && xmldoc->LoadFile(aFileName) &&
+        (root = xmldoc->RootElement()) != NULL)
+    {
+        svgdoc = new SVGDocument();
+        if (!(svgdoc && createTree(root,svgdoc,aLayers)))
+        {
+            delete svgdoc;
+            svgdoc = NULL;
+        }
+    }
+    
+    delete xmldoc;
+
+    return svgdoc;
+}
+
+
+//! Sets the root level transformation for the SVG document.
+void SVGDocument::setTransformation(const MATRIX2D &aMatrix)
+{
+    mMatrix = aMatrix;
+}
+
+
+//! Executes the command, i.e. applies it to the context.
+bool SVGDocument::execute(SVGContext *aContext)
+{
+    aContext->reset();
+    aContext->setCurrentTransformation(mMatrix);
+    return SVGCommandSet::execute(aContext);
+}
+
+
+//! Compiles the command to a program.
+bool SVGDocument::compile(SVGProgram *aProgram)
+{
+    if (!aProgram->addOpcode(SVG_OPCODE_RESET) ||
+        !aProgram->addMatrix(mMatrix))
+        return false;
+    return SVGCommandSet::compile(aProgram);
+}
+
+
+//! Compiles the document to a program that can be executed repeatedly.
+/*! The program does not refer to the document, so the document can be
+ *  deleted after this. Returns NULL if fails.
+ */
+SVGProgram * SVGDocument::createProgram()
+{
+    SVGProgram *program = new SVGProgram();
+    if (program == NULL)
+        return NULL;
+
+    if (!compile(program))
+    {
+        delete program;
+        return NULL;
+    }
+
+    return program;
+}
+
+
+//! Creates the SVG tree from the XML DOM.
+bool SVGDocument::createTree(class TiXmlElement *aElement, SVGCommandSet *aSet, bool aLayers)
+{
+    if (STREQ(aElement->Value(),"g"))
+    {
+        SVGCommandSet *group = new SVGCommandSet(true);
+        if (!group)
+            return false;
+
+        // The group and the paths after it start new layers. The nested groups
+        // belong to the layer of the top level group.
+        if (aLayers)
+            aSet->addLastChild(new SVGBeginLayerCommand());
+
+        aSet->addLastChild(group);
+
+        if (aLayers)
+            aSet->addLastChild(new SVGBeginLayerCommand());
+
+        const char *fill = aElement->Attribute("fill");
+        const char *fillOpacity = aElement->Attribute("fill-opacity");
+        const char *fillRule = aElement->Attribute("fill-rule");
+
+        if (fill)
+        {
+            SVGCommand *cmd = SVGColorCommand::build(fill);
+            if (cmd)
+                group->addLastChild(cmd);
+        }
+
+        if (fillOpacity)
+        {
+            SVGCommand *cmd = SVGOpacityCommand::build(fillOpacity);
+            if (cmd)
+                group->addLastChild(cmd);
+        }
+
+        if (fillRule)
+        {
+            SVGCommand *cmd = SVGFillRuleCommand::build(fillRule);
+            if (cmd)
+                group->addLastChild(cmd);
+        }
+
+        SVGCommand *stroke = createStroke(aElement);
+        if (stroke)
+            group->addLastChild(stroke);
+
+        TiXmlElement *child = aElement->FirstChildElement();
+        while (child)
+        {
+            if (!createTree(child,group,false))
+                return false;
+            child = child->NextSiblingElement();
+        }
+    }
+    else if (STREQ(aElement->Value(),"path"))
+    {
+        const char *fill = aElement->Attribute("fill");
+        const char *fillOpacity = aElement->Attribute("fill-opacity");
+        const char *fillRule = aElement->Attribute("fill-rule");
+        const char *data = aElement->Attribute("d");
+        SVGCommand *stroke = createStroke(aElement);
+
+        SVGCommand *path = createPath(fill,fillOpacity,fillRule,stroke,data);
+
+        if (!path)
+            return false;
+
+        aSet->addLastChild(path);
+    }
+    else if (STREQ(aElement->Value(),"rect") ||
+             STREQ(aElement->Value(),"circle") ||
+             STREQ(aElement->Value(),"ellipse") ||
+             STREQ(aElement->Value(),"polygon") ||
+             STREQ(aElement->Value(),"polyline"))
+    {
+        const char *fill = aElement->Attribute("fill");
+        const char *fillOpacity = aElement->Attribute("fill-opacity");
+        const char *fillRule = aElement->Attribute("fill-rule");
+
+        SVGCommand *shape = createBasicShape(aElement);
+        if (!shape)
+            return false;
+
+        SVGCommand *stroke = createStroke(aElement);
+        SVGCommand *path = createShape(fill,fillOpacity,fillRule,stroke,shape);
+
+        if (!path)
+            return false;
+
+        aSet->addLastChild(path);
+    }
+    else
+    {
+        TiXmlElement *child = aElement->FirstChildElement();
+        while (child)
+        {
+            if (!createTree(child,aSet,aLayers))
+                return false;
+            child = child->NextSiblingElement();
+        }
+    }
+
+    return true;
+}
+
+
+//! Creates a stroke command from the attributes of an element.
+/*! Returns NULL if the element has no stroke attributes.
+ */
+SVGCommand * SVGDocument::createStroke(class TiXmlElement *aElement)
+{
+    return SVGStrokeCommand::build(aElement->Attribute("stroke"),
+                                   aElement->Attribute("stroke-opacity"),
+                                   aElement->Attribute("stroke-width"),
+                                   aElement->Attribute("stroke-linejoin"),
+                                   aElement->Attribute("stroke-linecap"),
+                                   aElement->Attribute("stroke-miterlimit"),
+                                   aElement->Attribute("vector-effect"));
+}
+
+
+//! Creates the path commands for a basic shape element, NULL if fails.
+/*! The basic shapes are 'rect', 'circle', 'ellipse', 'polygon' and 'polyline'.
+ */
+SVGCommand * SVGDocument::createBasicShape(class TiXmlElement *aElement)
+{
+    const char *name = aElement->Value();
+
+    if (STREQ(name,"rect"))
+        return SVGRectangleCommand::build(aElement->Attribute("x"),aElement->Attribute("y"),
+                                          aElement->Attribute("width"),aElement->Attribute("height"),
+                                          aElement->Attribute("rx"),aElement->Attribute("ry"));
+    if (STREQ(name,"circle"))
+        return SVGEllipseCommand::build(aElement->Attribute("cx"),aElement->Attribute("cy"),
+                                        aElement->Attribute("r"),aElement->Attribute("r"));
+    if (STREQ(name,"ellipse"))
+        return SVGEllipseCommand::build(aElement->Attribute("cx"),aElement->Attribute("cy"),
+                                        aElement->Attribute("rx"),aElement->Attribute("ry"));
+    if (STREQ(name,"polygon"))
+        return SVGPathCommand::buildPoints(aElement->Attribute("points"),true);
+    if (STREQ(name,"polyline"))
+        return SVGPathCommand::buildPoints(aElement->Attribute("points"),false);
+
+    return NULL;
+}
+
+
+//! Creates a path command set from strings.
+/*! The set takes the ownership of the stroke command.
+ */
+SVGCommand * SVGDocument::createPath(const char *aFill, const char *aFillOpacity, const char *aFillRule, SVGCommand *aStroke, const char *aPath)
+{
+    // A path without the path data only has the attributes.
+    SVGCommand *path = NULL;
+    if (aPath)
+    {
+        path = SVGPathCommand::build(aPath);
+        if (path == NULL)
+        {
+            delete aStroke;
+            return NULL;
+        }
+    }
+
+    return createShape(aFill,aFillOpacity,aFillRule,aStroke,path);
+}
+
+
+//! Creates a path command set for a shape from strings.
+/*! The set takes the ownership of the stroke and the shape commands. The shape
+ *  may be NULL.
+ */
+SVGCommand * SVGDocument::createShape(const char *aFill, const char *aFillOpacity, const char *aFillRule, SVGCommand *aStroke, SVGCommand *aShape)
+{
+    SVGCommandSet *set = new SVGCommandSet(aFill != NULL || aFillOpacity != NULL || aStroke != NULL);
+
+    if (set == NULL)
+    {
+        delete aStroke;
+        delete aShape;
+    }
+
+    if (set)
+    {
+        if (aFill)
+        {
+            SVGCommand *cmd = SVGColorCommand::build(aFill);
+            if (cmd)
+                set->addLastChild(cmd);
+        }
+    
+        if (aFillOpacity)
+        {
+            SVGCommand *cmd = SVGOpacityCommand::build(aFillOpacity);
+            if (cmd)
+                set->addLastChild(cmd);
+        }
+
+        if (aFillRule)
+        {
+            SVGCommand *cmd = SVGFillRuleCommand::build(aFillRule);
+            if (cmd)
+                set->addLastChild(cmd);
+        }
+
+        if (aStroke)
+            set->addLastChild(aStroke);
+
+        if (aShape)
+            set->addLastChild(aShape);
+    }
+
+    return set;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// An SVG command tree compiled to a flat stream of opcodes and operands.
+///////////////////////////////////////////////////////////////////////////////
+
+//! Constructor.
+SVGProgram::SVGProgram()
+{
+    mCode = NULL;
+    mSize = 0;
+    mCapacity = 0;
+    mDepth = 0;
+    mMaxDepth = 0;
+    mPathCount = 0;
+    mStates = NULL;
+    mStateCount = 0;
+}
+
+
+//! Destructor.
+SVGProgram::~SVGProgram()
+{
+    delete[] mCode;
+    delete[] mStates;
+}
+
+
+//! Executes the program, i.e. applies it to the context.
+bool SVGProgram::execute(SVGContext *aContext)
+{
+    if (mStateCount < mMaxDepth)
+    {
+        delete[] mStates;
+        mStates = new SVGState[mMaxDepth];
+        if (mStates == NULL)
+        {
+            mStateCount = 0;
+            return false;
+        }
+        mStateCount = mMaxDepth;
+    }
+
+    return execute(aContext,0,mPathCount,mStates);
+}
+
+
+//! Executes a range of the paths of the program.
+/*! The state changes are always executed, so that each path gets the same state
+ *  as when the whole program is executed. The layers are begun by the range of
+ *  the path that follows them. The range that reaches the last path executes
+ *  also the rest of the program. The program is not modified, so the ranges
+ *  can be executed concurrently to different contexts.
+ *  \param aContext the context.
+ *  \param aFirstPath the index of the first path to execute.
+ *  \param aPathCount the count of paths to execute.
+ */
+bool SVGProgram::execute(SVGContext *aContext, int aFirstPath, int aPathCount)
+{
+    SVGState *states = new SVGState[mMaxDepth];
+    if (states == NULL)
+        return false;
+
+    bool result = execute(aContext,aFirstPath,aPathCount,states);
+
+    delete[] states;
+
+    return result;
+}
+
+
+//! Executes a range of the paths of the program with the given state stack.
+bool SVGProgram::execute(SVGContext *aContext, int aFirstPath, int aPathCount, SVGState *aStates)
+{
+    ShapeMaker *maker = aContext->getShapeMaker();
+    const SVGCodeWord *code = mCode;
+    const SVGCodeWord *end = mCode + mSize;
+    int depth = 0;
+
+    int path = 0;
+    int lastPath = aFirstPath + aPathCount;
+    if (lastPath >= mPathCount)
+        lastPath = mPathCount + 1;
+    bool inRange = path >= aFirstPath && path < lastPath;
+
+    MATRIX2D matrix;
+    SVGStroke stroke;
+    RATIONAL arguments[7];
+    int n, m;
+
+    while (code < end)
+    {
+        switch ((code++)->mInt)
+        {
+            case SVG_OPCODE_RESET:
+                aContext->reset();
+                // The root transformation follows as with the transformation.
+            case SVG_OPCODE_TRANSFORM:
+                for (n = 0; n < 3; n++)
+                {
+                    for (m = 0; m < 2; m++)
+                        matrix.mMatrix[n][m] = (code++)->mRational;
+                }
+                aContext->setCurrentTransformation(matrix);
+                break;
+
+            case SVG_OPCODE_PUSH_STATE:
+                aContext->getState(aStates[depth++]);
+                break;
+
+            case SVG_OPCODE_POP_STATE:
+                aContext->setState(aStates[--depth]);
+                break;
+
+            case SVG_OPCODE_COLOR:
+                aContext->setCurrentColor((code++)->mColor);
+                break;
+
+            case SVG_OPCODE_FILL_OFF:
+                aContext->setFillOff();
+                break;
+
+            case SVG_OPCODE_OPACITY:
+                aContext->setCurrentOpacity((code++)->mRational);
+                break;
+
+            case SVG_OPCODE_FILL_RULE:
+                aContext->setCurrentFillRule((RENDERER_FILLMODE)(code++)->mInt);
+                break;
+
+            case SVG_OPCODE_STROKE:
+                n = (code++)->mInt;
+                stroke.mColor = (code++)->mColor;
+                stroke.mNone = (code++)->mInt != 0;
+                stroke.mOpacity = (code++)->mRational;
+                stroke.mStyle.mWidth = (code++)->mRational;
+                stroke.mStyle.mJoin = (STROKE_JOIN)(code++)->mInt;
+                stroke.mStyle.mCap = (STROKE_CAP)(code++)->mInt;
+                stroke.mStyle.mMiterLimit = (code++)->mRational;
+                stroke.mStyle.mHairline = (code++)->mInt != 0;
+                SVGStrokeCommand::apply(aContext,stroke,n);
+                break;
+
+            case SVG_OPCODE_BEGIN_PATH:
+                if (!inRange)
+                    break;
+                maker->setFillEnabled(aContext->isFillVisible());
+                maker->setStrokeEnabled(aContext->isStrokeVisible());
+                if (!maker->beginPath())
+                    return false;
+                break;
+
+            case SVG_OPCODE_END_PATH:
+                if (inRange && !maker->endPath())
+                    return false;
+                path++;
+                inRange = path >= aFirstPath && path < lastPath;
+                break;
+
+            case SVG_OPCODE_BEGIN_LAYER:
+                if (inRange && !maker->beginLayer())
+                    return false;
+                break;
+
+            case SVG_OPCODE_RECTANGLE:
+                if (!inRange ||
+                    (!aContext->isFillVisible() && !aContext->isStrokeVisible()))
+                {
+                    code += 6;
+                    break;
+                }
+                for (n = 0; n < 6; n++)
+                    arguments[n] = (code++)->mRational;
+                if (!maker->rectangle(VECTOR2D(arguments[0],arguments[1]),
+                                      VECTOR2D(arguments[2],arguments[3]),
+                                      VECTOR2D(arguments[4],arguments[5])))
+                    return false;
+                break;
+
+            case SVG_OPCODE_ELLIPSE:
+                if (!inRange ||
+                    (!aContext->isFillVisible() && !aContext->isStrokeVisible()))
+                {
+                    code += 4;
+                    break;
+                }
+                for (n = 0; n < 4; n++)
+                    arguments[n] = (code++)->mRational;
+                if (!maker->ellipse(VECTOR2D(arguments[0],arguments[1]),
+                                    VECTOR2D(arguments[2],arguments[3])))
+                    return false;
+                break;
+
+            case SVG_OPCODE_PATH:
+            {
+                const SVGCodeWord *pathEnd = code + 1 + code->mInt;
+                code++;
+
+                // The whole path data is skipped if the path is not visible.
+                if (!inRange ||
+                    (!aContext->isFillVisible() && !aContext->isStrokeVisible()))
+                {
+                    code = pathEnd;
+                    break;
+                }
+
+                while (code < pathEnd)
+                {
+                    char command = (char)(code++)->mInt;
+                    int count = SVGPathCommand::getArgumentCount(command);
+                    for (n = 0; n < count; n++)
+                        arguments[n] = (code++)->mRational;
+
+                    if (!SVGPathCommand::executeCommand(maker,command,arguments))
+                        return false;
+                }
+                break;
+            }
+
+            default:
+                return false;
+        }
+    }
 
-//! Executes the command, i.e. applies it to the context.
-bool SVGTransformationCommand::execute(SVGContext *aContext)
-{
-    aContext->setCurrentTransformation(mMatrix);
     return true;
 }
 
 
-///////////////////////////////////////////////////////////////////////////////
-// A command representing a document in SVG command tree.
-///////////////////////////////////////////////////////////////////////////////
-
-//! Constructor.
-SVGDocument::SVGDocument()
+//! Returns the count of paths in the program.
+int SVGProgram::getPathCount()
 {
-    mMatrix.makeIdentity();
+    return mPathCount;
 }
 
 
-//! Loads the SVG document from a file.
-SVGDocument * SVGDocument::load(const char *aFileName)
+//! Adds an opcode to the end of the code.
+/*! The depth of the state stack is tracked, so that the stack can be allocated
+ *  before the execution. The paths are counted for executing them in ranges.
+ */
+bool SVGProgram::addOpcode(int aOpcode)
 {
-    SVGDocument *svgdoc = NULL;
-    TiXmlDocument *xmldoc = new TiXmlDocument();
-
-    TiXmlElement *root = NULL;
-    if (xmldoc && xmldoc->LoadFile(aFileName) &&
-        (root = xmldoc->RootElement()) != NULL)
+    if (aOpcode == SVG_OPCODE_PUSH_STATE)
     {
-        svgdoc = new SVGDocument();
-        if (!(svgdoc && createTree(root,svgdoc)))
-        {
-            delete svgdoc;
-            svgdoc = NULL;
-        }
+        mDepth++;
+        if (mDepth > mMaxDepth)
+            mMaxDepth = mDepth;
     }
-    
-    delete xmldoc;
+    else if (aOpcode == SVG_OPCODE_POP_STATE)
+        mDepth--;
+    else if (aOpcode == SVG_OPCODE_BEGIN_PATH)
+        mPathCount++;
 
-    return svgdoc;
+    return addInt(aOpcode);
 }
 
 
-//! Sets the root level transformation for the SVG document.
-void SVGDocument::setTransformation(const MATRIX2D &aMatrix)
+//! Adds an integer operand to the end of the code.
+bool SVGProgram::addInt(int aValue)
 {
-    mMatrix = aMatrix;
+    SVGCodeWord word;
+    word.mInt = aValue;
+    return addWord(word);
 }
 
 
-//! Executes the command, i.e. applies it to the context.
-bool SVGDocument::execute(SVGContext *aContext)
+//! Adds a color operand to the end of the code.
+bool SVGProgram::addColor(unsigned int aColor)
 {
-    aContext->reset();
-    aContext->setCurrentTransformation(mMatrix);
-    return SVGCommandSet::execute(aContext);
+    SVGCodeWord word;
+    word.mColor = aColor;
+    return addWord(word);
 }
 
 
-//! Creates the SVG tree from the XML DOM.
-bool SVGDocument::createTree(class TiXmlElement *aElement, SVGCommandSet *aSet)
+//! Adds a rational operand to the end of the code.
+bool SVGProgram::addRational(RATIONAL aValue)
 {
-    if (STREQ(aElement->Value(),"g"))
-    {
-        SVGCommandSet *group = new SVGCommandSet(true);
-        if (!group)
-            return false;
-
-        aSet->addLastChild(group);
-
-        const char *fill = aElement->Attribute("fill");
-        const char *fillOpacity = aElement->Attribute("fill-opacity");
-        const char *fillRule = aElement->Attribute("fill-rule");
-
-        if (fill)
-        {
-            SVGCommand *cmd = SVGColorCommand::build(fill);
-            if (cmd)
-                group->addLastChild(cmd);
-        }
-
-        if (fillOpacity)
-        {
-            SVGCommand *cmd = SVGOpacityCommand::build(fillOpacity);
-            if (cmd)
-                group->addLastChild(cmd);
-        }
+    SVGCodeWord word;
+    word.mRational = aValue;
+    return addWord(word);
+}
 
-        if (fillRule)
-        {
-            SVGCommand *cmd = SVGFillRuleCommand::build(fillRule);
-            if (cmd)
-                group->addLastChild(cmd);
-        }
 
-        TiXmlElement *child = aElement->FirstChildElement();
-        while (child)
+//! Adds a matrix operand to the end of the code.
+bool SVGProgram::addMatrix(const MATRIX2D &aMatrix)
+{
+    int n, m;
+    for (n = 0; n < 3; n++)
+    {
+        for (m = 0; m < 2; m++)
         {
-            if (!createTree(child,group))
+            if (!addRational(aMatrix.mMatrix[n][m]))
                 return false;
-            child = child->NextSiblingElement();
         }
     }
-    else if (STREQ(aElement->Value(),"path"))
-    {
-        const char *fill = aElement->Attribute("fill");
-        const char *fillOpacity = aElement->Attribute("fill-opacity");
-        const char *fillRule = aElement->Attribute("fill-rule");
-        const char *data = aElement->Attribute("d");
+    return true;
+}
 
-        SVGCommand *path = createPath(fill,fillOpacity,fillRule,data);
 
-        if (!path)
+//! Adds a word to the end of the code.
+bool SVGProgram::addWord(const SVGCodeWord &aWord)
+{
+    if (mSize == mCapacity)
+    {
+        int capacity = mCapacity * 2 + 0x100;
+        SVGCodeWord *code = new SVGCodeWord[capacity];
+        if (code == NULL)
             return false;
 
-        aSet->addLastChild(path);
-    }
-    else
-    {
-        TiXmlElement *child = aElement->FirstChildElement();
-        while (child)
-        {
-            if (!createTree(child,aSet))
-                return false;
-            child = child->NextSiblingElement();
-        }
+        int n;
+        for (n = 0; n < mSize; n++)
+            code[n] = mCode[n];
+
+        delete[] mCode;
+        mCode = code;
+        mCapacity = capacity;
     }
 
+    mCode[mSize++] = aWord;
     return true;
 }
 
 
-//! Creates a path command set from strings.
-SVGCommand * SVGDocument::createPath(const char *aFill, const char *aFillOpacity, const char *aFillRule, const char *aPath)
+///////////////////////////////////////////////////////////////////////////////
+// Tasks for loading SVG files concurrently.
+///////////////////////////////////////////////////////////////////////////////
+
+//! Constructor.
+SVGCompileTask::SVGCompileTask()
 {
-    SVGCommandSet *set = new SVGCommandSet(aFill != NULL || aFillOpacity != NULL);
+    mFileName = NULL;
+    mLayers = false;
+    mProgram = NULL;
+    mResult = false;
+}
 
-    if (set)
-    {
-        if (aFill)
-        {
-            SVGCommand *cmd = SVGColorCommand::build(aFill);
-            if (cmd)
-                set->addLastChild(cmd);
-        }
-    
-        if (aFillOpacity)
-        {
-            SVGCommand *cmd = SVGOpacityCommand::build(aFillOpacity);
-            if (cmd)
-                set->addLastChild(cmd);
-        }
 
-        if (aFillRule)
-        {
-            SVGCommand *cmd = SVGFillRuleCommand::build(aFillRule);
-            if (cmd)
-                set->addLastChild(cmd);
-        }
+//! Destructor.
+SVGCompileTask::~SVGCompileTask()
+{
+    delete[] mFileName;
+    delete mProgram;
+}
 
-        if (aPath)
-        {
-            SVGCommand *cmd = SVGPathCommand::build(aPath);
-            if (cmd)
-                set->addLastChild(cmd);
-            else
-            {
-                delete set;
-                return NULL;
-            }
-        }
-    }
 
-    return set;
+//! Runs the task.
+void SVGCompileTask::run()
+{
+    mProgram = new SVGProgram();
+    if (mProgram == NULL)
+        return;
+
+    SVGReader reader(mProgram);
+    mResult = reader.load(mFileName,mLayers);
 }
 
 
-//! A static method for loading an SVG file (and optionally creating a tesselated dump of it) into a VectorGraphic object.
-VectorGraphic * loadSVGtoVectorGraphic(PolygonFactory *aFactory, const char *aPath, const char *aSVGName, const char *aSVGDumpName, const char *aBinaryDumpName)
+//! Constructor.
+SVGTessellationTask::SVGTessellationTask()
 {
-    char *filename = new char[strlen(aPath) + strlen(aSVGName) + 1];
+    mProgram = NULL;
+    mFirstPath = 0;
+    mPathCount = 0;
+    mRetainCurves = false;
+    mShapeMaker = NULL;
+    mResult = false;
+}
 
-    if (filename == NULL)
-        return NULL;
 
-    filename[0] = '\0';
+//! Destructor.
+SVGTessellationTask::~SVGTessellationTask()
+{
+    delete mShapeMaker;
+}
 
-    if (aPath)
-    {
-        STRCAT(filename,aPath);
-    }
 
-    STRCAT(filename,aSVGName);
+//! Runs the task.
+/*! The program is only read, so the tasks of the same program can run
+ *  concurrently. Each task has a context and a shape maker of its own.
+ */
+void SVGTessellationTask::run()
+{
+    mShapeMaker = new ShapeMaker();
+    if (mShapeMaker == NULL)
+        return;
 
-    SVGDocument *doc = SVGDocument::load(filename);
+    mShapeMaker->setRetainCurves(mRetainCurves);
+    SVGContext context(mShapeMaker);
 
-    delete[] filename;
+    mResult = mShapeMaker->newShape() &&
+              context.init(100,10) &&
+              mProgram->execute(&context,mFirstPath,mPathCount);
+}
 
-    if (doc == NULL)
-        return NULL;
 
-    ShapeMaker shapeMaker;
-    if (!shapeMaker.newShape())
-    {
-        delete doc;
-        return NULL;
-    }
+///////////////////////////////////////////////////////////////////////////////
+// Loading SVG files to VectorGraphic objects.
+///////////////////////////////////////////////////////////////////////////////
 
-    SVGContext context(&shapeMaker);
-    
-    if (!context.init(100,10))
+//! Creates the full file name from the path and the name, NULL if fails.
+static char * createFileName(const char *aPath, const char *aName)
+{
+    char *filename = new char[(aPath ? STRLEN(aPath) : 0) + STRLEN(aName) + 1];
+
+    if (filename == NULL)
         return NULL;
 
-    if (!doc->execute(&context))
+    filename[0] = '\0';
+
+    if (aPath)
     {
-        delete doc;
-        return NULL;
+        STRCAT(filename,aPath);
     }
 
-    delete doc;
+    STRCAT(filename,aName);
 
-    const ShapeMaker::ShapeData *shapeData = shapeMaker.getShapeData();
+    return filename;
+}
 
-    int polyCount = shapeData->getPolygonCount();
+
+//! Creates a VectorGraphic object from a set of shapes (and optionally a tesselated dump of it).
+/*! The polygons of the shapes are concatenated in their order, as if they were
+ *  created by a single shape maker. The factory is called only from this
+ *  function, so it does not need to be thread safe.
+ *  \param aFactory the polygon factory.
+ *  \param aShapeData the shapes.
+ *  \param aShapeCount the count of shapes.
+ *  \param aSVGDumpName the name of the SVG dump, or NULL.
+ *  \param aBinaryDumpName the name of the binary dump, or NULL.
+ *  \return the graphic, NULL if fails.
+ */
+static VectorGraphic * createVectorGraphic(PolygonFactory *aFactory, const ShapeMaker::ShapeData * const *aShapeData, int aShapeCount, const char *aSVGDumpName, const char *aBinaryDumpName)
+{
+    int polyCount = 0;
+    int layerCount = 0;
+    int n, m;
+    for (n = 0; n < aShapeCount; n++)
+    {
+        polyCount += aShapeData[n]->getPolygonCount();
+        layerCount += aShapeData[n]->getLayerCount();
+    }
 
     PolygonWrapper **polys = new PolygonWrapper *[polyCount];
     PaintWrapper **cols = new PaintWrapper *[polyCount];
     RENDERER_FILLMODE *fillModes = new RENDERER_FILLMODE[polyCount];
 
+    const PolygonData **srcPolys = new const PolygonData *[polyCount];
+    const PathData **srcPaths = new const PathData *[polyCount];
+    const StrokeStyle **srcStrokes = new const StrokeStyle *[polyCount];
+    unsigned long *srcCols = new unsigned long[polyCount];
+    RENDERER_FILLMODE *srcFillModes = new RENDERER_FILLMODE[polyCount];
+    int *layerStarts = new int[layerCount];
+
     bool success = true;
     if (polys == NULL || cols == NULL || fillModes == NULL)
     {
@@ -1410,9 +2548,38 @@ VectorGraphic * loadSVGtoVectorGraphic(PolygonFactory *aFactory, const char *aPa
         success = false;
     }
 
-    const PolygonData * const *srcPolys = shapeData->getPolygons();
-    const unsigned long *srcCols = shapeData->getColors();
-    const RENDERER_FILLMODE *srcFillModes = shapeData->getFillModes();
+    if (srcPolys == NULL || srcPaths == NULL || srcStrokes == NULL ||
+        srcCols == NULL || srcFillModes == NULL || layerStarts == NULL)
+        success = false;
+
+    if (success)
+    {
+        int poly = 0;
+        layerCount = 0;
+        for (n = 0; n < aShapeCount; n++)
+        {
+            const ShapeMaker::ShapeData *shapeData = aShapeData[n];
+
+            // Layers without polygons are not stored, which also drops the
+            // layer begun at the seam of two shapes.
+            for (m = 0; m < shapeData->getLayerCount(); m++)
+            {
+                int layerStart = poly + shapeData->getLayerStarts()[m];
+                if (layerCount == 0 || layerStarts[layerCount-1] != layerStart)
+                    layerStarts[layerCount++] = layerStart;
+            }
+
+            for (m = 0; m < shapeData->getPolygonCount(); m++)
+            {
+                srcPolys[poly] = shapeData->getPolygons()[m];
+                srcPaths[poly] = shapeData->getPaths()[m];
+                srcStrokes[poly] = shapeData->getStrokes()[m];
+                srcCols[poly] = shapeData->getColors()[m];
+                srcFillModes[poly] = shapeData->getFillModes()[m];
+                poly++;
+            }
+        }
+    }
 
     if (success && aSVGDumpName != NULL)
     {
@@ -1425,12 +2592,16 @@ VectorGraphic * loadSVGtoVectorGraphic(PolygonFactory *aFactory, const char *aPa
     }
 
     aFactory->beginGraphic();
-    int n;
     if (success)
     {
         for (n = 0; n < polyCount; n++)
         {
-            polys[n] = aFactory->createPolygonWrapper(srcPolys[n]);
+            if (srcPaths[n] && srcStrokes[n])
+                polys[n] = aFactory->createStrokePolygonWrapper(srcPolys[n],srcPaths[n],srcStrokes[n]);
+            else if (srcPaths[n])
+                polys[n] = aFactory->createCurvePolygonWrapper(srcPolys[n],srcPaths[n]);
+            else
+                polys[n] = aFactory->createPolygonWrapper(srcPolys[n]);
             cols[n] = aFactory->createPaintWrapper(srcCols[n]);
             if (polys[n] == NULL || cols[n] == NULL)
                 success = false;
@@ -1447,6 +2618,16 @@ VectorGraphic * loadSVGtoVectorGraphic(PolygonFactory *aFactory, const char *aPa
             success = false;
     }
 
+    if (success)
+    {
+        // The bounding boxes and the layers are optional, so the graphic is usable
+        // even if storing them fails.
+        graphic->initBounds(srcPolys);
+
+        if (layerCount > 0)
+            graphic->setLayers(layerStarts,layerCount);
+    }
+
     if (!success)
     {
         if (polys)
@@ -1464,6 +2645,176 @@ VectorGraphic * loadSVGtoVectorGraphic(PolygonFactory *aFactory, const char *aPa
         delete[] fillModes;
     }
 
+    delete[] srcPolys;
+    delete[] srcPaths;
+    delete[] srcStrokes;
+    delete[] srcCols;
+    delete[] srcFillModes;
+    delete[] layerStarts;
+
     return graphic;
 }
 
+
+//! A static method for loading an SVG file (and optionally creating a tesselated dump of it) into a VectorGraphic object.
+/*! If aLayers is true, the top level groups of the document are kept as layers in the VectorGraphic.
+ *  If aRetainCurves is true, the polygons keep the curves, so that they can be flattened again
+ *  for the scale they are rendered at.
+ */
+VectorGraphic * loadSVGtoVectorGraphic(PolygonFactory *aFactory, const char *aPath, const char *aSVGName, const char *aSVGDumpName, const char *aBinaryDumpName, bool aLayers, bool aRetainCurves)
+{
+    char *filename = createFileName(aPath,aSVGName);
+
+    if (filename == NULL)
+        return NULL;
+
+    ShapeMaker shapeMaker;
+    shapeMaker.setRetainCurves(aRetainCurves);
+    SVGContext context(&shapeMaker);
+
+    // The document is streamed straight to the shape maker without building
+    // the XML DOM or the SVG command tree.
+    SVGReader reader(&context);
+    bool read = shapeMaker.newShape() &&
+                context.init(100,10) &&
+                reader.load(filename,aLayers);
+
+    delete[] filename;
+
+    if (!read)
+        return NULL;
+
+    const ShapeMaker::ShapeData *shapeData = shapeMaker.getShapeData();
+
+    return createVectorGraphic(aFactory,&shapeData,1,aSVGDumpName,aBinaryDumpName);
+}
+
+
+//! A static method for loading a set of SVG files concurrently into VectorGraphic objects.
+/*! The files are first compiled to programs concurrently. Then the paths of each
+ *  program are split to ranges, which are tessellated concurrently in shape makers
+ *  of their own. Finally the shapes are converted to graphics in the calling thread
+ *  in the order of the files, so the results are the same as with
+ *  loadSVGtoVectorGraphic() and the factory does not need to be thread safe.
+ *  \param aFactory the polygon factory.
+ *  \param aPath the path of the files, or NULL.
+ *  \param aSVGNames the names of the files.
+ *  \param aSVGDumpNames the names of the SVG dumps, or NULL.
+ *  \param aBinaryDumpNames the names of the binary dumps, or NULL.
+ *  \param aCount the count of files.
+ *  \param aGraphics an array for the graphics. The graphic is NULL for each file that fails to load.
+ *  \param aLayers if true, the top level groups of the documents are kept as layers.
+ *  \param aRetainCurves if true, the polygons keep the curves.
+ *  \param aThreadCount the count of threads, or 0 for one thread per processor.
+ *  \return true if all the files were loaded, false otherwise.
+ */
+bool loadSVGstoVectorGraphics(PolygonFactory *aFactory, const char *aPath, const char * const *aSVGNames, const char * const *aSVGDumpNames, const char * const *aBinaryDumpNames, int aCount, VectorGraphic **aGraphics, bool aLayers, bool aRetainCurves, int aThreadCount)
+{
+    int n, m;
+    for (n = 0; n < aCount; n++)
+        aGraphics[n] = NULL;
+
+    TASKRUNNER runner;
+    TASKRUNNER_INIT(runner,aThreadCount);
+    int threadCount = TASKRUNNER_GETTHREADCOUNT(runner);
+
+    SVGCompileTask *compileTasks = new SVGCompileTask[aCount];
+    TASKRUNNER_TASK **tasks = new TASKRUNNER_TASK *[aCount];
+    int *firstTasks = new int[aCount];
+    int *taskCounts = new int[aCount];
+    if (compileTasks == NULL || tasks == NULL || firstTasks == NULL || taskCounts == NULL)
+    {
+        delete[] compileTasks;
+        delete[] tasks;
+        delete[] firstTasks;
+        delete[] taskCounts;
+        return false;
+    }
+
+    for (n = 0; n < aCount; n++)
+    {
+        compileTasks[n].mFileName = createFileName(aPath,aSVGNames[n]);
+        compileTasks[n].mLayers = aLayers;
+        tasks[n] = &compileTasks[n];
+    }
+
+    TASKRUNNER_RUN(runner,tasks,aCount);
+
+    // The paths of large files are split to several ranges, so that a single
+    // file is tessellated by several threads.
+    int taskCount = 0;
+    for (n = 0; n < aCount; n++)
+    {
+        firstTasks[n] = taskCount;
+        taskCounts[n] = 0;
+        if (!compileTasks[n].mResult)
+            continue;
+
+        int pathCount = compileTasks[n].mProgram->getPathCount();
+        int count = pathCount / SVG_LOADER_MIN_PATHS_PER_TASK;
+        if (count > threadCount * SVG_LOADER_TASKS_PER_THREAD)
+            count = threadCount * SVG_LOADER_TASKS_PER_THREAD;
+        if (count < 1)
+            count = 1;
+
+        taskCounts[n] = count;
+        taskCount += count;
+    }
+
+    delete[] tasks;
+    SVGTessellationTask *tessellationTasks = new SVGTessellationTask[taskCount];
+    tasks = new TASKRUNNER_TASK *[taskCount];
+    const ShapeMaker::ShapeData **shapeData = new const ShapeMaker::ShapeData *[taskCount];
+
+    bool success = tessellationTasks != NULL && tasks != NULL && shapeData != NULL;
+    if (success)
+    {
+        for (n = 0; n < aCount; n++)
+        {
+            int pathCount = compileTasks[n].mResult ? compileTasks[n].mProgram->getPathCount() : 0;
+            for (m = 0; m < taskCounts[n]; m++)
+            {
+                SVGTessellationTask *task = &tessellationTasks[firstTasks[n] + m];
+                task->mProgram = compileTasks[n].mProgram;
+                task->mFirstPath = pathCount * m / taskCounts[n];
+                task->mPathCount = pathCount * (m + 1) / taskCounts[n] - task->mFirstPath;
+                task->mRetainCurves = aRetainCurves;
+                tasks[firstTasks[n] + m] = task;
+            }
+        }
+
+        TASKRUNNER_RUN(runner,tasks,taskCount);
+
+        for (n = 0; n < aCount; n++)
+        {
+            bool read = compileTasks[n].mResult;
+            for (m = 0; m < taskCounts[n]; m++)
+            {
+                SVGTessellationTask *task = &tessellationTasks[firstTasks[n] + m];
+                if (task->mResult)
+                    shapeData[m] = task->mShapeMaker->getShapeData();
+                else
+                    read = false;
+            }
+
+            if (read)
+            {
+                aGraphics[n] = createVectorGraphic(aFactory,shapeData,taskCounts[n],
+                                                   aSVGDumpNames ? aSVGDumpNames[n] : NULL,
+                                                   aBinaryDumpNames ? aBinaryDumpNames[n] : NULL);
+            }
+
+            if (aGraphics[n] == NULL)
+                success = false;
+        }
+    }
+
+    delete[] compileTasks;
+    delete[] tessellationTasks;
+    delete[] tasks;
+    delete[] firstTasks;
+    delete[] taskCounts;
+    delete[] shapeData;
+
+    return success;
+}
@@ -0,0 +1,750 @@
+/*!
+ * \file
+ * Scanline edge-flag algorithm for antialiasing <br>
+ * Copyright (c) 2005-2007 Kiia Kallio
+ *
+ * http://mlab.uiah.fi/~kkallio/antialiasing/
+ * 
+ * This code is distributed under the three-clause BSD license.
+ * Read the LICENSE file or visit the URL above for details.
+ *
+ * \brief A streaming reader for SVG files.
+ *
+ *
+ * $Id: $
+ * $Date: $
+ * $Revision: $
+ */
+
+#include "polygon/base/Base.h"
+#include "polygon/svg/ShapeMaker.h"
+#include "polygon/svg/SVG.h"
+#include "polygon/svg/SVGReader.h"
+
+// The names of the attributes in the order of the SVG_ATTRIBUTE_* indices.
+static const char * const gAttributeNames[SVG_ATTRIBUTE_COUNT] =
+{
+    "fill",
+    "fill-opacity",
+    "fill-rule",
+    "stroke",
+    "stroke-opacity",
+    "stroke-width",
+    "stroke-linejoin",
+    "stroke-linecap",
+    "stroke-miterlimit",
+    "vector-effect",
+    "d",
+    "x",
+    "y",
+    "width",
+    "height",
+    "rx",
+    "ry",
+    "cx",
+    "cy",
+    "r",
+    "points"
+};
+
+// Returns true for the characters allowed in element and attribute names.
+#define SVG_READER_IS_NAME_CHAR(aChar) \
+    (((aChar) >= 'a' && (aChar) <= 'z') || ((aChar) >= 'A' && (aChar) <= 'Z') || \
+     ((aChar) >= '0' && (aChar) <= '9') || (aChar) == '-' || (aChar) == '_' || \
+     (aChar) == ':' || (aChar) == '.' || ((unsigned char)(aChar)) >= 0x80)
+
+// Returns true for the white space characters in XML.
+#define SVG_READER_IS_WHITE_SPACE(aChar) \
+    ((aChar) == ' ' || (aChar) == '\t' || (aChar) == '\r' || (aChar) == '\n')
+
+//! Constructor.
+SVGReader::SVGReader(SVGContext *aContext)
+{
+    mContext = aContext;
+    mProgram = NULL;
+    init();
+}
+
+
+//! Constructor for compiling the document to a program.
+/*! The program is appended to, so a number of documents can be compiled to
+ *  the same program.
+ */
+SVGReader::SVGReader(SVGProgram *aProgram)
+{
+    mContext = NULL;
+    mProgram = aProgram;
+    init();
+}
+
+
+//! Initializer.
+void SVGReader::init()
+{
+    mMatrix.makeIdentity();
+    mLayers = false;
+    mPosition = NULL;
+    mEnd = NULL;
+    mElements = NULL;
+    mElementCount = 0;
+    mElementCapacity = 0;
+    mGroupDepth = 0;
+    mPathDepth = 0;
+    mBuffer = NULL;
+    mBufferSize = 0;
+    mBufferCapacity = 0;
+}
+
+
+//! Destructor.
+SVGReader::~SVGReader()
+{
+    delete[] mElements;
+    delete[] mBuffer;
+}
+
+
+//! Loads an SVG file and applies it to the context or compiles it to the program.
+/*! \param aFileName the name of the file.
+ *  \param aLayers if true, each top level group is stored as a layer of its own.
+ *  \return true if the file was read successfully, false otherwise.
+ */
+bool SVGReader::load(const char *aFileName, bool aLayers)
+{
+    MAPPEDFILE file;
+    if (!MAPPEDFILE_OPEN(file,aFileName))
+        return false;
+
+    bool result = read(MAPPEDFILE_GETDATA(file),MAPPEDFILE_GETSIZE(file),aLayers);
+
+    MAPPEDFILE_CLOSE(file);
+
+    return result;
+}
+
+
+//! Reads SVG data from memory and applies it to the context or compiles it to the program.
+/*! The data does not need to be zero terminated.
+ *  \param aData the SVG data.
+ *  \param aSize the size of the data in bytes.
+ *  \param aLayers if true, each top level group is stored as a layer of its own.
+ *  \return true if the data was read successfully, false otherwise.
+ */
+bool SVGReader::read(const char *aData, int aSize, bool aLayers)
+{
+    if (aData == NULL)
+        return false;
+
+    mLayers = aLayers;
+    mPosition = aData;
+    mEnd = aData + aSize;
+    mElementCount = 0;
+    mGroupDepth = 0;
+    mPathDepth = 0;
+
+    if (mProgram)
+    {
+        if (!mProgram->addOpcode(SVG_OPCODE_RESET) ||
+            !mProgram->addMatrix(mMatrix))
+            return false;
+    }
+    else
+    {
+        mContext->reset();
+        mContext->setCurrentTransformation(mMatrix);
+    }
+
+    bool root = false;
+    while (mPosition < mEnd)
+    {
+        // The character data between the tags is not used.
+        const char *tag = (const char *)memchr(mPosition,'<',mEnd - mPosition);
+        if (tag == NULL)
+            break;
+        mPosition = tag;
+
+        bool result;
+        if (startsWith("<?"))
+            result = skipPast("?>");
+        else if (startsWith("<!--"))
+            result = skipPast("-->");
+        else if (startsWith("<![CDATA["))
+            result = skipPast("]]>");
+        else if (startsWith("<!"))
+            result = skipDeclaration();
+        else if (startsWith("</"))
+            result = readEndTag();
+        else
+        {
+            result = readStartTag();
+            root = true;
+        }
+
+        if (!result)
+            return false;
+    }
+
+    // All the elements must be closed.
+    return root && mElementCount == 0;
+}
+
+
+//! Sets the root level transformation for the SVG document.
+void SVGReader::setTransformation(const MATRIX2D &aMatrix)
+{
+    mMatrix = aMatrix;
+}
+
+
+//! Reads the start tag of an element and begins the element.
+/*! Only the attributes of the group, path and basic shape elements are stored.
+ *  The content of a path or a basic shape element is skipped.
+ */
+bool SVGReader::readStartTag()
+{
+    // Skip '<'.
+    mPosition++;
+
+    const char *name = mPosition;
+    while (mPosition < mEnd && SVG_READER_IS_NAME_CHAR(*mPosition))
+        mPosition++;
+
+    int nameLength = (int)(mPosition - name);
+    if (nameLength == 0)
+        return false;
+
+    SVG_ELEMENT element = SVG_ELEMENT_OTHER;
+    if (mPathDepth == 0)
+    {
+        if (nameLength == 1 && name[0] == 'g')
+            element = SVG_ELEMENT_GROUP;
+        else if (nameLength == 4 && strncmp(name,"path",4) == 0)
+            element = SVG_ELEMENT_PATH;
+        else if (nameLength == 4 && strncmp(name,"rect",4) == 0)
+            element = SVG_ELEMENT_RECT;
+        else if (nameLength == 6 && strncmp(name,"circle",6) == 0)
+            element = SVG_ELEMENT_CIRCLE;
+        else if (nameLength == 7 && strncmp(name,"ellipse",7) == 0)
+            element = SVG_ELEMENT_ELLIPSE;
+        else if (nameLength == 7 && strncmp(name,"polygon",7) == 0)
+            element = SVG_ELEMENT_POLYGON;
+        else if (nameLength == 8 && strncmp(name,"polyline",8) == 0)
+            element = SVG_ELEMENT_POLYLINE;
+    }
+
+    int n;
+    for (n = 0; n < SVG_ATTRIBUTE_COUNT; n++)
+        mAttributes[n] = -1;
+    mBufferSize = 0;
+
+    for (;;)
+    {
+        skipWhiteSpace();
+
+        if (mPosition >= mEnd)
+            return false;
+
+        if (*mPosition == '>')
+        {
+            mPosition++;
+            return beginElement(element);
+        }
+
+        if (*mPosition == '/')
+        {
+            if (!startsWith("/>"))
+                return false;
+            mPosition += 2;
+            return beginElement(element) && endElement();
+        }
+
+        if (!readAttribute(element != SVG_ELEMENT_OTHER))
+            return false;
+    }
+}
+
+
+//! Reads the end tag of an element and ends the element.
+bool SVGReader::readEndTag()
+{
+    // Skip '</'.
+    mPosition += 2;
+
+    const char *name = mPosition;
+    while (mPosition < mEnd && SVG_READER_IS_NAME_CHAR(*mPosition))
+        mPosition++;
+
+    if (mPosition == name)
+        return false;
+
+    skipWhiteSpace();
+
+    if (mPosition >= mEnd || *mPosition != '>')
+        return false;
+    mPosition++;
+
+    if (mElementCount == 0)
+        return false;
+
+    return endElement();
+}
+
+
+//! Reads an attribute of a start tag.
+/*! \param aStore if true, the value is stored if the attribute is one of the
+ *         SVG_ATTRIBUTE_* attributes.
+ */
+bool SVGReader::readAttribute(bool aStore)
+{
+    const char *name = mPosition;
+    while (mPosition < mEnd && SVG_READER_IS_NAME_CHAR(*mPosition))
+        mPosition++;
+
+    int nameLength = (int)(mPosition - name);
+    if (nameLength == 0)
+        return false;
+
+    skipWhiteSpace();
+    if (mPosition >= mEnd || *mPosition != '=')
+        return false;
+    mPosition++;
+
+    skipWhiteSpace();
+    if (mPosition >= mEnd || (*mPosition != '"' && *mPosition != '\''))
+        return false;
+
+    char quote = *mPosition++;
+    const char *value = mPosition;
+    const char *valueEnd = (const char *)memchr(value,quote,mEnd - value);
+    if (valueEnd == NULL)
+        return false;
+    mPosition = valueEnd + 1;
+
+    if (aStore)
+    {
+        int n;
+        for (n = 0; n < SVG_ATTRIBUTE_COUNT; n++)
+        {
+            if (strncmp(gAttributeNames[n],name,nameLength) == 0 &&
+                gAttributeNames[n][nameLength] == '\0')
+                return storeAttribute(n,value,(int)(valueEnd - value));
+        }
+    }
+
+    return true;
+}
+
+
+//! Skips the input past the given string.
+bool SVGReader::skipPast(const char *aString)
+{
+    while (mPosition < mEnd)
+    {
+        if (startsWith(aString))
+        {
+            mPosition += STRLEN(aString);
+            return true;
+        }
+        mPosition++;
+    }
+
+    return false;
+}
+
+
+//! Skips a declaration such as DOCTYPE, including its internal subset.
+bool SVGReader::skipDeclaration()
+{
+    int depth = 0;
+    char quote = 0;
+    while (mPosition < mEnd)
+    {
+        char c = *mPosition++;
+        if (quote)
+        {
+            if (c == quote)
+                quote = 0;
+        }
+        else if (c == '"' || c == '\'')
+            quote = c;
+        else if (c == '[')
+            depth++;
+        else if (c == ']')
+            depth--;
+        else if (c == '>' && depth == 0)
+            return true;
+    }
+
+    return false;
+}
+
+
+//! Skips the white space in the input.
+void SVGReader::skipWhiteSpace()
+{
+    while (mPosition < mEnd && SVG_READER_IS_WHITE_SPACE(*mPosition))
+        mPosition++;
+}
+
+
+//! Returns true if the input continues with the given string.
+bool SVGReader::startsWith(const char *aString)
+{
+    const char *position = mPosition;
+    while (*aString)
+    {
+        if (position >= mEnd || *position != *aString)
+            return false;
+        position++;
+        aString++;
+    }
+
+    return true;
+}
+
+
+//! Stores an attribute value with the entity references decoded.
+/*! The values are stored zero terminated to a buffer that is reused for each
+ *  element. A decoded value is never longer than the original one.
+ */
+bool SVGReader::storeAttribute(int aAttribute, const char *aValue, int aLength)
+{
+    if (mBufferSize + aLength + 1 > mBufferCapacity)
+    {
+        int capacity = mBufferCapacity * 2 + aLength + 0x100;
+        char *buffer = new char[capacity];
+        if (buffer == NULL)
+            return false;
+
+        if (mBufferSize > 0)
+            MEMCPY(buffer,mBuffer,mBufferSize);
+
+        delete[] mBuffer;
+        mBuffer = buffer;
+        mBufferCapacity = capacity;
+    }
+
+    mAttributes[aAttribute] = mBufferSize;
+
+    char *target = mBuffer + mBufferSize;
+    const char *end = aValue + aLength;
+    while (aValue < end)
+    {
+        if (*aValue != '&')
+        {
+            *target++ = *aValue++;
+            continue;
+        }
+
+        const char *semicolon = (const char *)memchr(aValue,';',end - aValue);
+        int length = semicolon ? (int)(semicolon - aValue) + 1 : 0;
+        unsigned int code = 0;
+        bool valid = true;
+
+        if (length == 5 && strncmp(aValue,"&amp;",5) == 0)
+            code = '&';
+        else if (length == 4 && strncmp(aValue,"&lt;",4) == 0)
+            code = '<';
+        else if (length == 4 && strncmp(aValue,"&gt;",4) == 0)
+            code = '>';
+        else if (length == 6 && strncmp(aValue,"&quot;",6) == 0)
+            code = '"';
+        else if (length == 6 && strncmp(aValue,"&apos;",6) == 0)
+            code = '\'';
+        else if (length > 3 && aValue[1] == '#')
+        {
+            const char *digit = aValue + 2;
+            bool hex = *digit == 'x';
+            if (hex)
+                digit++;
+            if (digit == semicolon)
+                valid = false;
+            while (valid && digit < semicolon && code <= 0x10ffff)
+            {
+                char c = *digit++;
+                if (c >= '0' && c <= '9')
+                    code = code * (hex ? 16 : 10) + (c - '0');
+                else if (hex && c >= 'a' && c <= 'f')
+                    code = code * 16 + (c - 'a' + 10);
+                else if (hex && c >= 'A' && c <= 'F')
+                    code = code * 16 + (c - 'A' + 10);
+                else
+                    valid = false;
+            }
+            if (code == 0 || code > 0x10ffff)
+                valid = false;
+        }
+        else
+            valid = false;
+
+        if (!valid)
+        {
+            // Unknown references are kept as they are.
+            *target++ = *aValue++;
+            continue;
+        }
+
+        // The characters are stored as UTF-8.
+        if (code < 0x80)
+            *target++ = (char)code;
+        else if (code < 0x800)
+        {
+            *target++ = (char)(0xc0 | (code >> 6));
+            *target++ = (char)(0x80 | (code & 0x3f));
+        }
+        else if (code < 0x10000)
+        {
+            *target++ = (char)(0xe0 | (code >> 12));
+            *target++ = (char)(0x80 | ((code >> 6) & 0x3f));
+            *target++ = (char)(0x80 | (code & 0x3f));
+        }
+        else
+        {
+            *target++ = (char)(0xf0 | (code >> 18));
+            *target++ = (char)(0x80 | ((code >> 12) & 0x3f));
+            *target++ = (char)(0x80 | ((code >> 6) & 0x3f));
+            *target++ = (char)(0x80 | (code & 0x3f));
+        }
+        aValue += length;
+    }
+
+    *target++ = '\0';
+    mBufferSize = (int)(target - mBuffer);
+
+    return true;
+}
+
+
+//! Returns the value of an attribute of the current element, NULL if not set.
+const char * SVGReader::getAttribute(int aAttribute)
+{
+    if (mAttributes[aAttribute] < 0)
+        return NULL;
+    return mBuffer + mAttributes[aAttribute];
+}
+
+
+//! Begins an element, i.e. applies a group, a path or a basic shape to the context.
+/*! This does the same as executing the command tree SVGDocument creates for
+ *  the element.
+ */
+bool SVGReader::beginElement(SVG_ELEMENT aElement)
+{
+    if (mElementCount == mElementCapacity)
+    {
+        int capacity = mElementCapacity * 2 + 0x20;
+        SVG_ELEMENT *elements = new SVG_ELEMENT[capacity];
+        if (elements == NULL)
+            return false;
+
+        int n;
+        for (n = 0; n < mElementCount; n++)
+            elements[n] = mElements[n];
+
+        delete[] mElements;
+        mElements = elements;
+        mElementCapacity = capacity;
+    }
+
+    mElements[mElementCount++] = aElement;
+
+    SVGCommand *stroke;
+    switch (aElement)
+    {
+        case SVG_ELEMENT_GROUP:
+            // The group and the paths after it start new layers. The nested
+            // groups belong to the layer of the top level group.
+            if (mLayers && mGroupDepth == 0)
+            {
+                if (!beginLayer())
+                    return false;
+            }
+            mGroupDepth++;
+
+            if (!pushState())
+                return false;
+
+            // Invalid attributes are ignored.
+            if (getAttribute(SVG_ATTRIBUTE_FILL) &&
+                !execute(SVGColorCommand::build(getAttribute(SVG_ATTRIBUTE_FILL))))
+                return false;
+            if (getAttribute(SVG_ATTRIBUTE_FILL_OPACITY) &&
+                !execute(SVGOpacityCommand::build(getAttribute(SVG_ATTRIBUTE_FILL_OPACITY))))
+                return false;
+            if (getAttribute(SVG_ATTRIBUTE_FILL_RULE) &&
+                !execute(SVGFillRuleCommand::build(getAttribute(SVG_ATTRIBUTE_FILL_RULE))))
+                return false;
+            break;
+
+        case SVG_ELEMENT_PATH:
+        case SVG_ELEMENT_RECT:
+        case SVG_ELEMENT_CIRCLE:
+        case SVG_ELEMENT_ELLIPSE:
+        case SVG_ELEMENT_POLYGON:
+        case SVG_ELEMENT_POLYLINE:
+            mPathDepth++;
+            break;
+
+        default:
+            return true;
+    }
+
+    stroke = SVGStrokeCommand::build(getAttribute(SVG_ATTRIBUTE_STROKE),
+                                     getAttribute(SVG_ATTRIBUTE_STROKE_OPACITY),
+                                     getAttribute(SVG_ATTRIBUTE_STROKE_WIDTH),
+                                     getAttribute(SVG_ATTRIBUTE_STROKE_LINEJOIN),
+                                     getAttribute(SVG_ATTRIBUTE_STROKE_LINECAP),
+                                     getAttribute(SVG_ATTRIBUTE_STROKE_MITERLIMIT),
+                                     getAttribute(SVG_ATTRIBUTE_VECTOR_EFFECT));
+
+    if (aElement == SVG_ELEMENT_GROUP)
+        return execute(stroke);
+
+    // The path command set takes the ownership of the stroke command.
+    SVGCommand *path;
+    if (aElement == SVG_ELEMENT_PATH)
+    {
+        path = SVGDocument::createPath(getAttribute(SVG_ATTRIBUTE_FILL),
+                                       getAttribute(SVG_ATTRIBUTE_FILL_OPACITY),
+                                       getAttribute(SVG_ATTRIBUTE_FILL_RULE),
+                                       stroke,
+                                       getAttribute(SVG_ATTRIBUTE_D));
+    }
+    else
+    {
+        SVGCommand *shape = createBasicShape(aElement);
+        if (shape == NULL)
+        {
+            delete stroke;
+            return false;
+        }
+
+        path = SVGDocument::createShape(getAttribute(SVG_ATTRIBUTE_FILL),
+                                        getAttribute(SVG_ATTRIBUTE_FILL_OPACITY),
+                                        getAttribute(SVG_ATTRIBUTE_FILL_RULE),
+                                        stroke,
+                                        shape);
+    }
+
+    if (path == NULL)
+        return false;
+
+    return execute(path);
+}
+
+
+//! Creates the path commands for a basic shape element, NULL if fails.
+/*! This does the same as SVGDocument::createBasicShape().
+ */
+SVGCommand * SVGReader::createBasicShape(SVG_ELEMENT aElement)
+{
+    switch (aElement)
+    {
+        case SVG_ELEMENT_RECT:
+            return SVGRectangleCommand::build(getAttribute(SVG_ATTRIBUTE_X),
+                                              getAttribute(SVG_ATTRIBUTE_Y),
+                                              getAttribute(SVG_ATTRIBUTE_WIDTH),
+                                              getAttribute(SVG_ATTRIBUTE_HEIGHT),
+                                              getAttribute(SVG_ATTRIBUTE_RX),
+                                              getAttribute(SVG_ATTRIBUTE_RY));
+
+        case SVG_ELEMENT_CIRCLE:
+            return SVGEllipseCommand::build(getAttribute(SVG_ATTRIBUTE_CX),
+                                            getAttribute(SVG_ATTRIBUTE_CY),
+                                            getAttribute(SVG_ATTRIBUTE_R),
+                                            getAttribute(SVG_ATTRIBUTE_R));
+
+        case SVG_ELEMENT_ELLIPSE:
+            return SVGEllipseCommand::build(getAttribute(SVG_ATTRIBUTE_CX),
+                                            getAttribute(SVG_ATTRIBUTE_CY),
+                                            getAttribute(SVG_ATTRIBUTE_RX),
+                                            getAttribute(SVG_ATTRIBUTE_RY));
+
+        case SVG_ELEMENT_POLYGON:
+            return SVGPathCommand::buildPoints(getAttribute(SVG_ATTRIBUTE_POINTS),true);
+
+        case SVG_ELEMENT_POLYLINE:
+            return SVGPathCommand::buildPoints(getAttribute(SVG_ATTRIBUTE_POINTS),false);
+    }
+
+    return NULL;
+}
+
+
+//! Ends the current element.
+bool SVGReader::endElement()
+{
+    SVG_ELEMENT element = mElements[--mElementCount];
+
+    switch (element)
+    {
+        case SVG_ELEMENT_GROUP:
+            if (!popState())
+                return false;
+
+            mGroupDepth--;
+            if (mLayers && mGroupDepth == 0)
+            {
+                if (!beginLayer())
+                    return false;
+            }
+            break;
+
+        case SVG_ELEMENT_PATH:
+        case SVG_ELEMENT_RECT:
+        case SVG_ELEMENT_CIRCLE:
+        case SVG_ELEMENT_ELLIPSE:
+        case SVG_ELEMENT_POLYGON:
+        case SVG_ELEMENT_POLYLINE:
+            mPathDepth--;
+            break;
+    }
+
+    return true;
+}
+
+
+//! Pushes the state of the context.
+bool SVGReader::pushState()
+{
+    if (mProgram)
+        return mProgram->addOpcode(SVG_OPCODE_PUSH_STATE);
+    return mContext->pushState();
+}
+
+
+//! Pops the state of the context.
+bool SVGReader::popState()
+{
+    if (mProgram)
+        return mProgram->addOpcode(SVG_OPCODE_POP_STATE);
+    return mContext->popState();
+}
+
+
+//! Begins a new layer.
+bool SVGReader::beginLayer()
+{
+    if (mProgram)
+        return mProgram->addOpcode(SVG_OPCODE_BEGIN_LAYER);
+    return mContext->getShapeMaker()->beginLayer();
+}
+
+
+//! Executes or compiles a command and deletes it.
+/*! A NULL command is not an error, as the invalid attributes are ignored.
+ */
+bool SVGReader::execute(SVGCommand *aCommand)
+{
+    if (aCommand == NULL)
+        return true;
+
+    bool result;
+    if (mProgram)
+        result = aCommand->compile(mProgram);
+    else
+        result = aCommand->execute(mContext);
+    delete aCommand;
+
+    return result;
+}
@@ -27,7 +27,13 @@ ShapeMaker::ShapeMaker()
     MATRIX2D_MAKEIDENTITY(mTransformation);
     mCurrentColor = 0;
     mCurrentFillMode = RENDERER_FILLMODE_EVENODD;
+    mCurrentFillEnabled = true;
+    mCurrentStrokeColor = 0;
+    mCurrentStrokeEnabled = false;
     mBezierSteps = 32;
+    mFlatness = FLOAT_TO_RATIONAL(0.1f);
+    mRetainCurves = false;
+    mInternalCursorMove = false;
 }
 
 
@@ -63,6 +69,43 @@ void ShapeMaker::setFillRule(RENDERER_FILLMODE aFillMode)
 }
 
 
+//! Sets whether the paths are filled.
+/*! Current fill is applied to the path at beginPath().
+ */
+void ShapeMaker::setFillEnabled(bool aFillEnabled)
+{
+    mCurrentFillEnabled = aFillEnabled;
+}
+
+
+//! Sets the current stroke color.
+/*! Current stroke color is applied to the path at beginPath().
+ */
+void ShapeMaker::setStrokeColor(unsigned int aColor)
+{
+    mCurrentStrokeColor = aColor;
+}
+
+
+//! Sets the current stroke style.
+/*! Current stroke style is applied to the path at beginPath(). The width is
+ *  scaled with the transformation, unless the stroke is a hairline.
+ */
+void ShapeMaker::setStrokeStyle(const StrokeStyle &aStyle)
+{
+    mCurrentStrokeStyle = aStyle;
+}
+
+
+//! Sets whether the paths are stroked.
+/*! Current stroke is applied to the path at beginPath().
+ */
+void ShapeMaker::setStrokeEnabled(bool aStrokeEnabled)
+{
+    mCurrentStrokeEnabled = aStrokeEnabled;
+}
+
+
 //! Starts a new shape and clears the shape data collected this far.
 /*! This must be called as the first thing before assigning any commands to
  *  the shape maker.
@@ -70,7 +113,7 @@ void ShapeMaker::setFillRule(RENDERER_FILLMODE aFillMode)
 bool ShapeMaker::newShape()
 {
     delete mShapeData;
-    mShapeData = new ShapeMaker::ShapeData();
+    mShapeData = new ShapeMaker::ShapeData(mRetainCurves);
     if (mShapeData == NULL)
         return false;
     return true;
@@ -80,14 +123,44 @@ bool ShapeMaker::newShape()
 //! Begins a new path.
 bool ShapeMaker::beginPath()
 {
-    return mShapeData->beginPolygon(mCurrentColor,mCurrentFillMode);
+    if (!mCurrentStrokeEnabled)
+        return mShapeData->beginPolygon(mCurrentColor,mCurrentFillMode,mCurrentFillEnabled);
+
+    // The path is stored in transformed coordinates, so the width is scaled with
+    // the square root of the area scale of the transformation.
+    StrokeStyle style = mCurrentStrokeStyle;
+    if (!style.mHairline)
+    {
+        double determinant = MATRIX2D_GET_M11(mTransformation) * MATRIX2D_GET_M22(mTransformation) -
+                             MATRIX2D_GET_M12(mTransformation) * MATRIX2D_GET_M21(mTransformation);
+        style.mWidth = (RATIONAL)(style.mWidth * sqrt(fabs(determinant)));
+    }
+
+    return mShapeData->beginPolygon(mCurrentColor,mCurrentFillMode,mCurrentFillEnabled,mCurrentStrokeColor,&style);
 }
 
 
 //! Ends the path.
+/*! A sub polygon left open by the path is ended here, but it is not marked
+ *  closed, so it is stroked with caps. Filling closes it implicitly.
+ */
 bool ShapeMaker::endPath()
 {
-    return mShapeData->endPolygon();
+    // A close path has already ended the sub polygon. A sub polygon followed
+    // by a move at the end of the path is only left uncropped.
+    if (!mInternalCursorMove && !mShapeData->endSubPolygon())
+        return false;
+
+    if (mFlatness <= INT_TO_RATIONAL(0))
+        return mShapeData->endPolygon(SHAPEMAKER_STROKE_FLATNESS);
+    return mShapeData->endPolygon(mFlatness);
+}
+
+
+//! Begins a new layer.
+bool ShapeMaker::beginLayer()
+{
+    return mShapeData->beginLayer();
 }
 
 
@@ -125,7 +198,7 @@ bool ShapeMaker::lineToAbsolute(const VECTOR2D &aPosition)
     VECTOR2D position;
     MATRIX2D_TRANSFORM(mTransformation,aPosition,position);
 
-    return edgeTo(position);    
+    return edgeTo(position) && pathTo(position,PATH_POINT_ON_CURVE);
 }
 
 
@@ -195,11 +268,20 @@ bool ShapeMaker::curveToAbsolute(const VECTOR2D &aPoint1, const VECTOR2D &aPoint
     MATRIX2D_TRANSFORM(mTransformation,aPoint2,p2);
     MATRIX2D_TRANSFORM(mTransformation,aPosition,p3);
 
-    RATIONAL step = INT_TO_RATIONAL(1) / mBezierSteps;
+    // The second differences of the control points bound the deviation of the segments.
+    RATIONAL dx1 = VECTOR2D_GETX(p0) - INT_TO_RATIONAL(2) * VECTOR2D_GETX(p1) + VECTOR2D_GETX(p2);
+    RATIONAL dy1 = VECTOR2D_GETY(p0) - INT_TO_RATIONAL(2) * VECTOR2D_GETY(p1) + VECTOR2D_GETY(p2);
+    RATIONAL dx2 = VECTOR2D_GETX(p1) - INT_TO_RATIONAL(2) * VECTOR2D_GETX(p2) + VECTOR2D_GETX(p3);
+    RATIONAL dy2 = VECTOR2D_GETY(p1) - INT_TO_RATIONAL(2) * VECTOR2D_GETY(p2) + VECTOR2D_GETY(p3);
+    RATIONAL d1 = dx1 * dx1 + dy1 * dy1;
+    RATIONAL d2 = dx2 * dx2 + dy2 * dy2;
+    int steps = getBezierSteps((RATIONAL)sqrt((double)(d1 > d2 ? d1 : d2)),3);
+
+    RATIONAL step = INT_TO_RATIONAL(1) / steps;
     RATIONAL t = step;
     RATIONAL it = INT_TO_RATIONAL(1) - t;
     int n;
-    for (n = 0; n < mBezierSteps - 1; n++)
+    for (n = 0; n < steps - 1; n++)
     {
         VECTOR2D pos;
         RATIONAL it2 = it * it;
@@ -223,7 +305,10 @@ bool ShapeMaker::curveToAbsolute(const VECTOR2D &aPoint1, const VECTOR2D &aPoint
         it -= step;
     }
 
-    if (!edgeTo(p3))
+    if (!edgeTo(p3) ||
+        !pathTo(p1,PATH_POINT_CUBIC) ||
+        !pathTo(p2,PATH_POINT_CUBIC) ||
+        !pathTo(p3,PATH_POINT_ON_CURVE))
         return false;
 
     mCurrentPoint = aPosition;
@@ -286,11 +371,16 @@ bool ShapeMaker::quadraticCurveToAbsolute(const VECTOR2D &aPoint, const VECTOR2D
     MATRIX2D_TRANSFORM(mTransformation,aPoint,p1);
     MATRIX2D_TRANSFORM(mTransformation,aPosition,p2);
 
-    RATIONAL step = INT_TO_RATIONAL(1) / mBezierSteps;
+    // The second difference of the control points bounds the deviation of the segments.
+    RATIONAL dx = VECTOR2D_GETX(p0) - INT_TO_RATIONAL(2) * VECTOR2D_GETX(p1) + VECTOR2D_GETX(p2);
+    RATIONAL dy = VECTOR2D_GETY(p0) - INT_TO_RATIONAL(2) * VECTOR2D_GETY(p1) + VECTOR2D_GETY(p2);
+    int steps = getBezierSteps((RATIONAL)sqrt((double)(dx * dx + dy * dy)),2);
+
+    RATIONAL step = INT_TO_RATIONAL(1) / steps;
     RATIONAL t = step;
     RATIONAL it = INT_TO_RATIONAL(1) - t;
     int n;
-    for (n = 0; n < mBezierSteps - 1; n++)
+    for (n = 0; n < steps - 1; n++)
     {
         VECTOR2D pos;
         RATIONAL it2 = it * it;
@@ -310,7 +400,9 @@ bool ShapeMaker::quadraticCurveToAbsolute(const VECTOR2D &aPoint, const VECTOR2D
         it -= step; 
     }
 
-    if (!edgeTo(p2))
+    if (!edgeTo(p2) ||
+        !pathTo(p1,PATH_POINT_QUADRATIC) ||
+        !pathTo(p2,PATH_POINT_ON_CURVE))
         return false;
 
     mCurrentPoint = aPosition;
@@ -365,7 +457,110 @@ bool ShapeMaker::closePath()
     mCurrentPoint = mStartPoint;
     mCurrentControlPoint = mStartPoint;
 
-    return mShapeData->endSubPolygon();
+    // The next edge starts a new sub polygon from the start point.
+    if (!mInternalCursorMove)
+        mShapeData->closeSubPolygon();
+    VECTOR2D position;
+    MATRIX2D_TRANSFORM(mTransformation,mStartPoint,position);
+
+    return mShapeData->endSubPolygon() && moveTo(position);
+}
+
+
+//! Draws a rectangle with optionally rounded corners as a closed sub-path.
+/*! The rectangle is drawn as the 'rect' element of SVG. A rectangle without
+ *  rounded corners has only four vertices, so that it can be filled as a
+ *  rectangle if it is axis-aligned after the transformation. Nothing is drawn
+ *  if the rectangle is empty.
+ *  \param aPosition the top left corner.
+ *  \param aSize the width and the height.
+ *  \param aRadius the radii of the corners, clamped to half of the size.
+ */
+bool ShapeMaker::rectangle(const VECTOR2D &aPosition, const VECTOR2D &aSize, const VECTOR2D &aRadius)
+{
+    RATIONAL x = VECTOR2D_GETX(aPosition);
+    RATIONAL y = VECTOR2D_GETY(aPosition);
+    RATIONAL width = VECTOR2D_GETX(aSize);
+    RATIONAL height = VECTOR2D_GETY(aSize);
+
+    if (width <= INT_TO_RATIONAL(0) || height <= INT_TO_RATIONAL(0))
+        return true;
+
+    RATIONAL rx = VECTOR2D_GETX(aRadius);
+    RATIONAL ry = VECTOR2D_GETY(aRadius);
+    if (rx > width / INT_TO_RATIONAL(2))
+        rx = width / INT_TO_RATIONAL(2);
+    if (ry > height / INT_TO_RATIONAL(2))
+        ry = height / INT_TO_RATIONAL(2);
+
+    if (rx <= INT_TO_RATIONAL(0) || ry <= INT_TO_RATIONAL(0))
+    {
+        return moveToAbsolute(aPosition) &&
+               horizontalLineToAbsolute(x + width) &&
+               verticalLineToAbsolute(y + height) &&
+               horizontalLineToAbsolute(x) &&
+               closePath();
+    }
+
+    // The corners are drawn clockwise starting from the top right one. The
+    // straight edges are left out if the corners meet.
+    VECTOR2D radius(rx,ry);
+    VECTOR2D topLeft(x + rx,y + ry);
+    VECTOR2D topRight(x + width - rx,y + ry);
+    VECTOR2D bottomRight(x + width - rx,y + height - ry);
+    VECTOR2D bottomLeft(x + rx,y + height - ry);
+    int steps = getArcSteps(topLeft,radius);
+
+    if (!moveToAbsolute(VECTOR2D(x + rx,y)))
+        return false;
+    if (rx + rx < width && !horizontalLineToAbsolute(x + width - rx))
+        return false;
+    if (!arcTo(topRight,radius,3,steps))
+        return false;
+    if (ry + ry < height && !verticalLineToAbsolute(y + height - ry))
+        return false;
+    if (!arcTo(bottomRight,radius,0,steps))
+        return false;
+    if (rx + rx < width && !horizontalLineToAbsolute(x + rx))
+        return false;
+    if (!arcTo(bottomLeft,radius,1,steps))
+        return false;
+    if (ry + ry < height && !verticalLineToAbsolute(y + ry))
+        return false;
+    if (!arcTo(topLeft,radius,2,steps))
+        return false;
+
+    return closePath();
+}
+
+
+//! Draws an ellipse as a closed sub-path.
+/*! The ellipse is drawn as the 'ellipse' and 'circle' elements of SVG, starting
+ *  from the rightmost point. Nothing is drawn if either radius is zero.
+ *  \param aCenter the center of the ellipse.
+ *  \param aRadius the radii of the ellipse.
+ */
+bool ShapeMaker::ellipse(const VECTOR2D &aCenter, const VECTOR2D &aRadius)
+{
+    if (VECTOR2D_GETX(aRadius) <= INT_TO_RATIONAL(0) || VECTOR2D_GETY(aRadius) <= INT_TO_RATIONAL(0))
+        return true;
+
+    VECTOR2D start;
+    VECTOR2D_SETX(start,VECTOR2D_GETX(aCenter) + VECTOR2D_GETX(aRadius));
+    VECTOR2D_SETY(start,VECTOR2D_GETY(aCenter));
+
+    if (!moveToAbsolute(start))
+        return false;
+
+    int steps = getArcSteps(aCenter,aRadius);
+    int n;
+    for (n = 0; n < 4; n++)
+    {
+        if (!arcTo(aCenter,aRadius,n,steps))
+            return false;
+    }
+
+    return closePath();
 }
 
 
@@ -376,14 +571,51 @@ void ShapeMaker::setBezierSteps(int aSteps)
 }
 
 
+// Sets the flatness tolerance of the bezier curves.
+void ShapeMaker::setFlatness(RATIONAL aFlatness)
+{
+    mFlatness = aFlatness;
+}
+
+
+// Sets whether the curves are kept in the shape data.
+void ShapeMaker::setRetainCurves(bool aRetainCurves)
+{
+    mRetainCurves = aRetainCurves;
+}
+
+
+//! Returns the amount of segments a curve is split to.
+/*! \param aDifference the maximum length of the second differences.
+ *  \param aDegree the degree of the curve.
+ */
+int ShapeMaker::getBezierSteps(RATIONAL aDifference, int aDegree) const
+{
+    if (mFlatness <= INT_TO_RATIONAL(0))
+        return mBezierSteps;
+
+    return PathData::getCurveSteps(aDifference,aDegree,mFlatness);
+}
+
+
 //! Constructor.
-ShapeMaker::ShapeData::ShapeData()
+/*! \param aRetainCurves if true, the path data with the curves is stored as well.
+ */
+ShapeMaker::ShapeData::ShapeData(bool aRetainCurves)
 {
+    mRetainCurves = aRetainCurves;
     mPolygonCount = 0;
     mShapes = NULL;
     mPolygons = NULL;
+    mPaths = NULL;
+    mStrokes = NULL;
     mColors = NULL;
     mFillModes = NULL;
+    mLayerStarts = NULL;
+    mLayerCount = 0;
+    mCurrentFill = true;
+    mCurrentStrokeColor = 0;
+    mCurrentStroke = false;
 }
 
 
@@ -395,32 +627,137 @@ ShapeMaker::ShapeData::~ShapeData()
     {
         delete mShapes[n];
         delete mPolygons[n];
+        delete mPaths[n];
+        delete mStrokes[n];
     }
     delete[] mShapes;
     delete[] mPolygons;
+    delete[] mPaths;
+    delete[] mStrokes;
     delete[] mColors;
     delete[] mFillModes;
+    delete[] mLayerStarts;
 }
 
 
 //! Begins a new polygon.
-bool ShapeMaker::ShapeData::beginPolygon(unsigned long aColor, RENDERER_FILLMODE aFillMode)
+/*! \param aColor the fill color.
+ *  \param aFillMode the fill mode.
+ *  \param aFill if false, the polygon is not filled.
+ *  \param aStrokeColor the stroke color.
+ *  \param aStrokeStyle the stroke style in the coordinates of the vertices, or NULL
+ *         if the polygon is not stroked.
+ */
+bool ShapeMaker::ShapeData::beginPolygon(unsigned long aColor, RENDERER_FILLMODE aFillMode, bool aFill,
+                                         unsigned long aStrokeColor, const StrokeStyle *aStrokeStyle)
+{
+    mCurrentFill = aFill;
+    mCurrentStroke = aStrokeStyle != NULL;
+    if (aStrokeStyle)
+        mCurrentStrokeStyle = *aStrokeStyle;
+    mCurrentStrokeColor = aStrokeColor;
+
+    // The stroker needs the path, so it is recorded for the strokes as well.
+    ShapeEntry *currentShape = new ShapeEntry(mRetainCurves || aStrokeStyle != NULL);
+    if (currentShape == NULL)
+        return false;
+
+    if (!addPolygon(currentShape,aColor,aFillMode))
+    {
+        delete currentShape;
+        return false;
+    }
+
+    return true;
+}
+
+
+//! Ends the polygon.
+/*! If the polygon is both filled and stroked, the stroke is added as a separate
+ *  polygon after the fill. The shape entry of the fill owns the data of both.
+ *  \param aStrokeFlatness the maximum distance of the stroke from the curves and
+ *         the round joins and caps.
+ */
+bool ShapeMaker::ShapeData::endPolygon(RATIONAL aStrokeFlatness)
+{
+    // endPolygon() already called?
+    if (mPolygons[mPolygonCount-1] != NULL)
+        return false;
+
+    ShapeEntry *shape = mShapes[mPolygonCount-1];
+    if (mCurrentStroke && !shape->stroke(mStroker,mCurrentStrokeStyle,aStrokeFlatness))
+        return false;
+
+    if (mCurrentFill || !mCurrentStroke)
+    {
+        if (mCurrentFill)
+            mPolygons[mPolygonCount-1] = shape->createPolygonData();
+        else
+            mPolygons[mPolygonCount-1] = new PolygonData(NULL,NULL,0);
+        if (mPolygons[mPolygonCount-1] == NULL)
+            return false;
+
+        if (mRetainCurves && mCurrentFill)
+        {
+            mPaths[mPolygonCount-1] = shape->createPathData();
+            if (mPaths[mPolygonCount-1] == NULL)
+                return false;
+        }
+
+        if (!mCurrentStroke)
+            return true;
+
+        // The stroke has no shape entry of its own.
+        if (!addPolygon(NULL,mCurrentStrokeColor,RENDERER_FILLMODE_NONZERO))
+            return false;
+    }
+    else
+    {
+        mColors[mPolygonCount-1] = mCurrentStrokeColor;
+        mFillModes[mPolygonCount-1] = RENDERER_FILLMODE_NONZERO;
+    }
+
+    mPolygons[mPolygonCount-1] = shape->createStrokeData();
+    mStrokes[mPolygonCount-1] = new StrokeStyle(mCurrentStrokeStyle);
+    if (mPolygons[mPolygonCount-1] == NULL || mStrokes[mPolygonCount-1] == NULL)
+        return false;
+
+    if (mRetainCurves)
+    {
+        mPaths[mPolygonCount-1] = shape->createPathData();
+        if (mPaths[mPolygonCount-1] == NULL)
+            return false;
+    }
+
+    return true;
+}
+
+
+//! Adds a polygon to the end of the arrays.
+/*! \param aShape the shape entry of the polygon, or NULL if the data is owned by
+ *         another shape entry.
+ *  \param aColor the color.
+ *  \param aFillMode the fill mode.
+ */
+bool ShapeMaker::ShapeData::addPolygon(ShapeEntry *aShape, unsigned long aColor, RENDERER_FILLMODE aFillMode)
 {
     int polygonCount = mPolygonCount + 1;
 
     ShapeEntry **shapes = new ShapeEntry*[polygonCount];
     PolygonData **polygons = new PolygonData*[polygonCount];
+    PathData **paths = new PathData*[polygonCount];
+    StrokeStyle **strokes = new StrokeStyle*[polygonCount];
     unsigned long *colors = new unsigned long[polygonCount];
     RENDERER_FILLMODE *fillModes = new RENDERER_FILLMODE[polygonCount];
-    ShapeEntry *currentShape = new ShapeEntry();
 
-    if (shapes == NULL || polygons == NULL || colors == NULL || fillModes == NULL || currentShape == NULL)
+    if (shapes == NULL || polygons == NULL || paths == NULL || strokes == NULL || colors == NULL || fillModes == NULL)
     {
-        delete shapes;
-        delete polygons;
-        delete colors;
-        delete fillModes;
-        delete currentShape;
+        delete[] shapes;
+        delete[] polygons;
+        delete[] paths;
+        delete[] strokes;
+        delete[] colors;
+        delete[] fillModes;
         return false;
     }
 
@@ -429,22 +766,30 @@ bool ShapeMaker::ShapeData::beginPolygon(unsigned long aColor, RENDERER_FILLMODE
     {
         shapes[n] = mShapes[n];
         polygons[n] = mPolygons[n];
+        paths[n] = mPaths[n];
+        strokes[n] = mStrokes[n];
         colors[n] = mColors[n];
         fillModes[n] = mFillModes[n];
     }
 
     delete[] mShapes;
     delete[] mPolygons;
+    delete[] mPaths;
+    delete[] mStrokes;
     delete[] mColors;
     delete[] mFillModes;
 
     mShapes = shapes;
     mPolygons = polygons;
+    mPaths = paths;
+    mStrokes = strokes;
     mColors = colors;
     mFillModes = fillModes;
 
-    mShapes[mPolygonCount] = currentShape;
+    mShapes[mPolygonCount] = aShape;
     mPolygons[mPolygonCount] = NULL;
+    mPaths[mPolygonCount] = NULL;
+    mStrokes[mPolygonCount] = NULL;
     mColors[mPolygonCount] = aColor;
     mFillModes[mPolygonCount] = aFillMode;
 
@@ -454,17 +799,27 @@ bool ShapeMaker::ShapeData::beginPolygon(unsigned long aColor, RENDERER_FILLMODE
 }
 
 
-//! Ends the polygon.
-bool ShapeMaker::ShapeData::endPolygon()
+//! Begins a new layer at the next polygon.
+bool ShapeMaker::ShapeData::beginLayer()
 {
-    // endPolygon() already called?
-    if (mPolygons[mPolygonCount-1] != NULL)
-        return false;
+    // Layers without polygons are not stored.
+    if (mLayerCount > 0 && mLayerStarts[mLayerCount-1] == mPolygonCount)
+        return true;
 
-    mPolygons[mPolygonCount-1] = mShapes[mPolygonCount-1]->createPolygonData();
-    if (mPolygons[mPolygonCount-1] == NULL)
+    int layerCount = mLayerCount + 1;
+    int *layerStarts = new int[layerCount];
+    if (layerStarts == NULL)
         return false;
 
+    int n;
+    for (n = 0; n < mLayerCount; n++)
+        layerStarts[n] = mLayerStarts[n];
+
+    delete[] mLayerStarts;
+    mLayerStarts = layerStarts;
+    mLayerStarts[mLayerCount] = mPolygonCount;
+    mLayerCount = layerCount;
+
     return true;
 }
 
@@ -483,6 +838,13 @@ bool ShapeMaker::ShapeData::endSubPolygon()
 }
 
 
+//! Marks the current sub polygon closed.
+void ShapeMaker::ShapeData::closeSubPolygon()
+{
+    mShapes[mPolygonCount-1]->closeSubPolygon();
+}
+
+
 //! Adds a vertex to current sub polygon.
 bool ShapeMaker::ShapeData::addVertex(const VECTOR2D &aVertex)
 {
@@ -490,6 +852,13 @@ bool ShapeMaker::ShapeData::addVertex(const VECTOR2D &aVertex)
 }
 
 
+//! Adds a path point to current sub polygon.
+bool ShapeMaker::ShapeData::addPathPoint(const VECTOR2D &aPoint, PATH_POINT_TAG aTag)
+{
+    return mShapes[mPolygonCount-1]->addPathPoint(aPoint,aTag);
+}
+
+
 //! Returns a pointer to the polygon data.
 const PolygonData * const * ShapeMaker::ShapeData::getPolygons() const
 {
@@ -497,6 +866,24 @@ const PolygonData * const * ShapeMaker::ShapeData::getPolygons() const
 }
 
 
+//! Returns a pointer to the path data of the polygons.
+/*! The entries are NULL if the curves are not retained.
+ */
+const PathData * const * ShapeMaker::ShapeData::getPaths() const
+{
+    return mPaths;
+}
+
+
+//! Returns a pointer to the stroke styles of the polygons.
+/*! The entries are NULL for the fills.
+ */
+const StrokeStyle * const * ShapeMaker::ShapeData::getStrokes() const
+{
+    return mStrokes;
+}
+
+
 //! Returns a pointer to the color data.
 const unsigned long * ShapeMaker::ShapeData::getColors() const
 {
@@ -518,12 +905,35 @@ int ShapeMaker::ShapeData::getPolygonCount() const
 }
 
 
+//! Returns a pointer to the index of the first polygon of each layer.
+const int * ShapeMaker::ShapeData::getLayerStarts() const
+{
+    return mLayerStarts;
+}
+
+
+//! Returns the layer count.
+int ShapeMaker::ShapeData::getLayerCount() const
+{
+    return mLayerCount;
+}
+
+
 //! Constructor.
-ShapeMaker::ShapeData::ShapeEntry::ShapeEntry()
+ShapeMaker::ShapeData::ShapeEntry::ShapeEntry(bool aRetainCurves)
 {
     mVertexData = NULL;
     mVertexCounts = NULL;
     mSubPolygonCount = 0;
+    mRetainCurves = aRetainCurves;
+    mPointData = NULL;
+    mTagData = NULL;
+    mPointCounts = NULL;
+    mClosedData = NULL;
+    mStrokeVertices = NULL;
+    mStrokeData = NULL;
+    mStrokeCounts = NULL;
+    mStrokeCount = 0;
 }
 
 
@@ -534,9 +944,21 @@ ShapeMaker::ShapeData::ShapeEntry::~ShapeEntry()
     for (n = 0; n < mSubPolygonCount; n++)
     {
         delete[] mVertexData[n];
+        if (mRetainCurves)
+        {
+            delete[] mPointData[n];
+            delete[] mTagData[n];
+        }
     }
     delete[] mVertexData;
     delete[] mVertexCounts;
+    delete[] mPointData;
+    delete[] mTagData;
+    delete[] mPointCounts;
+    delete[] mClosedData;
+    delete[] mStrokeVertices;
+    delete[] mStrokeData;
+    delete[] mStrokeCounts;
 }
 
 
@@ -549,6 +971,77 @@ PolygonData * ShapeMaker::ShapeData::ShapeEntry::createPolygonData() const
 }
 
 
+//! Creates a PathData from the contents of the shape entry.
+/*! Returns NULL if the curves are not retained. Note that the ShapeEntry owns
+ *  the data the PathData refers to.
+ */
+PathData * ShapeMaker::ShapeData::ShapeEntry::createPathData() const
+{
+    if (!mRetainCurves)
+        return NULL;
+    return new PathData(mPointData, mTagData, mPointCounts, mSubPolygonCount, mClosedData);
+}
+
+
+//! Creates a PolygonData from the stroked outline of the shape entry.
+/*! Note that the ShapeEntry owns the data the PolygonData refers to.
+ */
+PolygonData * ShapeMaker::ShapeData::ShapeEntry::createStrokeData() const
+{
+    return new PolygonData(mStrokeData, mStrokeCounts, mStrokeCount);
+}
+
+
+//! Strokes the path of the shape entry.
+/*! The stroked outline is copied to the shape entry, so the same stroker can be
+ *  used for all the shape entries.
+ *  \param aStroker the stroker.
+ *  \param aStyle the stroke style.
+ *  \param aFlatness the maximum distance of the outline from the curves and the
+ *         round joins and caps.
+ */
+bool ShapeMaker::ShapeData::ShapeEntry::stroke(Stroker &aStroker, const StrokeStyle &aStyle, RATIONAL aFlatness)
+{
+    if (!mRetainCurves)
+        return false;
+
+    PathData pathData(mPointData, mTagData, mPointCounts, mSubPolygonCount, mClosedData);
+    if (!aStroker.stroke(&pathData, aStyle, aStyle.mWidth, aFlatness))
+        return false;
+
+    int strokeCount = aStroker.getSubPolygonCount();
+    const RATIONAL * const *vertexData = aStroker.getVertexData();
+    const int *vertexCounts = aStroker.getVertexCounts();
+
+    int vertexCount = 0;
+    int n;
+    for (n = 0; n < strokeCount; n++)
+        vertexCount += vertexCounts[n];
+
+    mStrokeVertices = new RATIONAL[vertexCount * 2];
+    mStrokeData = new RATIONAL*[strokeCount];
+    mStrokeCounts = new int[strokeCount];
+    if (mStrokeVertices == NULL || mStrokeData == NULL || mStrokeCounts == NULL)
+        return false;
+
+    // The outlines are copied to a single array.
+    RATIONAL *vertices = mStrokeVertices;
+    for (n = 0; n < strokeCount; n++)
+    {
+        int p;
+        for (p = 0; p < vertexCounts[n] * 2; p++)
+            vertices[p] = vertexData[n][p];
+
+        mStrokeData[n] = vertices;
+        mStrokeCounts[n] = vertexCounts[n];
+        vertices += vertexCounts[n] * 2;
+    }
+    mStrokeCount = strokeCount;
+
+    return true;
+}
+
+
 //! Starts a new sub polygon.
 bool ShapeMaker::ShapeData::ShapeEntry::beginSubPolygon()
 {
@@ -563,6 +1056,49 @@ bool ShapeMaker::ShapeData::ShapeEntry::beginSubPolygon()
         return false;
     }
 
+    if (mRetainCurves)
+    {
+        RATIONAL **pointData = new RATIONAL*[subPolygonCount];
+        PATH_POINT_TAG **tagData = new PATH_POINT_TAG*[subPolygonCount];
+        int *pointCounts = new int[subPolygonCount];
+        bool *closedData = new bool[subPolygonCount];
+
+        if (pointData == NULL || tagData == NULL || pointCounts == NULL || closedData == NULL)
+        {
+            delete[] vertexData;
+            delete[] vertexCounts;
+            delete[] pointData;
+            delete[] tagData;
+            delete[] pointCounts;
+            delete[] closedData;
+            return false;
+        }
+
+        int n;
+        for (n = 0; n < mSubPolygonCount; n++)
+        {
+            pointData[n] = mPointData[n];
+            tagData[n] = mTagData[n];
+            pointCounts[n] = mPointCounts[n];
+            closedData[n] = mClosedData[n];
+        }
+
+        delete[] mPointData;
+        delete[] mTagData;
+        delete[] mPointCounts;
+        delete[] mClosedData;
+
+        mPointData = pointData;
+        mTagData = tagData;
+        mPointCounts = pointCounts;
+        mClosedData = closedData;
+
+        mPointData[mSubPolygonCount] = NULL;
+        mTagData[mSubPolygonCount] = NULL;
+        mPointCounts[mSubPolygonCount] = 0;
+        mClosedData[mSubPolygonCount] = false;
+    }
+
     int n;
     for (n = 0; n < mSubPolygonCount; n++)
     {
@@ -608,10 +1144,46 @@ bool ShapeMaker::ShapeData::ShapeEntry::endSubPolygon()
     delete[] srcVertices;
     mVertexData[index] = vertices;
 
+    if (mRetainCurves && mPointCounts[index] > 0)
+    {
+        // Crop the path data to actual size.
+        RATIONAL *points = new RATIONAL[mPointCounts[index] * 2];
+        PATH_POINT_TAG *tags = new PATH_POINT_TAG[mPointCounts[index]];
+        if (points == NULL || tags == NULL)
+        {
+            delete[] points;
+            delete[] tags;
+            return false;
+        }
+
+        for (n = 0; n < mPointCounts[index]; n++)
+        {
+            points[n * 2] = mPointData[index][n * 2];
+            points[n * 2 + 1] = mPointData[index][n * 2 + 1];
+            tags[n] = mTagData[index][n];
+        }
+
+        delete[] mPointData[index];
+        delete[] mTagData[index];
+        mPointData[index] = points;
+        mTagData[index] = tags;
+    }
+
     return true;
 }
 
 
+//! Marks the current sub polygon closed.
+/*! The sub polygons are always closed when filled, so this affects only the strokes.
+ */
+void ShapeMaker::ShapeData::ShapeEntry::closeSubPolygon()
+{
+    int index = mSubPolygonCount - 1;
+    if (index >= 0 && mRetainCurves)
+        mClosedData[index] = true;
+}
+
+
 //! Adds a vertex to the shape entry.
 bool ShapeMaker::ShapeData::ShapeEntry::addVertex(const VECTOR2D &aVertex)
 {
@@ -651,6 +1223,56 @@ bool ShapeMaker::ShapeData::ShapeEntry::addVertex(const VECTOR2D &aVertex)
 }
 
 
+//! Adds a path point to the shape entry.
+bool ShapeMaker::ShapeData::ShapeEntry::addPathPoint(const VECTOR2D &aPoint, PATH_POINT_TAG aTag)
+{
+    if (!mRetainCurves)
+        return true;
+
+    int index = mSubPolygonCount - 1;
+    if (index < 0)
+        return false;
+
+    int pointCount = mPointCounts[index];
+
+    // Resize the point arrays in chunks.
+    // The size will be cropped to actual size at endSubPolygon().
+    if ((pointCount & 0xff) == 0)
+    {
+        RATIONAL *newPoints = new RATIONAL[(pointCount + 0x100) * 2];
+        PATH_POINT_TAG *newTags = new PATH_POINT_TAG[pointCount + 0x100];
+        if (newPoints == NULL || newTags == NULL)
+        {
+            delete[] newPoints;
+            delete[] newTags;
+            return false;
+        }
+
+        int n;
+        for (n = 0; n < pointCount; n++)
+        {
+            newPoints[n * 2] = mPointData[index][n * 2];
+            newPoints[n * 2 + 1] = mPointData[index][n * 2 + 1];
+            newTags[n] = mTagData[index][n];
+        }
+
+        delete[] mPointData[index];
+        delete[] mTagData[index];
+
+        mPointData[index] = newPoints;
+        mTagData[index] = newTags;
+    }
+
+    mPointCounts[index]++;
+
+    mPointData[index][pointCount * 2] = VECTOR2D_GETX(aPoint);
+    mPointData[index][pointCount * 2 + 1] = VECTOR2D_GETY(aPoint);
+    mTagData[index][pointCount] = aTag;
+
+    return true;
+}
+
+
 //! Returns a pointer to the shape data gathered since the last call to newShape().
 const ShapeMaker::ShapeData * ShapeMaker::getShapeData() const
 {
@@ -658,6 +1280,113 @@ const ShapeMaker::ShapeData * ShapeMaker::getShapeData() const
 }
 
 
+//! Returns the amount of segments a quarter of an ellipse is split to.
+/*! The segments are of equal angle, and their count is the smallest one that
+ *  keeps the segments within the flatness from the ellipse at the largest
+ *  radius of the ellipse after the transformation. This gives fewer segments
+ *  than splitting the bezier curves of the ellipse.
+ *  \param aCenter the center of the ellipse.
+ *  \param aRadius the radii of the ellipse.
+ */
+int ShapeMaker::getArcSteps(const VECTOR2D &aCenter, const VECTOR2D &aRadius) const
+{
+    if (mFlatness <= INT_TO_RATIONAL(0))
+        return mBezierSteps;
+
+    // The largest radius is the largest singular value of the transformed axes.
+    VECTOR2D center, axis1, axis2;
+    MATRIX2D_TRANSFORM(mTransformation,aCenter,center);
+    MATRIX2D_TRANSFORM(mTransformation,VECTOR2D(VECTOR2D_GETX(aCenter) + VECTOR2D_GETX(aRadius),VECTOR2D_GETY(aCenter)),axis1);
+    MATRIX2D_TRANSFORM(mTransformation,VECTOR2D(VECTOR2D_GETX(aCenter),VECTOR2D_GETY(aCenter) + VECTOR2D_GETY(aRadius)),axis2);
+
+    double ux = VECTOR2D_GETX(axis1) - VECTOR2D_GETX(center);
+    double uy = VECTOR2D_GETY(axis1) - VECTOR2D_GETY(center);
+    double vx = VECTOR2D_GETX(axis2) - VECTOR2D_GETX(center);
+    double vy = VECTOR2D_GETY(axis2) - VECTOR2D_GETY(center);
+    double uu = ux * ux + uy * uy;
+    double vv = vx * vx + vy * vy;
+    double uv = ux * vx + uy * vy;
+    double radius = sqrt((uu + vv) / 2 + sqrt((uu - vv) * (uu - vv) / 4 + uv * uv));
+
+    // A segment of angle a is within r(1 - cos(a/2)) from the circle.
+    if (radius <= mFlatness)
+        return 1;
+    double angle = 2 * acos(1 - mFlatness / radius);
+    double steps = 3.1415926535897932384626433832795 / 2 / angle;
+    if (steps >= PATH_DATA_MAX_CURVE_STEPS)
+        return PATH_DATA_MAX_CURVE_STEPS;
+
+    int n = (int)ceil(steps);
+    if (n < 1)
+        n = 1;
+    return n;
+}
+
+
+//! Draws a quarter of an ellipse from the current point.
+/*! The current point must be at the start of the quarter. The path data gets a
+ *  cubic bezier curve for the quarter, so that the ellipse can be flattened
+ *  again for other scales.
+ *  \param aCenter the center of the ellipse.
+ *  \param aRadius the radii of the ellipse.
+ *  \param aQuadrant the quadrant from 0 to 3, starting at the positive x axis
+ *         and turning towards the positive y axis.
+ *  \param aSteps the amount of segments.
+ */
+bool ShapeMaker::arcTo(const VECTOR2D &aCenter, const VECTOR2D &aRadius, int aQuadrant, int aSteps)
+{
+    static const int cosines[5] = { 1, 0, -1, 0, 1 };
+    static const int sines[5] = { 0, 1, 0, -1, 0 };
+
+    RATIONAL cx = VECTOR2D_GETX(aCenter);
+    RATIONAL cy = VECTOR2D_GETY(aCenter);
+    RATIONAL rx = VECTOR2D_GETX(aRadius);
+    RATIONAL ry = VECTOR2D_GETY(aRadius);
+
+    double startAngle = aQuadrant * 3.1415926535897932384626433832795 / 2;
+    double step = 3.1415926535897932384626433832795 / 2 / aSteps;
+    int n;
+    for (n = 1; n < aSteps; n++)
+    {
+        double angle = startAngle + n * step;
+        VECTOR2D point((RATIONAL)(cx + rx * cos(angle)),(RATIONAL)(cy + ry * sin(angle)));
+        VECTOR2D position;
+        MATRIX2D_TRANSFORM(mTransformation,point,position);
+        if (!edgeTo(position))
+            return false;
+    }
+
+    // The end points are exact, so that the straight edges of rounded
+    // rectangles stay axis-aligned.
+    RATIONAL cos0 = INT_TO_RATIONAL(cosines[aQuadrant]);
+    RATIONAL sin0 = INT_TO_RATIONAL(sines[aQuadrant]);
+    RATIONAL cos1 = INT_TO_RATIONAL(cosines[aQuadrant + 1]);
+    RATIONAL sin1 = INT_TO_RATIONAL(sines[aQuadrant + 1]);
+    RATIONAL kx = (RATIONAL)(rx * SHAPEMAKER_ARC_KAPPA);
+    RATIONAL ky = (RATIONAL)(ry * SHAPEMAKER_ARC_KAPPA);
+
+    VECTOR2D point1(cx + rx * cos0 - kx * sin0,cy + ry * sin0 + ky * cos0);
+    VECTOR2D point2(cx + rx * cos1 + kx * sin1,cy + ry * sin1 - ky * cos1);
+    VECTOR2D point3(cx + rx * cos1,cy + ry * sin1);
+
+    VECTOR2D p1, p2, p3;
+    MATRIX2D_TRANSFORM(mTransformation,point1,p1);
+    MATRIX2D_TRANSFORM(mTransformation,point2,p2);
+    MATRIX2D_TRANSFORM(mTransformation,point3,p3);
+
+    if (!edgeTo(p3) ||
+        !pathTo(p1,PATH_POINT_CUBIC) ||
+        !pathTo(p2,PATH_POINT_CUBIC) ||
+        !pathTo(p3,PATH_POINT_ON_CURVE))
+        return false;
+
+    mCurrentPoint = point3;
+    mCurrentControlPoint = point2;
+
+    return true;
+}
+
+
 //! Moves the internal cursor to a new position.
 /*! This uses the transformed coordinates.
  */
@@ -678,7 +1407,8 @@ bool ShapeMaker::edgeTo(const VECTOR2D &aPosition)
     {
         if (!mShapeData->endSubPolygon() ||
             !mShapeData->beginSubPolygon() ||
-            !mShapeData->addVertex(mInternalCursorPos))
+            !mShapeData->addVertex(mInternalCursorPos) ||
+            !pathTo(mInternalCursorPos,PATH_POINT_ON_CURVE))
             return false;
         mInternalCursorMove = false;
     }
@@ -688,3 +1418,14 @@ bool ShapeMaker::edgeTo(const VECTOR2D &aPosition)
 
     return true;
 }
+
+
+//! Adds a path point if the curves are retained or the path is stroked.
+/*! The path points are added after the edges, so that the sub polygon has been
+ *  started by edgeTo(). The shape entry ignores the points if it doesn't need
+ *  them. This uses the transformed coordinates.
+ */
+bool ShapeMaker::pathTo(const VECTOR2D &aPoint, PATH_POINT_TAG aTag)
+{
+    return mShapeData->addPathPoint(aPoint,aTag);
+}
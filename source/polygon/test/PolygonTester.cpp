@@ -35,6 +35,7 @@ PolygonTester::PolygonTester()
     mRotationSpeed = INT_TO_RATIONAL(0);
     mScale = INT_TO_RATIONAL(1);
     mScales = NULL;
+    mSceneRendering = false;
 }
 
 
@@ -134,6 +135,13 @@ void PolygonTester::setScale(RATIONAL aScale, int aVectorGraphic)
 }
 
 
+//! Sets the vector graphics to be rendered as a single scene.
+void PolygonTester::setSceneRendering(bool aSceneRendering)
+{
+    mSceneRendering = aSceneRendering;
+}
+
+
 //! Runs one iteration of the test. This renders the graphic to aTarget.
 void PolygonTester::runTest(RenderTargetWrapper *aTarget)
 {
@@ -160,7 +168,10 @@ void PolygonTester::runTest(RenderTargetWrapper *aTarget)
     TICKCOUNTER counter;
 
     TICKCOUNTER_START(counter);
-    mVectorGraphics[currentGraphic]->render(mFillers[currentFiller],aTarget,transformation);
+    if (mSceneRendering)
+        mVectorGraphics[currentGraphic]->renderScene(mFillers[currentFiller],aTarget,transformation);
+    else
+        mVectorGraphics[currentGraphic]->render(mFillers[currentFiller],aTarget,transformation);
     TICKCOUNTER_END(counter);
 
     mTestTimings[mCurrentTest] += TICKCOUNTER_GETTICKS(counter);
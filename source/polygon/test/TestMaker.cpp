@@ -700,9 +700,11 @@ PolygonTester * TestMaker::createQualityTest(Renderer **aRenderers, char **aRend
                                           VECTOR2D(INT_TO_RATIONAL(110),INT_TO_RATIONAL(110)),
                                           RENDERER_FILLMODE_EVENODD, 0xff000000,
                                           aFactory,NULL,NULL);
-        vgs[p++] = loadSVGtoVectorGraphic(aFactory,aSVGPath,"froggy.svg",NULL,NULL);
-        vgs[p++] = loadSVGtoVectorGraphic(aFactory,aSVGPath,"froggy-simple.svg",NULL,NULL);
-        vgs[p++] = loadSVGtoVectorGraphic(aFactory,aSVGPath,"lorem_ipsum_separate.svg",NULL,NULL);
+
+        // The SVG files are loaded concurrently.
+        const char * const svgNames[3] = { "froggy.svg", "froggy-simple.svg", "lorem_ipsum_separate.svg" };
+        loadSVGstoVectorGraphics(aFactory,aSVGPath,svgNames,NULL,NULL,3,&vgs[p]);
+        p += 3;
 
         for (n = 0; n < vgsCount; n++)
         {